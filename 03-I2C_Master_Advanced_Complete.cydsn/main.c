@@ -282,14 +282,7 @@ int main(void)
                                                 LIS3DH_OUT_ADC_3L,
                                                 2,
                                                 &TemperatureData[0]);
-        
-        error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                            LIS3DH_OUT_ADC_3L,
-                                            &TemperatureData[0]);
-        
-        error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                            LIS3DH_OUT_ADC_3H,
-                                            &TemperatureData[1]);
+        // OUT_ADC_3L and OUT_ADC_3H are both read by the Multi-Read above
         if(error == NO_ERROR)
         {
             OutTemp = (int16)((TemperatureData[0] | (TemperatureData[1]<<8)))>>6;
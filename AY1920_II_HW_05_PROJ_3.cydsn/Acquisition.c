@@ -0,0 +1,652 @@
+/*
+* This file includes the acquisition task of the accelerometer data.
+*/
+
+#include "Acquisition.h"
+#include "I2C_Interface.h"
+#include "LIS3DH_Registers.h"
+#include "PowerManager.h"
+#include "Scheduler.h"
+#include "Frames.h"
+#include "Capture.h"
+#include "Statistics.h"
+#include "Spectrum.h"
+#include "Decimator.h"
+#include "Tilt.h"
+#include "Velocity.h"
+#include "Device.h"
+#include "I2C_Queue.h"
+#include "TempCompensation.h"
+#include "Calibration.h"
+#include "Timestamp.h"
+#include "Health.h"
+#include "Compress.h"
+#include "FlashLog.h"
+#include "Format.h"
+#include "InterruptRoutines.h"
+#include "project.h"
+
+/**
+*   \brief Output data rate [Hz] of each ODR code of the Control register 1
+*/
+static const uint16_t odr_hz[] = {0, 1, 10, 25, 50, 100, 200, 400};
+
+static uint8_t CompressedArray[COMPRESS_MAX_PAYLOAD]; // Payload of a compressed frame
+static uint8_t AccData[DEVICE_FIFO_BUFFER_SIZE]; // Status register and acceleration data of a FIFO batch
+static int32_t batch[LIS3DH_FIFO_SIZE][3]; // Batch converted in mm/s^2
+static int32_t decimated[LIS3DH_FIFO_SIZE / 2 + 1][3];
+static uint8_t acquisition_task_id = 0;
+static uint8_t data_rate = LIS3DH_ODR_100HZ;
+static uint32_t sample_count = 0;
+static uint16_t output_mode = ACQUISITION_OUTPUT_RAW;
+static uint8_t text_output = 0;
+static uint16_t temperature_divider = 0;
+static uint8_t next_device = 1;     // First of the other devices served in the next period
+static uint32_t period_start = 0;   // Cycle counter at the start of the last acquisition
+static uint8_t AdcData[6];          // ADC channels, filled by the I2C queue
+static uint32_t temperature_index = 0;
+static uint8_t temperature_pending = 0;  // ADC burst queued and not sent yet
+static uint8_t temperature_ready = 0;    // AdcData holds a completed burst
+static uint32_t temperature_due = 0;    // sample count of the next ADC reading
+static uint8_t compensation_enabled = 0;
+static uint32_t sync_due = 0;           // Tick of the next clock sync frame
+static uint32_t health_due = 0;         // Tick of the next health frame
+static uint32_t last_skipped = 0;       // Releases lost by the scheduler at the previous run
+static uint8_t timestamp_synced = 0;    // The host has the previous timestamp frame
+static uint32_t timestamp_last = 0;     // Time of the previous timestamp frame [us]
+static uint32_t timestamp_due = 0;      // Tick of the next timestamp frame
+static uint16_t timestamp_samples = 0;  // Samples of device 0 since the previous timestamp frame
+static uint8_t retries = 0;             // Reads repeated in the current period
+
+    void Acquisition_Init(uint8_t task_id)
+    {
+        acquisition_task_id = task_id;
+        Timestamp_Reset();
+        Timestamp_SetRate(odr_hz[data_rate]);
+        FlashLog_SetRate(odr_hz[data_rate]);
+    }
+
+    ErrorCode Acquisition_SetDataRate(uint8_t odr)
+    {
+        if (odr < LIS3DH_ODR_1HZ || odr > LIS3DH_ODR_400HZ)
+        {
+            return ERROR;
+        }
+
+        // Same ODR on every device: all of them are served in one period
+        ErrorCode error = Device_UpdateRegisterAll(LIS3DH_CTRL_REG1,
+                                                   LIS3DH_CTRL_REG1_ODR_MASK,
+                                                   odr << LIS3DH_CTRL_REG1_ODR_SHIFT);
+        if (error == NO_ERROR)
+        {
+            data_rate = odr;
+            Velocity_SetRate(odr_hz[odr]);
+            Timestamp_SetRate(odr_hz[odr]);
+            FlashLog_SetRate(odr_hz[odr]);
+
+            // Poll the sensor once per sample period (Timer tick = 10 ms)
+            uint32_t period = 100 / odr_hz[odr];
+            Scheduler_SetPeriod(acquisition_task_id, period ? period : 1);
+
+            // Tell the host which sample starts the new time base
+            Packets_Rate rate = { odr_hz[odr], sample_count, Timer_Tick };
+            uint8_t payload[PACKETS_RATE_LENGTH];
+            Packets_PackRate(payload, &rate);
+            Frames_Send(FRAME_HEADER_RATE, payload, sizeof(payload));
+        }
+        return error;
+    }
+
+    uint16_t Acquisition_GetDataRate(void)
+    {
+        return odr_hz[data_rate];
+    }
+
+    uint32_t Acquisition_GetSampleCount(void)
+    {
+        return sample_count;
+    }
+
+    ErrorCode Acquisition_SetTemperatureDivider(uint16_t divider)
+    {
+        // BDU is already set in the Control register 4, as required by the ADC
+        ErrorCode error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
+                                                       LIS3DH_TEMP_CFG_REG,
+                                                       divider ? LIS3DH_TEMP_CFG_REG_ADC_EN | LIS3DH_TEMP_CFG_REG_TEMP_EN : 0);
+        if (error == NO_ERROR)
+        {
+            temperature_divider = divider;
+            temperature_due = sample_count;
+            if (!divider)
+            {
+                // No more temperature readings to follow the drift
+                compensation_enabled = 0;
+            }
+        }
+        return error;
+    }
+
+    uint16_t Acquisition_GetTemperatureDivider(void)
+    {
+        return temperature_divider;
+    }
+
+    ErrorCode Acquisition_SetCompensation(uint8_t enabled)
+    {
+        if (enabled && !TempComp_IsLoaded())
+        {
+            return ERROR;
+        }
+        if (enabled && !temperature_divider)
+        {
+            ErrorCode error = Acquisition_SetTemperatureDivider(ACQUISITION_DEFAULT_TEMPERATURE_DIVIDER);
+            if (error != NO_ERROR)
+            {
+                return error;
+            }
+        }
+        compensation_enabled = enabled;
+        return NO_ERROR;
+    }
+
+    uint8_t Acquisition_IsCompensated(void)
+    {
+        return compensation_enabled;
+    }
+
+    /**
+    *   \brief Completion of the ADC burst: only mark the result.
+    *
+    *   The callback runs inside the I2C queue, in the middle of another
+    *   task; the frame is sent by the acquisition task.
+    */
+    static void Acquisition_TemperatureRead(const I2C_Transaction* transaction, ErrorCode error)
+    {
+        (void)transaction;
+        if (error != NO_ERROR)
+        {
+            temperature_pending = 0;
+            return;
+        }
+        temperature_ready = 1;
+    }
+
+    /**
+    *   \brief Send the auxiliary frame of the last completed ADC burst.
+    */
+    static void Acquisition_SendTemperature(void)
+    {
+        if (!temperature_ready)
+        {
+            return;
+        }
+        temperature_ready = 0;
+        // AdcData stays untouched until the next burst, queued from now on
+        temperature_pending = 0;
+
+        int16_t out[3];
+        for (uint8_t channel = 0; channel < 3; channel++)
+        {
+            //10-bit left justified data
+            out[channel] = (int16)(AdcData[2 * channel] | (AdcData[2 * channel + 1] << 8)) >> 6;
+        }
+        // The last channel is the temperature
+        TempComp_Update(out[2]);
+        Packets_Auxiliary auxiliary = { temperature_index, out[0], out[1], out[2] };
+        uint8_t payload[PACKETS_AUXILIARY_LENGTH];
+        Packets_PackAuxiliary(payload, &auxiliary);
+        Frames_Send(FRAME_HEADER_AUXILIARY, payload, sizeof(payload));
+    }
+
+    /**
+    *   \brief Queue the reading of the three ADC channels in one burst.
+    */
+    static void Acquisition_ReadTemperature(void)
+    {
+        if (temperature_pending)
+        {
+            return;
+        }
+        I2C_Transaction transaction = {
+            LIS3DH_DEVICE_ADDRESS, LIS3DH_OUT_ADC1_L, 6, 0,
+            I2C_PRIORITY_TELEMETRY, AdcData, Acquisition_TemperatureRead
+        };
+        if (I2C_Queue_Submit(&transaction) == NO_ERROR)
+        {
+            temperature_index = sample_count;
+            temperature_pending = 1;
+        }
+        else
+        {
+            Health_Count(HEALTH_QUEUE_REJECT, 1);
+        }
+    }
+
+    uint32_t Acquisition_GetBusBudget(void)
+    {
+        const Scheduler_Task* task = Scheduler_GetTask(acquisition_task_id);
+        uint32_t period_us = (task ? task->period : 1) * 10000u;
+        uint32_t elapsed_us = (PowerManager_ReadCycles() - period_start) / (POWER_CYCLES_PER_TICK / 10000u);
+        if (elapsed_us + ACQUISITION_BUS_MARGIN_US >= period_us)
+        {
+            return 0;
+        }
+        return period_us - elapsed_us - ACQUISITION_BUS_MARGIN_US;
+    }
+
+    uint16_t Acquisition_GetTxAllowance(void)
+    {
+        uint32_t allowance = Frames_GetTxFree() +
+                             Acquisition_GetBusBudget() / 1000u * Frames_GetLinkRate() / 1000u;
+        return allowance > 0xFFFFu ? 0xFFFFu : (uint16_t)allowance;
+    }
+
+    void Acquisition_SetOutputMode(uint16_t mode)
+    {
+        output_mode = mode;
+    }
+
+    uint16_t Acquisition_GetOutputMode(void)
+    {
+        return output_mode;
+    }
+
+    uint32_t Acquisition_GetRawLoad(void)
+    {
+        uint32_t frame_bytes = PACKETS_SAMPLE_LENGTH + 2u;
+        if (output_mode & ACQUISITION_OUTPUT_OTHERS)
+        {
+            uint8_t others = Device_GetCount() > 1 ? Device_GetCount() - 1 : 0;
+            frame_bytes += (uint32_t)others * (PACKETS_DEVICE_SAMPLE_LENGTH + 2u);
+        }
+
+        // A timestamp frame with the first batch of each timestamp period,
+        // relative (3 bytes) when the previous one is less than 65.5 ms old
+        const Scheduler_Task* task = Scheduler_GetTask(acquisition_task_id);
+        uint32_t interval = task && task->period > ACQUISITION_TIMESTAMP_PERIOD ? task->period : ACQUISITION_TIMESTAMP_PERIOD;
+        uint32_t timestamp_bytes = (interval * 10u < FRAME_TIMESTAMP_ABSOLUTE / 1000u ? 3u : 7u) + 2u;
+        uint32_t periodic = timestamp_bytes * 100u / interval +
+                            (PACKETS_SYNC_LENGTH + 2u) * 100u / ACQUISITION_SYNC_PERIOD +
+                            (9u + 4u * HEALTH_COUNTERS + 2u) * 100u / ACQUISITION_HEALTH_PERIOD;
+        return frame_bytes * Acquisition_GetDataRate() + periodic;
+    }
+
+    void Acquisition_SetTextOutput(uint8_t enabled)
+    {
+        text_output = enabled;
+        timestamp_synced = 0;
+    }
+
+    uint8_t Acquisition_GetTextOutput(void)
+    {
+        return text_output;
+    }
+
+    /**
+    *   \brief Send the statistics of a completed window as a summary frame.
+    *
+    *   Payload of PACKETS_SUMMARY_LENGTH (58) bytes: first index (4), count
+    *   (2), mean, RMS, min, max of each axis (3 x 16) and RMS of the
+    *   magnitude (4); 60 bytes on the wire with the header and the tail.
+    */
+    static void Acquisition_SendSummary(const Statistics_Result* result)
+    {
+        const Statistics_Axis* axis = result->axis;
+        Packets_Summary summary = {
+            result->first_index, result->count,
+            axis[0].mean, axis[0].rms, axis[0].min, axis[0].max,
+            axis[1].mean, axis[1].rms, axis[1].min, axis[1].max,
+            axis[2].mean, axis[2].rms, axis[2].min, axis[2].max,
+            result->magnitude_rms
+        };
+        uint8_t payload[PACKETS_SUMMARY_LENGTH];
+        Packets_PackSummary(payload, &summary);
+        Frames_Send(FRAME_HEADER_SUMMARY, payload, sizeof(payload));
+    }
+
+    ErrorCode Acquisition_Start(void)
+    {
+        return Device_StartFifo();
+    }
+
+    /**
+    *   \brief Pass a converted sample to the selected outputs.
+    */
+    static void Acquisition_Output(const int32_t acceleration[3])
+    {
+        if ((output_mode & ACQUISITION_OUTPUT_RAW) && text_output)
+        {
+            // CSV line in [0.01 m/s^2], rounded: at most 22 bytes at +-16 g
+            char line[24];
+            char* position = line;
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                int32_t value = acceleration[axis];
+                position = Format_PutInt(position, (value >= 0 ? value + 5 : value - 5) / 10);
+                *position++ = axis < 2 ? ',' : '\r';
+            }
+            *position++ = '\n';
+            Frames_SendText(line, (uint8_t)(position - line));
+        }
+        else if (output_mode & ACQUISITION_OUTPUT_RAW)
+        {
+            // Values in [mm/s^2]
+            Packets_Sample sample = { acceleration[0], acceleration[1], acceleration[2] };
+            uint8_t payload[PACKETS_SAMPLE_LENGTH];
+            Packets_PackSample(payload, &sample);
+            Frames_Send(FRAME_HEADER_SAMPLE, payload, sizeof(payload));
+        }
+        if ((output_mode & ACQUISITION_OUTPUT_COMPRESSED) || FlashLog_IsRecording())
+        {
+            // A lost frame breaks the differences: restart with a keyframe
+            uint8_t length = Compress_AddSample(acceleration, sample_count, CompressedArray);
+            if (length > 0 && FlashLog_IsRecording() &&
+                FlashLog_Add(Timer_Tick, CompressedArray) != NO_ERROR)
+            {
+                Compress_Reset();
+            }
+            if (length > 0 && (output_mode & ACQUISITION_OUTPUT_COMPRESSED) &&
+                Frames_Send(FRAME_HEADER_COMPRESSED, CompressedArray, length) != NO_ERROR)
+            {
+                Compress_Reset();
+            }
+        }
+        if (output_mode & ACQUISITION_OUTPUT_CAPTURE)
+        {
+            Capture_AddSample(acceleration, sample_count);
+        }
+        if (output_mode & ACQUISITION_OUTPUT_SUMMARY)
+        {
+            Statistics_Result result;
+            if (Statistics_AddSample(acceleration, sample_count, &result))
+            {
+                Acquisition_SendSummary(&result);
+            }
+        }
+        if (output_mode & ACQUISITION_OUTPUT_SPECTRUM)
+        {
+            Spectrum_AddSample(acceleration, sample_count);
+        }
+        if (output_mode & ACQUISITION_OUTPUT_TILT)
+        {
+            Tilt_Result tilt;
+            if (Tilt_AddSample(acceleration, sample_count, &tilt))
+            {
+                Packets_Tilt packet = { tilt.first_index, tilt.pitch, tilt.roll };
+                uint8_t payload[PACKETS_TILT_LENGTH];
+                Packets_PackTilt(payload, &packet);
+                Frames_Send(FRAME_HEADER_TILT, payload, sizeof(payload));
+            }
+        }
+        if (output_mode & ACQUISITION_OUTPUT_VELOCITY)
+        {
+            Velocity_Result velocity;
+            if (Velocity_AddSample(acceleration, sample_count, &velocity))
+            {
+                Packets_Velocity packet = {
+                    velocity.first_index, velocity.count,
+                    velocity.rms[0], velocity.rms[1], velocity.rms[2]
+                };
+                uint8_t payload[PACKETS_VELOCITY_LENGTH];
+                Packets_PackVelocity(payload, &packet);
+                Frames_Send(FRAME_HEADER_VELOCITY, payload, sizeof(payload));
+            }
+        }
+        PowerManager_CountSample();
+        sample_count++;
+    }
+
+    /**
+    *   \brief Send a timestamp frame before a batch, delta encoded when
+    *   possible.
+    *
+    *   \param delta Time since the previous timestamp frame [us], 0 if the
+    *   host does not have it.
+    *   \param count Samples since the previous timestamp frame, those of the
+    *   batch included.
+    */
+    static ErrorCode Acquisition_SendTimestamp(uint32_t now, uint32_t delta, uint8_t count)
+    {
+        uint8_t payload[7];
+        payload[0] = count;
+        if (delta == 0 || delta >= FRAME_TIMESTAMP_ABSOLUTE)
+        {
+            uint8_t* position = Frames_PutUint16(&payload[1], FRAME_TIMESTAMP_ABSOLUTE);
+            Frames_PutUint32(position, now);
+            return Frames_Send(FRAME_HEADER_TIMESTAMP, payload, 7);
+        }
+        Frames_PutUint16(&payload[1], (uint16_t)delta);
+        return Frames_Send(FRAME_HEADER_TIMESTAMP, payload, 3);
+    }
+
+    /**
+    *   \brief Read the FIFO of device 0 and pass its samples through the
+    *   processing chain.
+    *
+    *   \retval Returns the number of samples read, 0 if the FIFO was empty
+    *   or the read failed.
+    */
+    static uint8_t Acquisition_ServicePrimary(void)
+    {
+        Device* device = Device_Get(0);
+        uint32_t now = Timestamp_Now();
+        uint8_t count = device ? Device_ReadFifo(device, AccData) : 0;
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        // Release of this run: the scheduler already moved next_release on
+        const Scheduler_Task* task = Scheduler_GetTask(acquisition_task_id);
+        Timestamp_RecordBatch(now, task->next_release - task->period, count);
+        if ((output_mode & ACQUISITION_OUTPUT_RAW) && !text_output)
+        {
+            // One timestamp frame per period for all the samples since the
+            // previous one, earlier if the next batch could overflow the count
+            timestamp_samples += count;
+            if (!timestamp_synced || (int32_t)(Timer_Tick - timestamp_due) >= 0 ||
+                timestamp_samples > 0xFF - LIS3DH_FIFO_SIZE)
+            {
+                timestamp_synced = Acquisition_SendTimestamp(now, timestamp_synced ? now - timestamp_last : 0,
+                                                             (uint8_t)timestamp_samples) == NO_ERROR;
+                timestamp_last = now;
+                timestamp_due = Timer_Tick + ACQUISITION_TIMESTAMP_PERIOD;
+                timestamp_samples = 0;
+            }
+        }
+        else
+        {
+            timestamp_synced = 0;
+            timestamp_samples = 0;
+        }
+
+        // Low-rate channel: one ADC burst every temperature_divider samples
+        if (temperature_divider && (int32_t)(sample_count - temperature_due) >= 0)
+        {
+            Acquisition_ReadTemperature();
+            temperature_due = sample_count + temperature_divider;
+        }
+
+        for (uint8_t n = 0; n < count; n++)
+        {
+            Device_Convert(device, DEVICE_FIFO_SAMPLE(AccData, n), batch[n]);
+            if (Calibration_IsCapturing())
+            {
+                Calibration_AddSample(batch[n]);
+            }
+            Calibration_Apply(batch[n]);
+            if (compensation_enabled)
+            {
+                TempComp_Apply(batch[n]);
+            }
+            Acquisition_Output(batch[n]);
+        }
+
+        if (output_mode & ACQUISITION_OUTPUT_DECIMATED)
+        {
+            uint8_t outputs = Decimator_Process(batch, count, decimated);
+            uint8_t factor = Decimator_GetFactor();
+            uint8_t payload[PACKETS_DECIMATED_LENGTH];
+            for (uint8_t n = 0; n < outputs; n++)
+            {
+                Packets_Decimated packet = { factor, decimated[n][0], decimated[n][1], decimated[n][2] };
+                Packets_PackDecimated(payload, &packet);
+                Frames_Send(FRAME_HEADER_DECIMATED, payload, sizeof(payload));
+            }
+        }
+        return count;
+    }
+
+    /**
+    *   \brief Read the FIFO of the other devices and send their samples.
+    *
+    *   The samples are sent with the raw stream when
+    *   ACQUISITION_OUTPUT_OTHERS is set and Acquisition_GetRawLoad() fits
+    *   in the link; the FIFOs are read in any case, so they never overflow.
+    *   The first device served rotates every period, so that a late period
+    *   does not always delay the same device.
+    */
+    static void Acquisition_ServiceOthers(void)
+    {
+        uint8_t others = Device_GetCount() > 1 ? Device_GetCount() - 1 : 0;
+        uint16_t streams = ACQUISITION_OUTPUT_RAW | ACQUISITION_OUTPUT_OTHERS;
+        uint8_t send = (output_mode & streams) == streams && !text_output;
+        // Beyond the link rate the frames of every device would queue up
+        // behind the blocking writes: those of the other devices are dropped
+        uint8_t fits = send && Acquisition_GetRawLoad() <= Frames_GetLinkRate();
+        for (uint8_t i = 0; i < others; i++)
+        {
+            Device* device = Device_Get(1 + (next_device - 1 + i) % others);
+            uint8_t count = Device_ReadFifo(device, AccData);
+            if (!fits)
+            {
+                if (send)
+                {
+                    Health_Count(HEALTH_TX_DROP, count);
+                }
+                continue;
+            }
+            for (uint8_t n = 0; n < count; n++)
+            {
+                int32_t acceleration[3];
+                Device_Convert(device, DEVICE_FIFO_SAMPLE(AccData, n), acceleration);
+                Packets_DeviceSample sample = {
+                    device->id, acceleration[0], acceleration[1], acceleration[2]
+                };
+                uint8_t payload[PACKETS_DEVICE_SAMPLE_LENGTH];
+                Packets_PackDeviceSample(payload, &sample);
+                Frames_Send(FRAME_HEADER_DEVICE_SAMPLE, payload, sizeof(payload));
+            }
+        }
+        if (others > 0)
+        {
+            next_device = 1 + next_device % others;
+        }
+    }
+
+    /**
+    *   \brief Send a clock sync frame when it is due.
+    *
+    *   The frame is postponed while a long frame is open: kept aside, it
+    *   would leave with a stale timestamp.
+    */
+    static void Acquisition_SendSync(void)
+    {
+        uint32_t tick = Timer_Tick;
+        if ((int32_t)(tick - sync_due) < 0 || Frames_IsLongFrameOpen() || text_output)
+        {
+            return;
+        }
+        sync_due = tick + ACQUISITION_SYNC_PERIOD;
+
+        uint16_t pending = Frames_GetTxPending();
+        Packets_Sync sync = { tick, Timestamp_Now(), sample_count, pending };
+        uint8_t payload[PACKETS_SYNC_LENGTH];
+        Packets_PackSync(payload, &sync);
+        Frames_Send(FRAME_HEADER_SYNC, payload, sizeof(payload));
+    }
+
+    /**
+    *   \brief Send the health frame when it is due, postponed like the sync frame.
+    */
+    static void Acquisition_SendHealth(void)
+    {
+        uint32_t tick = Timer_Tick;
+        if ((int32_t)(tick - health_due) < 0 || Frames_IsLongFrameOpen() || text_output)
+        {
+            return;
+        }
+        health_due = tick + ACQUISITION_HEALTH_PERIOD;
+
+        uint8_t payload[9 + 4 * HEALTH_COUNTERS];
+        uint8_t* position = Frames_PutUint32(payload, tick);
+        position = Frames_PutUint32(position, sample_count);
+        *position++ = HEALTH_COUNTERS;
+        for (uint8_t c = 0; c < HEALTH_COUNTERS; c++)
+        {
+            position = Frames_PutUint32(position, Health_Get((Health_Counter)c));
+        }
+        Frames_Send(FRAME_HEADER_HEALTH, payload, sizeof(payload));
+    }
+
+    /**
+    *   \brief Count the releases lost since the previous run.
+    */
+    static void Acquisition_CountSkipped(void)
+    {
+        // The scheduler counts them; after a reset of its statistics
+        // (command 't') they start again from 0
+        uint32_t skipped = Scheduler_GetTask(acquisition_task_id)->stats.skipped;
+        Health_Count(HEALTH_SKIPPED_TICK, skipped >= last_skipped ? skipped - last_skipped : skipped);
+        last_skipped = skipped;
+    }
+
+    void Acquisition_Task(void)
+    {
+        period_start = PowerManager_ReadCycles();
+        Acquisition_CountSkipped();
+        if (Acquisition_ServicePrimary() == 0)
+        {
+            if (retries < ACQUISITION_MAX_RETRIES)
+            {
+                // As the polling loop of the first version: read again until
+                // the data is there, a bounded number of times so that a
+                // missing sensor cannot starve the other tasks
+                retries++;
+                Scheduler_Retry();
+                return;
+            }
+            Health_Count(HEALTH_EMPTY_POLL, 1);
+        }
+        retries = 0;
+        Acquisition_ServiceOthers();
+        Acquisition_SendTemperature();
+        Acquisition_SendSync();
+        Acquisition_SendHealth();
+    }
+
+    void Acquisition_SpectrumTask(void)
+    {
+        Spectrum_Result result;
+        if (!Spectrum_Process(&result))
+        {
+            return;
+        }
+
+        uint8_t payload[8 + 2 * (SPECTRUM_MAX_BANDS + 1) + 4 * SPECTRUM_MAX_BANDS];
+        uint8_t* position = Frames_PutUint32(payload, result.first_index);
+        position = Frames_PutUint16(position, result.points);
+        *position++ = (uint8_t)result.exponent;
+        *position++ = result.bands;
+        for (uint8_t b = 0; b <= result.bands; b++)
+        {
+            position = Frames_PutUint16(position, result.edges[b]);
+        }
+        for (uint8_t b = 0; b < result.bands; b++)
+        {
+            position = Frames_PutUint32(position, result.energy[b]);
+        }
+        Frames_Send(FRAME_HEADER_SPECTRUM, payload, (uint8_t)(position - payload));
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,210 @@
+/**
+*   \file Acquisition.h
+*   \brief Acquisition of the LIS3DH samples and streaming over UART.
+*
+*   The acquisition task reads a new set of data from the accelerometer,
+*   converts it to m/s^2 and sends it to the Bridge Control Panel.
+*/
+
+#ifndef Acquisition_H
+    #define Acquisition_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Time kept free on the bus before each acquisition [us]
+    */
+    #define ACQUISITION_BUS_MARGIN_US 1000
+
+    /**
+    *   \brief Reads of an empty or failed FIFO poll repeated before giving up
+    *   until the next period
+    */
+    #define ACQUISITION_MAX_RETRIES 3
+
+    /**
+    *   \brief Period of the timestamp frames in Timer ticks (50 ms): short
+    *   enough for the relative form (below 65.5 ms), long enough to keep
+    *   them at about 100 B/s at any data rate
+    */
+    #define ACQUISITION_TIMESTAMP_PERIOD 5
+
+    /**
+    *   \brief Period of the clock sync frames in Timer ticks (1 s)
+    */
+    #define ACQUISITION_SYNC_PERIOD 100
+
+    /**
+    *   \brief Period of the health frames in Timer ticks (10 s)
+    */
+    #define ACQUISITION_HEALTH_PERIOD 1000
+
+    /**
+    *   \brief Outputs of the acquisition task (bit mask)
+    */
+    #define ACQUISITION_OUTPUT_RAW (1<<0)       ///< Every sample as a sample frame
+    #define ACQUISITION_OUTPUT_CAPTURE (1<<1)   ///< Samples fed to the triggered capture
+    #define ACQUISITION_OUTPUT_SUMMARY (1<<2)   ///< Windowed statistics as summary frames
+    #define ACQUISITION_OUTPUT_SPECTRUM (1<<3)  ///< Band energies as spectrum frames
+    #define ACQUISITION_OUTPUT_DECIMATED (1<<4) ///< Decimated stream (CIC + FIR)
+    #define ACQUISITION_OUTPUT_TILT (1<<5)      ///< Pitch and roll as tilt frames
+    #define ACQUISITION_OUTPUT_VELOCITY (1<<6)  ///< Velocity RMS as velocity frames
+    #define ACQUISITION_OUTPUT_COMPRESSED (1<<7) ///< Every sample, losslessly compressed
+    #define ACQUISITION_OUTPUT_OTHERS (1<<8)    ///< Sample frames of the other devices, with the raw stream
+
+    /**
+    *   \brief Prepare the output packet.
+    *
+    *   \param task_id Index of the acquisition task in the scheduler.
+    */
+    void Acquisition_Init(uint8_t task_id);
+
+    /**
+    *   \brief Enable the FIFO of every accelerometer in Stream mode.
+    *
+    *   Device_Init() must be called before.
+    */
+    ErrorCode Acquisition_Start(void);
+
+    /**
+    *   \brief Change the output data rate of the accelerometer.
+    *
+    *   This function writes the ODR field of the Control register 1, adapts
+    *   the period of the acquisition task and sends a rate change frame so
+    *   that the host can keep its time base.
+    *   \param odr ODR code (LIS3DH_ODR_1HZ ... LIS3DH_ODR_400HZ).
+    */
+    ErrorCode Acquisition_SetDataRate(uint8_t odr);
+
+    /**
+    *   \brief Current output data rate [Hz].
+    */
+    uint16_t Acquisition_GetDataRate(void);
+
+    /**
+    *   \brief Number of samples sent since the start.
+    */
+    uint32_t Acquisition_GetSampleCount(void);
+
+    /**
+    *   \brief Default sub-rate of the temperature channel [samples]
+    */
+    #define ACQUISITION_DEFAULT_TEMPERATURE_DIVIDER 100
+
+    /**
+    *   \brief Multiplex the ADC/temperature channel into the stream.
+    *
+    *   Every \p divider samples, OUT_ADC1 ... OUT_ADC3 are read in one burst
+    *   through the I2C queue; the acquisition task sends the result as an
+    *   auxiliary frame at its next run.
+    *   \param divider Samples between two readings, 0 disables the channel.
+    */
+    ErrorCode Acquisition_SetTemperatureDivider(uint16_t divider);
+
+    /**
+    *   \brief Current sub-rate of the temperature channel (0 = disabled).
+    */
+    uint16_t Acquisition_GetTemperatureDivider(void);
+
+    /**
+    *   \brief Enable or disable the temperature compensated offset correction.
+    *
+    *   A table must be loaded (see TempCompensation.h). The temperature
+    *   channel is enabled at the default sub-rate if it is off.
+    */
+    ErrorCode Acquisition_SetCompensation(uint8_t enabled);
+
+    /**
+    *   \brief Return 1 if the offset correction is enabled.
+    */
+    uint8_t Acquisition_IsCompensated(void);
+
+    /**
+    *   \brief Select where the samples go (ACQUISITION_OUTPUT_* mask).
+    */
+    void Acquisition_SetOutputMode(uint16_t mode);
+
+    /**
+    *   \brief Current output mask.
+    */
+    uint16_t Acquisition_GetOutputMode(void);
+
+    /**
+    *   \brief Bytes per second of the raw stream at the current rate: the
+    *   sample frames of device 0, the periodic frames (timestamp, sync,
+    *   health) and, with ACQUISITION_OUTPUT_OTHERS, the sample frames of
+    *   the other devices.
+    *
+    *   The frames of the other devices are sent only while this load fits
+    *   in Frames_GetLinkRate(); otherwise they are counted as dropped.
+    */
+    uint32_t Acquisition_GetRawLoad(void);
+
+    /**
+    *   \brief Send the raw stream as CSV lines instead of sample frames.
+    *
+    *   Each line is "x,y,z\r\n", ended as the command replies, with the
+    *   acceleration of device 0 in integer [0.01 m/s^2] (981 is 1 g); the
+    *   samples of the other devices and the periodic binary frames
+    *   (timestamp, sync, health) are paused, so that a terminal shows only
+    *   text.
+    *
+    *   A line is at most 19 bytes up to +-8 g: 1.9 kB/s at 100 Hz, just
+    *   within the 1.92 kB/s of the link at 19200 baud (a board at rest
+    *   sends about 10 bytes per line). At +-16 g a line can reach 22
+    *   bytes, 2.2 kB/s at 100 Hz: more than the link, so the writes wait
+    *   and the acquisition falls behind. 50 Hz fits at any full scale.
+    */
+    void Acquisition_SetTextOutput(uint8_t enabled);
+
+    /**
+    *   \brief Return 1 if the raw stream is sent as CSV lines.
+    */
+    uint8_t Acquisition_GetTextOutput(void);
+
+    /**
+    *   \brief Bus time left before the next acquisition [us].
+    *
+    *   The period of the acquisition task minus the time elapsed since its
+    *   last start and ACQUISITION_BUS_MARGIN_US: the transactions of the I2C
+    *   queue that fit in it cannot delay the next sample fetch.
+    */
+    uint32_t Acquisition_GetBusBudget(void);
+
+    /**
+    *   \brief Bytes that can be written to UART_Debug before the next
+    *   acquisition.
+    *
+    *   The room that takes them without waiting (Frames_GetTxFree()) plus
+    *   what the link sends (Frames_GetLinkRate()) in the time of
+    *   Acquisition_GetBusBudget(): writing more would delay the samples.
+    */
+    uint16_t Acquisition_GetTxAllowance(void);
+
+    /**
+    *   \brief Acquisition task.
+    *
+    *   This function reads the samples waiting in the FIFO of device 0 in
+    *   one batch and passes each of them to the selected outputs; the
+    *   decimated stream is computed on the whole batch. Then it reads the
+    *   FIFO of the other devices and sends their samples, the auxiliary
+    *   frame of an ADC burst completed since the last run, and every
+    *   ACQUISITION_SYNC_PERIOD ticks a clock sync frame (a health frame every
+    *   ACQUISITION_HEALTH_PERIOD ticks). It is released by the scheduler
+    *   once per sample period, at most at every Timer tick (10 ms), so every
+    *   device is served within one period.
+    */
+    void Acquisition_Task(void);
+
+    /**
+    *   \brief Spectrum task.
+    *
+    *   This function does the next step of the FFT of the collected block
+    *   and sends the spectrum frame when the band energies are ready. It has
+    *   the lowest priority, so it only runs in the time left by the others.
+    */
+    void Acquisition_SpectrumTask(void);
+
+#endif // Acquisition_H
+/* [] END OF FILE */
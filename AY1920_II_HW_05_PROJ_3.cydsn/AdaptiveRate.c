@@ -0,0 +1,115 @@
+/*
+* This file includes the activity/inactivity driven output data rate.
+*/
+
+#include "AdaptiveRate.h"
+#include "Acquisition.h"
+#include "I2C_Interface.h"
+#include "LIS3DH_Registers.h"
+#include "Scheduler.h"
+
+static uint8_t adaptive_task_id = 0;
+static uint8_t adaptive_enabled = 0;
+static uint8_t low_rate = 0;
+
+    void AdaptiveRate_Init(uint8_t task_id)
+    {
+        adaptive_task_id = task_id;
+        Scheduler_SetEnabled(adaptive_task_id, 0);
+    }
+
+    static ErrorCode AdaptiveRate_Configure(uint8_t enabled)
+    {
+        // Generator 1: motion, OR of the high events of the three axes
+        uint8_t int1_cfg = LIS3DH_INT_CFG_XHIE | LIS3DH_INT_CFG_YHIE | LIS3DH_INT_CFG_ZHIE;
+        // Generator 2: stillness, AND of the low events of the three axes
+        uint8_t int2_cfg = LIS3DH_INT_CFG_AOI |
+                           LIS3DH_INT_CFG_XLIE | LIS3DH_INT_CFG_YLIE | LIS3DH_INT_CFG_ZLIE;
+        if (!enabled)
+        {
+            int1_cfg = 0;
+            int2_cfg = 0;
+        }
+
+        // Gravity removed by the high-pass filter on both generators
+        ErrorCode error = I2C_Peripheral_UpdateRegister(LIS3DH_DEVICE_ADDRESS,
+                                                        LIS3DH_CTRL_REG2,
+                                                        LIS3DH_CTRL_REG2_HPIA1 | LIS3DH_CTRL_REG2_HPIA2,
+                                                        enabled ? LIS3DH_CTRL_REG2_HPIA1 | LIS3DH_CTRL_REG2_HPIA2 : 0);
+        // Latched requests, so that an event between two polls is not lost
+        error |= I2C_Peripheral_UpdateRegister(LIS3DH_DEVICE_ADDRESS,
+                                               LIS3DH_CTRL_REG5,
+                                               LIS3DH_CTRL_REG5_LIR_INT1 | LIS3DH_CTRL_REG5_LIR_INT2,
+                                               enabled ? LIS3DH_CTRL_REG5_LIR_INT1 | LIS3DH_CTRL_REG5_LIR_INT2 : 0);
+        // The sleep-to-wake function changes the rate by itself and its state
+        // is only visible on the INT2 pin, which is not connected: keep it off
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_ACT_THS, 0);
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_ACT_DUR, 0);
+
+        // Thresholds and durations first, then the configuration that arms the generator
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_INT1_THS, ADAPTIVE_MOTION_THS);
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_INT1_DURATION, ADAPTIVE_MOTION_DURATION);
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_INT1_CFG, int1_cfg);
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_INT2_THS, ADAPTIVE_STILL_THS);
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_INT2_DURATION, ADAPTIVE_STILL_DURATION);
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_INT2_CFG, int2_cfg);
+
+        return error ? ERROR : NO_ERROR;
+    }
+
+    ErrorCode AdaptiveRate_SetEnabled(uint8_t enabled)
+    {
+        ErrorCode error = AdaptiveRate_Configure(enabled);
+        if (error != NO_ERROR)
+        {
+            return error;
+        }
+
+        adaptive_enabled = enabled;
+        Scheduler_SetEnabled(adaptive_task_id, enabled);
+        if (!enabled && low_rate)
+        {
+            error = Acquisition_SetDataRate(ADAPTIVE_HIGH_ODR);
+        }
+        low_rate = 0;
+        return error;
+    }
+
+    uint8_t AdaptiveRate_IsEnabled(void)
+    {
+        return adaptive_enabled;
+    }
+
+    void AdaptiveRate_Task(void)
+    {
+        // INT1_SRC ... INT2_SRC in one transaction, reading them clears the latches
+        uint8_t sources[5];
+        ErrorCode error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
+                                                           LIS3DH_INT1_SRC,
+                                                           5,
+                                                           &sources[0]);
+        if (error != NO_ERROR)
+        {
+            return;
+        }
+
+        uint8_t motion = sources[0] & LIS3DH_INT_SRC_IA;
+        uint8_t still = sources[LIS3DH_INT2_SRC - LIS3DH_INT1_SRC] & LIS3DH_INT_SRC_IA;
+
+        if (low_rate && motion)
+        {
+            if (Acquisition_SetDataRate(ADAPTIVE_HIGH_ODR) == NO_ERROR)
+            {
+                low_rate = 0;
+            }
+        }
+        else if (!low_rate && still && !motion)
+        {
+            if (Acquisition_SetDataRate(ADAPTIVE_LOW_ODR) == NO_ERROR)
+            {
+                low_rate = 1;
+            }
+        }
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,79 @@
+/**
+*   \file AdaptiveRate.h
+*   \brief Activity/inactivity driven output data rate.
+*
+*   The interrupt generators of the LIS3DH watch the high-pass filtered
+*   acceleration: generator 1 detects motion (any axis above threshold) and
+*   generator 2 detects stillness (all axes below threshold for a while).
+*   The adaptive task polls their source registers and switches the output
+*   data rate between a low rate when still and a high rate on motion.
+*/
+
+#ifndef AdaptiveRate_H
+    #define AdaptiveRate_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+    #include "LIS3DH_Registers.h"
+
+    /**
+    *   \brief Output data rate when the sensor is still
+    */
+    #define ADAPTIVE_LOW_ODR LIS3DH_ODR_10HZ
+
+    /**
+    *   \brief Output data rate when the sensor is moving
+    */
+    #define ADAPTIVE_HIGH_ODR LIS3DH_ODR_100HZ
+
+    /**
+    *   \brief Motion threshold, 32 mg/LSB in the ±4.0 g FSR (96 mg)
+    */
+    #define ADAPTIVE_MOTION_THS 3
+
+    /**
+    *   \brief Samples above threshold to detect motion (1/ODR units)
+    */
+    #define ADAPTIVE_MOTION_DURATION 1
+
+    /**
+    *   \brief Stillness threshold, 32 mg/LSB in the ±4.0 g FSR (64 mg)
+    */
+    #define ADAPTIVE_STILL_THS 2
+
+    /**
+    *   \brief Samples below threshold to detect stillness (1/ODR units, 1 s at 100 Hz)
+    */
+    #define ADAPTIVE_STILL_DURATION 100
+
+    /**
+    *   \brief Period of the adaptive task in Timer ticks (50 ms)
+    */
+    #define ADAPTIVE_TASK_PERIOD 5
+
+    /**
+    *   \brief Save the scheduler index of the adaptive task (disabled at start).
+    */
+    void AdaptiveRate_Init(uint8_t task_id);
+
+    /**
+    *   \brief Enable or disable the adaptive output data rate.
+    *
+    *   When enabled, the interrupt generators are configured and the task is
+    *   started; when disabled, they are turned off and the high rate is
+    *   restored.
+    */
+    ErrorCode AdaptiveRate_SetEnabled(uint8_t enabled);
+
+    /**
+    *   \brief Adaptive rate enabled or not.
+    */
+    uint8_t AdaptiveRate_IsEnabled(void);
+
+    /**
+    *   \brief Adaptive task: poll the interrupt sources and switch the rate.
+    */
+    void AdaptiveRate_Task(void);
+
+#endif // AdaptiveRate_H
+/* [] END OF FILE */
@@ -0,0 +1,385 @@
+/*
+* This file includes the six-position calibration.
+*/
+
+#include "Calibration.h"
+#include "Storage.h"
+#include "project.h"
+#include "Format.h"
+#include "string.h"
+
+/**
+*   \brief Image saved in the emulated EEPROM: magic (uint16), mode (uint8),
+*   reserved (uint8), offsets (3 x int32), matrix (9 x int16), gains
+*   (3 x int16), checksum byte that makes the sum of all the bytes zero
+*/
+#define CALIBRATION_MAGIC 0x4143
+#define CALIBRATION_IMAGE_SIZE (4 + 12 + 18 + 6 + 1)
+
+/**
+*   \brief Result of the last finished capture, reported by the task
+*/
+typedef enum {
+    CAPTURE_NONE,
+    CAPTURE_DONE,
+    CAPTURE_MOVED,
+    CAPTURE_NOT_ALIGNED
+} CaptureResult;
+
+static const char* orientation_names[6] = {"+X", "-X", "+Y", "-Y", "+Z", "-Z"};
+
+// Saved calibration
+static uint8_t calibration_valid = 0;
+static int32_t offset[3];
+static int16_t matrix[3][3];    // Q12, gain and misalignment
+static int16_t gain[3];         // Q12, gain only
+
+// Correction in use
+static CalibrationMode mode = CALIBRATION_OFF;
+static int32_t active_offset[3] = {0, 0, 0};
+static int16_t active_matrix[3][3];
+
+// Session
+static int32_t orientation_mean[6][3];
+static uint8_t captured = 0;            // bit k: orientation k captured
+static volatile uint8_t capturing = 0;
+static uint16_t capture_count = 0;
+static int64_t capture_sum[3];
+static int64_t capture_squares[3];
+static CaptureResult capture_result = CAPTURE_NONE;
+static uint8_t capture_orientation = 0;
+
+    /**
+    *   \brief Copy the correction of the current mode to the active one.
+    */
+    static void Calibration_Activate(void)
+    {
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            active_offset[i] = mode == CALIBRATION_OFF ? 0 : offset[i];
+            for (uint8_t j = 0; j < 3; j++)
+            {
+                int16_t identity = (i == j) ? (1 << CALIBRATION_Q) : 0;
+                if (mode == CALIBRATION_FULL_MATRIX)
+                {
+                    active_matrix[i][j] = matrix[i][j];
+                }
+                else if (mode == CALIBRATION_OFFSET_GAIN)
+                {
+                    active_matrix[i][j] = (i == j) ? gain[i] : 0;
+                }
+                else
+                {
+                    active_matrix[i][j] = identity;
+                }
+            }
+        }
+    }
+
+    static void Calibration_Encode(uint8_t* image)
+    {
+        uint8_t* position = image;
+        *position++ = CALIBRATION_MAGIC & 0xFF;
+        *position++ = CALIBRATION_MAGIC >> 8;
+        *position++ = (uint8_t)mode;
+        *position++ = 0;
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            for (uint8_t b = 0; b < 4; b++)
+            {
+                *position++ = (uint8_t)((uint32_t)offset[i] >> (8 * b));
+            }
+        }
+        for (uint8_t i = 0; i < 9; i++)
+        {
+            *position++ = (uint8_t)matrix[i / 3][i % 3];
+            *position++ = (uint8_t)((uint16_t)matrix[i / 3][i % 3] >> 8);
+        }
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            *position++ = (uint8_t)gain[i];
+            *position++ = (uint8_t)((uint16_t)gain[i] >> 8);
+        }
+        uint8_t sum = 0;
+        for (uint8_t i = 0; i < CALIBRATION_IMAGE_SIZE - 1; i++)
+        {
+            sum += image[i];
+        }
+        *position = (uint8_t)(-sum);
+    }
+
+    static ErrorCode Calibration_Decode(const uint8_t* image)
+    {
+        uint8_t sum = 0;
+        for (uint8_t i = 0; i < CALIBRATION_IMAGE_SIZE; i++)
+        {
+            sum += image[i];
+        }
+        if (sum != 0 || (image[0] | (image[1] << 8)) != CALIBRATION_MAGIC ||
+            image[2] > CALIBRATION_FULL_MATRIX)
+        {
+            return ERROR;
+        }
+
+        const uint8_t* position = &image[4];
+        for (uint8_t i = 0; i < 3; i++, position += 4)
+        {
+            offset[i] = (int32_t)((uint32_t)position[0] | ((uint32_t)position[1] << 8) |
+                                  ((uint32_t)position[2] << 16) | ((uint32_t)position[3] << 24));
+        }
+        for (uint8_t i = 0; i < 9; i++, position += 2)
+        {
+            matrix[i / 3][i % 3] = (int16_t)(position[0] | (position[1] << 8));
+        }
+        for (uint8_t i = 0; i < 3; i++, position += 2)
+        {
+            gain[i] = (int16_t)(position[0] | (position[1] << 8));
+        }
+        mode = (CalibrationMode)image[2];
+        calibration_valid = 1;
+        return NO_ERROR;
+    }
+
+    void Calibration_Init(void)
+    {
+        uint8_t image[CALIBRATION_IMAGE_SIZE];
+        if (Storage_Read(STORAGE_CALIBRATION_ADDRESS, image, sizeof(image)) != NO_ERROR ||
+            Calibration_Decode(image) != NO_ERROR)
+        {
+            mode = CALIBRATION_OFF;
+        }
+        Calibration_Activate();
+    }
+
+    ErrorCode Calibration_Capture(void)
+    {
+        if (capturing)
+        {
+            return ERROR;
+        }
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            capture_sum[axis] = 0;
+            capture_squares[axis] = 0;
+        }
+        capture_count = 0;
+        capture_result = CAPTURE_NONE;
+        capturing = 1;
+        return NO_ERROR;
+    }
+
+    uint8_t Calibration_IsCapturing(void)
+    {
+        return capturing;
+    }
+
+    void Calibration_AddSample(const int32_t acceleration[3])
+    {
+        if (!capturing)
+        {
+            return;
+        }
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            capture_sum[axis] += acceleration[axis];
+            capture_squares[axis] += (int64_t)acceleration[axis] * acceleration[axis];
+        }
+        if (++capture_count < CALIBRATION_SAMPLES)
+        {
+            return;
+        }
+        capturing = 0;
+
+        int32_t mean[3];
+        uint8_t dominant = 0;
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            mean[axis] = (int32_t)(capture_sum[axis] / CALIBRATION_SAMPLES);
+            // N^2 times the variance: with the truncated mean, the error would
+            // reach 2 |mean|, more than the limit above 1.15 g
+            int64_t variance = capture_squares[axis] * CALIBRATION_SAMPLES - capture_sum[axis] * capture_sum[axis];
+            if (variance > (int64_t)CALIBRATION_MAX_NOISE * CALIBRATION_MAX_NOISE * CALIBRATION_SAMPLES * CALIBRATION_SAMPLES)
+            {
+                capture_result = CAPTURE_MOVED;
+                return;
+            }
+            int32_t magnitude = mean[axis] < 0 ? -mean[axis] : mean[axis];
+            int32_t largest = mean[dominant] < 0 ? -mean[dominant] : mean[dominant];
+            if (magnitude > largest)
+            {
+                dominant = axis;
+            }
+        }
+
+        // The axis along gravity must read well above half of it
+        int32_t largest = mean[dominant] < 0 ? -mean[dominant] : mean[dominant];
+        if (largest < CALIBRATION_GRAVITY * 3 / 4)
+        {
+            capture_result = CAPTURE_NOT_ALIGNED;
+            return;
+        }
+        capture_orientation = 2 * dominant + (mean[dominant] < 0);
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            orientation_mean[capture_orientation][axis] = mean[axis];
+        }
+        captured |= 1 << capture_orientation;
+        capture_result = CAPTURE_DONE;
+    }
+
+    /**
+    *   \brief Compute offsets, gains and matrix from the six orientations.
+    *
+    *   The difference between the up and down captures of axis j is the
+    *   column j of 2g * S, with S the sensitivity matrix; the correction
+    *   matrix is 2g * S^-1, computed with the adjugate in 64-bit integers.
+    */
+    static ErrorCode Calibration_Compute(void)
+    {
+        int64_t d[3][3];
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            int64_t sum = 0;
+            for (uint8_t k = 0; k < 6; k++)
+            {
+                sum += orientation_mean[k][i];
+            }
+            offset[i] = (int32_t)(sum / 6);
+            for (uint8_t j = 0; j < 3; j++)
+            {
+                d[i][j] = orientation_mean[2 * j][i] - orientation_mean[2 * j + 1][i];
+            }
+        }
+
+        // Gain of each axis within 0.8 ... 1.25 of the nominal one
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            if (d[i][i] < 2 * CALIBRATION_GRAVITY * 4 / 5 || d[i][i] > 2 * CALIBRATION_GRAVITY * 5 / 4)
+            {
+                return ERROR;
+            }
+            gain[i] = (int16_t)(((int64_t)2 * CALIBRATION_GRAVITY * (1 << CALIBRATION_Q) + d[i][i] / 2) / d[i][i]);
+        }
+
+        int64_t adjugate[3][3];
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            for (uint8_t j = 0; j < 3; j++)
+            {
+                // Cofactor of d[j][i]
+                uint8_t r0 = (j + 1) % 3, r1 = (j + 2) % 3;
+                uint8_t c0 = (i + 1) % 3, c1 = (i + 2) % 3;
+                adjugate[i][j] = d[r0][c0] * d[r1][c1] - d[r0][c1] * d[r1][c0];
+            }
+        }
+        int64_t determinant = d[0][0] * adjugate[0][0] + d[0][1] * adjugate[1][0] + d[0][2] * adjugate[2][0];
+        if (determinant <= 0)
+        {
+            return ERROR;
+        }
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            for (uint8_t j = 0; j < 3; j++)
+            {
+                int64_t scaled = adjugate[i][j] * 2 * CALIBRATION_GRAVITY * (1 << CALIBRATION_Q);
+                scaled += (scaled >= 0 ? determinant : -determinant) / 2;
+                matrix[i][j] = (int16_t)(scaled / determinant);
+            }
+        }
+        return NO_ERROR;
+    }
+
+    void Calibration_Apply(int32_t acceleration[3])
+    {
+        int32_t x = acceleration[0] - active_offset[0];
+        int32_t y = acceleration[1] - active_offset[1];
+        int32_t z = acceleration[2] - active_offset[2];
+        const int32_t round = 1 << (CALIBRATION_Q - 1);
+        acceleration[0] = (active_matrix[0][0] * x + active_matrix[0][1] * y + active_matrix[0][2] * z + round) >> CALIBRATION_Q;
+        acceleration[1] = (active_matrix[1][0] * x + active_matrix[1][1] * y + active_matrix[1][2] * z + round) >> CALIBRATION_Q;
+        acceleration[2] = (active_matrix[2][0] * x + active_matrix[2][1] * y + active_matrix[2][2] * z + round) >> CALIBRATION_Q;
+    }
+
+    ErrorCode Calibration_SetMode(CalibrationMode new_mode)
+    {
+        if (new_mode != CALIBRATION_OFF && !calibration_valid)
+        {
+            return ERROR;
+        }
+        mode = new_mode;
+        Calibration_Activate();
+        if (calibration_valid)
+        {
+            uint8_t image[CALIBRATION_IMAGE_SIZE];
+            Calibration_Encode(image);
+            return Storage_Write(STORAGE_CALIBRATION_ADDRESS, image, sizeof(image));
+        }
+        return NO_ERROR;
+    }
+
+    CalibrationMode Calibration_GetMode(void)
+    {
+        return mode;
+    }
+
+    void Calibration_Task(void)
+    {
+        char message[80];
+        CaptureResult result = capture_result;
+        if (result == CAPTURE_NONE)
+        {
+            return;
+        }
+        capture_result = CAPTURE_NONE;
+
+        if (result == CAPTURE_MOVED)
+        {
+            UART_Debug_PutString("Calibration: the board moved, capture again\r\n");
+            return;
+        }
+        if (result == CAPTURE_NOT_ALIGNED)
+        {
+            UART_Debug_PutString("Calibration: no axis along gravity, capture again\r\n");
+            return;
+        }
+
+        Format_Text(message, sizeof(message), "Calibration: %s captured, missing:", orientation_names[capture_orientation]);
+        for (uint8_t k = 0; k < 6; k++)
+        {
+            if (!(captured & (1 << k)))
+            {
+                strcat(message, " ");
+                strcat(message, orientation_names[k]);
+            }
+        }
+        strcat(message, "\r\n");
+        UART_Debug_PutString(message);
+        if (captured != 0x3F)
+        {
+            return;
+        }
+
+        captured = 0;
+        if (Calibration_Compute() != NO_ERROR)
+        {
+            UART_Debug_PutString("Calibration: gains out of range, calibration discarded\r\n");
+            return;
+        }
+        calibration_valid = 1;
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            Format_Text(message, sizeof(message), "Axis %c: offset %ld mm/s^2, gain %d/4096\r\n",
+                    'X' + i, (long)offset[i], gain[i]);
+            UART_Debug_PutString(message);
+        }
+        if (Calibration_SetMode(CALIBRATION_FULL_MATRIX) == NO_ERROR)
+        {
+            UART_Debug_PutString("Calibration: saved and applied (full matrix)\r\n");
+        }
+        else
+        {
+            UART_Debug_PutString("Calibration: applied, not saved\r\n");
+        }
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,113 @@
+/**
+*   \file Calibration.h
+*   \brief Six-position calibration of offset, gain and misalignment.
+*
+*   The board is placed still with each axis pointing up and down (six
+*   orientations, in any order) and a capture is started for each one. The
+*   average of every capture gives the offset and the sensitivity of the
+*   three axes; the full 3x3 matrix also corrects the misalignment and the
+*   cross-axis sensitivity. The result is saved in the emulated EEPROM and
+*   applied to every sample in fixed point:
+*
+*       corrected = M * (measured - offset)
+*
+*   with M in Q12, that is 3 subtractions and 9 multiply-accumulates.
+*/
+
+#ifndef Calibration_H
+    #define Calibration_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Samples averaged for each orientation (2 s at 100 Hz)
+    */
+    #define CALIBRATION_SAMPLES 200
+
+    /**
+    *   \brief Standard gravity [mm/s^2]
+    */
+    #define CALIBRATION_GRAVITY 9806
+
+    /**
+    *   \brief Maximum standard deviation during a capture [mm/s^2]: above it
+    *   the board is considered moving and the capture is discarded
+    */
+    #define CALIBRATION_MAX_NOISE 150
+
+    /**
+    *   \brief Fractional bits of the correction matrix
+    */
+    #define CALIBRATION_Q 12
+
+    /**
+    *   \brief Period of the calibration task in Timer ticks (100 ms)
+    */
+    #define CALIBRATION_TASK_PERIOD 10
+
+    /**
+    *   \brief Correction applied to the samples
+    */
+    typedef enum {
+        CALIBRATION_OFF,            ///< Nominal sensitivity and zero offset
+        CALIBRATION_OFFSET_GAIN,    ///< Offset and gain of each axis
+        CALIBRATION_FULL_MATRIX     ///< Offset and 3x3 matrix (gain and misalignment)
+    } CalibrationMode;
+
+    /**
+    *   \brief Load the calibration saved in the emulated EEPROM, if any.
+    *
+    *   Storage_Init() must be called before.
+    */
+    void Calibration_Init(void);
+
+    /**
+    *   \brief Start the capture of the current orientation.
+    *
+    *   The first capture starts a new calibration session.
+    *   \retval Returns ERROR if a capture is already running.
+    */
+    ErrorCode Calibration_Capture(void);
+
+    /**
+    *   \brief Accumulate a sample of the running capture.
+    *
+    *   \param acceleration X, Y, Z in [mm/s^2] before any correction.
+    */
+    void Calibration_AddSample(const int32_t acceleration[3]);
+
+    /**
+    *   \brief Return 1 while a capture is running.
+    */
+    uint8_t Calibration_IsCapturing(void);
+
+    /**
+    *   \brief Apply the correction of the current mode.
+    *
+    *   \param acceleration X, Y, Z in [mm/s^2], corrected in place.
+    */
+    void Calibration_Apply(int32_t acceleration[3]);
+
+    /**
+    *   \brief Select the correction and save it.
+    *
+    *   \retval Returns ERROR if no calibration is available.
+    */
+    ErrorCode Calibration_SetMode(CalibrationMode mode);
+
+    /**
+    *   \brief Current correction.
+    */
+    CalibrationMode Calibration_GetMode(void);
+
+    /**
+    *   \brief Calibration task.
+    *
+    *   This function reports the end of each capture and, when all six
+    *   orientations are captured, computes, saves and applies the result.
+    */
+    void Calibration_Task(void);
+
+#endif // Calibration_H
+/* [] END OF FILE */
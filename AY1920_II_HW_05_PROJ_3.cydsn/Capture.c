@@ -0,0 +1,211 @@
+/*
+* This file includes the threshold triggered capture.
+*/
+
+#include "Capture.h"
+#include "Acquisition.h"
+#include "Frames.h"
+
+/**
+*   \brief State of the capture
+*/
+typedef enum {
+    CAPTURE_ARMED,      ///< Waiting for a trigger
+    CAPTURE_POST,       ///< Collecting the post-trigger samples
+    CAPTURE_DUMP        ///< Sending the burst frame
+} CaptureState;
+
+static int32_t buffer[CAPTURE_BUFFER_SIZE][3];
+static uint16_t write_position = 0;     // position of the next sample
+static uint16_t filled = 0;             // valid samples in the buffer
+
+static uint16_t pre_samples = CAPTURE_DEFAULT_PRE;
+static uint16_t post_samples = CAPTURE_DEFAULT_POST;
+static int32_t thresholds[3] = {0, 0, 0};
+static int64_t magnitude_threshold_2 = (int64_t)CAPTURE_DEFAULT_MAGNITUDE_THS * CAPTURE_DEFAULT_MAGNITUDE_THS;
+
+static CaptureState state = CAPTURE_ARMED;
+static uint16_t remaining = 0;          // post samples still to collect, or samples to send
+static uint16_t read_position = 0;      // next sample of the window to send
+static uint8_t sample_offset = 0;       // bytes of that sample already sent
+static uint16_t window = 0;             // samples of the window (pre + post)
+static uint32_t trigger_index = 0;
+static uint8_t trigger_source = 0;
+static uint16_t missed_triggers = 0;
+static uint8_t header_sent = 0;
+
+    void Capture_Init(void)
+    {
+        int32_t none[3] = {0, 0, 0};
+        if (state == CAPTURE_DUMP)
+        {
+            return; // the burst being sent is completed first
+        }
+        write_position = 0;
+        filled = 0;
+        missed_triggers = 0;
+        Capture_Configure(CAPTURE_DEFAULT_PRE, CAPTURE_DEFAULT_POST, none, CAPTURE_DEFAULT_MAGNITUDE_THS);
+    }
+
+    ErrorCode Capture_Configure(uint16_t pre,
+                                uint16_t post,
+                                const int32_t axis_threshold[3],
+                                int32_t magnitude_threshold)
+    {
+        if (state == CAPTURE_DUMP || post == 0 ||
+            pre + post > CAPTURE_MAX_WINDOW || magnitude_threshold < 0)
+        {
+            return ERROR;
+        }
+        pre_samples = pre;
+        post_samples = post;
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            thresholds[axis] = axis_threshold[axis];
+        }
+        magnitude_threshold_2 = (int64_t)magnitude_threshold * magnitude_threshold;
+        state = CAPTURE_ARMED;
+        return NO_ERROR;
+    }
+
+    static uint8_t Capture_Check(const int32_t acceleration[3])
+    {
+        uint8_t source = 0;
+        int64_t magnitude_2 = 0;
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            int32_t value = acceleration[axis] < 0 ? -acceleration[axis] : acceleration[axis];
+            if (thresholds[axis] > 0 && value > thresholds[axis])
+            {
+                source |= (1 << axis);
+            }
+            magnitude_2 += (int64_t)acceleration[axis] * acceleration[axis];
+        }
+        if (magnitude_threshold_2 > 0 && magnitude_2 > magnitude_threshold_2)
+        {
+            source |= CAPTURE_TRIGGER_MAGNITUDE;
+        }
+        return source;
+    }
+
+    void Capture_AddSample(const int32_t acceleration[3], uint32_t index)
+    {
+        if (state == CAPTURE_DUMP && remaining > 0 && write_position == read_position)
+        {
+            // The next slot holds a sample of the window not sent yet: this
+            // sample is dropped and the next window starts after the gap
+            filled = 0;
+        }
+        else
+        {
+            buffer[write_position][0] = acceleration[0];
+            buffer[write_position][1] = acceleration[1];
+            buffer[write_position][2] = acceleration[2];
+            write_position = (write_position + 1) % CAPTURE_BUFFER_SIZE;
+            if (filled < CAPTURE_BUFFER_SIZE)
+            {
+                filled++;
+            }
+        }
+
+        uint8_t source = Capture_Check(acceleration);
+        switch (state)
+        {
+            case CAPTURE_ARMED:
+                if (source)
+                {
+                    trigger_index = index;
+                    trigger_source = source;
+                    // The trigger sample is the first post-trigger sample
+                    remaining = post_samples - 1;
+                    state = CAPTURE_POST;
+                }
+                break;
+
+            case CAPTURE_POST:
+                trigger_source |= source;
+                remaining--;
+                break;
+
+            case CAPTURE_DUMP:
+                if (source)
+                {
+                    missed_triggers++;
+                }
+                break;
+        }
+
+        if (state == CAPTURE_POST && remaining == 0)
+        {
+            // The window ends with the sample just written
+            window = pre_samples + post_samples;
+            if (window > filled)
+            {
+                window = filled; // not enough samples since the start
+            }
+            read_position = (write_position + CAPTURE_BUFFER_SIZE - window) % CAPTURE_BUFFER_SIZE;
+            remaining = window;
+            state = CAPTURE_DUMP;
+        }
+    }
+
+    void Capture_Task(void)
+    {
+        if (state != CAPTURE_DUMP)
+        {
+            return;
+        }
+
+        uint16_t tx_free = Acquisition_GetTxAllowance();
+        uint8_t sample[12];
+
+        if (!header_sent)
+        {
+            uint8_t header[11];
+            if (tx_free < sizeof(header) + 1 || Frames_Begin(FRAME_HEADER_BURST) != NO_ERROR)
+            {
+                return;
+            }
+            uint8_t* position = Frames_PutUint32(header, trigger_index);
+            position = Frames_PutUint16(position, window - post_samples);
+            position = Frames_PutUint16(position, post_samples);
+            *position++ = trigger_source;
+            Frames_PutUint16(position, missed_triggers);
+            Frames_Write(header, sizeof(header));
+            tx_free -= sizeof(header) + 1;
+            missed_triggers = 0;
+            header_sent = 1;
+        }
+
+        // Send only what the UART takes before the next acquisition, the
+        // rest at the next run: a sample may be split between two runs
+        while (remaining > 0 && tx_free > 0)
+        {
+            uint8_t* position = Frames_PutUint32(sample, (uint32_t)buffer[read_position][0]);
+            position = Frames_PutUint32(position, (uint32_t)buffer[read_position][1]);
+            Frames_PutUint32(position, (uint32_t)buffer[read_position][2]);
+            uint8_t length = sizeof(sample) - sample_offset;
+            if (length > tx_free)
+            {
+                length = tx_free;
+            }
+            Frames_Write(&sample[sample_offset], length);
+            tx_free -= length;
+            sample_offset += length;
+            if (sample_offset == sizeof(sample))
+            {
+                sample_offset = 0;
+                read_position = (read_position + 1) % CAPTURE_BUFFER_SIZE;
+                remaining--;
+            }
+        }
+
+        if (remaining == 0 && tx_free > 0)
+        {
+            Frames_End();
+            header_sent = 0;
+            state = CAPTURE_ARMED;
+        }
+    }
+
+/* [] END OF FILE */
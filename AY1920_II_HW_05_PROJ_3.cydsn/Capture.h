@@ -0,0 +1,93 @@
+/**
+*   \file Capture.h
+*   \brief Threshold triggered capture with pre-trigger buffer.
+*
+*   The samples are kept in a circular buffer in RAM. When a sample exceeds
+*   one of the thresholds, the capture waits for the post-trigger samples and
+*   then sends the window around the event as one burst frame. The burst is
+*   sent in pieces by the capture task: each run writes only the bytes the
+*   UART sends before the next acquisition (Acquisition_GetTxAllowance()),
+*   so the dump does not delay a sample fetch. New samples keep entering the
+*   buffer meanwhile, but never in place of the samples still to be sent.
+*/
+
+#ifndef Capture_H
+    #define Capture_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Number of samples of the circular buffer.
+    *
+    *   The window (pre + post) is at most half of it; the other half and
+    *   the slots already sent take the samples acquired during the dump. A
+    *   full window is a burst of 1549 bytes, 0.81 s at 19200 baud: up to
+    *   200 Hz it fits, at 400 Hz (322 samples) the writer catches up with
+    *   the samples not sent yet. The samples that would overwrite them are
+    *   dropped, and the next window starts after the gap (with fewer
+    *   pre-trigger samples if it comes soon after the dump).
+    */
+    #define CAPTURE_BUFFER_SIZE 256
+
+    /**
+    *   \brief Maximum number of samples of the window.
+    */
+    #define CAPTURE_MAX_WINDOW (CAPTURE_BUFFER_SIZE / 2)
+
+    /**
+    *   \brief Default window and threshold
+    */
+    #define CAPTURE_DEFAULT_PRE 64
+    #define CAPTURE_DEFAULT_POST 64
+    #define CAPTURE_DEFAULT_MAGNITUDE_THS 19612 // 2 g in [mm/s^2]
+
+    /**
+    *   \brief Period of the capture task in Timer ticks (10 ms)
+    */
+    #define CAPTURE_TASK_PERIOD 1
+
+    /**
+    *   \brief Trigger sources reported in the burst frame
+    */
+    #define CAPTURE_TRIGGER_X (1<<0)
+    #define CAPTURE_TRIGGER_Y (1<<1)
+    #define CAPTURE_TRIGGER_Z (1<<2)
+    #define CAPTURE_TRIGGER_MAGNITUDE (1<<3)
+
+    /**
+    *   \brief Reset the buffer and set the default window and threshold.
+    *
+    *   Nothing is changed while a burst frame is being sent.
+    */
+    void Capture_Init(void);
+
+    /**
+    *   \brief Configure window and thresholds.
+    *
+    *   \param pre Samples before the trigger sample.
+    *   \param post Samples after the trigger sample (trigger included).
+    *   \param axis_threshold Absolute threshold of X, Y and Z [mm/s^2], 0 disables the axis.
+    *   \param magnitude_threshold Threshold of the vector magnitude [mm/s^2], 0 disables it.
+    *   \retval Returns ERROR if the values are not valid or a burst is being sent.
+    */
+    ErrorCode Capture_Configure(uint16_t pre,
+                                uint16_t post,
+                                const int32_t axis_threshold[3],
+                                int32_t magnitude_threshold);
+
+    /**
+    *   \brief Put a new sample in the buffer and check the thresholds.
+    *
+    *   \param acceleration X, Y, Z in [mm/s^2].
+    *   \param index Index of the sample in the stream.
+    */
+    void Capture_AddSample(const int32_t acceleration[3], uint32_t index);
+
+    /**
+    *   \brief Capture task: send the pending burst frame a piece at a time.
+    */
+    void Capture_Task(void);
+
+#endif // Capture_H
+/* [] END OF FILE */
@@ -0,0 +1,96 @@
+/*
+* This file includes the click detection.
+*/
+
+#include "Click.h"
+#include "Acquisition.h"
+#include "Frames.h"
+#include "I2C_Interface.h"
+#include "LIS3DH_Registers.h"
+#include "Scheduler.h"
+#include "I2C_Queue.h"
+#include "Health.h"
+
+static uint8_t click_task_id = 0;
+static uint8_t click_enabled = 0;
+static uint8_t click_src = 0;       // Filled by the I2C queue
+static uint8_t click_pending = 0;
+
+    void Click_Init(uint8_t task_id)
+    {
+        click_task_id = task_id;
+        Scheduler_SetEnabled(click_task_id, 0);
+    }
+
+    ErrorCode Click_SetEnabled(uint8_t enabled)
+    {
+        uint8_t click_cfg = LIS3DH_CLICK_CFG_XS | LIS3DH_CLICK_CFG_YS | LIS3DH_CLICK_CFG_ZS |
+                            LIS3DH_CLICK_CFG_XD | LIS3DH_CLICK_CFG_YD | LIS3DH_CLICK_CFG_ZD;
+
+        // Gravity removed by the high-pass filter before the click engine
+        ErrorCode error = I2C_Peripheral_UpdateRegister(LIS3DH_DEVICE_ADDRESS,
+                                                        LIS3DH_CTRL_REG2,
+                                                        LIS3DH_CTRL_REG2_HPCLICK,
+                                                        enabled ? LIS3DH_CTRL_REG2_HPCLICK : 0);
+
+        // Threshold and timings first, then the configuration that arms the engine
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CLICK_THS,
+                                              LIS3DH_CLICK_THS_LIR | CLICK_THRESHOLD);
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_TIME_LIMIT, CLICK_TIME_LIMIT);
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_TIME_LATENCY, CLICK_TIME_LATENCY);
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_TIME_WINDOW, CLICK_TIME_WINDOW);
+        error |= I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CLICK_CFG,
+                                              enabled ? click_cfg : 0);
+        if (error)
+        {
+            return ERROR;
+        }
+
+        click_enabled = enabled;
+        Scheduler_SetEnabled(click_task_id, enabled);
+        return NO_ERROR;
+    }
+
+    uint8_t Click_IsEnabled(void)
+    {
+        return click_enabled;
+    }
+
+    /**
+    *   \brief Send the click frame when CLICK_SRC is read.
+    */
+    static void Click_SourceRead(const I2C_Transaction* transaction, ErrorCode error)
+    {
+        (void)transaction;
+        click_pending = 0;
+        if (error != NO_ERROR || !(click_src & LIS3DH_CLICK_SRC_IA))
+        {
+            return;
+        }
+
+        // The sample index places the event in the sample stream
+        Packets_Click click = { click_src, Acquisition_GetSampleCount() };
+        uint8_t payload[PACKETS_CLICK_LENGTH];
+        Packets_PackClick(payload, &click);
+        Frames_Send(FRAME_HEADER_CLICK, payload, sizeof(payload));
+    }
+
+    void Click_Task(void)
+    {
+        // Telemetry: read in the bus time left by the acquisition
+        if (click_pending)
+        {
+            return;
+        }
+        I2C_Transaction transaction = {
+            LIS3DH_DEVICE_ADDRESS, LIS3DH_CLICK_SRC, 1, 0,
+            I2C_PRIORITY_TELEMETRY, &click_src, Click_SourceRead
+        };
+        click_pending = (I2C_Queue_Submit(&transaction) == NO_ERROR);
+        if (!click_pending)
+        {
+            Health_Count(HEALTH_QUEUE_REJECT, 1);
+        }
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,66 @@
+/**
+*   \file Click.h
+*   \brief Single and double click detection by the LIS3DH click engine.
+*
+*   The click engine of the sensor works on the high-pass filtered data of
+*   the three axes. The click task polls the latched CLICK_SRC register and
+*   sends one event frame per click, so the host does not need the raw
+*   samples to detect taps.
+*/
+
+#ifndef Click_H
+    #define Click_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Click threshold, about 32 mg/LSB in the ±4.0 g FSR (1.25 g)
+    */
+    #define CLICK_THRESHOLD 40
+
+    /**
+    *   \brief Maximum time above threshold of a click (1/ODR units, 100 ms at 100 Hz)
+    */
+    #define CLICK_TIME_LIMIT 10
+
+    /**
+    *   \brief Dead time after the first click of a double click (1/ODR units, 200 ms at 100 Hz)
+    */
+    #define CLICK_TIME_LATENCY 20
+
+    /**
+    *   \brief Window for the second click of a double click (1/ODR units, 300 ms at 100 Hz)
+    */
+    #define CLICK_TIME_WINDOW 30
+
+    /**
+    *   \brief Period of the click task in Timer ticks (50 ms)
+    */
+    #define CLICK_TASK_PERIOD 5
+
+    /**
+    *   \brief Save the scheduler index of the click task (disabled at start).
+    */
+    void Click_Init(uint8_t task_id);
+
+    /**
+    *   \brief Enable or disable the click detection on the three axes.
+    */
+    ErrorCode Click_SetEnabled(uint8_t enabled);
+
+    /**
+    *   \brief Return 1 if the click detection is enabled.
+    */
+    uint8_t Click_IsEnabled(void);
+
+    /**
+    *   \brief Click task.
+    *
+    *   This function reads CLICK_SRC (the read clears the latch) and sends a
+    *   click event frame if a click was detected.
+    */
+    void Click_Task(void);
+
+#endif // Click_H
+/* [] END OF FILE */
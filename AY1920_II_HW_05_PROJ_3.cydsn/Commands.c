@@ -0,0 +1,791 @@
+/*
+* This file includes the command task and the command table.
+*/
+
+#include "Commands.h"
+#include "PowerManager.h"
+#include "AdaptiveRate.h"
+#include "Acquisition.h"
+#include "Capture.h"
+#include "Statistics.h"
+#include "Spectrum.h"
+#include "Decimator.h"
+#include "Tilt.h"
+#include "Velocity.h"
+#include "Device.h"
+#include "LIS3DH_Registers.h"
+#include "HighPass.h"
+#include "Click.h"
+#include "TempCompensation.h"
+#include "Storage.h"
+#include "Calibration.h"
+#include "Timestamp.h"
+#include "Health.h"
+#include "Compress.h"
+#include "FlashLog.h"
+#include "Frames.h"
+#include "InterruptRoutines.h"
+#include "Scheduler.h"
+#include "project.h"
+#include "Format.h"
+
+/**
+*   \brief Entry of the command table.
+*/
+typedef struct {
+    char key;                   ///< Character that triggers the command
+    void (*handler)(void);      ///< Function executed
+    const char* help;           ///< Description printed by the help command
+} Command;
+
+/**
+*   \brief Line of a long reply: writes line index in line and returns its
+*   length, 0 to skip the line, COMMANDS_REPLY_END after the last line.
+*/
+typedef uint8_t (*Commands_ReplyLine)(uint8_t index, char* line, uint8_t size);
+
+#define COMMANDS_REPLY_END 0xFF
+
+static void Command_Help(void);
+static void Commands_StartReply(Commands_ReplyLine line);
+
+static uint8_t commands_task_id = 0;
+static Commands_ReplyLine reply = NULL;     // Long reply being sent, NULL if none
+static uint8_t reply_index = 0;             // Next line of the reply
+static char reply_line[80];
+static uint8_t reply_length = 0;
+static uint8_t reply_offset = 0;            // Characters of the line already sent
+
+/**
+*   \brief Timeout of a chunk of a binary upload [Timer ticks]
+*/
+#define COMMANDS_UPLOAD_TIMEOUT 50
+
+/**
+*   \brief Bytes of a binary upload sent by the host before waiting for the
+*   acknowledge: the size of the RX FIFO, UART_Debug has no RX buffer
+*/
+#define COMMANDS_UPLOAD_CHUNK 4
+
+/**
+*   \brief Acknowledge of a chunk of a binary upload (ASCII ACK)
+*/
+#define COMMANDS_UPLOAD_ACK 0x06
+
+    /**
+    *   \brief Receive the binary payload that follows a command.
+    *
+    *   The caller first replies with a line that tells the host to start.
+    *   The host then sends COMMANDS_UPLOAD_CHUNK bytes at a time and waits
+    *   for COMMANDS_UPLOAD_ACK before the next chunk, so the 4-byte RX
+    *   FIFO never overflows. Uploads are rare maintenance operations, so
+    *   the function waits for the bytes; the FIFO of the accelerometer
+    *   covers the pause.
+    *   \retval Returns ERROR if a chunk does not arrive before the timeout.
+    */
+    static ErrorCode Commands_ReadBinary(uint8_t* data, uint8_t length)
+    {
+        uint8_t received = 0;
+        while (received < length)
+        {
+            uint32_t start = Timer_Tick;
+            uint8_t chunk_end = length - received > COMMANDS_UPLOAD_CHUNK ? received + COMMANDS_UPLOAD_CHUNK : length;
+            while (received < chunk_end)
+            {
+                // GetChar cannot be used here: 0 is a valid byte
+                if (UART_Debug_GetRxBufferSize())
+                {
+                    data[received++] = UART_Debug_ReadRxData();
+                }
+                else if (Timer_Tick - start > COMMANDS_UPLOAD_TIMEOUT)
+                {
+                    return ERROR;
+                }
+            }
+            UART_Debug_PutChar(COMMANDS_UPLOAD_ACK);
+        }
+        return NO_ERROR;
+    }
+
+    static void Command_PowerActive(void)
+    {
+        PowerManager_SetMode(POWER_MODE_ACTIVE);
+        UART_Debug_PutString("Power mode: active\r\n");
+    }
+
+    static void Command_PowerSleep(void)
+    {
+        PowerManager_SetMode(POWER_MODE_SLEEP);
+        UART_Debug_PutString("Power mode: sleep\r\n");
+    }
+
+    static void Command_PowerAltActive(void)
+    {
+        PowerManager_SetMode(POWER_MODE_ALT_ACTIVE);
+        UART_Debug_PutString("Power mode: alternate active\r\n");
+    }
+
+    static void Command_AdaptiveRate(void)
+    {
+        uint8_t enabled = !AdaptiveRate_IsEnabled();
+        if (AdaptiveRate_SetEnabled(enabled) == NO_ERROR)
+        {
+            UART_Debug_PutString(enabled ? "Adaptive rate: on\r\n" : "Adaptive rate: off\r\n");
+        }
+        else
+        {
+            UART_Debug_PutString("Error occurred during I2C comm to set the adaptive rate\r\n");
+        }
+    }
+
+    static void Command_RawOutput(void)
+    {
+        uint16_t mode = Acquisition_GetOutputMode() ^ ACQUISITION_OUTPUT_RAW;
+        Acquisition_SetOutputMode(mode);
+        UART_Debug_PutString((mode & ACQUISITION_OUTPUT_RAW) ? "Raw stream: on\r\n" : "Raw stream: off\r\n");
+    }
+
+    static void Command_OtherDevicesOutput(void)
+    {
+        char message[80];
+        uint16_t mode = Acquisition_GetOutputMode() ^ ACQUISITION_OUTPUT_OTHERS;
+        Acquisition_SetOutputMode(mode);
+        if (!(mode & ACQUISITION_OUTPUT_OTHERS))
+        {
+            UART_Debug_PutString("Other devices: off\r\n");
+            return;
+        }
+        // The frames of the other devices are dropped while they do not fit
+        uint32_t load = Acquisition_GetRawLoad();
+        uint16_t link = Frames_GetLinkRate();
+        Format_Text(message, sizeof(message), "Other devices: on, raw stream %lu of %u B/s%s\r\n",
+                    load, link, load > link ? ", over the link: dropped" : "");
+        UART_Debug_PutString(message);
+    }
+
+    static void Command_CompressedOutput(void)
+    {
+        uint16_t mode = Acquisition_GetOutputMode() ^ ACQUISITION_OUTPUT_COMPRESSED;
+        if (mode & ACQUISITION_OUTPUT_COMPRESSED)
+        {
+            // The first frame is a keyframe
+            Compress_Reset();
+        }
+        Acquisition_SetOutputMode(mode);
+        UART_Debug_PutString((mode & ACQUISITION_OUTPUT_COMPRESSED) ? "Compressed stream: on\r\n" : "Compressed stream: off\r\n");
+    }
+
+    static void Command_TextOutput(void)
+    {
+        uint8_t enabled = !Acquisition_GetTextOutput();
+        Acquisition_SetTextOutput(enabled);
+        UART_Debug_PutString(enabled ? "CSV stream: on, 0.01 m/s^2\r\nx,y,z\r\n" : "CSV stream: off\r\n");
+    }
+
+    static void Command_CaptureOutput(void)
+    {
+        uint16_t mode = Acquisition_GetOutputMode() ^ ACQUISITION_OUTPUT_CAPTURE;
+        if (mode & ACQUISITION_OUTPUT_CAPTURE)
+        {
+            // Start from an empty pre-trigger buffer
+            Capture_Init();
+        }
+        Acquisition_SetOutputMode(mode);
+        UART_Debug_PutString((mode & ACQUISITION_OUTPUT_CAPTURE) ? "Capture: armed\r\n" : "Capture: off\r\n");
+    }
+
+    static void Command_SummaryOutput(void)
+    {
+        uint16_t mode = Acquisition_GetOutputMode() ^ ACQUISITION_OUTPUT_SUMMARY;
+        if (mode & ACQUISITION_OUTPUT_SUMMARY)
+        {
+            // The first window starts with the next sample
+            Statistics_Reset();
+        }
+        Acquisition_SetOutputMode(mode);
+        UART_Debug_PutString((mode & ACQUISITION_OUTPUT_SUMMARY) ? "Summary: on\r\n" : "Summary: off\r\n");
+    }
+
+    static void Command_SummaryWindow(void)
+    {
+        char message[80];
+        // Cycle through windows of 1, 10 and 60 s at the current rate
+        static const uint8_t seconds[] = {1, 10, 60};
+        static uint8_t selected = 0;
+        selected = (selected + 1) % (sizeof(seconds) / sizeof(seconds[0]));
+        uint32_t samples = (uint32_t)seconds[selected] * Acquisition_GetDataRate();
+        Statistics_SetWindow(samples > 0xFFFF ? 0xFFFF : (uint16_t)samples);
+        Velocity_SetWindow(Statistics_GetWindow());
+        Format_Text(message, sizeof(message), "Summary window: %u samples\r\n", Statistics_GetWindow());
+        UART_Debug_PutString(message);
+    }
+
+    static void Command_VelocityOutput(void)
+    {
+        uint16_t mode = Acquisition_GetOutputMode() ^ ACQUISITION_OUTPUT_VELOCITY;
+        if (mode & ACQUISITION_OUTPUT_VELOCITY)
+        {
+            // Filters and first window start with the next sample
+            Velocity_Reset();
+        }
+        Acquisition_SetOutputMode(mode);
+        UART_Debug_PutString((mode & ACQUISITION_OUTPUT_VELOCITY) ? "Velocity: on\r\n" : "Velocity: off\r\n");
+    }
+
+    static void Command_TiltOutput(void)
+    {
+        uint16_t mode = Acquisition_GetOutputMode() ^ ACQUISITION_OUTPUT_TILT;
+        if (mode & ACQUISITION_OUTPUT_TILT)
+        {
+            // The first interval starts with the next sample
+            Tilt_Reset();
+        }
+        Acquisition_SetOutputMode(mode);
+        UART_Debug_PutString((mode & ACQUISITION_OUTPUT_TILT) ? "Tilt: on\r\n" : "Tilt: off\r\n");
+    }
+
+    static void Command_TiltRate(void)
+    {
+        char message[80];
+        // Cycle through 10, 5 and 1 outputs per second at the current rate
+        static const uint8_t hz[] = {10, 5, 1};
+        static uint8_t selected = 0;
+        selected = (selected + 1) % (sizeof(hz) / sizeof(hz[0]));
+        uint16_t samples = Acquisition_GetDataRate() / hz[selected];
+        Tilt_SetInterval(samples > 0 ? samples : 1);
+        Format_Text(message, sizeof(message), "Tilt interval: %u samples\r\n", Tilt_GetInterval());
+        UART_Debug_PutString(message);
+    }
+
+    static void Command_SpectrumOutput(void)
+    {
+        uint16_t mode = Acquisition_GetOutputMode() ^ ACQUISITION_OUTPUT_SPECTRUM;
+        if (mode & ACQUISITION_OUTPUT_SPECTRUM)
+        {
+            // The first block starts with the next sample
+            Spectrum_Init();
+        }
+        Acquisition_SetOutputMode(mode);
+        UART_Debug_PutString((mode & ACQUISITION_OUTPUT_SPECTRUM) ? "Spectrum: on\r\n" : "Spectrum: off\r\n");
+    }
+
+    static void Command_DecimatedOutput(void)
+    {
+        uint16_t mode = Acquisition_GetOutputMode() ^ ACQUISITION_OUTPUT_DECIMATED;
+        if (mode & ACQUISITION_OUTPUT_DECIMATED)
+        {
+            Decimator_Reset();
+        }
+        Acquisition_SetOutputMode(mode);
+        UART_Debug_PutString((mode & ACQUISITION_OUTPUT_DECIMATED) ? "Decimated stream: on\r\n" : "Decimated stream: off\r\n");
+    }
+
+    static void Command_DecimationFactor(void)
+    {
+        char message[80];
+        uint8_t factor = Decimator_GetFactor() * 2;
+        if (factor > DECIMATOR_MAX_FACTOR)
+        {
+            factor = DECIMATOR_MIN_FACTOR;
+        }
+        Decimator_Configure(factor);
+        Format_Text(message, sizeof(message), "Decimation factor: %u\r\n", factor);
+        UART_Debug_PutString(message);
+    }
+
+    static void Command_DataRate(void)
+    {
+        char message[80];
+        // Cycle through 10, 25, 50, 100, 200 and 400 Hz, from the rate the
+        // devices run at now (the adaptive rate may have changed it)
+        uint8_t odr = (Device_Get(0)->ctrl_reg1 & LIS3DH_CTRL_REG1_ODR_MASK) >> LIS3DH_CTRL_REG1_ODR_SHIFT;
+        odr = odr < LIS3DH_ODR_400HZ ? odr + 1 : LIS3DH_ODR_10HZ;
+        if (Acquisition_SetDataRate(odr) == NO_ERROR)
+        {
+            Format_Text(message, sizeof(message), "Output data rate: %u Hz\r\n", Acquisition_GetDataRate());
+            UART_Debug_PutString(message);
+        }
+        else
+        {
+            UART_Debug_PutString("Error occurred during I2C comm to set the output data rate\r\n");
+        }
+    }
+
+    static void Command_HighPass(void)
+    {
+        char message[80];
+        // Cycle through off, 2, 1, 0.5 and 0.2 Hz (at 100 Hz ODR)
+        static const char* cutoff_names[] = {"2", "1", "0.5", "0.2"};
+        uint8_t enabled = 1;
+        uint8_t cutoff = HIGHPASS_CUTOFF_2HZ;
+        if (HighPass_IsEnabled())
+        {
+            cutoff = HighPass_GetCutoff() + 1;
+            if (cutoff > HIGHPASS_CUTOFF_0_2HZ)
+            {
+                enabled = 0;
+                cutoff = HIGHPASS_CUTOFF_2HZ;
+            }
+        }
+        if (HighPass_Configure(enabled, cutoff) != NO_ERROR)
+        {
+            UART_Debug_PutString("Error occurred during I2C comm to set the high-pass filter\r\n");
+            return;
+        }
+        if (enabled)
+        {
+            Format_Text(message, sizeof(message), "High-pass output: %s Hz at 100 Hz ODR\r\n", cutoff_names[cutoff]);
+            UART_Debug_PutString(message);
+        }
+        else
+        {
+            UART_Debug_PutString("High-pass output: off\r\n");
+        }
+    }
+
+    static void Command_Click(void)
+    {
+        uint8_t enabled = !Click_IsEnabled();
+        if (Click_SetEnabled(enabled) == NO_ERROR)
+        {
+            UART_Debug_PutString(enabled ? "Click events: on\r\n" : "Click events: off\r\n");
+        }
+        else
+        {
+            UART_Debug_PutString("Error occurred during I2C comm to set the click detection\r\n");
+        }
+    }
+
+    static void Command_Temperature(void)
+    {
+        char message[80];
+        uint16_t divider = Acquisition_GetTemperatureDivider() ? 0 : ACQUISITION_DEFAULT_TEMPERATURE_DIVIDER;
+        if (Acquisition_SetTemperatureDivider(divider) != NO_ERROR)
+        {
+            UART_Debug_PutString("Error occurred during I2C comm to set the temperature channel\r\n");
+            return;
+        }
+        if (divider)
+        {
+            Format_Text(message, sizeof(message), "Temperature channel: every %u samples\r\n", divider);
+            UART_Debug_PutString(message);
+        }
+        else
+        {
+            UART_Debug_PutString("Temperature channel: off\r\n");
+        }
+    }
+
+    static void Command_Compensation(void)
+    {
+        uint8_t enabled = !Acquisition_IsCompensated();
+        if (Acquisition_SetCompensation(enabled) == NO_ERROR)
+        {
+            UART_Debug_PutString(enabled ? "Temperature compensation: on\r\n" : "Temperature compensation: off\r\n");
+        }
+        else
+        {
+            UART_Debug_PutString("Temperature compensation needs a table and the temperature channel\r\n");
+        }
+    }
+
+    static void Command_CompensationUpload(void)
+    {
+        // Fixed size image, padded by the host tool
+        uint8_t image[TEMPCOMP_MAX_IMAGE_SIZE];
+        UART_Debug_PutString("Compensation table upload: ready\r\n");
+        if (Commands_ReadBinary(image, sizeof(image)) != NO_ERROR)
+        {
+            UART_Debug_PutString("Compensation table upload: timeout\r\n");
+            return;
+        }
+        if (TempComp_Load(image, sizeof(image)) != NO_ERROR)
+        {
+            UART_Debug_PutString("Compensation table upload: invalid table\r\n");
+            return;
+        }
+        if (Storage_Write(STORAGE_TEMPCOMP_ADDRESS, image, sizeof(image)) != NO_ERROR)
+        {
+            UART_Debug_PutString("Compensation table upload: loaded, not saved\r\n");
+            return;
+        }
+        UART_Debug_PutString("Compensation table upload: saved\r\n");
+    }
+
+    static void Command_CalibrationCapture(void)
+    {
+        if (Calibration_Capture() == NO_ERROR)
+        {
+            UART_Debug_PutString("Calibration: capturing, keep the board still\r\n");
+        }
+        else
+        {
+            UART_Debug_PutString("Calibration: capture already running\r\n");
+        }
+    }
+
+    static void Command_CalibrationMode(void)
+    {
+        static const char* names[] = {"off", "offset and gain", "full matrix"};
+        char message[48];
+        CalibrationMode mode = (CalibrationMode)((Calibration_GetMode() + 1) % 3);
+        ErrorCode error = Calibration_SetMode(mode);
+        if (Calibration_GetMode() != mode)
+        {
+            // No calibration available: only off is allowed
+            Calibration_SetMode(CALIBRATION_OFF);
+            UART_Debug_PutString("Calibration: none available, capture the six orientations\r\n");
+            return;
+        }
+        Format_Text(message, sizeof(message), "Calibration: %s%s\r\n", names[mode], error == NO_ERROR ? "" : " (not saved)");
+        UART_Debug_PutString(message);
+    }
+
+    static void Command_DutyReport(void)
+    {
+        char message[80];
+        PowerStats stats;
+        PowerManager_GetStats(&stats);
+        uint16_t duty = PowerManager_GetDutyCycle();
+        uint32_t per_sample = stats.samples ? (uint32_t)(stats.active_cycles / stats.samples) : 0;
+
+        Format_Text(message, sizeof(message), "Awake: %u.%u%% over %lu ticks, %lu sleeps\r\n",
+                duty / 10, duty % 10, (unsigned long)stats.ticks, (unsigned long)stats.sleeps);
+        UART_Debug_PutString(message);
+        Format_Text(message, sizeof(message), "Awake per sample: %lu cycles (%lu us), %lu samples\r\n",
+                (unsigned long)per_sample,
+                (unsigned long)(per_sample / (BCLK__BUS_CLK__HZ / 1000000u)),
+                (unsigned long)stats.samples);
+        UART_Debug_PutString(message);
+        PowerManager_ResetStats();
+    }
+
+    /**
+    *   \brief Two lines per task; the statistics are reset after the last.
+    */
+    static uint8_t Command_TaskReportLine(uint8_t index, char* line, uint8_t size)
+    {
+        if (index >= 2 * Scheduler_GetTaskCount())
+        {
+            Scheduler_ResetStats();
+            return COMMANDS_REPLY_END;
+        }
+        const Scheduler_Task* task = Scheduler_GetTask(index / 2);
+        if (index % 2 == 0)
+        {
+            uint32_t average = task->stats.runs ?
+                (uint32_t)(task->stats.total_cycles / task->stats.runs) : 0;
+            return (uint8_t)Format_Text(line, size, "%s: runs %lu avg %lu max %lu cycles\r\n",
+                    task->name,
+                    (unsigned long)task->stats.runs,
+                    (unsigned long)average,
+                    (unsigned long)task->stats.max_cycles);
+        }
+        return (uint8_t)Format_Text(line, size, "  overruns %lu skipped %lu max lateness %lu\r\n",
+                (unsigned long)task->stats.overruns,
+                (unsigned long)task->stats.skipped,
+                (unsigned long)task->stats.max_lateness);
+    }
+
+    static void Command_TaskReport(void)
+    {
+        Commands_StartReply(Command_TaskReportLine);
+    }
+
+    static void Command_BusReport(void)
+    {
+        char message[80];
+        for (uint8_t i = 0; i < Device_GetCount(); i++)
+        {
+            const Device* device = Device_Get(i);
+            uint16_t utilization = Device_GetBusUtilization(device);
+            Format_Text(message, sizeof(message), "Device %u (0x%02X): bus %u.%u%%\r\n",
+                    device->id, device->address, utilization / 10, utilization % 10);
+            UART_Debug_PutString(message);
+            Format_Text(message, sizeof(message), "  batches %lu bytes %lu overruns %lu\r\n",
+                    (unsigned long)device->stats.transfers,
+                    (unsigned long)device->stats.bytes,
+                    (unsigned long)device->stats.overruns);
+            UART_Debug_PutString(message);
+        }
+        Device_ResetStats();
+    }
+
+    /**
+    *   \brief Line of a jitter histogram: the range (line 0), then a line
+    *   for each bin, empty (0 characters) if the bin is.
+    */
+    static uint8_t Command_HistogramLine(const char* name, const Timestamp_Histogram* histogram,
+                                         uint8_t index, char* line, uint8_t size)
+    {
+        if (index == 0)
+        {
+            return (uint8_t)Format_Text(line, size, "%s: %lu values, min %ld us, max %ld us\r\n", name,
+                    (unsigned long)histogram->count, (long)histogram->min, (long)histogram->max);
+        }
+        uint8_t b = index - 1;
+        if (histogram->bins[b] == 0)
+        {
+            return 0;
+        }
+        // The first and the last bin are open
+        long low = histogram->first_bin_us + (long)b * TIMESTAMP_BIN_US;
+        unsigned long values = histogram->bins[b];
+        if (b == 0)
+        {
+            return (uint8_t)Format_Text(line, size, "  < %ld us: %lu\r\n", low + TIMESTAMP_BIN_US, values);
+        }
+        if (b == TIMESTAMP_BINS - 1)
+        {
+            return (uint8_t)Format_Text(line, size, "  >= %ld us: %lu\r\n", low, values);
+        }
+        return (uint8_t)Format_Text(line, size, "  %ld ... %ld us: %lu\r\n", low, low + TIMESTAMP_BIN_US, values);
+    }
+
+    /**
+    *   \brief The two histograms; they are reset after the last line.
+    */
+    static uint8_t Command_JitterReportLine(uint8_t index, char* line, uint8_t size)
+    {
+        if (index <= TIMESTAMP_BINS)
+        {
+            return Command_HistogramLine("Read latency", Timestamp_GetLatency(), index, line, size);
+        }
+        if (index < 2 * (TIMESTAMP_BINS + 1))
+        {
+            return Command_HistogramLine("Interval error", Timestamp_GetIntervalError(),
+                                         index - (TIMESTAMP_BINS + 1), line, size);
+        }
+        Timestamp_Reset();
+        return COMMANDS_REPLY_END;
+    }
+
+    static void Command_JitterReport(void)
+    {
+        Commands_StartReply(Command_JitterReportLine);
+    }
+
+    static void Command_LossReport(void)
+    {
+        char message[80];
+        Format_Text(message, sizeof(message), "Samples %lu, losses since start-up:\r\n",
+                (unsigned long)Acquisition_GetSampleCount());
+        UART_Debug_PutString(message);
+        for (uint8_t c = 0; c < HEALTH_COUNTERS; c++)
+        {
+            Format_Text(message, sizeof(message), "  %s: %lu\r\n", Health_GetName((Health_Counter)c),
+                    (unsigned long)Health_Get((Health_Counter)c));
+            UART_Debug_PutString(message);
+        }
+    }
+
+    static void Command_FlashLog(void)
+    {
+        char message[80];
+        if (FlashLog_IsRecording())
+        {
+            FlashLog_Stop();
+            Format_Text(message, sizeof(message), "Flash log: stopped, %u rows\r\n", FlashLog_GetRowCount());
+        }
+        else if (FlashLog_Start() == NO_ERROR)
+        {
+            // The first frame of the log is a keyframe
+            Compress_Reset();
+            Format_Text(message, sizeof(message), "Flash log: recording after row %u of %u\r\n",
+                    FlashLog_GetRowCount(), FLASHLOG_ROWS);
+        }
+        else
+        {
+            Format_Text(message, sizeof(message), "Flash log: busy, try again\r\n");
+        }
+        UART_Debug_PutString(message);
+    }
+
+    static void Command_FlashLogDump(void)
+    {
+        char message[80];
+        if (FlashLog_StartDump() == NO_ERROR)
+        {
+            Format_Text(message, sizeof(message), "Flash log dump: %u rows\r\n", FlashLog_GetRowCount());
+        }
+        else
+        {
+            Format_Text(message, sizeof(message), "Flash log: stop the recording and wait for the dump\r\n");
+        }
+        UART_Debug_PutString(message);
+    }
+
+    static void Command_FlashLogErase(void)
+    {
+        UART_Debug_PutString(FlashLog_Erase() == NO_ERROR ? "Flash log erased\r\n" :
+                             "Flash log: stop the recording and wait for the dump\r\n");
+    }
+
+/**
+*   \brief Command table.
+*/
+static const Command commands[] = {
+    {'a', Command_PowerActive,        "Power mode: active (busy wait)"},
+    {'s', Command_PowerSleep,         "Power mode: CPU sleep between samples"},
+    {'l', Command_PowerAltActive,     "Power mode: alternate active between samples"},
+    {'m', Command_AdaptiveRate,       "Toggle the motion adaptive output data rate"},
+    {'r', Command_RawOutput,          "Toggle the stream of every sample"},
+    {'O', Command_OtherDevicesOutput, "Toggle the sample frames of the other accelerometers (raw stream)"},
+    {'V', Command_TextOutput,         "Toggle the raw stream as CSV lines in 0.01 m/s^2"},
+    {'C', Command_CompressedOutput,   "Toggle the losslessly compressed stream of every sample"},
+    {'c', Command_CaptureOutput,      "Toggle the threshold triggered capture"},
+    {'u', Command_SummaryOutput,      "Toggle the summary frames of the windowed statistics"},
+    {'y', Command_VelocityOutput,     "Toggle the velocity RMS frames (vibration severity)"},
+    {'w', Command_SummaryWindow,      "Cycle the summary and velocity window (1, 10, 60 s)"},
+    {'i', Command_TiltOutput,         "Toggle the tilt frames (pitch and roll)"},
+    {'j', Command_TiltRate,           "Cycle the tilt output rate (10, 5, 1 Hz)"},
+    {'f', Command_SpectrumOutput,     "Toggle the spectrum frames (FFT band energies)"},
+    {'e', Command_DecimatedOutput,    "Toggle the decimated stream (CIC + FIR)"},
+    {'x', Command_DecimationFactor,   "Cycle the decimation factor (2 ... 32)"},
+    {'o', Command_DataRate,           "Cycle the output data rate (10 ... 400 Hz)"},
+    {'g', Command_HighPass,           "Cycle the high-pass filtered output (off, 2 ... 0.2 Hz)"},
+    {'k', Command_Click,              "Toggle the click event frames"},
+    {'p', Command_Temperature,        "Toggle the temperature channel (ADC1 ... ADC3)"},
+    {'n', Command_Compensation,       "Toggle the temperature compensated offset correction"},
+    {'z', Command_CompensationUpload, "Upload a compensation table (binary image in acknowledged chunks)"},
+    {'b', Command_CalibrationCapture, "Capture the current orientation of the six-position calibration"},
+    {'v', Command_CalibrationMode,    "Cycle the calibration correction (off, offset and gain, full matrix)"},
+    {'d', Command_DutyReport,         "Print and reset the awake duty cycle"},
+    {'q', Command_BusReport,          "Print and reset the bus utilization of each accelerometer"},
+    {'h', Command_JitterReport,       "Print and reset the read latency and interval jitter"},
+    {'F', Command_FlashLog,           "Toggle the recording of the compressed stream in the flash log"},
+    {'D', Command_FlashLogDump,       "Dump the flash log as log row frames"},
+    {'E', Command_FlashLogErase,      "Erase the flash log"},
+    {'L', Command_LossReport,         "Print the loss counters (overruns, skipped ticks, drops)"},
+    {'t', Command_TaskReport,         "Print and reset the task statistics"},
+    {'?', Command_Help,               "Print this help"},
+};
+
+#define COMMANDS_COUNT (sizeof(commands) / sizeof(commands[0]))
+
+    static uint8_t Command_HelpLine(uint8_t index, char* line, uint8_t size)
+    {
+        if (index >= COMMANDS_COUNT)
+        {
+            return COMMANDS_REPLY_END;
+        }
+        return (uint8_t)Format_Text(line, size, "%c: %s\r\n", commands[index].key, commands[index].help);
+    }
+
+    static void Command_Help(void)
+    {
+        Commands_StartReply(Command_HelpLine);
+    }
+
+    /**
+    *   \brief Format the next line of the reply that is not empty.
+    *
+    *   \retval Returns ERROR after the last line.
+    */
+    static ErrorCode Commands_NextLine(void)
+    {
+        do
+        {
+            reply_length = reply(reply_index++, reply_line, sizeof(reply_line));
+        } while (reply_length == 0);
+        return reply_length == COMMANDS_REPLY_END ? ERROR : NO_ERROR;
+    }
+
+    /**
+    *   \brief Send the next piece of the long reply.
+    *
+    *   A line is written as a text long frame, so that the frames of the
+    *   other tasks do not split it; the pieces fit in the time left before
+    *   the next acquisition.
+    */
+    static void Commands_SendReply(void)
+    {
+        uint16_t allowance = Acquisition_GetTxAllowance();
+        while (allowance > 0)
+        {
+            if (reply_offset == 0 && Frames_BeginText() != NO_ERROR)
+            {
+                // Another long frame is open (log dump): wait for its end
+                return;
+            }
+            uint8_t chunk = reply_length - reply_offset;
+            if (chunk > allowance)
+            {
+                chunk = (uint8_t)allowance;
+            }
+            Frames_Write((const uint8_t*)&reply_line[reply_offset], chunk);
+            reply_offset += chunk;
+            allowance -= chunk;
+            if (reply_offset < reply_length)
+            {
+                return;
+            }
+            Frames_End();
+            reply_offset = 0;
+            if (Commands_NextLine() != NO_ERROR)
+            {
+                reply = NULL;
+                Scheduler_SetPeriod(commands_task_id, COMMANDS_TASK_PERIOD);
+                return;
+            }
+        }
+    }
+
+    /**
+    *   \brief Start a long reply, sent by the next runs of the task.
+    */
+    static void Commands_StartReply(Commands_ReplyLine line)
+    {
+        reply = line;
+        reply_index = 0;
+        reply_offset = 0;
+        if (Commands_NextLine() == NO_ERROR)
+        {
+            Scheduler_SetPeriod(commands_task_id, 1);
+        }
+        else
+        {
+            reply = NULL;
+        }
+    }
+
+    void Commands_Init(uint8_t task_id)
+    {
+        commands_task_id = task_id;
+    }
+
+    void Commands_Task(void)
+    {
+        uint8_t received;
+        if (reply != NULL)
+        {
+            Commands_SendReply();
+            return;
+        }
+        // The replies are written straight to the UART: inside an open long
+        // frame they would corrupt it, so the commands wait in the RX FIFO
+        // until the frame is closed
+        if (Frames_IsLongFrameOpen())
+        {
+            return;
+        }
+        // GetChar returns 0 when the receive buffer is empty
+        while ((received = UART_Debug_GetChar()) != 0)
+        {
+            for (uint8_t i = 0; i < COMMANDS_COUNT; i++)
+            {
+                if (commands[i].key == (char)received)
+                {
+                    commands[i].handler();
+                    break;
+                }
+            }
+            if (reply != NULL)
+            {
+                // The next commands wait for the end of the reply
+                return;
+            }
+        }
+    }
+
+/* [] END OF FILE */
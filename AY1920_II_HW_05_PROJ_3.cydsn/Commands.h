@@ -0,0 +1,40 @@
+/**
+*   \file Commands.h
+*   \brief Single character commands received over UART.
+*
+*   The command task reads the characters received by UART_Debug and runs
+*   the matching entry of a fixed command table. Text answers are sent on
+*   the same UART: the Bridge Control Panel skips them because they are
+*   not enclosed between the packet header and tail.
+*/
+
+#ifndef Commands_H
+    #define Commands_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Period of the command task in Timer ticks (100 ms)
+    */
+    #define COMMANDS_TASK_PERIOD 10
+
+    /**
+    *   \brief Save the scheduler index of the command task.
+    */
+    void Commands_Init(uint8_t task_id);
+
+    /**
+    *   \brief Command task.
+    *
+    *   This function executes all the commands received since its last run.
+    *   While a long frame is open (Frames_Begin()) no command is executed:
+    *   they are read after Frames_End().
+    *
+    *   The long replies (help, task and jitter reports) are sent a line at a
+    *   time, each line in pieces of Acquisition_GetTxAllowance() bytes: the
+    *   task then runs every tick and reads no command until the reply ends.
+    */
+    void Commands_Task(void);
+
+#endif // Commands_H
+/* [] END OF FILE */
@@ -0,0 +1,346 @@
+/*
+* This file includes the lossless compression of the sample stream. It does
+* not depend on the PSoC generated code, so it can be compiled on a host PC
+* too.
+*/
+
+#include <stddef.h>
+#include "Compress.h"
+
+/**
+*   \brief Largest Rice parameter
+*/
+#define COMPRESS_MAX_K 24
+
+/**
+*   \brief Bit writer and reader, most significant bit first
+*/
+typedef struct {
+    uint8_t* position;
+    const uint8_t* end;
+    uint32_t bits;      // Bits not yet written or read, in the low part
+    uint8_t count;      // Number of those bits
+    uint8_t overflow;   // Set when the buffer is too short
+} Compress_Bits;
+
+static int32_t frame[COMPRESS_FRAME_SAMPLES][3];
+static uint32_t values[COMPRESS_FRAME_SAMPLES][3];  // Zig-zag differences of the frame
+static uint8_t frame_count = 0;
+static uint32_t frame_index = 0;
+static int32_t previous[3];
+static uint8_t sequence = 0;
+static uint8_t frames_to_keyframe = 0;  // 0: the next frame is a keyframe
+
+    static uint8_t* Compress_PutInt32(uint8_t* buffer, int32_t value)
+    {
+        uint32_t bits = (uint32_t)value;
+        buffer[0] = (uint8_t)bits;
+        buffer[1] = (uint8_t)(bits >> 8);
+        buffer[2] = (uint8_t)(bits >> 16);
+        buffer[3] = (uint8_t)(bits >> 24);
+        return buffer + 4;
+    }
+
+    static int32_t Compress_GetInt32(const uint8_t* buffer)
+    {
+        return (int32_t)(buffer[0] | ((uint32_t)buffer[1] << 8) |
+                         ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24));
+    }
+
+    /**
+    *   \brief Write up to COMPRESS_MAX_K bits.
+    */
+    static void Compress_PutBits(Compress_Bits* writer, uint32_t value, uint8_t bits)
+    {
+        writer->bits = (writer->bits << bits) | (value & ((1u << bits) - 1));
+        writer->count += bits;
+        while (writer->count >= 8)
+        {
+            if (writer->position == writer->end)
+            {
+                writer->overflow = 1;
+                writer->count = 0;
+                return;
+            }
+            writer->count -= 8;
+            *writer->position++ = (uint8_t)(writer->bits >> writer->count);
+        }
+    }
+
+    static void Compress_PutCode(Compress_Bits* writer, uint32_t value, uint8_t k)
+    {
+        uint32_t quotient = value >> k;
+        if (quotient >= COMPRESS_ESCAPE)
+        {
+            Compress_PutBits(writer, 0xFFFF, COMPRESS_ESCAPE);
+            Compress_PutBits(writer, value >> 16, 16);
+            Compress_PutBits(writer, value, 16);
+            return;
+        }
+        // Quotient in unary: ones ended by a zero
+        Compress_PutBits(writer, ((1u << quotient) - 1) << 1, (uint8_t)(quotient + 1));
+        if (k > 0)
+        {
+            Compress_PutBits(writer, value, k);
+        }
+    }
+
+    /**
+    *   \brief Build the payload of the collected frame.
+    */
+    static uint8_t Compress_Frame(uint8_t* payload)
+    {
+        uint8_t keyframe = (frames_to_keyframe == 0);
+        uint8_t* position = &payload[4];
+        if (keyframe)
+        {
+            position[0] = (uint8_t)frame_index;
+            position[1] = (uint8_t)(frame_index >> 8);
+            position[2] = (uint8_t)(frame_index >> 16);
+            position[3] = (uint8_t)(frame_index >> 24);
+            position += 4;
+        }
+        uint8_t* body = position;
+        const uint8_t* verbatim_end = body + 12 * frame_count;
+
+        // Zig-zag differences; a keyframe starts from its first sample
+        uint8_t first = keyframe ? 1 : 0;
+        uint8_t k[3];
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            int32_t last = keyframe ? frame[0][axis] : previous[axis];
+            uint64_t sum = 0;
+            for (uint8_t n = first; n < frame_count; n++)
+            {
+                int32_t delta = (int32_t)((uint32_t)frame[n][axis] - (uint32_t)last);
+                values[n][axis] = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+                sum += values[n][axis];
+                last = frame[n][axis];
+            }
+            // Largest k with 2^k below the mean of the values
+            uint8_t bits = 0;
+            uint64_t coded = frame_count - first;
+            while (bits < COMPRESS_MAX_K && (coded << (bits + 1)) <= sum)
+            {
+                bits++;
+            }
+            k[axis] = bits;
+        }
+
+        Compress_Bits writer = {position, verbatim_end, 0, 0, 0};
+        if (keyframe)
+        {
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                writer.position = Compress_PutInt32(writer.position, frame[0][axis]);
+            }
+        }
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            *writer.position++ = k[axis];
+        }
+        for (uint8_t n = first; n < frame_count && !writer.overflow; n++)
+        {
+            Compress_PutCode(&writer, values[n][0], k[0]);
+            Compress_PutCode(&writer, values[n][1], k[1]);
+            Compress_PutCode(&writer, values[n][2], k[2]);
+        }
+        if (writer.count > 0)
+        {
+            Compress_PutBits(&writer, 0, (uint8_t)(8 - writer.count));
+        }
+
+        uint8_t flags = keyframe ? COMPRESS_FLAG_KEYFRAME : 0;
+        if (writer.overflow || writer.position == verbatim_end)
+        {
+            // No gain: the samples as they are
+            flags |= COMPRESS_FLAG_VERBATIM;
+            position = body;
+            for (uint8_t n = 0; n < frame_count; n++)
+            {
+                for (uint8_t axis = 0; axis < 3; axis++)
+                {
+                    position = Compress_PutInt32(position, frame[n][axis]);
+                }
+            }
+        }
+        else
+        {
+            position = writer.position;
+        }
+
+        payload[0] = (uint8_t)(position - payload);
+        payload[1] = flags;
+        payload[2] = frame_count;
+        payload[3] = sequence++;
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            previous[axis] = frame[frame_count - 1][axis];
+        }
+        frames_to_keyframe = keyframe ? COMPRESS_KEYFRAME_INTERVAL - 1 : frames_to_keyframe - 1;
+        return payload[0];
+    }
+
+    void Compress_Reset(void)
+    {
+        frame_count = 0;
+        frames_to_keyframe = 0;
+    }
+
+    uint8_t Compress_AddSample(const int32_t acceleration[3], uint32_t index, uint8_t* payload)
+    {
+        if (frame_count == 0)
+        {
+            frame_index = index;
+        }
+        frame[frame_count][0] = acceleration[0];
+        frame[frame_count][1] = acceleration[1];
+        frame[frame_count][2] = acceleration[2];
+        if (++frame_count < COMPRESS_FRAME_SAMPLES)
+        {
+            return 0;
+        }
+        uint8_t length = Compress_Frame(payload);
+        frame_count = 0;
+        return length;
+    }
+
+    void Compress_InitDecoder(Compress_Decoder* decoder)
+    {
+        decoder->synced = 0;
+        decoder->sequence = 0;
+        decoder->next_index = 0;
+    }
+
+    /**
+    *   \brief Read up to COMPRESS_MAX_K bits.
+    */
+    static uint32_t Compress_GetBits(Compress_Bits* reader, uint8_t bits)
+    {
+        while (reader->count < bits)
+        {
+            if (reader->position == reader->end)
+            {
+                reader->overflow = 1;
+                return 0;
+            }
+            reader->bits = (reader->bits << 8) | *reader->position++;
+            reader->count += 8;
+        }
+        reader->count -= bits;
+        return (reader->bits >> reader->count) & ((1u << bits) - 1);
+    }
+
+    static uint32_t Compress_GetCode(Compress_Bits* reader, uint8_t k)
+    {
+        uint32_t quotient = 0;
+        while (quotient < COMPRESS_ESCAPE && Compress_GetBits(reader, 1))
+        {
+            quotient++;
+        }
+        if (quotient == COMPRESS_ESCAPE)
+        {
+            uint32_t high = Compress_GetBits(reader, 16);
+            return (high << 16) | Compress_GetBits(reader, 16);
+        }
+        return k > 0 ? (quotient << k) | Compress_GetBits(reader, k) : quotient;
+    }
+
+    ErrorCode Compress_Decode(Compress_Decoder* decoder, const uint8_t* payload, uint8_t length,
+                              int32_t samples[][3], uint8_t* count, uint32_t* first_index)
+    {
+        *count = 0;
+        if (length < 4 || payload[0] != length || payload[2] == 0 ||
+            payload[2] > COMPRESS_FRAME_SAMPLES)
+        {
+            return ERROR;
+        }
+        uint8_t flags = payload[1];
+        uint8_t samples_count = payload[2];
+        uint8_t keyframe = flags & COMPRESS_FLAG_KEYFRAME;
+
+        // A lost frame breaks the chain of differences until a keyframe
+        if (!keyframe && (!decoder->synced || payload[3] != decoder->sequence))
+        {
+            decoder->synced = 0;
+            return NO_ERROR;
+        }
+        const uint8_t* position = &payload[4];
+        const uint8_t* end = payload + length;
+        uint32_t index = decoder->next_index;
+        if (keyframe)
+        {
+            if (end - position < 4)
+            {
+                return ERROR;
+            }
+            index = (uint32_t)Compress_GetInt32(position);
+            position += 4;
+        }
+
+        if (flags & COMPRESS_FLAG_VERBATIM)
+        {
+            if (end - position != 12 * samples_count)
+            {
+                return ERROR;
+            }
+            for (uint8_t n = 0; n < samples_count; n++)
+            {
+                for (uint8_t axis = 0; axis < 3; axis++, position += 4)
+                {
+                    samples[n][axis] = Compress_GetInt32(position);
+                }
+            }
+        }
+        else
+        {
+            int32_t last[3] = {decoder->previous[0], decoder->previous[1], decoder->previous[2]};
+            uint8_t first = 0;
+            if (keyframe)
+            {
+                if (end - position < 12)
+                {
+                    return ERROR;
+                }
+                for (uint8_t axis = 0; axis < 3; axis++, position += 4)
+                {
+                    last[axis] = samples[0][axis] = Compress_GetInt32(position);
+                }
+                first = 1;
+            }
+            if (end - position < 3 || position[0] > COMPRESS_MAX_K ||
+                position[1] > COMPRESS_MAX_K || position[2] > COMPRESS_MAX_K)
+            {
+                return ERROR;
+            }
+            uint8_t k[3] = {position[0], position[1], position[2]};
+            Compress_Bits reader = {(uint8_t*)(position + 3), end, 0, 0, 0};
+            for (uint8_t n = first; n < samples_count; n++)
+            {
+                for (uint8_t axis = 0; axis < 3; axis++)
+                {
+                    uint32_t value = Compress_GetCode(&reader, k[axis]);
+                    int32_t delta = (int32_t)((value >> 1) ^ (0u - (value & 1)));
+                    last[axis] = samples[n][axis] = (int32_t)((uint32_t)last[axis] + (uint32_t)delta);
+                }
+            }
+            if (reader.overflow)
+            {
+                decoder->synced = 0;
+                return ERROR;
+            }
+        }
+
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            decoder->previous[axis] = samples[samples_count - 1][axis];
+        }
+        decoder->synced = 1;
+        decoder->sequence = (uint8_t)(payload[3] + 1);
+        decoder->next_index = index + samples_count;
+        *first_index = index;
+        *count = samples_count;
+        return NO_ERROR;
+    }
+
+/* [] END OF FILE */
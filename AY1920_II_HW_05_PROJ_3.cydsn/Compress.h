@@ -0,0 +1,113 @@
+/**
+*   \file Compress.h
+*   \brief Lossless compression of the sample stream.
+*
+*   The samples are collected in frames of COMPRESS_FRAME_SAMPLES. Each axis
+*   is coded as the difference from the previous sample, mapped to an
+*   unsigned value by zig-zag (0, -1, 1, -2 ... -> 0, 1, 2, 3 ...) and written
+*   with a Rice code whose parameter k is chosen per frame and per axis from
+*   the mean of the values: quotient in unary, then k bits. A quotient of
+*   COMPRESS_ESCAPE or more is written as COMPRESS_ESCAPE ones followed by
+*   the 32-bit value; if the coded frame is not smaller than the samples
+*   themselves, they are sent verbatim.
+*
+*   Every COMPRESS_KEYFRAME_INTERVAL frames, and after a reset, a keyframe
+*   carries the index of its first sample and that sample in full, so that
+*   a host that lost a frame resyncs on the next keyframe. The frames are
+*   numbered to detect the losses. Payload (little endian):
+*
+*   - length of the payload (uint8), flags (uint8, COMPRESS_FLAG_*),
+*     samples n (uint8), sequence number (uint8);
+*   - keyframe: index of the first sample (uint32);
+*   - verbatim: n samples X, Y, Z (int32);
+*   - coded: keyframe only, first sample X, Y, Z (int32); k of X, Y, Z
+*     (uint8); then the codes of the other samples, X, Y, Z of each one,
+*     most significant bit first, the last byte padded with zeros.
+*
+*   The differences of a keyframe start from its first sample, those of
+*   the other frames from the last sample of the previous frame.
+*
+*   The decoder is used by the host tools; the code does not include any
+*   PSoC header, so it can be compiled on a host PC too.
+*/
+
+#ifndef Compress_H
+    #define Compress_H
+
+    #include <stdint.h>
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Samples per frame
+    */
+    #define COMPRESS_FRAME_SAMPLES 16
+
+    /**
+    *   \brief Frames from a keyframe to the next one
+    */
+    #define COMPRESS_KEYFRAME_INTERVAL 16
+
+    /**
+    *   \brief Longest unary quotient: longer ones are escaped
+    */
+    #define COMPRESS_ESCAPE 16
+
+    /**
+    *   \brief Flags of a frame
+    */
+    #define COMPRESS_FLAG_KEYFRAME (1<<0)   ///< Index and first sample in full
+    #define COMPRESS_FLAG_VERBATIM (1<<1)   ///< Samples not coded
+
+    /**
+    *   \brief Largest payload: a verbatim keyframe
+    */
+    #define COMPRESS_MAX_PAYLOAD (8 + 12 * COMPRESS_FRAME_SAMPLES)
+
+    /**
+    *   \brief State of a decoder on the host
+    */
+    typedef struct {
+        int32_t previous[3];    ///< Last decoded sample
+        uint32_t next_index;    ///< Index of the next sample
+        uint8_t sequence;       ///< Expected sequence number
+        uint8_t synced;         ///< 0 until the first keyframe
+    } Compress_Decoder;
+
+    /**
+    *   \brief Discard the samples collected and start over with a keyframe.
+    *
+    *   Call it when a frame could not be sent.
+    */
+    void Compress_Reset(void);
+
+    /**
+    *   \brief Collect a sample.
+    *
+    *   \param acceleration X, Y, Z.
+    *   \param index Index of the sample in the stream.
+    *   \param payload Buffer of COMPRESS_MAX_PAYLOAD bytes, filled when the
+    *   frame is complete.
+    *   \retval Length of the payload, 0 while the frame is not complete.
+    */
+    uint8_t Compress_AddSample(const int32_t acceleration[3], uint32_t index, uint8_t* payload);
+
+    /**
+    *   \brief Prepare a decoder: it waits for a keyframe.
+    */
+    void Compress_InitDecoder(Compress_Decoder* decoder);
+
+    /**
+    *   \brief Decode a frame.
+    *
+    *   After a lost frame (wrong sequence number) the frames are skipped
+    *   until the next keyframe.
+    *   \param samples Buffer of COMPRESS_FRAME_SAMPLES samples.
+    *   \param count Samples decoded, 0 while waiting for a keyframe.
+    *   \param first_index Index of the first sample decoded.
+    *   \retval Returns ERROR if the payload is malformed.
+    */
+    ErrorCode Compress_Decode(Compress_Decoder* decoder, const uint8_t* payload, uint8_t length,
+                              int32_t samples[][3], uint8_t* count, uint32_t* first_index);
+
+#endif // Compress_H
+/* [] END OF FILE */
@@ -0,0 +1,161 @@
+/*
+* This file includes the decimation filter chain. It does not depend on the
+* PSoC generated code, so it can be compiled on a host PC too.
+*/
+
+#include "Decimator.h"
+
+#define FIR_HALF ((DECIMATOR_FIR_TAPS - 1) / 2)
+#define CIC_RATES 5
+
+/**
+*   \brief Center and one side of the FIR (Q15, DC gain 1) for each CIC rate
+*   R = 1, 2, 4, 8, 16: least squares fit of 1/CIC up to 0.15 and 0 from 0.3
+*   of the CIC output rate
+*/
+static const int16_t fir_coefficients[CIC_RATES][FIR_HALF + 1] = {
+    {14798, 10106, 1434, -2611, -1071, 909, 640, -255, -286, 38, 81},
+    {16046, 10651, 837, -3387, -1183, 1216, 779, -347, -361, 53, 103},
+    {16380, 10794, 672, -3596, -1208, 1303, 817, -374, -381, 58, 109},
+    {16462, 10831, 630, -3649, -1214, 1325, 827, -380, -387, 59, 111},
+    {16486, 10840, 620, -3663, -1216, 1331, 829, -382, -388, 59, 111},
+};
+
+static uint8_t rate_log2 = 1;       // log2 of the CIC rate R
+static uint8_t phase = 0;           // inputs since the last CIC output
+
+// CIC state, in modular arithmetic: the wrap-around of the integrators is
+// cancelled by the combs. 64 bits, since the comb output reaches R^4 |x|:
+// 2^16 * 2^18 at R = 16 and +-16 g
+static uint64_t integrator[3][DECIMATOR_CIC_ORDER];
+static uint64_t comb_delay[3][DECIMATOR_CIC_ORDER];
+
+// FIR input history at the CIC output rate
+static int32_t history[3][DECIMATOR_FIR_TAPS];
+static uint8_t history_position = 0;
+static uint8_t fir_phase = 0;
+
+    ErrorCode Decimator_Configure(uint8_t factor)
+    {
+        uint8_t log2 = 0;
+        while ((DECIMATOR_MIN_FACTOR << log2) < factor)
+        {
+            log2++;
+        }
+        if (factor < DECIMATOR_MIN_FACTOR || factor > DECIMATOR_MAX_FACTOR ||
+            (DECIMATOR_MIN_FACTOR << log2) != factor)
+        {
+            return ERROR;
+        }
+        rate_log2 = log2;
+        Decimator_Reset();
+        return NO_ERROR;
+    }
+
+    uint8_t Decimator_GetFactor(void)
+    {
+        return DECIMATOR_MIN_FACTOR << rate_log2;
+    }
+
+    void Decimator_Reset(void)
+    {
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            for (uint8_t stage = 0; stage < DECIMATOR_CIC_ORDER; stage++)
+            {
+                integrator[axis][stage] = 0;
+                comb_delay[axis][stage] = 0;
+            }
+            for (uint8_t tap = 0; tap < DECIMATOR_FIR_TAPS; tap++)
+            {
+                history[axis][tap] = 0;
+            }
+        }
+        phase = 0;
+        history_position = 0;
+        fir_phase = 0;
+    }
+
+    /**
+    *   \brief FIR output centered on the oldest half of the history.
+    */
+    static int32_t Decimator_Fir(uint8_t axis)
+    {
+        const int16_t* h = fir_coefficients[rate_log2];
+        const int32_t* x = history[axis];
+        // history_position is the oldest entry, the center is FIR_HALF after it
+        uint8_t center = (history_position + FIR_HALF) % DECIMATOR_FIR_TAPS;
+        int64_t accumulator = (int64_t)h[0] * x[center];
+
+        uint8_t before = center;
+        uint8_t after = center;
+        for (uint8_t k = 1; k <= FIR_HALF; k++)
+        {
+            before = before ? before - 1 : DECIMATOR_FIR_TAPS - 1;
+            after = after + 1 < DECIMATOR_FIR_TAPS ? after + 1 : 0;
+            // Symmetric filter: one product for two taps
+            accumulator += (int64_t)h[k] * (x[before] + x[after]);
+        }
+        return (int32_t)((accumulator + (1 << 14)) >> 15);
+    }
+
+    uint8_t Decimator_Process(const int32_t input[][3],
+                              uint8_t count,
+                              int32_t output[][3])
+    {
+        uint8_t outputs = 0;
+
+        for (uint8_t n = 0; n < count; n++)
+        {
+            // CIC integrators at the input rate
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                uint64_t value = (uint64_t)(int64_t)input[n][axis];
+                for (uint8_t stage = 0; stage < DECIMATOR_CIC_ORDER; stage++)
+                {
+                    integrator[axis][stage] += value;
+                    value = integrator[axis][stage];
+                }
+            }
+            if (++phase < (1u << rate_log2))
+            {
+                continue;
+            }
+            phase = 0;
+
+            // CIC combs at the input rate / R, gain R^4 removed by a shift
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                uint64_t value = integrator[axis][DECIMATOR_CIC_ORDER - 1];
+                for (uint8_t stage = 0; stage < DECIMATOR_CIC_ORDER; stage++)
+                {
+                    uint64_t difference = value - comb_delay[axis][stage];
+                    comb_delay[axis][stage] = value;
+                    value = difference;
+                }
+                uint8_t shift = DECIMATOR_CIC_ORDER * rate_log2;
+                int64_t filtered = (int64_t)value;
+                if (shift)
+                {
+                    filtered = (filtered + ((int64_t)1 << (shift - 1))) >> shift;
+                }
+                history[axis][history_position] = (int32_t)filtered;
+            }
+            history_position = (history_position + 1) % DECIMATOR_FIR_TAPS;
+
+            // FIR evaluated only for the samples kept by the decimation by 2
+            fir_phase ^= 1;
+            if (fir_phase)
+            {
+                continue;
+            }
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                output[outputs][axis] = Decimator_Fir(axis);
+            }
+            outputs++;
+        }
+        return outputs;
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,71 @@
+/**
+*   \file Decimator.h
+*   \brief Integer decimation filter chain (CIC + compensating FIR).
+*
+*   The samples are decimated by R with a fourth order CIC filter, then by 2
+*   with a 21-tap symmetric FIR that compensates the CIC droop and removes
+*   the band that would alias. The total decimation factor is 2R. At the
+*   output rate fo, the passband is flat within 1% up to 0.3 fo. The tones
+*   from 0.6 fo that fold into the passband are attenuated at least 48 dB
+*   at every factor. Above factor 2 the worst are the ones near 2k fo
+*   +- 0.3 fo, which only the CIC attenuates: 49.8 dB at factor 4, 58 dB
+*   and more at the others (Host_Tools/decimator_check.c).
+*
+*   Only integer arithmetic is used and the code does not include any PSoC
+*   header, so it can be compiled on a host PC too.
+*/
+
+#ifndef Decimator_H
+    #define Decimator_H
+
+    #include <stdint.h>
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Order of the CIC filter
+    */
+    #define DECIMATOR_CIC_ORDER 4
+
+    /**
+    *   \brief Taps of the compensating FIR filter
+    */
+    #define DECIMATOR_FIR_TAPS 21
+
+    /**
+    *   \brief Decimation factors: 2R with R = 1, 2, 4, 8, 16
+    */
+    #define DECIMATOR_MIN_FACTOR 2
+    #define DECIMATOR_MAX_FACTOR 32
+    #define DECIMATOR_DEFAULT_FACTOR 4
+
+    /**
+    *   \brief Set the decimation factor and clear the filter state.
+    *
+    *   \param factor 2, 4, 8, 16 or 32.
+    */
+    ErrorCode Decimator_Configure(uint8_t factor);
+
+    /**
+    *   \brief Current decimation factor.
+    */
+    uint8_t Decimator_GetFactor(void);
+
+    /**
+    *   \brief Clear the filter state.
+    */
+    void Decimator_Reset(void);
+
+    /**
+    *   \brief Filter a batch of samples.
+    *
+    *   \param input X, Y, Z of \p count consecutive samples.
+    *   \param count Samples of the batch.
+    *   \param output Decimated samples, room for count / 2 + 1 entries.
+    *   \retval Returns the number of decimated samples written in \p output.
+    */
+    uint8_t Decimator_Process(const int32_t input[][3],
+                              uint8_t count,
+                              int32_t output[][3]);
+
+#endif // Decimator_H
+/* [] END OF FILE */
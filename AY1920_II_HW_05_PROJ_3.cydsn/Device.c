@@ -0,0 +1,207 @@
+/*
+* This file includes the instances of the LIS3DH accelerometers.
+*/
+
+#include "Device.h"
+#include "I2C_Interface.h"
+#include "LIS3DH_Registers.h"
+#include "PowerManager.h"
+#include "Health.h"
+#include "InterruptRoutines.h"
+#include "project.h"
+
+/**
+*   \brief Addresses where a LIS3DH can answer, device 0 first
+*/
+static const uint8_t device_addresses[DEVICE_MAX] = {LIS3DH_DEVICE_ADDRESS, LIS3DH_DEVICE_ADDRESS_SA0_HIGH};
+
+/**
+*   \brief Scale of the High Resolution samples for each full scale [um/s^2/digit]:
+*   1, 2, 4 and 12 mg/digit
+*/
+static const uint32_t scale_um_s2[4] = {9806, 19612, 39224, 117672};
+
+static Device devices[DEVICE_MAX];
+static uint8_t device_count = 0;
+static uint32_t stats_start_tick = 0;
+
+    /**
+    *   \brief Read the configuration of a device into its shadow registers.
+    */
+    static ErrorCode Device_ReadShadow(Device* device)
+    {
+        ErrorCode error = I2C_Peripheral_ReadRegister(device->address, LIS3DH_CTRL_REG1, &device->ctrl_reg1);
+        if (error == NO_ERROR)
+        {
+            error = I2C_Peripheral_ReadRegister(device->address, LIS3DH_CTRL_REG4, &device->ctrl_reg4);
+        }
+        device->um_s2_per_digit = scale_um_s2[(device->ctrl_reg4 & LIS3DH_CTRL_REG4_FS_MASK) >> LIS3DH_CTRL_REG4_FS_SHIFT];
+        return error;
+    }
+
+    ErrorCode Device_Init(void)
+    {
+        device_count = 0;
+        for (uint8_t i = 0; i < DEVICE_MAX; i++)
+        {
+            Device* device = &devices[device_count];
+            device->id = device_count;
+            device->address = device_addresses[i];
+
+            uint8_t who_am_i;
+            if (!I2C_Peripheral_IsDeviceConnected(device->address) ||
+                I2C_Peripheral_ReadRegister(device->address, LIS3DH_WHO_AM_I_REG_ADDR, &who_am_i) != NO_ERROR ||
+                who_am_i != LIS3DH_WHO_AM_I_VALUE)
+            {
+                if (i == 0)
+                {
+                    return ERROR;
+                }
+                continue;
+            }
+
+            // The other devices copy the configuration of device 0
+            if (i > 0 &&
+                (I2C_Peripheral_WriteRegister(device->address, LIS3DH_CTRL_REG1, devices[0].ctrl_reg1) != NO_ERROR ||
+                 I2C_Peripheral_WriteRegister(device->address, LIS3DH_CTRL_REG4, devices[0].ctrl_reg4) != NO_ERROR))
+            {
+                continue;
+            }
+            if (Device_ReadShadow(device) == NO_ERROR)
+            {
+                device_count++;
+            }
+            else if (i == 0)
+            {
+                return ERROR;
+            }
+        }
+        Device_ResetStats();
+        return NO_ERROR;
+    }
+
+    uint8_t Device_GetCount(void)
+    {
+        return device_count;
+    }
+
+    Device* Device_Get(uint8_t id)
+    {
+        return id < device_count ? &devices[id] : NULL;
+    }
+
+    ErrorCode Device_UpdateRegisterAll(uint8_t register_address, uint8_t mask, uint8_t value)
+    {
+        ErrorCode error = NO_ERROR;
+        for (uint8_t i = 0; i < device_count; i++)
+        {
+            Device* device = &devices[i];
+            if (I2C_Peripheral_UpdateRegister(device->address, register_address, mask, value) != NO_ERROR)
+            {
+                error = ERROR;
+                continue;
+            }
+            if (register_address == LIS3DH_CTRL_REG1)
+            {
+                device->ctrl_reg1 = (device->ctrl_reg1 & ~mask) | (value & mask);
+            }
+            else if (register_address == LIS3DH_CTRL_REG4)
+            {
+                device->ctrl_reg4 = (device->ctrl_reg4 & ~mask) | (value & mask);
+                device->um_s2_per_digit = scale_um_s2[(device->ctrl_reg4 & LIS3DH_CTRL_REG4_FS_MASK) >> LIS3DH_CTRL_REG4_FS_SHIFT];
+            }
+        }
+        return error;
+    }
+
+    ErrorCode Device_StartFifo(void)
+    {
+        // Stream mode: the FIFO keeps the last 32 samples, read in batches
+        ErrorCode error = Device_UpdateRegisterAll(LIS3DH_CTRL_REG5,
+                                                   LIS3DH_CTRL_REG5_FIFO_EN,
+                                                   LIS3DH_CTRL_REG5_FIFO_EN);
+        for (uint8_t i = 0; i < device_count; i++)
+        {
+            if (I2C_Peripheral_WriteRegister(devices[i].address,
+                                             LIS3DH_FIFO_CTRL_REG,
+                                             LIS3DH_FIFO_CTRL_REG_STREAM) != NO_ERROR)
+            {
+                error = ERROR;
+            }
+        }
+        return error;
+    }
+
+    uint8_t Device_ReadFifo(Device* device, uint8_t* data)
+    {
+        uint32_t start = PowerManager_ReadCycles();
+        uint8_t fifo_src;
+
+        //Read of the FIFO source register: number of samples waiting
+        uint8_t count = 0;
+        if (I2C_Peripheral_ReadRegister(device->address, LIS3DH_FIFO_SRC_REG, &fifo_src) == NO_ERROR)
+        {
+            count = fifo_src & LIS3DH_FIFO_SRC_REG_FSS_MASK;
+            if (fifo_src & LIS3DH_FIFO_SRC_REG_OVRN)
+            {
+                count = LIS3DH_FIFO_SIZE;
+                device->stats.overruns++;
+                Health_Count(HEALTH_FIFO_OVERFLOW, 1);
+            }
+        }
+        else
+        {
+            Health_Count(HEALTH_I2C_ERROR, 1);
+        }
+
+        //The Status register and the whole batch in one Multi-Read
+        if (count > 0)
+        {
+            if (I2C_Peripheral_ReadRegisterMulti(device->address, LIS3DH_STATUS_REG, 1 + 6 * count, data) == NO_ERROR)
+            {
+                device->stats.transfers++;
+                device->stats.bytes += 1 + 6 * count;
+                if (data[0] & LIS3DH_STATUS_REG_ZYXOR)
+                {
+                    Health_Count(HEALTH_SENSOR_OVERRUN, 1);
+                }
+            }
+            else
+            {
+                count = 0;
+                Health_Count(HEALTH_I2C_ERROR, 1);
+            }
+        }
+        device->fifo_level = count;
+        device->stats.cycles += PowerManager_ReadCycles() - start;
+        return count;
+    }
+
+    void Device_Convert(const Device* device, const uint8_t* data, int32_t acceleration[3])
+    {
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            int16_t out = (int16)(data[2 * axis] | (data[2 * axis + 1] << 8)) >> 4; //We have 12-bit of data
+            acceleration[axis] = ((int32_t)out * (int32_t)device->um_s2_per_digit) / 1000; //Integer conversion in mm/s^2
+        }
+    }
+
+    uint16_t Device_GetBusUtilization(const Device* device)
+    {
+        uint64_t elapsed = (uint64_t)(Timer_Tick - stats_start_tick) * POWER_CYCLES_PER_TICK;
+        return elapsed ? (uint16_t)((device->stats.cycles * 1000) / elapsed) : 0;
+    }
+
+    void Device_ResetStats(void)
+    {
+        for (uint8_t i = 0; i < device_count; i++)
+        {
+            devices[i].stats.transfers = 0;
+            devices[i].stats.bytes = 0;
+            devices[i].stats.cycles = 0;
+            devices[i].stats.overruns = 0;
+        }
+        stats_start_tick = Timer_Tick;
+    }
+
+/* [] END OF FILE */
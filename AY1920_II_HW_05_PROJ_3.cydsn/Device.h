@@ -0,0 +1,119 @@
+/**
+*   \file Device.h
+*   \brief Instances of the LIS3DH accelerometers on the I2C bus.
+*
+*   Each accelerometer is described by its address, its configuration kept
+*   in shadow registers, the scale of its samples and the state of its
+*   FIFO. Two LIS3DH share the bus with SA0 low (0x18) and high (0x19).
+*   Device 0 is the one at LIS3DH_DEVICE_ADDRESS: it feeds the whole
+*   processing chain, the other devices stream their raw samples. The time
+*   spent on the bus is measured for every device.
+*/
+
+#ifndef Device_H
+    #define Device_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+    #include "LIS3DH_Registers.h"
+
+    /**
+    *   \brief Maximum number of accelerometers
+    */
+    #define DEVICE_MAX 2
+
+    /**
+    *   \brief Bus statistics of a device
+    */
+    typedef struct {
+        uint32_t transfers;     ///< Batches read
+        uint32_t bytes;         ///< Bytes read in the batches
+        uint64_t cycles;        ///< CPU cycles spent in the bus transactions
+        uint32_t overruns;      ///< Batches read with a full FIFO (samples lost)
+    } Device_BusStats;
+
+    /**
+    *   \brief Accelerometer instance
+    */
+    typedef struct {
+        uint8_t id;                 ///< Index of the device, sent in the frames
+        uint8_t address;            ///< 7-bit I2C address
+        uint8_t ctrl_reg1;          ///< Shadow of the Control register 1 (ODR)
+        uint8_t ctrl_reg4;          ///< Shadow of the Control register 4 (full scale)
+        uint32_t um_s2_per_digit;   ///< Scale of the 12-bit samples [um/s^2/digit]
+        uint8_t fifo_level;         ///< Samples found in the FIFO at the last read
+        Device_BusStats stats;
+    } Device;
+
+    /**
+    *   \brief Register the device 0 and look for the others.
+    *
+    *   Device 0 must already be configured; every other LIS3DH found on
+    *   the bus gets the same configuration. The FIFO is started by
+    *   Device_StartFifo().
+    *   \retval Returns ERROR if device 0 does not answer.
+    */
+    ErrorCode Device_Init(void);
+
+    /**
+    *   \brief Number of devices found.
+    */
+    uint8_t Device_GetCount(void);
+
+    /**
+    *   \brief Device with the given index, NULL if not present.
+    */
+    Device* Device_Get(uint8_t id);
+
+    /**
+    *   \brief Change some bits of a register of every device.
+    *
+    *   The shadow registers are updated too, so the devices stay at the
+    *   same ODR and full scale.
+    */
+    ErrorCode Device_UpdateRegisterAll(uint8_t register_address, uint8_t mask, uint8_t value);
+
+    /**
+    *   \brief Enable the FIFO in Stream mode on every device.
+    */
+    ErrorCode Device_StartFifo(void);
+
+    /**
+    *   \brief Bytes of a FIFO batch: the Status register, then the samples
+    */
+    #define DEVICE_FIFO_BUFFER_SIZE (1 + 6 * LIS3DH_FIFO_SIZE)
+
+    /**
+    *   \brief Position of sample n in a FIFO batch
+    */
+    #define DEVICE_FIFO_SAMPLE(data, n) (&(data)[1 + 6 * (n)])
+
+    /**
+    *   \brief Read all the samples waiting in the FIFO of a device.
+    *
+    *   The Status register is read in the same transfer, one byte more: the
+    *   register address rolls back from OUT_Z_H to OUT_X_L while the FIFO is
+    *   read. Full FIFO, ZYXOR and bus errors are counted in Health.
+    *   \param device Device to be read.
+    *   \param data Buffer of DEVICE_FIFO_BUFFER_SIZE bytes.
+    *   \retval Number of samples read (0 on a bus error).
+    */
+    uint8_t Device_ReadFifo(Device* device, uint8_t* data);
+
+    /**
+    *   \brief Convert a raw 12-bit sample to [mm/s^2].
+    */
+    void Device_Convert(const Device* device, const uint8_t* data, int32_t acceleration[3]);
+
+    /**
+    *   \brief Bus utilization of a device since the last reset [per mille].
+    */
+    uint16_t Device_GetBusUtilization(const Device* device);
+
+    /**
+    *   \brief Reset the bus statistics of every device.
+    */
+    void Device_ResetStats(void);
+
+#endif // Device_H
+/* [] END OF FILE */
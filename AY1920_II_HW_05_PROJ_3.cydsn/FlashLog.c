@@ -0,0 +1,364 @@
+/*
+* This file includes the circular log of the compressed frames in flash.
+*/
+
+#include "FlashLog.h"
+#include "Frames.h"
+#include "Storage.h"
+#include "Health.h"
+#include "Acquisition.h"
+#include "project.h"
+
+/**
+*   \brief Steps of a row write
+*/
+typedef enum {
+    FLASHLOG_IDLE,          ///< No write in progress
+    FLASHLOG_LOADING,       ///< Row latch of the SPC being loaded
+    FLASHLOG_PROGRAMMING    ///< Row being erased and programmed
+} FlashLog_WriteState;
+
+/**
+*   \brief Flash region of the log, aligned to the flash rows.
+*
+*   Volatile: the compiler must not assume that it still holds the zeros
+*   of the image.
+*/
+static const volatile uint8_t log_flash[FLASHLOG_ROWS * FLASHLOG_ROW_SIZE]
+    CY_ALIGN(CY_FLASH_SIZEOF_ROW) = {0u};
+
+static uint8_t rows[2][FLASHLOG_ROW_SIZE];  // Row being filled and row being written
+static uint8_t fill = 0;                    // Index of the row being filled
+static uint8_t used = 0;                    // Bytes of records in it
+static uint16_t row_rate = 0;               // Rate at the start of the row being filled
+static uint16_t current_rate = 0;
+static uint8_t close_requested = 0;         // Close the row being filled at the next run
+static uint8_t write_pending = 0;           // The other row waits to be written
+static FlashLog_WriteState write_state = FLASHLOG_IDLE;
+static uint16_t head = 0;                   // Row written next
+static uint32_t next_sequence = 0;
+static uint32_t first_sequence = 0;         // First row after the last erase
+static uint16_t row_count = 0;
+static uint8_t recording = 0;
+static uint8_t dumping = 0;
+static uint8_t dump_header_sent = 0;
+static uint16_t dump_row = 0;               // Row being sent
+static uint16_t dump_index = 0;             // Its position in the dump
+static uint16_t dump_offset = 0;            // Bytes of the row already sent
+
+    static uint32_t FlashLog_ReadUint32(const volatile uint8_t* data)
+    {
+        return data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    }
+
+    static uint16_t FlashLog_Checksum(const uint8_t* data, uint16_t length)
+    {
+        uint16_t sum1 = 0;
+        uint16_t sum2 = 0;
+        for (uint16_t n = 0; n < length; n++)
+        {
+            sum1 = (sum1 + data[n]) % 255;
+            sum2 = (sum2 + sum1) % 255;
+        }
+        return (uint16_t)((sum2 << 8) | sum1);
+    }
+
+    void FlashLog_Init(void)
+    {
+        uint8_t saved[STORAGE_FLASHLOG_SIZE];
+        first_sequence = Storage_Read(STORAGE_FLASHLOG_ADDRESS, saved, sizeof(saved)) == NO_ERROR ?
+                         FlashLog_ReadUint32(saved) : 0;
+
+        // The newest row has the highest sequence number
+        uint8_t found = 0;
+        uint32_t newest = 0;
+        for (uint16_t row = 0; row < FLASHLOG_ROWS; row++)
+        {
+            const volatile uint8_t* header = &log_flash[row * FLASHLOG_ROW_SIZE];
+            uint32_t sequence = FlashLog_ReadUint32(&header[4]);
+            if (header[0] == FLASHLOG_MAGIC && header[1] <= FLASHLOG_ROW_CAPACITY &&
+                (!found || sequence > newest))
+            {
+                found = 1;
+                newest = sequence;
+                head = (row + 1) % FLASHLOG_ROWS;
+            }
+        }
+        next_sequence = (found && newest + 1 > first_sequence) ? newest + 1 : first_sequence;
+        row_count = next_sequence - first_sequence < FLASHLOG_ROWS ?
+                    (uint16_t)(next_sequence - first_sequence) : FLASHLOG_ROWS;
+    }
+
+    ErrorCode FlashLog_Start(void)
+    {
+        if (dumping || write_state != FLASHLOG_IDLE || CySetTemp() != CYRET_SUCCESS)
+        {
+            return ERROR;
+        }
+        recording = 1;
+        return NO_ERROR;
+    }
+
+    void FlashLog_Stop(void)
+    {
+        recording = 0;
+    }
+
+    uint8_t FlashLog_IsRecording(void)
+    {
+        return recording;
+    }
+
+    /**
+    *   \brief Complete the header of the row being filled and queue it.
+    */
+    static void FlashLog_CloseRow(void)
+    {
+        uint8_t* row = rows[fill];
+        row[0] = FLASHLOG_MAGIC;
+        row[1] = used;
+        uint8_t* position = Frames_PutUint32(&row[4], next_sequence++);
+        Frames_PutUint16(position, row_rate);
+        Frames_PutUint16(&row[2], FlashLog_Checksum(&row[4], FLASHLOG_HEADER_SIZE - 4 + used));
+        for (uint16_t n = FLASHLOG_HEADER_SIZE + used; n < FLASHLOG_ROW_SIZE; n++)
+        {
+            row[n] = 0;
+        }
+        fill ^= 1;
+        used = 0;
+        close_requested = 0;
+        write_pending = 1;
+    }
+
+    ErrorCode FlashLog_Add(uint32_t tick, const uint8_t* payload)
+    {
+        uint8_t length = payload[0];
+        if (!recording)
+        {
+            return ERROR;
+        }
+        if (used + 4 + length > FLASHLOG_ROW_CAPACITY)
+        {
+            if (write_pending)
+            {
+                Health_Count(HEALTH_LOG_DROP, 1);
+                return ERROR;
+            }
+            FlashLog_CloseRow();
+        }
+        if (used == 0)
+        {
+            row_rate = current_rate;
+        }
+        uint8_t* position = Frames_PutUint32(&rows[fill][FLASHLOG_HEADER_SIZE + used], tick);
+        for (uint8_t n = 0; n < length; n++)
+        {
+            position[n] = payload[n];
+        }
+        used += 4 + length;
+        return NO_ERROR;
+    }
+
+    void FlashLog_SetRate(uint16_t rate)
+    {
+        current_rate = rate;
+        if (used > 0)
+        {
+            close_requested = 1;
+        }
+    }
+
+    uint16_t FlashLog_GetRowCount(void)
+    {
+        return row_count;
+    }
+
+    ErrorCode FlashLog_StartDump(void)
+    {
+        if (recording || dumping || write_pending || used > 0)
+        {
+            return ERROR;
+        }
+        if (row_count > 0)
+        {
+            dump_row = (head + FLASHLOG_ROWS - row_count) % FLASHLOG_ROWS;
+            dump_index = 0;
+            dump_offset = 0;
+            dump_header_sent = 0;
+            dumping = 1;
+        }
+        return NO_ERROR;
+    }
+
+    uint8_t FlashLog_IsDumping(void)
+    {
+        return dumping;
+    }
+
+    ErrorCode FlashLog_Erase(void)
+    {
+        uint8_t saved[STORAGE_FLASHLOG_SIZE];
+        if (recording || dumping || write_pending || used > 0)
+        {
+            return ERROR;
+        }
+        Frames_PutUint32(saved, next_sequence);
+        if (Storage_Write(STORAGE_FLASHLOG_ADDRESS, saved, sizeof(saved)) != NO_ERROR)
+        {
+            return ERROR;
+        }
+        first_sequence = next_sequence;
+        row_count = 0;
+        return NO_ERROR;
+    }
+
+    /**
+    *   \brief Release the SPC and move to the next row.
+    */
+    static void FlashLog_EndWrite(ErrorCode error)
+    {
+        CySpcUnlock();
+        CyFlushCache();
+        if (error != NO_ERROR)
+        {
+            // The row keeps its place: the host rejects it by the checksum
+            Health_Count(HEALTH_LOG_DROP, 1);
+        }
+        head = (head + 1) % FLASHLOG_ROWS;
+        if (row_count < FLASHLOG_ROWS)
+        {
+            row_count++;
+        }
+        write_pending = 0;
+        write_state = FLASHLOG_IDLE;
+    }
+
+    /**
+    *   \brief Do the next step of the row write; the SPC works between the runs.
+    */
+    static void FlashLog_WriteStep(void)
+    {
+        uint32_t address = (uint32_t)(uintptr_t)&log_flash[head * FLASHLOG_ROW_SIZE];
+        uint8_t array = (uint8_t)(address / CY_FLASH_SIZEOF_ARRAY);
+        uint16_t row = (uint16_t)((address % CY_FLASH_SIZEOF_ARRAY) / CY_FLASH_SIZEOF_ROW);
+
+        switch (write_state)
+        {
+            case FLASHLOG_IDLE:
+                // The emulated EEPROM may be using the SPC: try at the next run
+                if (CySpcLock() != CYRET_SUCCESS)
+                {
+                    return;
+                }
+                if (CySpcLoadRowFull(array, row, rows[fill ^ 1], CYDEV_FLS_ROW_SIZE) != CYRET_STARTED)
+                {
+                    CySpcUnlock();
+                    return;
+                }
+                write_state = FLASHLOG_LOADING;
+                break;
+
+            case FLASHLOG_LOADING:
+                if (CY_SPC_BUSY)
+                {
+                    return;
+                }
+                if (CY_SPC_READ_STATUS == CY_SPC_STATUS_SUCCESS &&
+                    CySpcWriteRow(array, row, dieTemperature[0], dieTemperature[1]) == CYRET_STARTED)
+                {
+                    write_state = FLASHLOG_PROGRAMMING;
+                }
+                else
+                {
+                    FlashLog_EndWrite(ERROR);
+                }
+                break;
+
+            case FLASHLOG_PROGRAMMING:
+                if (CY_SPC_BUSY)
+                {
+                    return;
+                }
+                FlashLog_EndWrite(CY_SPC_READ_STATUS == CY_SPC_STATUS_SUCCESS ? NO_ERROR : ERROR);
+                break;
+        }
+    }
+
+    /**
+    *   \brief Send the next part of the dump.
+    *
+    *   The bytes that the UART takes before the next acquisition are
+    *   written (Acquisition_GetTxAllowance()), waiting for the UART: the
+    *   dump runs close to the line rate without delaying a sample.
+    */
+    static void FlashLog_DumpStep(void)
+    {
+        uint32_t allowance = Acquisition_GetTxAllowance();
+
+        if (!dump_header_sent)
+        {
+            uint8_t header[4];
+            if (allowance < sizeof(header) + 1 || Frames_Begin(FRAME_HEADER_LOG_ROW) != NO_ERROR)
+            {
+                return;
+            }
+            // The row is copied, since the frames take plain pointers
+            const volatile uint8_t* source = &log_flash[dump_row * FLASHLOG_ROW_SIZE];
+            for (uint16_t n = 0; n < FLASHLOG_ROW_SIZE; n++)
+            {
+                rows[0][n] = source[n];
+            }
+            uint8_t* position = Frames_PutUint16(header, dump_index);
+            Frames_PutUint16(position, row_count);
+            Frames_Write(header, sizeof(header));
+            allowance -= sizeof(header) + 1;
+            dump_header_sent = 1;
+        }
+
+        while (dump_offset < FLASHLOG_ROW_SIZE && allowance > 0)
+        {
+            uint16_t chunk = FLASHLOG_ROW_SIZE - dump_offset;
+            if (chunk > 128)
+            {
+                chunk = 128;
+            }
+            if (chunk > allowance)
+            {
+                chunk = (uint16_t)allowance;
+            }
+            Frames_Write(&rows[0][dump_offset], (uint8_t)chunk);
+            dump_offset += chunk;
+            allowance -= chunk;
+        }
+
+        if (dump_offset == FLASHLOG_ROW_SIZE && allowance > 0)
+        {
+            Frames_End();
+            dump_header_sent = 0;
+            dump_offset = 0;
+            dump_row = (dump_row + 1) % FLASHLOG_ROWS;
+            if (++dump_index == row_count)
+            {
+                dumping = 0;
+            }
+        }
+    }
+
+    void FlashLog_Task(void)
+    {
+        if (write_pending)
+        {
+            FlashLog_WriteStep();
+        }
+        else if (used > 0 && (!recording || close_requested))
+        {
+            // Last row after a stop, or first row at a new rate
+            FlashLog_CloseRow();
+        }
+        else if (dumping)
+        {
+            FlashLog_DumpStep();
+        }
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,138 @@
+/**
+*   \file FlashLog.h
+*   \brief Circular log of the compressed sample frames in flash.
+*
+*   When no host is attached, the compressed frames (see Compress.h) can be
+*   recorded in a flash region reserved for the log and dumped later. The
+*   frames are collected in a row buffer in RAM; a full row is programmed
+*   by the SPC while the CPU keeps running, one step per run of the log
+*   task, and the next row is filled in a second buffer meanwhile. The rows
+*   are written in turn, oldest first, so every row is erased once per lap
+*   of the log; after a reset the recording resumes after the newest row.
+*
+*   Row (little endian):
+*
+*   - magic FLASHLOG_MAGIC (uint8), bytes of records U (uint8), Fletcher-16
+*     of the bytes from the sequence number to the last record (uint16);
+*   - sequence number of the row (uint32), output data rate [Hz] at the
+*     start of the row (uint16);
+*   - U bytes of records: Timer tick at the end of the frame (uint32), then
+*     the payload of the compressed frame, whose first byte is its length.
+*
+*   The rows numbered before the last erase are ignored; the number is kept
+*   in the emulated EEPROM (see Storage.h).
+*/
+
+#ifndef FlashLog_H
+    #define FlashLog_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Rows of the log: 160 kB, about 5 minutes at 100 Hz
+    */
+    #define FLASHLOG_ROWS 640
+
+    /**
+    *   \brief Size of a row [bytes], CY_FLASH_SIZEOF_ROW
+    */
+    #define FLASHLOG_ROW_SIZE 256
+
+    /**
+    *   \brief Header of a row and bytes left for the records
+    */
+    #define FLASHLOG_HEADER_SIZE 10
+    #define FLASHLOG_ROW_CAPACITY (FLASHLOG_ROW_SIZE - FLASHLOG_HEADER_SIZE)
+
+    /**
+    *   \brief First byte of a written row
+    */
+    #define FLASHLOG_MAGIC 0x4C
+
+    /**
+    *   \brief Period of the log task in Timer ticks (10 ms)
+    */
+    #define FLASHLOG_TASK_PERIOD 1
+
+    /**
+    *   \brief Find the newest row and the first row after the last erase.
+    *
+    *   Storage_Init() must be called before.
+    */
+    void FlashLog_Init(void);
+
+    /**
+    *   \brief Start recording the compressed frames.
+    *
+    *   The die temperature used by the flash writes is measured here.
+    *   \retval Returns ERROR during a dump or if the SPC is not available.
+    */
+    ErrorCode FlashLog_Start(void);
+
+    /**
+    *   \brief Stop recording; the row being filled is written by the task.
+    */
+    void FlashLog_Stop(void);
+
+    /**
+    *   \brief Return 1 while recording.
+    */
+    uint8_t FlashLog_IsRecording(void);
+
+    /**
+    *   \brief Add a compressed frame to the log.
+    *
+    *   The frame is dropped if the row is full and the previous one is
+    *   still being written: restart the compression with a keyframe.
+    *   \param tick Timer tick of the last sample of the frame.
+    *   \param payload Payload of the compressed frame.
+    *   \retval Returns ERROR if the frame was dropped.
+    */
+    ErrorCode FlashLog_Add(uint32_t tick, const uint8_t* payload);
+
+    /**
+    *   \brief Close the row being filled, so that the rate of the next row
+    *   is \p rate. Call it when the output data rate changes.
+    */
+    void FlashLog_SetRate(uint16_t rate);
+
+    /**
+    *   \brief Number of rows in the log, oldest to newest.
+    */
+    uint16_t FlashLog_GetRowCount(void);
+
+    /**
+    *   \brief Send every row of the log as log row frames, oldest first.
+    *
+    *   The rows are sent by the log task, at the UART rate.
+    *   \retval Returns ERROR while recording, writing or dumping.
+    */
+    ErrorCode FlashLog_StartDump(void);
+
+    /**
+    *   \brief Return 1 while the rows are being sent.
+    */
+    uint8_t FlashLog_IsDumping(void);
+
+    /**
+    *   \brief Empty the log.
+    *
+    *   The rows are not erased: the sequence number of the next row is
+    *   saved as the start of the log.
+    *   \retval Returns ERROR while recording, writing or dumping, or if the
+    *   emulated EEPROM cannot be written.
+    */
+    ErrorCode FlashLog_Erase(void);
+
+    /**
+    *   \brief Log task.
+    *
+    *   This function does the next step of the row write (load the row
+    *   latch, program the row, release the SPC), writes the last row after
+    *   a stop, and sends the next part of a dump.
+    */
+    void FlashLog_Task(void);
+
+#endif // FlashLog_H
+/* [] END OF FILE */
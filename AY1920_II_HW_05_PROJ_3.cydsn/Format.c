@@ -0,0 +1,180 @@
+/*
+* This file includes the minimal text formatter. It does not depend on the
+* PSoC generated code, so it can be compiled on a host PC too.
+*/
+
+#include <stdarg.h>
+#include "Format.h"
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+    char* Format_PutUint(char* position, uint32_t value)
+    {
+        // Digits from the least significant, then reversed in place
+        char* start = position;
+        do
+        {
+            *position++ = (char)('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        for (char* low = start, *high = position - 1; low < high; low++, high--)
+        {
+            char digit = *low;
+            *low = *high;
+            *high = digit;
+        }
+        return position;
+    }
+
+    char* Format_PutInt(char* position, int32_t value)
+    {
+        if (value < 0)
+        {
+            *position++ = '-';
+            return Format_PutUint(position, 0u - (uint32_t)value);
+        }
+        return Format_PutUint(position, (uint32_t)value);
+    }
+
+    char* Format_PutHex(char* position, uint32_t value, uint8_t digits)
+    {
+        for (int8_t shift = 4 * (digits - 1); shift >= 0; shift -= 4)
+        {
+            *position++ = hex_digits[(value >> shift) & 0xF];
+        }
+        return position;
+    }
+
+    char* Format_PutFixed(char* position, int32_t value, uint8_t decimals)
+    {
+        uint32_t scale = 1;
+        for (uint8_t d = 0; d < decimals; d++)
+        {
+            scale *= 10;
+        }
+        uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+        if (value < 0)
+        {
+            *position++ = '-';
+        }
+        position = Format_PutUint(position, magnitude / scale);
+        if (decimals > 0)
+        {
+            // Fraction with its leading zeros
+            *position++ = '.';
+            uint32_t fraction = magnitude % scale;
+            for (uint32_t digit = scale / 10; digit > 0; digit /= 10)
+            {
+                *position++ = (char)('0' + (fraction / digit) % 10);
+            }
+        }
+        return position;
+    }
+
+    uint16_t Format_Text(char* buffer, uint16_t size, const char* format, ...)
+    {
+        if (size == 0)
+        {
+            return 0;
+        }
+        va_list arguments;
+        va_start(arguments, format);
+        uint16_t length = 0;
+        for (; *format != '\0'; format++)
+        {
+            char field[12];     // Longest conversion: 10 digits and a sign
+            const char* text = field;
+            char* end = field;
+            char pad = ' ';
+            uint8_t width = 0;
+            uint8_t is_long = 0;
+
+            if (*format != '%')
+            {
+                field[0] = *format;
+                end = field + 1;
+            }
+            else
+            {
+                format++;
+                if (*format == '0')
+                {
+                    pad = '0';
+                    format++;
+                }
+                while (*format >= '0' && *format <= '9')
+                {
+                    width = (uint8_t)(10 * width + (*format++ - '0'));
+                }
+                if (*format == 'l')
+                {
+                    is_long = 1;
+                    format++;
+                }
+                switch (*format)
+                {
+                    case 'd':
+                        end = Format_PutInt(field, is_long ? (int32_t)va_arg(arguments, long) :
+                                                             (int32_t)va_arg(arguments, int));
+                        break;
+                    case 'u':
+                        end = Format_PutUint(field, is_long ? (uint32_t)va_arg(arguments, unsigned long) :
+                                                              (uint32_t)va_arg(arguments, unsigned int));
+                        break;
+                    case 'x':
+                    case 'X':
+                    {
+                        uint32_t value = is_long ? (uint32_t)va_arg(arguments, unsigned long) :
+                                                   (uint32_t)va_arg(arguments, unsigned int);
+                        uint8_t digits = 1;
+                        while (digits < 8 && (value >> (4 * digits)) != 0)
+                        {
+                            digits++;
+                        }
+                        end = Format_PutHex(field, value, digits);
+                        if (*format == 'x')
+                        {
+                            for (char* c = field; c < end; c++)
+                            {
+                                *c = (*c >= 'A') ? (char)(*c - 'A' + 'a') : *c;
+                            }
+                        }
+                        break;
+                    }
+                    case 'c':
+                        field[0] = (char)va_arg(arguments, int);
+                        end = field + 1;
+                        break;
+                    case 's':
+                        text = va_arg(arguments, const char*);
+                        for (end = (char*)text; *end != '\0'; end++)
+                        {
+                        }
+                        break;
+                    case '\0':
+                        format--;   // Stop at the end of the format
+                        break;
+                    default:
+                        field[0] = *format;     // %% and unknown conversions
+                        end = field + 1;
+                        break;
+                }
+            }
+
+            // Padding on the left up to the width, then the field
+            uint16_t field_length = (uint16_t)(end - text);
+            for (; width > field_length && length + 1 < size; width--)
+            {
+                buffer[length++] = pad;
+            }
+            for (const char* c = text; c < end && length + 1 < size; c++)
+            {
+                buffer[length++] = *c;
+            }
+        }
+        va_end(arguments);
+        buffer[length] = '\0';
+        return length;
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,53 @@
+/**
+*   \file Format.h
+*   \brief Minimal text formatter, in place of sprintf.
+*
+*   The Put functions write a number at a position and return the position
+*   after it, like Frames_PutUint32(), so that a line is built in one pass
+*   and sent with Frames_SendText().
+*   Format_Text() covers the conversions used by the diagnostics: %d %u %x
+*   %X %c %s %%, with the 'l' length, the '0' flag and a width. It never
+*   writes more than the size of the buffer.
+*
+*   The code does not include any PSoC header, so it can be compiled on a
+*   host PC too.
+*/
+
+#ifndef Format_H
+    #define Format_H
+
+    #include <stdint.h>
+
+    /**
+    *   \brief Write an unsigned decimal number.
+    */
+    char* Format_PutUint(char* position, uint32_t value);
+
+    /**
+    *   \brief Write a signed decimal number.
+    */
+    char* Format_PutInt(char* position, int32_t value);
+
+    /**
+    *   \brief Write an upper case hexadecimal number of digits digits.
+    */
+    char* Format_PutHex(char* position, uint32_t value, uint8_t digits);
+
+    /**
+    *   \brief Write a fixed-point number: value / 10^decimals.
+    *
+    *   e.g. 9806 with 3 decimals is written as 9.806.
+    */
+    char* Format_PutFixed(char* position, int32_t value, uint8_t decimals);
+
+    /**
+    *   \brief Format a string, as snprintf() with a subset of conversions.
+    *
+    *   \param buffer Output, always terminated.
+    *   \param size Bytes of the buffer.
+    *   \retval Characters written, without the terminator.
+    */
+    uint16_t Format_Text(char* buffer, uint16_t size, const char* format, ...);
+
+#endif // Format_H
+/* [] END OF FILE */
@@ -0,0 +1,165 @@
+/*
+* This file includes the functions to build and send the frames.
+*
+* The payloads are packed in local buffers and copied with PutArray: there
+* is no ring to build them in, as UART_Debug has no software TX buffer
+* (only its 4-byte hardware FIFO, the TX interrupt is not configured) and
+* the buffer size cannot be changed without the schematic. The copy of a
+* 10-byte sample payload takes a few microseconds; the writes wait about
+* 521 us per byte beyond the FIFO at 19200 baud.
+*/
+
+#include "Frames.h"
+#include "Health.h"
+#include "project.h"
+
+static uint8_t long_frame_open = 0;
+static uint8_t long_frame_text = 0;     // The open long frame is text: no tail
+static uint8_t deferred[FRAMES_DEFERRED_SIZE];
+static uint8_t deferred_length = 0;
+
+    /**
+    *   \brief Count a stall if size bytes do not fit in the free TX room.
+    */
+    static void Frames_CountStall(uint16_t size)
+    {
+        // The writes wait when the bytes do not fit in the free room
+        if (Frames_GetTxFree() < size)
+        {
+            Health_Count(HEALTH_TX_STALL, 1);
+        }
+    }
+
+    ErrorCode Frames_Send(uint8_t header, const uint8_t* payload, uint8_t length)
+    {
+        if (long_frame_open)
+        {
+            // Keep the frame aside until the long frame is closed
+            if (deferred_length + length + 2 > FRAMES_DEFERRED_SIZE)
+            {
+                Health_Count(HEALTH_TX_DROP, 1);
+                return ERROR;
+            }
+            deferred[deferred_length++] = header;
+            for (uint8_t i = 0; i < length; i++)
+            {
+                deferred[deferred_length++] = payload[i];
+            }
+            deferred[deferred_length++] = FRAME_TAIL;
+            return NO_ERROR;
+        }
+
+        Frames_CountStall(length + 2u);
+        UART_Debug_PutChar(header);
+        UART_Debug_PutArray(payload, length);
+        UART_Debug_PutChar(FRAME_TAIL);
+        return NO_ERROR;
+    }
+
+    ErrorCode Frames_SendText(const char* text, uint8_t length)
+    {
+        if (long_frame_open)
+        {
+            // Text inside a binary frame would corrupt it
+            Health_Count(HEALTH_TX_DROP, 1);
+            return ERROR;
+        }
+        Frames_CountStall(length);
+        UART_Debug_PutArray((const uint8_t*)text, length);
+        return NO_ERROR;
+    }
+
+    ErrorCode Frames_Begin(uint8_t header)
+    {
+        if (long_frame_open)
+        {
+            return ERROR;
+        }
+        long_frame_open = 1;
+        long_frame_text = 0;
+        UART_Debug_PutChar(header);
+        return NO_ERROR;
+    }
+
+    ErrorCode Frames_BeginText(void)
+    {
+        if (long_frame_open)
+        {
+            return ERROR;
+        }
+        long_frame_open = 1;
+        long_frame_text = 1;
+        return NO_ERROR;
+    }
+
+    void Frames_Write(const uint8_t* data, uint8_t length)
+    {
+        UART_Debug_PutArray(data, length);
+    }
+
+    void Frames_End(void)
+    {
+        if (!long_frame_text)
+        {
+            UART_Debug_PutChar(FRAME_TAIL);
+        }
+        long_frame_open = 0;
+        if (deferred_length)
+        {
+            UART_Debug_PutArray(deferred, deferred_length);
+            deferred_length = 0;
+        }
+    }
+
+    uint8_t Frames_IsLongFrameOpen(void)
+    {
+        return long_frame_open;
+    }
+
+    uint16_t Frames_GetTxFree(void)
+    {
+    #if (UART_Debug_TX_BUFFER_SIZE > UART_Debug_FIFO_LENGTH)
+        // GetTxBufferSize returns the number of bytes waiting to be sent
+        return UART_Debug_TX_BUFFER_SIZE - UART_Debug_GetTxBufferSize();
+    #else
+        // Hardware FIFO only: all of it is free when empty, at least one
+        // byte when not full
+        uint8_t status = UART_Debug_ReadTxStatus();
+        return (status & UART_Debug_TX_STS_FIFO_EMPTY) ? UART_Debug_FIFO_LENGTH :
+               (status & UART_Debug_TX_STS_FIFO_NOT_FULL) ? 1u : 0u;
+    #endif
+    }
+
+    uint16_t Frames_GetTxPending(void)
+    {
+    #if (UART_Debug_TX_BUFFER_SIZE > UART_Debug_FIFO_LENGTH)
+        return UART_Debug_GetTxBufferSize();
+    #else
+        return 0;
+    #endif
+    }
+
+    uint16_t Frames_GetLinkRate(void)
+    {
+        uint32_t divider = (uint32_t)UART_Debug_IntClock_GetDividerRegister() + 1u;
+        // 8 clocks per bit, 10 bits per byte
+        return (uint16_t)(BCLK__BUS_CLK__HZ / divider / 80u);
+    }
+
+    uint8_t* Frames_PutUint16(uint8_t* buffer, uint16_t value)
+    {
+        buffer[0] = (uint8_t)(value & 0xFF);
+        buffer[1] = (uint8_t)(value >> 8);
+        return buffer + 2;
+    }
+
+    uint8_t* Frames_PutUint32(uint8_t* buffer, uint32_t value)
+    {
+        buffer[0] = (uint8_t)(value & 0xFF);
+        buffer[1] = (uint8_t)(value >> 8);
+        buffer[2] = (uint8_t)(value >> 16);
+        buffer[3] = (uint8_t)(value >> 24);
+        return buffer + 4;
+    }
+
+/* [] END OF FILE */
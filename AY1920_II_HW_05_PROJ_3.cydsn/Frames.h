@@ -0,0 +1,189 @@
+/**
+*   \file Frames.h
+*   \brief Frames sent to the host over UART.
+*
+*   Every frame starts with a header byte that identifies its type and ends
+*   with the tail byte 0xC0. The sample frame (header 0xA0) is the one
+*   plotted by the Bridge Control Panel; the other types are for the host
+*   tools. Multi-byte fields are little endian. The frames of fixed layout
+*   are generated from Host_Tools/packets.json, see Packets.h; those of
+*   variable length are described here.
+*/
+
+#ifndef Frames_H
+    #define Frames_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+    #include "Packets.h"
+
+    /**
+    *   \brief Header of the burst frame of the capture mode.
+    *
+    *   Payload: index of the trigger sample (uint32), pre-trigger samples
+    *   (uint16), post-trigger samples (uint16), trigger source (uint8, bit 0-2
+    *   X/Y/Z threshold, bit 3 magnitude), triggers missed during the previous
+    *   dump (uint16), then pre + post samples X, Y, Z in [mm/s^2] as int32.
+    */
+    #define FRAME_HEADER_BURST 0xA2
+
+    /**
+    *   \brief Header of the spectrum frame.
+    *
+    *   Payload: index of the first sample of the block (uint32), points of
+    *   the block N (uint16), exponent e (int8), number of bands B (uint8),
+    *   B + 1 band edges in bins (uint16), B band energies (uint32). The
+    *   energy of a band is the sum of |X[k]|^2 of its bins, with X the DFT
+    *   of the Hann windowed, mean removed samples divided by N and scaled
+    *   by 2^e: divide by 4^e to get [(mm/s^2)^2]. Bin k is at k * rate / N.
+    */
+    #define FRAME_HEADER_SPECTRUM 0xA4
+
+    /**
+    *   \brief Header of the timestamp frame, sent before the sample frames of
+    *   a batch of device 0 every ACQUISITION_TIMESTAMP_PERIOD ticks.
+    *
+    *   Payload: samples n since the previous timestamp frame, those of the
+    *   batch included (uint8), time since the previous timestamp frame [us]
+    *   (uint16). If that field is FRAME_TIMESTAMP_ABSOLUTE, the timestamp
+    *   [us] follows (uint32): the first frame and those after a gap are
+    *   absolute. The timestamp t is the start of the FIFO read of the batch;
+    *   of the n samples, from the first one sent after the previous
+    *   timestamp frame to the last one of the batch, sample i is at about
+    *   t - (n - 1 - i) / rate.
+    */
+    #define FRAME_HEADER_TIMESTAMP 0xAB
+    #define FRAME_TIMESTAMP_ABSOLUTE 0xFFFF
+
+    /**
+    *   \brief Header of the health frame, sent every ACQUISITION_HEALTH_PERIOD
+    *   ticks.
+    *
+    *   Payload: Timer tick (uint32), samples acquired (uint32), number of
+    *   counters C (uint8), then C loss counters (uint32) in the order of
+    *   Health_Counter. The counters are cumulative since start-up: a lost
+    *   frame loses no event.
+    */
+    #define FRAME_HEADER_HEALTH 0xAD
+
+    /**
+    *   \brief Header of the compressed sample frame.
+    *
+    *   Payload: COMPRESS_FRAME_SAMPLES samples of device 0 as the sample
+    *   frame, coded as described in Compress.h; the first byte is the
+    *   length of the payload.
+    */
+    #define FRAME_HEADER_COMPRESSED 0xAE
+
+    /**
+    *   \brief Header of the log row frame, sent by a dump of the flash log.
+    *
+    *   Payload: position of the row in the dump (uint16), rows of the dump
+    *   (uint16), then the FLASHLOG_ROW_SIZE bytes of the row as described
+    *   in FlashLog.h, oldest row first.
+    */
+    #define FRAME_HEADER_LOG_ROW 0xAF
+
+    /**
+    *   \brief Tail of every frame
+    */
+    #define FRAME_TAIL 0xC0
+
+    /**
+    *   \brief Size of the buffer of the frames sent while a long frame is open
+    */
+    #define FRAMES_DEFERRED_SIZE 64
+
+    /**
+    *   \brief Send a frame over UART.
+    *
+    *   If a long frame is open (see Frames_Begin()), the frame is kept aside
+    *   and sent right after the long frame ends.
+    *   \param header Header byte identifying the frame type.
+    *   \param payload Bytes between the header and the tail.
+    *   \param length Number of bytes of the payload.
+    *   \retval Returns ERROR if the frame was dropped.
+    */
+    ErrorCode Frames_Send(uint8_t header, const uint8_t* payload, uint8_t length);
+
+    /**
+    *   \brief Send a line of text over UART.
+    *
+    *   Text inside a long frame would corrupt it, so the line is dropped
+    *   while a long frame is open.
+    *   \param text Characters of the line (no terminator needed).
+    *   \param length Number of characters.
+    *   \retval Returns ERROR if the line was dropped.
+    */
+    ErrorCode Frames_SendText(const char* text, uint8_t length);
+
+    /**
+    *   \brief Open a long frame, written in pieces by Frames_Write().
+    *
+    *   A long frame can span several task runs, so that it never blocks on
+    *   a full UART buffer. Only one long frame can be open at a time.
+    */
+    ErrorCode Frames_Begin(uint8_t header);
+
+    /**
+    *   \brief Open a long text reply, written in pieces by Frames_Write().
+    *
+    *   As a long frame without header and tail: the frames sent meanwhile
+    *   are kept aside, so that they do not split the text, and follow it at
+    *   Frames_End().
+    */
+    ErrorCode Frames_BeginText(void);
+
+    /**
+    *   \brief Append bytes to the open long frame.
+    */
+    void Frames_Write(const uint8_t* data, uint8_t length);
+
+    /**
+    *   \brief Close the open long frame and send the frames kept aside.
+    */
+    void Frames_End(void);
+
+    /**
+    *   \brief Return 1 while a long frame is open.
+    */
+    uint8_t Frames_IsLongFrameOpen(void);
+
+    /**
+    *   \brief Number of bytes that can be sent without waiting.
+    *
+    *   Without a software TX buffer, the room in the hardware FIFO: all of
+    *   it when empty, 1 byte when not full (the status tells no more).
+    */
+    uint16_t Frames_GetTxFree(void);
+
+    /**
+    *   \brief Number of bytes waiting in the software TX buffer.
+    *
+    *   Without a software TX buffer, 0 is returned: the hardware FIFO holds
+    *   only a few bytes.
+    */
+    uint16_t Frames_GetTxPending(void);
+
+    /**
+    *   \brief Bytes per second the UART link carries.
+    *
+    *   Derived from the bus clock and the divider of the UART clock (8x
+    *   oversampling, 10 bits per byte): 1920 at 19200 baud.
+    */
+    uint16_t Frames_GetLinkRate(void);
+
+    /**
+    *   \brief Write a 16-bit value in little endian order.
+    *   \retval Returns the position after the written bytes.
+    */
+    uint8_t* Frames_PutUint16(uint8_t* buffer, uint16_t value);
+
+    /**
+    *   \brief Write a 32-bit value in little endian order.
+    *   \retval Returns the position after the written bytes.
+    */
+    uint8_t* Frames_PutUint32(uint8_t* buffer, uint32_t value);
+
+#endif // Frames_H
+/* [] END OF FILE */
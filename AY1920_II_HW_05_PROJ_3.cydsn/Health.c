@@ -0,0 +1,34 @@
+/*
+* This file includes the loss counters of the acquisition pipeline. It does
+* not depend on the PSoC generated code, so it can be compiled on a host PC
+* too.
+*/
+
+#include "Health.h"
+
+static uint32_t counters[HEALTH_COUNTERS];
+
+static const char* const names[HEALTH_COUNTERS] = {
+    "sensor overrun", "FIFO overflow", "empty poll", "skipped tick",
+    "I2C error", "queue reject", "TX stall", "TX drop", "log drop"
+};
+
+    void Health_Count(Health_Counter counter, uint32_t events)
+    {
+        if (counter < HEALTH_COUNTERS)
+        {
+            counters[counter] += events;
+        }
+    }
+
+    uint32_t Health_Get(Health_Counter counter)
+    {
+        return counter < HEALTH_COUNTERS ? counters[counter] : 0;
+    }
+
+    const char* Health_GetName(Health_Counter counter)
+    {
+        return counter < HEALTH_COUNTERS ? names[counter] : "";
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,51 @@
+/**
+*   \file Health.h
+*   \brief Loss accounting of the acquisition pipeline.
+*
+*   Every place where a sample or a frame can be lost, or delayed enough to
+*   be at risk, increments one counter. The counters are cumulative since
+*   start-up and sent in the health frame, so a configuration is proven
+*   loss-free at a given ODR when they do not change over a long run.
+*
+*   The code does not include any PSoC header, so it can be compiled on a
+*   host PC too.
+*/
+
+#ifndef Health_H
+    #define Health_H
+
+    #include <stdint.h>
+
+    /**
+    *   \brief Loss counters, in the order of the health frame
+    */
+    typedef enum {
+        HEALTH_SENSOR_OVERRUN,  ///< Batches read with ZYXOR set in the STATUS_REG
+        HEALTH_FIFO_OVERFLOW,   ///< Batches read with a full FIFO (samples overwritten)
+        HEALTH_EMPTY_POLL,      ///< Acquisition periods without a sample after the retries
+        HEALTH_SKIPPED_TICK,    ///< Releases of the acquisition task lost by the scheduler
+        HEALTH_I2C_ERROR,       ///< Failed sample reads and queued transactions
+        HEALTH_QUEUE_REJECT,    ///< Transactions refused by the full I2C queue
+        HEALTH_TX_STALL,        ///< Frames that waited for room in the UART TX buffer or FIFO
+        HEALTH_TX_DROP,         ///< Frames dropped
+        HEALTH_LOG_DROP,        ///< Compressed frames and rows not written to the flash log
+        HEALTH_COUNTERS
+    } Health_Counter;
+
+    /**
+    *   \brief Add events to a counter.
+    */
+    void Health_Count(Health_Counter counter, uint32_t events);
+
+    /**
+    *   \brief Events counted since start-up.
+    */
+    uint32_t Health_Get(Health_Counter counter);
+
+    /**
+    *   \brief Short name of a counter, for the reports.
+    */
+    const char* Health_GetName(Health_Counter counter);
+
+#endif // Health_H
+/* [] END OF FILE */
@@ -0,0 +1,54 @@
+/*
+* This file includes the configuration of the LIS3DH high-pass filter.
+*/
+
+#include "HighPass.h"
+#include "I2C_Interface.h"
+#include "LIS3DH_Registers.h"
+
+static uint8_t highpass_enabled = 0;
+static uint8_t highpass_cutoff = HIGHPASS_CUTOFF_2HZ;
+
+    ErrorCode HighPass_Configure(uint8_t enabled, uint8_t cutoff)
+    {
+        if (cutoff > HIGHPASS_CUTOFF_0_2HZ)
+        {
+            return ERROR;
+        }
+
+        // Normal mode (HPM = 00), the click and interrupt routing bits are kept
+        uint8_t value = (cutoff << LIS3DH_CTRL_REG2_HPCF_SHIFT) |
+                        (enabled ? LIS3DH_CTRL_REG2_FDS : 0);
+        ErrorCode error = I2C_Peripheral_UpdateRegister(LIS3DH_DEVICE_ADDRESS,
+                                                        LIS3DH_CTRL_REG2,
+                                                        LIS3DH_CTRL_REG2_HPM_MASK |
+                                                        LIS3DH_CTRL_REG2_HPCF_MASK |
+                                                        LIS3DH_CTRL_REG2_FDS,
+                                                        value);
+        if (error == NO_ERROR && enabled)
+        {
+            // Reading the Reference register resets the filter
+            uint8_t reference;
+            error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
+                                                LIS3DH_REFERENCE,
+                                                &reference);
+        }
+        if (error == NO_ERROR)
+        {
+            highpass_enabled = enabled;
+            highpass_cutoff = cutoff;
+        }
+        return error;
+    }
+
+    uint8_t HighPass_IsEnabled(void)
+    {
+        return highpass_enabled;
+    }
+
+    uint8_t HighPass_GetCutoff(void)
+    {
+        return highpass_cutoff;
+    }
+
+/* [] END OF FILE */
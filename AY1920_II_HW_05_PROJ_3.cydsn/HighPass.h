@@ -0,0 +1,47 @@
+/**
+*   \file HighPass.h
+*   \brief High-pass filter of the LIS3DH on the output data.
+*
+*   When enabled, the output registers and the FIFO hold the high-pass
+*   filtered acceleration (FDS bit of the Control register 2), so gravity is
+*   removed by the sensor instead of the firmware or the host. All the
+*   outputs of the acquisition then carry the filtered data.
+*/
+
+#ifndef HighPass_H
+    #define HighPass_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Cut-off frequency codes (HPCF), values at 100 Hz ODR; the
+    *   cut-off scales with the output data rate
+    */
+    #define HIGHPASS_CUTOFF_2HZ   0
+    #define HIGHPASS_CUTOFF_1HZ   1
+    #define HIGHPASS_CUTOFF_0_5HZ 2
+    #define HIGHPASS_CUTOFF_0_2HZ 3
+
+    /**
+    *   \brief Enable or disable the filtered output.
+    *
+    *   The filter is reset when enabled, so the output starts from zero
+    *   instead of settling from the gravity step.
+    *   \param enabled 1 to send filtered data to the output registers and FIFO.
+    *   \param cutoff Cut-off frequency code (HIGHPASS_CUTOFF_*).
+    */
+    ErrorCode HighPass_Configure(uint8_t enabled, uint8_t cutoff);
+
+    /**
+    *   \brief Return 1 if the output data is filtered.
+    */
+    uint8_t HighPass_IsEnabled(void);
+
+    /**
+    *   \brief Current cut-off frequency code.
+    */
+    uint8_t HighPass_GetCutoff(void);
+
+#endif // HighPass_H
+/* [] END OF FILE */
@@ -136,13 +136,13 @@
         uint8_t error = I2C_Master_MasterSendStart(device_address, I2C_Master_WRITE_XFER_MODE);
         if (error == I2C_Master_MSTR_NO_ERROR)
         {
-            // Write register address
-            error = I2C_Master_MasterWriteByte(register_address);
+            // Write register address with the MSB equal to 1 (auto-increment)
+            error = I2C_Master_MasterWriteByte(register_address | 0x80);
             if (error == I2C_Master_MSTR_NO_ERROR)
             {
                 // Continue writing until we have data to write
                 uint8_t counter = register_count;
-                while(counter >= 0)
+                while(counter > 0)
                 {
                      error =
                         I2C_Master_MasterWriteByte(data[register_count-counter]);
@@ -163,6 +163,26 @@
         return error ? ERROR : NO_ERROR;
     }
     
+    ErrorCode I2C_Peripheral_UpdateRegister(uint8_t device_address,
+                                            uint8_t register_address,
+                                            uint8_t mask,
+                                            uint8_t value)
+    {
+        uint8_t data;
+        ErrorCode error = I2C_Peripheral_ReadRegister(device_address,
+                                                      register_address,
+                                                      &data);
+        if (error == NO_ERROR)
+        {
+            // Keep the bits outside the mask
+            data = (data & ~mask) | (value & mask);
+            error = I2C_Peripheral_WriteRegister(device_address,
+                                                 register_address,
+                                                 data);
+        }
+        return error;
+    }
+    
     
     uint8_t I2C_Peripheral_IsDeviceConnected(uint8_t device_address)
     {
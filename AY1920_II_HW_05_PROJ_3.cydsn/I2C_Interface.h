@@ -83,6 +83,21 @@
                                             uint8_t register_count,
                                             uint8_t* data);
     
+    /** 
+    *   \brief Change some bits of a register over I2C.
+    *   
+    *   This function reads the register, replaces the bits selected by the
+    *   mask and writes it back, so that the other bits are preserved.
+    *   \param device_address I2C address of the device to talk to.
+    *   \param register_address Address of the register to be updated.
+    *   \param mask Bits to be changed.
+    *   \param value New value of the bits selected by the mask.
+    */
+    ErrorCode I2C_Peripheral_UpdateRegister(uint8_t device_address,
+                                            uint8_t register_address,
+                                            uint8_t mask,
+                                            uint8_t value);
+    
     /**
     *   \brief Check if device is connected over I2C.
     *
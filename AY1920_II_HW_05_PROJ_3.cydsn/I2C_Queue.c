@@ -0,0 +1,226 @@
+/*
+* This file includes the prioritised queue of I2C transactions. It does not
+* depend on the PSoC generated code, so it can be compiled on a host PC too.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include "I2C_Queue.h"
+
+/**
+*   \brief Slot of the queue
+*/
+typedef struct {
+    I2C_Transaction transaction;
+    uint32_t sequence;      // Submission order, for FIFO order within a priority
+    uint8_t used;
+} I2C_QueueEntry;
+
+static I2C_QueueEntry queue[I2C_QUEUE_SIZE];
+static uint8_t pending = 0;
+static uint32_t next_sequence = 0;
+static I2C_TransferFunction transfer_function = NULL;
+static I2C_QueueStats stats;
+static uint8_t scratch[I2C_QUEUE_MAX_TRANSFER];
+
+    ErrorCode I2C_Queue_Init(I2C_TransferFunction transfer)
+    {
+        if (transfer == NULL)
+        {
+            return ERROR;
+        }
+        transfer_function = transfer;
+        for (uint8_t i = 0; i < I2C_QUEUE_SIZE; i++)
+        {
+            queue[i].used = 0;
+        }
+        pending = 0;
+        I2C_Queue_ResetStats();
+        return NO_ERROR;
+    }
+
+    ErrorCode I2C_Queue_Submit(const I2C_Transaction* transaction)
+    {
+        if (transaction == NULL || transaction->data == NULL || transaction->register_count == 0 ||
+            transaction->priority >= I2C_PRIORITY_COUNT)
+        {
+            return ERROR;
+        }
+        for (uint8_t i = 0; i < I2C_QUEUE_SIZE; i++)
+        {
+            if (!queue[i].used)
+            {
+                queue[i].transaction = *transaction;
+                queue[i].sequence = next_sequence++;
+                queue[i].used = 1;
+                pending++;
+                stats.submitted++;
+                if (pending > stats.max_pending)
+                {
+                    stats.max_pending = pending;
+                }
+                return NO_ERROR;
+            }
+        }
+        stats.rejected++;
+        return ERROR;
+    }
+
+    /**
+    *   \brief Index of the next transaction: highest priority, then oldest.
+    */
+    static int8_t I2C_Queue_Next(void)
+    {
+        int8_t next = -1;
+        for (uint8_t i = 0; i < I2C_QUEUE_SIZE; i++)
+        {
+            if (!queue[i].used)
+            {
+                continue;
+            }
+            if (next < 0 ||
+                queue[i].transaction.priority < queue[next].transaction.priority ||
+                (queue[i].transaction.priority == queue[next].transaction.priority &&
+                 (int32_t)(queue[i].sequence - queue[next].sequence) < 0))
+            {
+                next = i;
+            }
+        }
+        return next;
+    }
+
+    /**
+    *   \brief Return 1 if the entry is a read that can be merged with others.
+    */
+    static uint8_t I2C_Queue_CanCoalesce(const I2C_Transaction* transaction)
+    {
+        return !(transaction->flags & (I2C_FLAG_WRITE | I2C_FLAG_NO_COALESCE));
+    }
+
+    /**
+    *   \brief Collect the pending reads adjacent to the first one.
+    *
+    *   \param group Indices of the merged entries, the first one included.
+    *   \param start First register of the merged read.
+    *   \retval Number of entries in the group.
+    */
+    static uint8_t I2C_Queue_Coalesce(uint8_t first, uint8_t group[I2C_QUEUE_SIZE],
+                                      uint8_t* start, uint8_t* count)
+    {
+        const I2C_Transaction* head = &queue[first].transaction;
+        uint8_t size = 1;
+        group[0] = first;
+        *start = head->register_address;
+        *count = head->register_count;
+        if (!I2C_Queue_CanCoalesce(head))
+        {
+            return size;
+        }
+
+        // Extend the range on both sides until no pending read touches it
+        uint8_t extended;
+        do
+        {
+            extended = 0;
+            for (uint8_t i = 0; i < I2C_QUEUE_SIZE; i++)
+            {
+                const I2C_Transaction* other = &queue[i].transaction;
+                uint8_t member = 0;
+                for (uint8_t g = 0; g < size; g++)
+                {
+                    member |= (group[g] == i);
+                }
+                if (!queue[i].used || member || !I2C_Queue_CanCoalesce(other) ||
+                    other->device_address != head->device_address ||
+                    *count + other->register_count > I2C_QUEUE_MAX_TRANSFER)
+                {
+                    continue;
+                }
+                if (other->register_address == (uint8_t)(*start + *count))
+                {
+                    *count += other->register_count;
+                }
+                else if ((uint8_t)(other->register_address + other->register_count) == *start)
+                {
+                    *start = other->register_address;
+                    *count += other->register_count;
+                }
+                else
+                {
+                    continue;
+                }
+                group[size++] = i;
+                extended = 1;
+            }
+        } while (extended);
+        return size;
+    }
+
+    uint8_t I2C_Queue_Service(uint32_t budget_us)
+    {
+        uint8_t completed = 0;
+        while (pending > 0)
+        {
+            uint8_t first = (uint8_t)I2C_Queue_Next();
+            uint8_t group[I2C_QUEUE_SIZE];
+            uint8_t start, count;
+            uint8_t size = I2C_Queue_Coalesce(first, group, &start, &count);
+
+            // Only the sample fetch may run over the budget
+            const I2C_Transaction* head = &queue[first].transaction;
+            uint8_t write = (head->flags & I2C_FLAG_WRITE) != 0;
+            uint32_t estimate = write ? I2C_QUEUE_WRITE_US(count) : I2C_QUEUE_READ_US(count);
+            if (head->priority != I2C_PRIORITY_SAMPLE && estimate > budget_us)
+            {
+                stats.deferred++;
+                break;
+            }
+            budget_us = estimate < budget_us ? budget_us - estimate : 0;
+
+            // A single transaction uses its own buffer, a merged read the scratch one
+            ErrorCode error = transfer_function(head->device_address, start, count,
+                                                size == 1 ? head->data : scratch, write);
+            stats.transfers++;
+            stats.coalesced += size - 1;
+
+            // Free the slots before the callbacks, which may submit again
+            I2C_Transaction done[I2C_QUEUE_SIZE];
+            for (uint8_t g = 0; g < size; g++)
+            {
+                done[g] = queue[group[g]].transaction;
+                queue[group[g]].used = 0;
+                if (size > 1)
+                {
+                    memcpy(done[g].data, &scratch[done[g].register_address - start], done[g].register_count);
+                }
+            }
+            pending -= size;
+            for (uint8_t g = 0; g < size; g++)
+            {
+                if (done[g].callback != NULL)
+                {
+                    done[g].callback(&done[g], error);
+                }
+                completed++;
+            }
+        }
+        return completed;
+    }
+
+    uint8_t I2C_Queue_GetPending(void)
+    {
+        return pending;
+    }
+
+    void I2C_Queue_GetStats(I2C_QueueStats* out)
+    {
+        *out = stats;
+    }
+
+    void I2C_Queue_ResetStats(void)
+    {
+        memset(&stats, 0, sizeof(stats));
+        stats.max_pending = pending;
+    }
+
+/* [] END OF FILE */
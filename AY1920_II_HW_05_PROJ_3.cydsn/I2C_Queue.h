@@ -0,0 +1,151 @@
+/**
+*   \file I2C_Queue.h
+*   \brief Prioritised queue of I2C transactions.
+*
+*   Producers submit transaction descriptors instead of calling the
+*   blocking functions of I2C_Interface directly. The queue is served in the
+*   time left before the next acquisition: transactions are executed in
+*   priority order (FIFO order within a priority) while their estimated
+*   bus time fits in the budget given by the caller, the others wait for
+*   the next call. Sample reads (I2C_PRIORITY_SAMPLE) are never deferred.
+*
+*   Pending reads of the same device whose register ranges are adjacent
+*   are coalesced into one auto-increment transaction, saving the address
+*   phase of each of them.
+*
+*   The queue does not include any PSoC header: the function that performs
+*   a transfer is passed in at initialization, so the same code runs on the
+*   device and in the host simulation (Host_Tools/i2c_queue_sim.c).
+*/
+
+#ifndef I2C_Queue_H
+    #define I2C_Queue_H
+
+    #include <stdint.h>
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Maximum number of pending transactions
+    */
+    #define I2C_QUEUE_SIZE 16
+
+    /**
+    *   \brief Maximum length of a coalesced read [bytes]
+    */
+    #define I2C_QUEUE_MAX_TRANSFER 16
+
+    /**
+    *   \brief Bus clock [kHz]: 100 kHz, the default of the I2C component
+    */
+    #define I2C_QUEUE_BUS_KHZ 100
+
+    /**
+    *   \brief Estimated bus time of a read or a write of n registers [us]:
+    *   9 clocks per byte, 3 bytes of addressing for a read (address, register,
+    *   address again after the restart) and 2 for a write
+    */
+    #define I2C_QUEUE_READ_US(n) ((uint32_t)((n) + 3) * 9000 / I2C_QUEUE_BUS_KHZ)
+    #define I2C_QUEUE_WRITE_US(n) ((uint32_t)((n) + 2) * 9000 / I2C_QUEUE_BUS_KHZ)
+
+    /**
+    *   \brief Priority of a transaction, highest first
+    */
+    typedef enum {
+        I2C_PRIORITY_SAMPLE,        ///< Sample fetch: executed even over the budget
+        I2C_PRIORITY_CONFIG,        ///< Configuration commands
+        I2C_PRIORITY_TELEMETRY,     ///< Status, temperature and event polling
+        I2C_PRIORITY_COUNT
+    } I2C_Priority;
+
+    /**
+    *   \brief Flags of a transaction
+    */
+    #define I2C_FLAG_WRITE (1<<0)           ///< Write the registers, read them otherwise
+    #define I2C_FLAG_NO_COALESCE (1<<1)     ///< Never merged with other reads (e.g. FIFO output)
+
+    struct I2C_Transaction;
+
+    /**
+    *   \brief Function called when a transaction is completed.
+    *
+    *   \param transaction The completed transaction (data holds the registers read).
+    *   \param error Result of the transfer.
+    */
+    typedef void (*I2C_Callback)(const struct I2C_Transaction* transaction, ErrorCode error);
+
+    /**
+    *   \brief Descriptor of a transaction.
+    *
+    *   The data buffer must stay valid until the callback is called.
+    */
+    typedef struct I2C_Transaction {
+        uint8_t device_address;     ///< 7-bit I2C address
+        uint8_t register_address;   ///< First register
+        uint8_t register_count;     ///< Number of registers
+        uint8_t flags;              ///< I2C_FLAG_* mask
+        I2C_Priority priority;
+        uint8_t* data;              ///< Registers to write or buffer for the registers read
+        I2C_Callback callback;      ///< Called on completion (may be NULL)
+    } I2C_Transaction;
+
+    /**
+    *   \brief Function that performs a transfer, e.g. I2C_Peripheral_ReadRegisterMulti().
+    */
+    typedef ErrorCode (*I2C_TransferFunction)(uint8_t device_address,
+                                              uint8_t register_address,
+                                              uint8_t register_count,
+                                              uint8_t* data,
+                                              uint8_t write);
+
+    /**
+    *   \brief Statistics of the queue.
+    */
+    typedef struct {
+        uint32_t submitted;     ///< Transactions accepted
+        uint32_t rejected;      ///< Transactions refused because the queue was full
+        uint32_t transfers;     ///< Bus transfers performed
+        uint32_t coalesced;     ///< Transactions merged into the transfer of another one
+        uint32_t deferred;      ///< Calls that left transactions pending for lack of budget
+        uint8_t max_pending;    ///< Largest number of pending transactions
+    } I2C_QueueStats;
+
+    /**
+    *   \brief Initialize an empty queue.
+    *
+    *   \param transfer Function that performs the transfers.
+    */
+    ErrorCode I2C_Queue_Init(I2C_TransferFunction transfer);
+
+    /**
+    *   \brief Add a transaction to the queue.
+    *
+    *   The descriptor is copied, the data buffer is not.
+    *   \retval Returns ERROR if the queue is full or the descriptor is not valid.
+    */
+    ErrorCode I2C_Queue_Submit(const I2C_Transaction* transaction);
+
+    /**
+    *   \brief Execute the pending transactions that fit in a time budget.
+    *
+    *   \param budget_us Bus time available before the next acquisition [us].
+    *   \retval Number of transactions completed.
+    */
+    uint8_t I2C_Queue_Service(uint32_t budget_us);
+
+    /**
+    *   \brief Number of pending transactions.
+    */
+    uint8_t I2C_Queue_GetPending(void);
+
+    /**
+    *   \brief Read the statistics.
+    */
+    void I2C_Queue_GetStats(I2C_QueueStats* stats);
+
+    /**
+    *   \brief Reset the statistics.
+    */
+    void I2C_Queue_ResetStats(void);
+
+#endif // I2C_Queue_H
+/* [] END OF FILE */
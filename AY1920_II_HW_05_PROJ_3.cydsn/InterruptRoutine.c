@@ -10,13 +10,16 @@
  * ========================================
 */
 #include "InterruptRoutines.h"
+#include "PowerManager.h"
 
-uint8 Flag_Read = 0;  // Initialitazion of the flag
+volatile uint32 Timer_Tick = 0;  // Initialitazion of the tick counter
+volatile uint32 Timer_TickCycles = 0;  // CPU cycle counter at the last tick
 
 CY_ISR(Custom_ISR)
 {  
     Timer_ReadStatusRegister();
-     Flag_Read = 1;  // flag high at every 10ms
+    Timer_TickCycles = PowerManager_ReadCycles();  // before the tick, see Timestamp_Now
+    Timer_Tick++;  // one tick every 10ms
     
 }
 /* [] END OF FILE */
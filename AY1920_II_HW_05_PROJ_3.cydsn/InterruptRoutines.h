@@ -16,9 +16,16 @@
    #include "project.h"
     
    /*
-    // Definition of a global flag for the constant rate read
+    // Tick counter incremented by the Timer ISR every 10ms,
+    // used by the scheduler to release the tasks
    */
-   extern uint8 Flag_Read; 
+   extern volatile uint32 Timer_Tick;
+
+   /*
+    // CPU cycle counter read by the Timer ISR at the last tick,
+    // the reference of the timestamps inside the tick
+   */
+   extern volatile uint32 Timer_TickCycles;
     
    CY_ISR_PROTO(Custom_ISR);
 
@@ -0,0 +1,271 @@
+/**
+*   \file LIS3DH_Registers.h
+*   \brief Register map of the LIS3DH accelerometer.
+*
+*   This file contains the addresses of the LIS3DH registers and the values
+*   written to them, shared by all the source files that talk to the sensor.
+*/
+
+#ifndef LIS3DH_Registers_H
+    #define LIS3DH_Registers_H
+
+    /**
+    *   \brief 7-bit I2C address of the slave device.
+    */
+    #define LIS3DH_DEVICE_ADDRESS 0x18
+
+    /**
+    *   \brief 7-bit I2C address of a second slave device with the SA0 pin high.
+    */
+    #define LIS3DH_DEVICE_ADDRESS_SA0_HIGH 0x19
+
+    /**
+    *   \brief Address of the WHO AM I register
+    */
+    #define LIS3DH_WHO_AM_I_REG_ADDR 0x0F
+
+    /**
+    *   \brief Value of the WHO AM I register
+    */
+    #define LIS3DH_WHO_AM_I_VALUE 0x33
+
+    /**
+    *   \brief Address of the Status register
+    */
+    #define LIS3DH_STATUS_REG 0x27
+
+    /**
+    *   \brief ZYXDA bit of the Status register: a new set of data is available
+    */
+    #define LIS3DH_STATUS_REG_ZYXDA (1<<3)
+
+    /**
+    *   \brief ZYXOR bit of the Status register: a new set of data has
+    *   overwritten the previous one before it was read
+    */
+    #define LIS3DH_STATUS_REG_ZYXOR (1<<7)
+
+    /**
+    *   \brief Address of the ADC1 output LSB register: ADC1, ADC2 and ADC3
+    *   (temperature when TEMP_EN is set) follow in 0x08 ... 0x0D
+    */
+    #define LIS3DH_OUT_ADC1_L 0x08
+
+    /**
+    *   \brief Address of the Temperature Sensor Configuration register and its bits
+    */
+    #define LIS3DH_TEMP_CFG_REG 0x1F
+    #define LIS3DH_TEMP_CFG_REG_ADC_EN (1<<7)
+    #define LIS3DH_TEMP_CFG_REG_TEMP_EN (1<<6)
+
+    /**
+    *   \brief Address of the Control register 1
+    */
+    #define LIS3DH_CTRL_REG1 0x20
+
+    /**
+    *   \brief Hex value to set high resolution mode at 100 Hz to the accelerator
+    */
+    #define LIS3DH_HIGH_RESOLUTION_MODE_100HZ_CTRL_REG1 0x57
+
+    /**
+    *   \brief Address of the Control register 4
+    */
+    #define LIS3DH_CTRL_REG4 0x23
+
+    /**
+    *   \brief Hex value to set High Resolution mode at 100 Hz in the ±4.0 g FSR to the accelerator (BDU =1)
+    */
+    #define LIS3DH_HIGH_RESOLUTION_MODE_100HZ_CTRL_REG4 0x98
+
+    /**
+    *   \brief Full-scale field of the Control register 4 (FS1:FS0: ±2, 4, 8, 16 g)
+    */
+    #define LIS3DH_CTRL_REG4_FS_MASK 0x30
+    #define LIS3DH_CTRL_REG4_FS_SHIFT 4
+
+    /**
+    *   \brief Self-test field of the Control register 4 (ST1:ST0)
+    */
+    #define LIS3DH_CTRL_REG4_ST_MASK 0x06
+    #define LIS3DH_CTRL_REG4_ST_0 0x02      ///< Self-test 0
+
+    /**
+    *   \brief Hex value to set Normal mode in the ±2.0 g FSR (BDU = 1), used by
+    *   the self-test because the datasheet limits refer to it
+    */
+    #define LIS3DH_NORMAL_MODE_2G_CTRL_REG4 0x80
+
+    /**
+    *   \brief Address of the Control register 2 (high-pass filter)
+    */
+    #define LIS3DH_CTRL_REG2 0x21
+
+    /**
+    *   \brief HPIA1 and HPIA2 bits of the Control register 2: high-pass filter
+    *   enabled on the interrupt generators 1 and 2 (gravity removed)
+    */
+    #define LIS3DH_CTRL_REG2_HPIA1 (1<<0)
+    #define LIS3DH_CTRL_REG2_HPIA2 (1<<1)
+
+    /**
+    *   \brief High-pass filter fields of the Control register 2
+    */
+    #define LIS3DH_CTRL_REG2_HPM_MASK 0xC0      ///< 00: normal mode, reset by reading REFERENCE
+    #define LIS3DH_CTRL_REG2_HPCF_SHIFT 4
+    #define LIS3DH_CTRL_REG2_HPCF_MASK 0x30     ///< Cut-off frequency, see HIGHPASS_CUTOFF_*
+    #define LIS3DH_CTRL_REG2_FDS (1<<3)         ///< Filtered data to the output registers and FIFO
+    #define LIS3DH_CTRL_REG2_HPCLICK (1<<2)     ///< Filtered data to the click function
+
+    /**
+    *   \brief Address of the Reference register: reading it resets the high-pass filter
+    */
+    #define LIS3DH_REFERENCE 0x26
+
+    /**
+    *   \brief Address of the Control register 5
+    */
+    #define LIS3DH_CTRL_REG5 0x24
+
+    /**
+    *   \brief LIR_INT1 and LIR_INT2 bits of the Control register 5: interrupt
+    *   requests latched until the source register is read
+    */
+    #define LIS3DH_CTRL_REG5_LIR_INT1 (1<<3)
+    #define LIS3DH_CTRL_REG5_LIR_INT2 (1<<1)
+
+    /**
+    *   \brief FIFO_EN bit of the Control register 5
+    */
+    #define LIS3DH_CTRL_REG5_FIFO_EN (1<<6)
+
+    /**
+    *   \brief Address of the FIFO control register and Stream mode value
+    *   (FM = 10: the oldest sample is overwritten when the FIFO is full)
+    */
+    #define LIS3DH_FIFO_CTRL_REG 0x2E
+    #define LIS3DH_FIFO_CTRL_REG_STREAM 0x80
+
+    /**
+    *   \brief Address of the FIFO source register and its fields
+    */
+    #define LIS3DH_FIFO_SRC_REG 0x2F
+    #define LIS3DH_FIFO_SRC_REG_OVRN (1<<6)     ///< FIFO full, samples overwritten
+    #define LIS3DH_FIFO_SRC_REG_EMPTY (1<<5)
+    #define LIS3DH_FIFO_SRC_REG_FSS_MASK 0x1F   ///< Unread samples
+
+    /**
+    *   \brief Depth of the FIFO [samples]
+    */
+    #define LIS3DH_FIFO_SIZE 32
+
+    /**
+    *   \brief ODR field of the Control register 1 (bits 7:4)
+    */
+    #define LIS3DH_CTRL_REG1_ODR_SHIFT 4
+    #define LIS3DH_CTRL_REG1_ODR_MASK 0xF0
+
+    /**
+    *   \brief Output data rate codes of the Control register 1
+    */
+    #define LIS3DH_ODR_1HZ   0x1
+    #define LIS3DH_ODR_10HZ  0x2
+    #define LIS3DH_ODR_25HZ  0x3
+    #define LIS3DH_ODR_50HZ  0x4
+    #define LIS3DH_ODR_100HZ 0x5
+    #define LIS3DH_ODR_200HZ 0x6
+    #define LIS3DH_ODR_400HZ 0x7
+
+    /**
+    *   \brief Addresses of the interrupt generator 1 registers
+    */
+    #define LIS3DH_INT1_CFG 0x30
+    #define LIS3DH_INT1_SRC 0x31
+    #define LIS3DH_INT1_THS 0x32
+    #define LIS3DH_INT1_DURATION 0x33
+
+    /**
+    *   \brief Addresses of the interrupt generator 2 registers
+    */
+    #define LIS3DH_INT2_CFG 0x34
+    #define LIS3DH_INT2_SRC 0x35
+    #define LIS3DH_INT2_THS 0x36
+    #define LIS3DH_INT2_DURATION 0x37
+
+    /**
+    *   \brief Bits of the INTx_CFG registers
+    */
+    #define LIS3DH_INT_CFG_AOI  (1<<7)  ///< AND combination of the events
+    #define LIS3DH_INT_CFG_ZHIE (1<<5)
+    #define LIS3DH_INT_CFG_ZLIE (1<<4)
+    #define LIS3DH_INT_CFG_YHIE (1<<3)
+    #define LIS3DH_INT_CFG_YLIE (1<<2)
+    #define LIS3DH_INT_CFG_XHIE (1<<1)
+    #define LIS3DH_INT_CFG_XLIE (1<<0)
+
+    /**
+    *   \brief IA bit of the INTx_SRC registers: interrupt active
+    */
+    #define LIS3DH_INT_SRC_IA (1<<6)
+
+    /**
+    *   \brief Addresses of the click registers
+    */
+    #define LIS3DH_CLICK_CFG 0x38
+    #define LIS3DH_CLICK_SRC 0x39
+    #define LIS3DH_CLICK_THS 0x3A
+    #define LIS3DH_TIME_LIMIT 0x3B
+    #define LIS3DH_TIME_LATENCY 0x3C
+    #define LIS3DH_TIME_WINDOW 0x3D
+
+    /**
+    *   \brief Bits of the CLICK_CFG register: single (S) and double (D) click per axis
+    */
+    #define LIS3DH_CLICK_CFG_ZD (1<<5)
+    #define LIS3DH_CLICK_CFG_ZS (1<<4)
+    #define LIS3DH_CLICK_CFG_YD (1<<3)
+    #define LIS3DH_CLICK_CFG_YS (1<<2)
+    #define LIS3DH_CLICK_CFG_XD (1<<1)
+    #define LIS3DH_CLICK_CFG_XS (1<<0)
+
+    /**
+    *   \brief Bits of the CLICK_SRC register
+    */
+    #define LIS3DH_CLICK_SRC_IA (1<<6)      ///< Click detected
+    #define LIS3DH_CLICK_SRC_DCLICK (1<<5)  ///< Double click
+    #define LIS3DH_CLICK_SRC_SCLICK (1<<4)  ///< Single click
+    #define LIS3DH_CLICK_SRC_SIGN (1<<3)    ///< 1: negative direction
+    #define LIS3DH_CLICK_SRC_Z (1<<2)
+    #define LIS3DH_CLICK_SRC_Y (1<<1)
+    #define LIS3DH_CLICK_SRC_X (1<<0)
+
+    /**
+    *   \brief LIR_Click bit of the CLICK_THS register: click latched until CLICK_SRC is read
+    */
+    #define LIS3DH_CLICK_THS_LIR (1<<7)
+
+    /**
+    *   \brief Addresses of the sleep-to-wake (activity) registers
+    */
+    #define LIS3DH_ACT_THS 0x3E
+    #define LIS3DH_ACT_DUR 0x3F
+
+    /**
+    *   \brief Address of the X-axis acceleration data output LSB register
+    */
+    #define LIS3DH_OUT_X_L 0x28
+    /**
+    *   \brief Address of the Y-axis acceleration data output LSB register
+    */
+    #define LIS3DH_OUT_Y_L 0x2A
+    /**
+    *   \brief Address of the Z-axis acceleration data output LSB register
+    */
+    #define LIS3DH_OUT_Z_L 0x2C
+
+    //Thanks to the MultiRead function we don't need to specify the MSB registers Address
+    //With the FIFO enabled, the read address goes back to OUT_X_L after OUT_Z_H,
+    //so a single MultiRead of 6*n bytes returns n samples
+
+#endif // LIS3DH_Registers_H
+/* [] END OF FILE */
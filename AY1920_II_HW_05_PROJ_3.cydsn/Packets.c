@@ -0,0 +1,219 @@
+/*
+* This file includes the packers of the fixed-layout frames. Generated by
+* Host_Tools/packetgen.py from Host_Tools/packets.json: do not edit.
+*/
+
+#include "Packets.h"
+
+    uint8_t* Packets_PackSample(uint8_t* payload, const Packets_Sample* packet)
+    {
+        payload[0] = (uint8_t)packet->x;
+        payload[1] = (uint8_t)((uint32_t)packet->x >> 8);
+        payload[2] = (uint8_t)((uint32_t)packet->x >> 16);
+        payload[3] = (uint8_t)((uint32_t)packet->x >> 24);
+        payload[4] = (uint8_t)packet->y;
+        payload[5] = (uint8_t)((uint32_t)packet->y >> 8);
+        payload[6] = (uint8_t)((uint32_t)packet->y >> 16);
+        payload[7] = (uint8_t)((uint32_t)packet->y >> 24);
+        payload[8] = (uint8_t)packet->z;
+        payload[9] = (uint8_t)((uint32_t)packet->z >> 8);
+        payload[10] = (uint8_t)((uint32_t)packet->z >> 16);
+        payload[11] = (uint8_t)((uint32_t)packet->z >> 24);
+        return payload + 12;
+    }
+
+    uint8_t* Packets_PackRate(uint8_t* payload, const Packets_Rate* packet)
+    {
+        payload[0] = (uint8_t)packet->rate;
+        payload[1] = (uint8_t)((uint16_t)packet->rate >> 8);
+        payload[2] = (uint8_t)packet->sample_count;
+        payload[3] = (uint8_t)((uint32_t)packet->sample_count >> 8);
+        payload[4] = (uint8_t)((uint32_t)packet->sample_count >> 16);
+        payload[5] = (uint8_t)((uint32_t)packet->sample_count >> 24);
+        payload[6] = (uint8_t)packet->tick;
+        payload[7] = (uint8_t)((uint32_t)packet->tick >> 8);
+        payload[8] = (uint8_t)((uint32_t)packet->tick >> 16);
+        payload[9] = (uint8_t)((uint32_t)packet->tick >> 24);
+        return payload + 10;
+    }
+
+    uint8_t* Packets_PackSummary(uint8_t* payload, const Packets_Summary* packet)
+    {
+        payload[0] = (uint8_t)packet->first_index;
+        payload[1] = (uint8_t)((uint32_t)packet->first_index >> 8);
+        payload[2] = (uint8_t)((uint32_t)packet->first_index >> 16);
+        payload[3] = (uint8_t)((uint32_t)packet->first_index >> 24);
+        payload[4] = (uint8_t)packet->count;
+        payload[5] = (uint8_t)((uint16_t)packet->count >> 8);
+        payload[6] = (uint8_t)packet->x_mean;
+        payload[7] = (uint8_t)((uint32_t)packet->x_mean >> 8);
+        payload[8] = (uint8_t)((uint32_t)packet->x_mean >> 16);
+        payload[9] = (uint8_t)((uint32_t)packet->x_mean >> 24);
+        payload[10] = (uint8_t)packet->x_rms;
+        payload[11] = (uint8_t)((uint32_t)packet->x_rms >> 8);
+        payload[12] = (uint8_t)((uint32_t)packet->x_rms >> 16);
+        payload[13] = (uint8_t)((uint32_t)packet->x_rms >> 24);
+        payload[14] = (uint8_t)packet->x_min;
+        payload[15] = (uint8_t)((uint32_t)packet->x_min >> 8);
+        payload[16] = (uint8_t)((uint32_t)packet->x_min >> 16);
+        payload[17] = (uint8_t)((uint32_t)packet->x_min >> 24);
+        payload[18] = (uint8_t)packet->x_max;
+        payload[19] = (uint8_t)((uint32_t)packet->x_max >> 8);
+        payload[20] = (uint8_t)((uint32_t)packet->x_max >> 16);
+        payload[21] = (uint8_t)((uint32_t)packet->x_max >> 24);
+        payload[22] = (uint8_t)packet->y_mean;
+        payload[23] = (uint8_t)((uint32_t)packet->y_mean >> 8);
+        payload[24] = (uint8_t)((uint32_t)packet->y_mean >> 16);
+        payload[25] = (uint8_t)((uint32_t)packet->y_mean >> 24);
+        payload[26] = (uint8_t)packet->y_rms;
+        payload[27] = (uint8_t)((uint32_t)packet->y_rms >> 8);
+        payload[28] = (uint8_t)((uint32_t)packet->y_rms >> 16);
+        payload[29] = (uint8_t)((uint32_t)packet->y_rms >> 24);
+        payload[30] = (uint8_t)packet->y_min;
+        payload[31] = (uint8_t)((uint32_t)packet->y_min >> 8);
+        payload[32] = (uint8_t)((uint32_t)packet->y_min >> 16);
+        payload[33] = (uint8_t)((uint32_t)packet->y_min >> 24);
+        payload[34] = (uint8_t)packet->y_max;
+        payload[35] = (uint8_t)((uint32_t)packet->y_max >> 8);
+        payload[36] = (uint8_t)((uint32_t)packet->y_max >> 16);
+        payload[37] = (uint8_t)((uint32_t)packet->y_max >> 24);
+        payload[38] = (uint8_t)packet->z_mean;
+        payload[39] = (uint8_t)((uint32_t)packet->z_mean >> 8);
+        payload[40] = (uint8_t)((uint32_t)packet->z_mean >> 16);
+        payload[41] = (uint8_t)((uint32_t)packet->z_mean >> 24);
+        payload[42] = (uint8_t)packet->z_rms;
+        payload[43] = (uint8_t)((uint32_t)packet->z_rms >> 8);
+        payload[44] = (uint8_t)((uint32_t)packet->z_rms >> 16);
+        payload[45] = (uint8_t)((uint32_t)packet->z_rms >> 24);
+        payload[46] = (uint8_t)packet->z_min;
+        payload[47] = (uint8_t)((uint32_t)packet->z_min >> 8);
+        payload[48] = (uint8_t)((uint32_t)packet->z_min >> 16);
+        payload[49] = (uint8_t)((uint32_t)packet->z_min >> 24);
+        payload[50] = (uint8_t)packet->z_max;
+        payload[51] = (uint8_t)((uint32_t)packet->z_max >> 8);
+        payload[52] = (uint8_t)((uint32_t)packet->z_max >> 16);
+        payload[53] = (uint8_t)((uint32_t)packet->z_max >> 24);
+        payload[54] = (uint8_t)packet->magnitude_rms;
+        payload[55] = (uint8_t)((uint32_t)packet->magnitude_rms >> 8);
+        payload[56] = (uint8_t)((uint32_t)packet->magnitude_rms >> 16);
+        payload[57] = (uint8_t)((uint32_t)packet->magnitude_rms >> 24);
+        return payload + 58;
+    }
+
+    uint8_t* Packets_PackDecimated(uint8_t* payload, const Packets_Decimated* packet)
+    {
+        payload[0] = (uint8_t)packet->factor;
+        payload[1] = (uint8_t)packet->x;
+        payload[2] = (uint8_t)((uint32_t)packet->x >> 8);
+        payload[3] = (uint8_t)((uint32_t)packet->x >> 16);
+        payload[4] = (uint8_t)((uint32_t)packet->x >> 24);
+        payload[5] = (uint8_t)packet->y;
+        payload[6] = (uint8_t)((uint32_t)packet->y >> 8);
+        payload[7] = (uint8_t)((uint32_t)packet->y >> 16);
+        payload[8] = (uint8_t)((uint32_t)packet->y >> 24);
+        payload[9] = (uint8_t)packet->z;
+        payload[10] = (uint8_t)((uint32_t)packet->z >> 8);
+        payload[11] = (uint8_t)((uint32_t)packet->z >> 16);
+        payload[12] = (uint8_t)((uint32_t)packet->z >> 24);
+        return payload + 13;
+    }
+
+    uint8_t* Packets_PackClick(uint8_t* payload, const Packets_Click* packet)
+    {
+        payload[0] = (uint8_t)packet->source;
+        payload[1] = (uint8_t)packet->sample_count;
+        payload[2] = (uint8_t)((uint32_t)packet->sample_count >> 8);
+        payload[3] = (uint8_t)((uint32_t)packet->sample_count >> 16);
+        payload[4] = (uint8_t)((uint32_t)packet->sample_count >> 24);
+        return payload + 5;
+    }
+
+    uint8_t* Packets_PackAuxiliary(uint8_t* payload, const Packets_Auxiliary* packet)
+    {
+        payload[0] = (uint8_t)packet->sample_count;
+        payload[1] = (uint8_t)((uint32_t)packet->sample_count >> 8);
+        payload[2] = (uint8_t)((uint32_t)packet->sample_count >> 16);
+        payload[3] = (uint8_t)((uint32_t)packet->sample_count >> 24);
+        payload[4] = (uint8_t)packet->adc1;
+        payload[5] = (uint8_t)((uint16_t)packet->adc1 >> 8);
+        payload[6] = (uint8_t)packet->adc2;
+        payload[7] = (uint8_t)((uint16_t)packet->adc2 >> 8);
+        payload[8] = (uint8_t)packet->adc3;
+        payload[9] = (uint8_t)((uint16_t)packet->adc3 >> 8);
+        return payload + 10;
+    }
+
+    uint8_t* Packets_PackTilt(uint8_t* payload, const Packets_Tilt* packet)
+    {
+        payload[0] = (uint8_t)packet->first_index;
+        payload[1] = (uint8_t)((uint32_t)packet->first_index >> 8);
+        payload[2] = (uint8_t)((uint32_t)packet->first_index >> 16);
+        payload[3] = (uint8_t)((uint32_t)packet->first_index >> 24);
+        payload[4] = (uint8_t)packet->pitch;
+        payload[5] = (uint8_t)((uint16_t)packet->pitch >> 8);
+        payload[6] = (uint8_t)packet->roll;
+        payload[7] = (uint8_t)((uint16_t)packet->roll >> 8);
+        return payload + 8;
+    }
+
+    uint8_t* Packets_PackVelocity(uint8_t* payload, const Packets_Velocity* packet)
+    {
+        payload[0] = (uint8_t)packet->first_index;
+        payload[1] = (uint8_t)((uint32_t)packet->first_index >> 8);
+        payload[2] = (uint8_t)((uint32_t)packet->first_index >> 16);
+        payload[3] = (uint8_t)((uint32_t)packet->first_index >> 24);
+        payload[4] = (uint8_t)packet->count;
+        payload[5] = (uint8_t)((uint16_t)packet->count >> 8);
+        payload[6] = (uint8_t)packet->x_rms;
+        payload[7] = (uint8_t)((uint32_t)packet->x_rms >> 8);
+        payload[8] = (uint8_t)((uint32_t)packet->x_rms >> 16);
+        payload[9] = (uint8_t)((uint32_t)packet->x_rms >> 24);
+        payload[10] = (uint8_t)packet->y_rms;
+        payload[11] = (uint8_t)((uint32_t)packet->y_rms >> 8);
+        payload[12] = (uint8_t)((uint32_t)packet->y_rms >> 16);
+        payload[13] = (uint8_t)((uint32_t)packet->y_rms >> 24);
+        payload[14] = (uint8_t)packet->z_rms;
+        payload[15] = (uint8_t)((uint32_t)packet->z_rms >> 8);
+        payload[16] = (uint8_t)((uint32_t)packet->z_rms >> 16);
+        payload[17] = (uint8_t)((uint32_t)packet->z_rms >> 24);
+        return payload + 18;
+    }
+
+    uint8_t* Packets_PackDeviceSample(uint8_t* payload, const Packets_DeviceSample* packet)
+    {
+        payload[0] = (uint8_t)packet->device;
+        payload[1] = (uint8_t)packet->x;
+        payload[2] = (uint8_t)((uint32_t)packet->x >> 8);
+        payload[3] = (uint8_t)((uint32_t)packet->x >> 16);
+        payload[4] = (uint8_t)((uint32_t)packet->x >> 24);
+        payload[5] = (uint8_t)packet->y;
+        payload[6] = (uint8_t)((uint32_t)packet->y >> 8);
+        payload[7] = (uint8_t)((uint32_t)packet->y >> 16);
+        payload[8] = (uint8_t)((uint32_t)packet->y >> 24);
+        payload[9] = (uint8_t)packet->z;
+        payload[10] = (uint8_t)((uint32_t)packet->z >> 8);
+        payload[11] = (uint8_t)((uint32_t)packet->z >> 16);
+        payload[12] = (uint8_t)((uint32_t)packet->z >> 24);
+        return payload + 13;
+    }
+
+    uint8_t* Packets_PackSync(uint8_t* payload, const Packets_Sync* packet)
+    {
+        payload[0] = (uint8_t)packet->tick;
+        payload[1] = (uint8_t)((uint32_t)packet->tick >> 8);
+        payload[2] = (uint8_t)((uint32_t)packet->tick >> 16);
+        payload[3] = (uint8_t)((uint32_t)packet->tick >> 24);
+        payload[4] = (uint8_t)packet->timestamp;
+        payload[5] = (uint8_t)((uint32_t)packet->timestamp >> 8);
+        payload[6] = (uint8_t)((uint32_t)packet->timestamp >> 16);
+        payload[7] = (uint8_t)((uint32_t)packet->timestamp >> 24);
+        payload[8] = (uint8_t)packet->sample_count;
+        payload[9] = (uint8_t)((uint32_t)packet->sample_count >> 8);
+        payload[10] = (uint8_t)((uint32_t)packet->sample_count >> 16);
+        payload[11] = (uint8_t)((uint32_t)packet->sample_count >> 24);
+        payload[12] = (uint8_t)packet->tx_pending;
+        payload[13] = (uint8_t)((uint16_t)packet->tx_pending >> 8);
+        return payload + 14;
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,223 @@
+/**
+*   \file Packets.h
+*   \brief Fixed-layout frames sent to the host over UART.
+*
+*   Generated by Host_Tools/packetgen.py from Host_Tools/packets.json: do
+*   not edit, change the schema and run the generator. For each frame:
+*   the header byte, the length of the payload, a structure with the
+*   fields and a function that writes them in little endian order. The
+*   frames of variable length are described in Frames.h.
+*/
+
+#ifndef Packets_H
+    #define Packets_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Header of the sample frame, plotted by the Bridge Control
+    *   Panel.
+    *
+    *   Payload: x [mm/s^2] (int32), y [mm/s^2] (int32), z [mm/s^2]
+    *   (int32).
+    */
+    #define FRAME_HEADER_SAMPLE 0xA0
+    #define PACKETS_SAMPLE_LENGTH 12
+
+    typedef struct {
+        int32_t x; ///< [mm/s^2]
+        int32_t y; ///< [mm/s^2]
+        int32_t z; ///< [mm/s^2]
+    } Packets_Sample;
+
+    uint8_t* Packets_PackSample(uint8_t* payload, const Packets_Sample* packet);
+
+    /**
+    *   \brief Header of the rate change frame.
+    *
+    *   Payload: new output rate [Hz] (uint16), number of samples sent
+    *   before the change (uint32), Timer tick of the change (uint32).
+    */
+    #define FRAME_HEADER_RATE 0xA1
+    #define PACKETS_RATE_LENGTH 10
+
+    typedef struct {
+        uint16_t rate;         ///< [Hz]
+        uint32_t sample_count;
+        uint32_t tick;
+    } Packets_Rate;
+
+    uint8_t* Packets_PackRate(uint8_t* payload, const Packets_Rate* packet);
+
+    /**
+    *   \brief Header of the summary frame of the statistics mode. The
+    *   peak-to-peak value is max - min.
+    *
+    *   Payload: index of the first sample of the window (uint32),
+    *   samples of the window (uint16), x_mean [mm/s^2] (int32), x_rms
+    *   [mm/s^2] (uint32), x_min [mm/s^2] (int32), x_max [mm/s^2]
+    *   (int32), y_mean [mm/s^2] (int32), y_rms [mm/s^2] (uint32), y_min
+    *   [mm/s^2] (int32), y_max [mm/s^2] (int32), z_mean [mm/s^2]
+    *   (int32), z_rms [mm/s^2] (uint32), z_min [mm/s^2] (int32), z_max
+    *   [mm/s^2] (int32), RMS of the magnitude [mm/s^2] (uint32).
+    */
+    #define FRAME_HEADER_SUMMARY 0xA3
+    #define PACKETS_SUMMARY_LENGTH 58
+
+    typedef struct {
+        uint32_t first_index;
+        uint16_t count;
+        int32_t x_mean;         ///< [mm/s^2]
+        uint32_t x_rms;         ///< [mm/s^2]
+        int32_t x_min;          ///< [mm/s^2]
+        int32_t x_max;          ///< [mm/s^2]
+        int32_t y_mean;         ///< [mm/s^2]
+        uint32_t y_rms;         ///< [mm/s^2]
+        int32_t y_min;          ///< [mm/s^2]
+        int32_t y_max;          ///< [mm/s^2]
+        int32_t z_mean;         ///< [mm/s^2]
+        uint32_t z_rms;         ///< [mm/s^2]
+        int32_t z_min;          ///< [mm/s^2]
+        int32_t z_max;          ///< [mm/s^2]
+        uint32_t magnitude_rms; ///< [mm/s^2]
+    } Packets_Summary;
+
+    uint8_t* Packets_PackSummary(uint8_t* payload, const Packets_Summary* packet);
+
+    /**
+    *   \brief Header of the decimated sample frame. The rate of the
+    *   stream is the output data rate / factor.
+    *
+    *   Payload: decimation factor (uint8), x [mm/s^2] (int32), y
+    *   [mm/s^2] (int32), z [mm/s^2] (int32).
+    */
+    #define FRAME_HEADER_DECIMATED 0xA5
+    #define PACKETS_DECIMATED_LENGTH 13
+
+    typedef struct {
+        uint8_t factor;
+        int32_t x;      ///< [mm/s^2]
+        int32_t y;      ///< [mm/s^2]
+        int32_t z;      ///< [mm/s^2]
+    } Packets_Decimated;
+
+    uint8_t* Packets_PackDecimated(uint8_t* payload, const Packets_Decimated* packet);
+
+    /**
+    *   \brief Header of the click event frame.
+    *
+    *   Payload: CLICK_SRC register of the LIS3DH (bit 5 double click,
+    *   bit 4 single click, bit 3 negative sign, bit 2-0 Z/Y/X axis)
+    *   (uint8), samples acquired when the click was read (uint32).
+    */
+    #define FRAME_HEADER_CLICK 0xA6
+    #define PACKETS_CLICK_LENGTH 5
+
+    typedef struct {
+        uint8_t source;
+        uint32_t sample_count;
+    } Packets_Click;
+
+    uint8_t* Packets_PackClick(uint8_t* payload, const Packets_Click* packet);
+
+    /**
+    *   \brief Header of the auxiliary (ADC/temperature) frame. ADC3 is
+    *   the temperature sensor: a relative, uncalibrated value.
+    *
+    *   Payload: samples acquired at the reading (uint32), 10-bit value
+    *   (int16), 10-bit value (int16), 10-bit value (int16).
+    */
+    #define FRAME_HEADER_AUXILIARY 0xA7
+    #define PACKETS_AUXILIARY_LENGTH 10
+
+    typedef struct {
+        uint32_t sample_count;
+        int16_t adc1;
+        int16_t adc2;
+        int16_t adc3;
+    } Packets_Auxiliary;
+
+    uint8_t* Packets_PackAuxiliary(uint8_t* payload, const Packets_Auxiliary* packet);
+
+    /**
+    *   \brief Header of the tilt frame: pitch and roll of the average
+    *   gravity vector.
+    *
+    *   Payload: index of the first sample of the interval (uint32),
+    *   pitch [0.01 degrees] (int16), roll [0.01 degrees] (int16).
+    */
+    #define FRAME_HEADER_TILT 0xA8
+    #define PACKETS_TILT_LENGTH 8
+
+    typedef struct {
+        uint32_t first_index;
+        int16_t pitch;        ///< [0.01 degrees]
+        int16_t roll;         ///< [0.01 degrees]
+    } Packets_Tilt;
+
+    uint8_t* Packets_PackTilt(uint8_t* payload, const Packets_Tilt* packet);
+
+    /**
+    *   \brief Header of the velocity summary frame, for vibration
+    *   severity in [mm/s].
+    *
+    *   Payload: index of the first sample of the window (uint32),
+    *   samples of the window (uint16), x_rms [um/s] (uint32), y_rms
+    *   [um/s] (uint32), z_rms [um/s] (uint32).
+    */
+    #define FRAME_HEADER_VELOCITY 0xA9
+    #define PACKETS_VELOCITY_LENGTH 18
+
+    typedef struct {
+        uint32_t first_index;
+        uint16_t count;
+        uint32_t x_rms;       ///< [um/s]
+        uint32_t y_rms;       ///< [um/s]
+        uint32_t z_rms;       ///< [um/s]
+    } Packets_Velocity;
+
+    uint8_t* Packets_PackVelocity(uint8_t* payload, const Packets_Velocity* packet);
+
+    /**
+    *   \brief Header of the sample frame of the other accelerometers,
+    *   sent with the raw stream when their output is on (command 'O').
+    *   The samples of device 0 use the sample frame.
+    *
+    *   Payload: device id, 1 ... DEVICE_MAX - 1 (uint8), x [mm/s^2]
+    *   (int32), y [mm/s^2] (int32), z [mm/s^2] (int32).
+    */
+    #define FRAME_HEADER_DEVICE_SAMPLE 0xAA
+    #define PACKETS_DEVICE_SAMPLE_LENGTH 13
+
+    typedef struct {
+        uint8_t device;
+        int32_t x;      ///< [mm/s^2]
+        int32_t y;      ///< [mm/s^2]
+        int32_t z;      ///< [mm/s^2]
+    } Packets_DeviceSample;
+
+    uint8_t* Packets_PackDeviceSample(uint8_t* payload, const Packets_DeviceSample* packet);
+
+    /**
+    *   \brief Header of the clock sync frame, sent every
+    *   ACQUISITION_SYNC_PERIOD ticks. The host pairs each frame with
+    *   its arrival time to map the device clock on the host clock.
+    *
+    *   Payload: Timer tick (uint32), same clock as the timestamp frame
+    *   [us] (uint32), samples acquired (uint32), bytes waiting in the
+    *   UART TX buffer before the frame (uint16).
+    */
+    #define FRAME_HEADER_SYNC 0xAC
+    #define PACKETS_SYNC_LENGTH 14
+
+    typedef struct {
+        uint32_t tick;
+        uint32_t timestamp;    ///< [us]
+        uint32_t sample_count;
+        uint16_t tx_pending;
+    } Packets_Sync;
+
+    uint8_t* Packets_PackSync(uint8_t* payload, const Packets_Sync* packet);
+
+#endif // Packets_H
+/* [] END OF FILE */
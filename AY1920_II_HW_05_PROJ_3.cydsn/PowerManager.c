@@ -0,0 +1,125 @@
+/*
+* This file includes the power management of the acquisition loop.
+*/
+
+#include "PowerManager.h"
+#include "InterruptRoutines.h"
+#include "project.h"
+#include "cyPm.h"
+
+static PowerMode power_mode = POWER_MODE_SLEEP;
+
+static uint32_t window_start_tick = 0;
+static uint32_t segment_start = 0;      // cycle counter when the CPU last woke up
+static uint64_t active_cycles = 0;      // awake cycles of the closed segments
+static uint32_t sleeps = 0;
+static uint32_t samples = 0;
+
+    void PowerManager_Start(void)
+    {
+        // Enable the DWT cycle counter
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        PowerManager_ResetStats();
+    }
+
+    ErrorCode PowerManager_SetMode(PowerMode mode)
+    {
+        if (mode > POWER_MODE_ALT_ACTIVE)
+        {
+            return ERROR;
+        }
+        power_mode = mode;
+        PowerManager_ResetStats();
+        return NO_ERROR;
+    }
+
+    PowerMode PowerManager_GetMode(void)
+    {
+        return power_mode;
+    }
+
+    void PowerManager_Idle(uint32_t now, uint32_t next_release)
+    {
+        (void)next_release; // the Timer ISR wakes up the CPU at every tick
+
+        if (power_mode == POWER_MODE_ACTIVE)
+        {
+            // Busy wait: the scheduler polls again immediately
+            return;
+        }
+
+        uint8 interrupt_state = CyEnterCriticalSection();
+        if (Timer_Tick == now) // no tick in the meantime
+        {
+            // Close the awake segment: the cycle counter is not guaranteed
+            // to count while the core is stopped, so it is read on both sides
+            active_cycles += (uint32_t)(DWT->CYCCNT - segment_start);
+            if (power_mode == POWER_MODE_SLEEP)
+            {
+                CY_PM_WFI; // a pending interrupt wakes up the CPU even if masked
+            }
+            else
+            {
+                CyPmAltAct(PM_ALT_ACT_TIME_NONE, PM_ALT_ACT_SRC_INTERRUPT);
+            }
+            segment_start = DWT->CYCCNT;
+            sleeps++;
+        }
+        CyExitCriticalSection(interrupt_state);
+    }
+
+    uint32_t PowerManager_ReadCycles(void)
+    {
+        return DWT->CYCCNT;
+    }
+
+    void PowerManager_CountSample(void)
+    {
+        samples++;
+    }
+
+    void PowerManager_GetStats(PowerStats* stats)
+    {
+        uint8 interrupt_state = CyEnterCriticalSection();
+        stats->ticks = Timer_Tick - window_start_tick;
+        if (power_mode == POWER_MODE_ACTIVE)
+        {
+            // Busy wait: the CPU is never stopped
+            stats->active_cycles = (uint64_t)stats->ticks * POWER_CYCLES_PER_TICK;
+        }
+        else
+        {
+            stats->active_cycles = active_cycles + (uint32_t)(DWT->CYCCNT - segment_start);
+        }
+        stats->sleeps = sleeps;
+        stats->samples = samples;
+        CyExitCriticalSection(interrupt_state);
+    }
+
+    uint16_t PowerManager_GetDutyCycle(void)
+    {
+        PowerStats stats;
+        PowerManager_GetStats(&stats);
+        uint64_t elapsed = (uint64_t)stats.ticks * POWER_CYCLES_PER_TICK;
+        if (elapsed == 0)
+        {
+            return 1000;
+        }
+        uint64_t duty = stats.active_cycles * 1000u / elapsed;
+        return duty > 1000 ? 1000 : (uint16_t)duty;
+    }
+
+    void PowerManager_ResetStats(void)
+    {
+        uint8 interrupt_state = CyEnterCriticalSection();
+        window_start_tick = Timer_Tick;
+        segment_start = DWT->CYCCNT;
+        active_cycles = 0;
+        sleeps = 0;
+        samples = 0;
+        CyExitCriticalSection(interrupt_state);
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,90 @@
+/**
+*   \file PowerManager.h
+*   \brief Low-power idle handling and duty cycle instrumentation.
+*
+*   The power manager is the idle hook of the scheduler: between two Timer
+*   ticks the CPU is put in the selected low-power mode and woken up by the
+*   Timer interrupt. The time spent awake is measured with the DWT cycle
+*   counter, read right before entering and right after leaving low power.
+*/
+
+#ifndef PowerManager_H
+    #define PowerManager_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Number of CPU cycles in a Timer tick (10 ms).
+    */
+    #define POWER_CYCLES_PER_TICK (BCLK__BUS_CLK__HZ / 100u)
+
+    /**
+    *   \brief Power modes used when no task is ready.
+    */
+    typedef enum {
+        POWER_MODE_ACTIVE,      ///< Busy wait, the CPU is never stopped
+        POWER_MODE_SLEEP,       ///< CPU sleep (WFI), peripherals in Active mode
+        POWER_MODE_ALT_ACTIVE   ///< Alternate Active mode through cyPm, woken by interrupt
+    } PowerMode;
+
+    /**
+    *   \brief Duty cycle statistics since the last reset.
+    */
+    typedef struct {
+        uint32_t ticks;             ///< Elapsed Timer ticks
+        uint64_t active_cycles;     ///< CPU cycles spent awake
+        uint32_t sleeps;            ///< Number of low-power entries
+        uint32_t samples;           ///< Samples acquired in the same window
+    } PowerStats;
+
+    /**
+    *   \brief Start the cycle counter and reset the statistics.
+    */
+    void PowerManager_Start(void);
+
+    /**
+    *   \brief Select the power mode used when the CPU is idle.
+    */
+    ErrorCode PowerManager_SetMode(PowerMode mode);
+
+    /**
+    *   \brief Currently selected power mode.
+    */
+    PowerMode PowerManager_GetMode(void);
+
+    /**
+    *   \brief Idle hook of the scheduler.
+    *
+    *   Enter the selected power mode unless the tick has already changed
+    *   from \p now, so that a Timer interrupt is never missed.
+    */
+    void PowerManager_Idle(uint32_t now, uint32_t next_release);
+
+    /**
+    *   \brief Free-running CPU cycle counter.
+    */
+    uint32_t PowerManager_ReadCycles(void);
+
+    /**
+    *   \brief Account a sample acquired, used for the awake time per sample.
+    */
+    void PowerManager_CountSample(void);
+
+    /**
+    *   \brief Copy the duty cycle statistics.
+    */
+    void PowerManager_GetStats(PowerStats* stats);
+
+    /**
+    *   \brief Active duty cycle in tenths of percent (0 - 1000).
+    */
+    uint16_t PowerManager_GetDutyCycle(void);
+
+    /**
+    *   \brief Restart the statistics window.
+    */
+    void PowerManager_ResetStats(void);
+
+#endif // PowerManager_H
+/* [] END OF FILE */
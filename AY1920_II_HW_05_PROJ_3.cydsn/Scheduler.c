@@ -0,0 +1,192 @@
+/*
+* This file includes the cooperative scheduler. It does not depend on the
+* PSoC generated code, so it can be compiled on a host PC too.
+*/
+
+#include <stddef.h>
+#include "Scheduler.h"
+
+/**
+*   \brief True if tick \p a is at or after tick \p b (wrap-around safe).
+*/
+#define TICK_REACHED(a, b) ((int32_t)((uint32_t)(a) - (uint32_t)(b)) >= 0)
+
+static Scheduler_Task tasks[SCHEDULER_MAX_TASKS];
+static uint8_t task_count = 0;
+
+static Scheduler_ClockSource get_tick = NULL;
+static Scheduler_ClockSource get_cycles = NULL;
+static Scheduler_IdleHook idle = NULL;
+
+static uint8_t retry_requested = 0;
+
+    ErrorCode Scheduler_Init(Scheduler_ClockSource tick_source,
+                             Scheduler_ClockSource cycle_source,
+                             Scheduler_IdleHook idle_hook)
+    {
+        if (tick_source == NULL || cycle_source == NULL)
+        {
+            return ERROR;
+        }
+        get_tick = tick_source;
+        get_cycles = cycle_source;
+        idle = idle_hook;
+        task_count = 0;
+        return NO_ERROR;
+    }
+
+    ErrorCode Scheduler_AddTask(const char* name,
+                                Scheduler_TaskFunction function,
+                                uint32_t period,
+                                uint32_t deadline,
+                                uint32_t offset,
+                                uint8_t* task_id)
+    {
+        if (get_tick == NULL || function == NULL || period == 0 ||
+            deadline > period || task_count >= SCHEDULER_MAX_TASKS)
+        {
+            return ERROR;
+        }
+
+        Scheduler_Task* task = &tasks[task_count];
+        task->name = name;
+        task->function = function;
+        task->period = period;
+        task->deadline = deadline ? deadline : period;
+        task->next_release = get_tick() + offset;
+        task->enabled = 1;
+        Scheduler_TaskStats empty = {0};
+        task->stats = empty;
+
+        if (task_id != NULL)
+        {
+            *task_id = task_count;
+        }
+        task_count++;
+        return NO_ERROR;
+    }
+
+    ErrorCode Scheduler_SetEnabled(uint8_t task_id, uint8_t enabled)
+    {
+        if (task_id >= task_count)
+        {
+            return ERROR;
+        }
+        if (enabled && !tasks[task_id].enabled)
+        {
+            // Do not account the time spent disabled as lateness
+            tasks[task_id].next_release = get_tick();
+        }
+        tasks[task_id].enabled = enabled;
+        return NO_ERROR;
+    }
+
+    ErrorCode Scheduler_SetPeriod(uint8_t task_id, uint32_t period)
+    {
+        if (task_id >= task_count || period == 0)
+        {
+            return ERROR;
+        }
+        Scheduler_Task* task = &tasks[task_id];
+        // Keep the deadline relative to the period
+        if (task->deadline == task->period || task->deadline > period)
+        {
+            task->deadline = period;
+        }
+        task->period = period;
+        return NO_ERROR;
+    }
+
+    uint8_t Scheduler_RunOnce(void)
+    {
+        uint32_t now = get_tick();
+        uint32_t next_release = now + 0x7FFFFFFFu;
+
+        for (uint8_t i = 0; i < task_count; i++)
+        {
+            Scheduler_Task* task = &tasks[i];
+            if (!task->enabled)
+            {
+                continue;
+            }
+            if (!TICK_REACHED(now, task->next_release))
+            {
+                if (!TICK_REACHED(task->next_release, next_release))
+                {
+                    next_release = task->next_release;
+                }
+                continue;
+            }
+
+            // The task is ready: releases older than one period are lost
+            uint32_t release = task->next_release;
+            uint32_t lateness = now - release;
+            if (lateness >= task->period)
+            {
+                uint32_t lost = lateness / task->period;
+                task->stats.skipped += lost;
+                release += lost * task->period;
+                lateness -= lost * task->period;
+            }
+            task->next_release = release + task->period;
+            if (lateness > task->stats.max_lateness)
+            {
+                task->stats.max_lateness = lateness;
+            }
+
+            retry_requested = 0;
+            uint32_t start = get_cycles();
+            task->function();
+            uint32_t elapsed = get_cycles() - start;
+            if (retry_requested)
+            {
+                task->next_release = release;
+            }
+
+            task->stats.runs++;
+            task->stats.last_cycles = elapsed;
+            task->stats.total_cycles += elapsed;
+            if (elapsed > task->stats.max_cycles)
+            {
+                task->stats.max_cycles = elapsed;
+            }
+            if (!TICK_REACHED(release + task->deadline, get_tick() + 1))
+            {
+                // Completed in a tick after the one of the deadline
+                task->stats.overruns++;
+            }
+            return 1;
+        }
+
+        if (idle != NULL)
+        {
+            idle(now, next_release);
+        }
+        return 0;
+    }
+
+    void Scheduler_Retry(void)
+    {
+        retry_requested = 1;
+    }
+
+    uint8_t Scheduler_GetTaskCount(void)
+    {
+        return task_count;
+    }
+
+    const Scheduler_Task* Scheduler_GetTask(uint8_t task_id)
+    {
+        return task_id < task_count ? &tasks[task_id] : NULL;
+    }
+
+    void Scheduler_ResetStats(void)
+    {
+        Scheduler_TaskStats empty = {0};
+        for (uint8_t i = 0; i < task_count; i++)
+        {
+            tasks[i].stats = empty;
+        }
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,147 @@
+/**
+*   \file Scheduler.h
+*   \brief Cooperative run-to-completion task scheduler.
+*
+*   Tasks are kept in a fixed table and released periodically on a tick
+*   provided by the caller. The scheduler does not include any PSoC header:
+*   the tick source, the cycle counter used to measure the execution time
+*   and the idle hook are passed in at initialization, so the same code runs
+*   on the device (Timer ISR + DWT cycle counter + WFI) and on a host PC
+*   against a fake tick source.
+*
+*   Tasks are served in table order, so the first task added has the
+*   highest priority. A task is never preempted by another task.
+*/
+
+#ifndef Scheduler_H
+    #define Scheduler_H
+
+    #include <stdint.h>
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Maximum number of tasks in the task table: the 9 tasks of
+    *   main.c and room for 3 more.
+    */
+    #define SCHEDULER_MAX_TASKS 12
+
+    /**
+    *   \brief Function executed by a task. It must run to completion.
+    */
+    typedef void (*Scheduler_TaskFunction)(void);
+
+    /**
+    *   \brief Function returning a free-running 32-bit counter.
+    */
+    typedef uint32_t (*Scheduler_ClockSource)(void);
+
+    /**
+    *   \brief Function called when no task is ready.
+    *
+    *   \param now Tick at which the scheduler found no ready task.
+    *   \param next_release Tick of the earliest next task release.
+    *   The hook must return as soon as the tick changes from \p now.
+    */
+    typedef void (*Scheduler_IdleHook)(uint32_t now, uint32_t next_release);
+
+    /**
+    *   \brief Execution statistics of a task.
+    */
+    typedef struct {
+        uint32_t runs;          ///< Number of completed executions
+        uint32_t overruns;      ///< Executions completed after their deadline
+        uint32_t skipped;       ///< Releases lost because the task was late by more than a period
+        uint32_t last_cycles;   ///< Execution time of the last run [cycles]
+        uint32_t max_cycles;    ///< Worst execution time [cycles]
+        uint64_t total_cycles;  ///< Sum of all execution times [cycles]
+        uint32_t max_lateness;  ///< Worst delay between release and start [ticks]
+    } Scheduler_TaskStats;
+
+    /**
+    *   \brief Entry of the task table.
+    */
+    typedef struct {
+        const char* name;                   ///< Name used in diagnostics
+        Scheduler_TaskFunction function;    ///< Task body
+        uint32_t period;                    ///< Release period [ticks]
+        uint32_t deadline;                  ///< Relative deadline [ticks], at most the period
+        uint32_t next_release;              ///< Tick of the next release
+        uint8_t enabled;                    ///< Released only when not zero
+        Scheduler_TaskStats stats;          ///< Execution statistics
+    } Scheduler_Task;
+
+    /**
+    *   \brief Initialize the scheduler with an empty task table.
+    *
+    *   \param tick_source Clock used to release tasks.
+    *   \param cycle_source Clock used to measure execution times.
+    *   \param idle_hook Function called when no task is ready (may be NULL).
+    */
+    ErrorCode Scheduler_Init(Scheduler_ClockSource tick_source,
+                             Scheduler_ClockSource cycle_source,
+                             Scheduler_IdleHook idle_hook);
+
+    /**
+    *   \brief Add a periodic task to the task table.
+    *
+    *   \param name Name of the task.
+    *   \param function Task body.
+    *   \param period Release period [ticks], must be greater than 0.
+    *   \param deadline Relative deadline [ticks], 0 means equal to the period.
+    *   \param offset Delay of the first release [ticks].
+    *   \param task_id Pointer where the index of the task is saved (may be NULL).
+    */
+    ErrorCode Scheduler_AddTask(const char* name,
+                                Scheduler_TaskFunction function,
+                                uint32_t period,
+                                uint32_t deadline,
+                                uint32_t offset,
+                                uint8_t* task_id);
+
+    /**
+    *   \brief Enable or disable a task.
+    *
+    *   A task that is enabled again is released at the next tick.
+    */
+    ErrorCode Scheduler_SetEnabled(uint8_t task_id, uint8_t enabled);
+
+    /**
+    *   \brief Change the release period of a task.
+    */
+    ErrorCode Scheduler_SetPeriod(uint8_t task_id, uint32_t period);
+
+    /**
+    *   \brief Run the highest priority ready task, or call the idle hook.
+    *
+    *   \retval Returns 1 if a task was executed, 0 otherwise.
+    */
+    uint8_t Scheduler_RunOnce(void);
+
+    /**
+    *   \brief Keep the running task ready after it returns.
+    *
+    *   Called from inside a task that could not complete its job (e.g. data
+    *   not available yet): the task is released again at the next call of
+    *   Scheduler_RunOnce() instead of waiting for its next period.
+    */
+    void Scheduler_Retry(void);
+
+    /**
+    *   \brief Number of tasks in the task table.
+    */
+    uint8_t Scheduler_GetTaskCount(void);
+
+    /**
+    *   \brief Read-only access to an entry of the task table.
+    *
+    *   \retval Returns NULL if \p task_id is out of range.
+    */
+    const Scheduler_Task* Scheduler_GetTask(uint8_t task_id);
+
+    /**
+    *   \brief Reset the statistics of all the tasks.
+    */
+    void Scheduler_ResetStats(void);
+
+#endif // Scheduler_H
+/* [] END OF FILE */
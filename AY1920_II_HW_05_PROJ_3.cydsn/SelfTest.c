@@ -0,0 +1,135 @@
+/*
+* This file includes the boot-time self-test of the accelerometer.
+*/
+
+#include "SelfTest.h"
+#include "I2C_Interface.h"
+#include "LIS3DH_Registers.h"
+#include "project.h"
+
+    /**
+    *   \brief Wait for a new sample and read it.
+    *
+    *   \param sample X, Y, Z in 10-bit left justified format, shifted down.
+    */
+    static ErrorCode SelfTest_ReadSample(int16_t sample[3])
+    {
+        uint8_t status = 0;
+        uint8_t waited = 0;
+        do
+        {
+            if (I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_STATUS_REG, &status) != NO_ERROR ||
+                waited++ >= SELFTEST_TIMEOUT_MS)
+            {
+                return ERROR;
+            }
+            if (!(status & LIS3DH_STATUS_REG_ZYXDA))
+            {
+                CyDelay(1);
+            }
+        } while (!(status & LIS3DH_STATUS_REG_ZYXDA));
+
+        uint8_t data[6];
+        if (I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS, LIS3DH_OUT_X_L, 6, data) != NO_ERROR)
+        {
+            return ERROR;
+        }
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            sample[axis] = (int16)(data[2 * axis] | (data[2 * axis + 1] << 8)) >> 6; //Normal mode: 10-bit data
+        }
+        return NO_ERROR;
+    }
+
+    /**
+    *   \brief Discard the samples acquired while the output settles, then
+    *   average SELFTEST_SAMPLES samples.
+    */
+    static ErrorCode SelfTest_Average(int16_t average[3])
+    {
+        int16_t sample[3];
+        int16_t sum[3] = {0, 0, 0};
+        for (uint8_t n = 0; n < SELFTEST_SETTLE_SAMPLES + SELFTEST_SAMPLES; n++)
+        {
+            if (SelfTest_ReadSample(sample) != NO_ERROR)
+            {
+                return ERROR;
+            }
+            if (n >= SELFTEST_SETTLE_SAMPLES)
+            {
+                for (uint8_t axis = 0; axis < 3; axis++)
+                {
+                    sum[axis] += sample[axis];
+                }
+            }
+        }
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            average[axis] = sum[axis] / SELFTEST_SAMPLES;
+        }
+        return NO_ERROR;
+    }
+
+    ErrorCode SelfTest_Run(SelfTest_Result* result)
+    {
+        result->failed_axes = 0x07;
+        result->error = ERROR;
+
+        uint8_t ctrl_reg4;
+        if (I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG4, &ctrl_reg4) != NO_ERROR)
+        {
+            return ERROR;
+        }
+
+        // Samples straight from the output registers, unfiltered
+        ErrorCode error = I2C_Peripheral_UpdateRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG5,
+                                                        LIS3DH_CTRL_REG5_FIFO_EN, 0);
+        if (error == NO_ERROR)
+        {
+            error = I2C_Peripheral_UpdateRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG2,
+                                                  LIS3DH_CTRL_REG2_FDS, 0);
+        }
+        if (error == NO_ERROR)
+        {
+            error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG4,
+                                                 LIS3DH_NORMAL_MODE_2G_CTRL_REG4);
+        }
+        if (error == NO_ERROR)
+        {
+            error = SelfTest_Average(result->off);
+        }
+        if (error == NO_ERROR)
+        {
+            error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG4,
+                                                 LIS3DH_NORMAL_MODE_2G_CTRL_REG4 | LIS3DH_CTRL_REG4_ST_0);
+        }
+        if (error == NO_ERROR)
+        {
+            error = SelfTest_Average(result->on);
+        }
+
+        // Restore the configuration even after a failure
+        if (I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG4, ctrl_reg4) != NO_ERROR)
+        {
+            error = ERROR;
+        }
+        if (error != NO_ERROR)
+        {
+            return ERROR;
+        }
+
+        result->error = NO_ERROR;
+        result->failed_axes = 0;
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            result->change[axis] = result->on[axis] - result->off[axis];
+            int16_t magnitude = result->change[axis] < 0 ? -result->change[axis] : result->change[axis];
+            if (magnitude < SELFTEST_MIN_CHANGE || magnitude > SELFTEST_MAX_CHANGE)
+            {
+                result->failed_axes |= 1 << axis;
+            }
+        }
+        return result->failed_axes ? ERROR : NO_ERROR;
+    }
+
+/* [] END OF FILE */
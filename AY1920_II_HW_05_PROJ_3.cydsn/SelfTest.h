@@ -0,0 +1,74 @@
+/**
+*   \file SelfTest.h
+*   \brief Boot-time validation with the LIS3DH built-in self-test.
+*
+*   The self-test applies an electrostatic force to the proof mass, so each
+*   working axis shows a known output change. The averages of
+*   SELFTEST_SAMPLES samples with the self-test off and on are compared and
+*   the change of every axis must be within the datasheet limits (Normal
+*   mode, ±2 g). An axis that is stuck or disconnected does not move and
+*   fails the test, even when WHO_AM_I reads correctly.
+*
+*   The test reads at most SELFTEST_MAX_SAMPLES samples and waits at most
+*   SELFTEST_TIMEOUT_MS for each one, so at 100 Hz it takes about 160 ms
+*   and never more than SELFTEST_MAX_SAMPLES * SELFTEST_TIMEOUT_MS.
+*/
+
+#ifndef SelfTest_H
+    #define SelfTest_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Samples averaged with the self-test off and on
+    */
+    #define SELFTEST_SAMPLES 5
+
+    /**
+    *   \brief Samples discarded after each change of the configuration
+    *   (the output settles in about 3 ODR periods)
+    */
+    #define SELFTEST_SETTLE_SAMPLES 3
+
+    /**
+    *   \brief Maximum number of samples read by the test
+    */
+    #define SELFTEST_MAX_SAMPLES (2 * (SELFTEST_SETTLE_SAMPLES + SELFTEST_SAMPLES))
+
+    /**
+    *   \brief Maximum wait for a new sample [ms] (2.5 ODR periods at 100 Hz)
+    */
+    #define SELFTEST_TIMEOUT_MS 25
+
+    /**
+    *   \brief Limits of the output change [LSb of the 10-bit Normal mode at ±2 g]
+    */
+    #define SELFTEST_MIN_CHANGE 17
+    #define SELFTEST_MAX_CHANGE 360
+
+    /**
+    *   \brief Result of the self-test
+    */
+    typedef struct {
+        int16_t off[3];         ///< Average X, Y, Z with the self-test off [LSb]
+        int16_t on[3];          ///< Average X, Y, Z with the self-test on [LSb]
+        int16_t change[3];      ///< Output change on - off [LSb]
+        uint8_t failed_axes;    ///< Bit 0, 1, 2 set if X, Y, Z are out of the limits
+        ErrorCode error;        ///< ERROR if the sensor did not answer or produce data
+    } SelfTest_Result;
+
+    /**
+    *   \brief Run the self-test.
+    *
+    *   The FIFO and the high-pass filtered output are turned off; CTRL_REG4
+    *   is restored at the end. Call it after CTRL_REG1 is written (the ODR
+    *   must be running) and before Acquisition_Start().
+    *   \param result Pointer to the structure filled with the result.
+    *   \retval Returns ERROR if the communication failed or an axis is out
+    *   of the limits.
+    */
+    ErrorCode SelfTest_Run(SelfTest_Result* result);
+
+#endif // SelfTest_H
+/* [] END OF FILE */
@@ -0,0 +1,329 @@
+/*
+* This file includes the fixed-point spectrum engine. It does not depend on
+* the PSoC generated code, so it can be compiled on a host PC too.
+*/
+
+#include <stddef.h>
+#include "Spectrum.h"
+
+/**
+*   \brief sin(2*pi*i/SPECTRUM_MAX_POINTS) in Q15, i = 0 .. SPECTRUM_MAX_POINTS/4
+*/
+static const int16_t sine_table[SPECTRUM_MAX_POINTS / 4 + 1] = {
+        0,   402,   804,  1206,  1608,  2009,  2411,  2811,
+     3212,  3612,  4011,  4410,  4808,  5205,  5602,  5998,
+     6393,  6787,  7180,  7571,  7962,  8351,  8740,  9127,
+     9512,  9896, 10279, 10660, 11039, 11417, 11793, 12167,
+    12540, 12910, 13279, 13646, 14010, 14373, 14733, 15091,
+    15447, 15800, 16151, 16500, 16846, 17190, 17531, 17869,
+    18205, 18538, 18868, 19195, 19520, 19841, 20160, 20475,
+    20788, 21097, 21403, 21706, 22006, 22302, 22595, 22884,
+    23170, 23453, 23732, 24008, 24279, 24548, 24812, 25073,
+    25330, 25583, 25833, 26078, 26320, 26557, 26791, 27020,
+    27246, 27467, 27684, 27897, 28106, 28311, 28511, 28707,
+    28899, 29086, 29269, 29448, 29622, 29792, 29957, 30118,
+    30274, 30425, 30572, 30715, 30853, 30986, 31114, 31238,
+    31357, 31471, 31581, 31686, 31786, 31881, 31972, 32058,
+    32138, 32214, 32286, 32352, 32413, 32470, 32522, 32568,
+    32610, 32647, 32679, 32706, 32729, 32746, 32758, 32766,
+    32767,
+};
+
+/**
+*   \brief Default bands of a 256-point block, at 100 Hz about 0.4-1.5,
+*   1.5-5, 5-10, 10-20, 20-30 and 30-50 Hz
+*/
+static const uint16_t default_edges[] = {1, 4, 13, 26, 52, 77, 129};
+
+/**
+*   \brief Steps of the transform
+*/
+#define STEP_IDLE 0
+#define STEP_FIRST_STAGE 1
+
+static uint8_t axis = SPECTRUM_DEFAULT_AXIS;
+static uint16_t points = SPECTRUM_DEFAULT_POINTS;
+static uint8_t stages = 0;          // log2(points / 2)
+static uint8_t bands = 0;
+static uint16_t edges[SPECTRUM_MAX_BANDS + 1];
+
+// Block being collected
+static int32_t block[SPECTRUM_MAX_POINTS];
+static uint16_t collected = 0;
+static uint8_t block_full = 0;
+static uint32_t block_index = 0;
+
+// Block being transformed: points/2 complex values, real and imaginary interleaved
+static int16_t work[SPECTRUM_MAX_POINTS];
+static uint8_t step = STEP_IDLE;
+static uint32_t work_index = 0;
+static int8_t work_exponent = 0;
+
+    /**
+    *   \brief sin(2*pi*i/SPECTRUM_MAX_POINTS) in Q15 for any i.
+    */
+    static int16_t Spectrum_Sin(uint32_t i)
+    {
+        const uint32_t quarter = SPECTRUM_MAX_POINTS / 4;
+        i &= SPECTRUM_MAX_POINTS - 1;
+        if (i <= quarter)
+        {
+            return sine_table[i];
+        }
+        if (i <= 2 * quarter)
+        {
+            return sine_table[2 * quarter - i];
+        }
+        if (i <= 3 * quarter)
+        {
+            return -sine_table[i - 2 * quarter];
+        }
+        return -sine_table[4 * quarter - i];
+    }
+
+    static int16_t Spectrum_Cos(uint32_t i)
+    {
+        return Spectrum_Sin(i + SPECTRUM_MAX_POINTS / 4);
+    }
+
+    /**
+    *   \brief Rounded Q15 product.
+    */
+    static int32_t Spectrum_Mul(int32_t a, int32_t b)
+    {
+        return (a * b + (1 << 14)) >> 15;
+    }
+
+    static uint16_t Spectrum_BitReverse(uint16_t value, uint8_t bits)
+    {
+        uint16_t reversed = 0;
+        for (uint8_t i = 0; i < bits; i++)
+        {
+            reversed = (reversed << 1) | (value & 1);
+            value >>= 1;
+        }
+        return reversed;
+    }
+
+    void Spectrum_Init(void)
+    {
+        Spectrum_Configure(SPECTRUM_DEFAULT_AXIS,
+                           SPECTRUM_DEFAULT_POINTS,
+                           default_edges,
+                           sizeof(default_edges) / sizeof(default_edges[0]) - 1);
+    }
+
+    ErrorCode Spectrum_Configure(uint8_t new_axis,
+                                 uint16_t new_points,
+                                 const uint16_t* new_edges,
+                                 uint8_t new_bands)
+    {
+        if (new_axis > 2 || (new_points != 256 && new_points != 512) ||
+            new_points > SPECTRUM_MAX_POINTS || new_edges == NULL ||
+            new_bands == 0 || new_bands > SPECTRUM_MAX_BANDS ||
+            new_edges[new_bands] > new_points / 2 + 1)
+        {
+            return ERROR;
+        }
+        for (uint8_t b = 0; b < new_bands; b++)
+        {
+            if (new_edges[b] >= new_edges[b + 1])
+            {
+                return ERROR;
+            }
+        }
+
+        axis = new_axis;
+        points = new_points;
+        stages = 0;
+        while ((1u << (stages + 1)) < points)
+        {
+            stages++;
+        }
+        bands = new_bands;
+        for (uint8_t b = 0; b <= bands; b++)
+        {
+            edges[b] = new_edges[b];
+        }
+        collected = 0;
+        block_full = 0;
+        step = STEP_IDLE;
+        return NO_ERROR;
+    }
+
+    void Spectrum_AddSample(const int32_t acceleration[3], uint32_t index)
+    {
+        if (block_full)
+        {
+            return;
+        }
+        if (collected == 0)
+        {
+            block_index = index;
+        }
+        block[collected++] = acceleration[axis];
+        if (collected == points)
+        {
+            block_full = 1;
+        }
+    }
+
+    /**
+    *   \brief Move the collected block to the work buffer.
+    *
+    *   The mean is removed, the block is scaled so that the largest value
+    *   uses 14 bits (the FFT stages cannot overflow), windowed and stored
+    *   in bit-reversed order.
+    */
+    static void Spectrum_Load(void)
+    {
+        int64_t sum = 0;
+        for (uint16_t n = 0; n < points; n++)
+        {
+            sum += block[n];
+        }
+        int32_t mean = (int32_t)(sum / points);
+
+        int32_t largest = 0;
+        for (uint16_t n = 0; n < points; n++)
+        {
+            int32_t value = block[n] - mean;
+            value = value < 0 ? -value : value;
+            if (value > largest)
+            {
+                largest = value;
+            }
+        }
+        int8_t exponent = 0;
+        if (largest > 0)
+        {
+            while (largest > 16383)
+            {
+                largest >>= 1;
+                exponent--;
+            }
+            while (largest < 8192)
+            {
+                largest <<= 1;
+                exponent++;
+            }
+        }
+
+        for (uint16_t n = 0; n < points; n++)
+        {
+            int32_t value = block[n] - mean;
+            value = exponent >= 0 ? value << exponent : value >> -exponent;
+            // Hann window: (1 - cos(2*pi*n/N)) / 2
+            int32_t hann = (32767 - Spectrum_Cos((uint32_t)n * (SPECTRUM_MAX_POINTS / points))) >> 1;
+            uint16_t position = Spectrum_BitReverse(n >> 1, stages);
+            work[2 * position + (n & 1)] = (int16_t)Spectrum_Mul(value, hann);
+        }
+
+        work_index = block_index;
+        work_exponent = exponent;
+        collected = 0;
+        block_full = 0;
+    }
+
+    /**
+    *   \brief Radix-2 butterflies of one stage, scaled by 1/2.
+    */
+    static void Spectrum_Stage(uint8_t stage)
+    {
+        uint16_t complex_points = points / 2;
+        uint16_t half = 1u << stage;
+        uint32_t twiddle_step = (SPECTRUM_MAX_POINTS / complex_points) * (complex_points >> (stage + 1));
+
+        for (uint16_t start = 0; start < complex_points; start += 2 * half)
+        {
+            for (uint16_t j = 0; j < half; j++)
+            {
+                int32_t wr = Spectrum_Cos(j * twiddle_step);
+                int32_t wi = -Spectrum_Sin(j * twiddle_step);
+                int16_t* a = &work[2 * (start + j)];
+                int16_t* b = &work[2 * (start + j + half)];
+
+                int32_t tr = Spectrum_Mul(b[0], wr) - Spectrum_Mul(b[1], wi);
+                int32_t ti = Spectrum_Mul(b[0], wi) + Spectrum_Mul(b[1], wr);
+                int32_t ar = a[0];
+                int32_t ai = a[1];
+                a[0] = (int16_t)((ar + tr) >> 1);
+                a[1] = (int16_t)((ai + ti) >> 1);
+                b[0] = (int16_t)((ar - tr) >> 1);
+                b[1] = (int16_t)((ai - ti) >> 1);
+            }
+        }
+    }
+
+    /**
+    *   \brief Split the half-size complex FFT into the real FFT and sum the
+    *   power of the bins of each band.
+    */
+    static void Spectrum_Bands(Spectrum_Result* result)
+    {
+        uint16_t complex_points = points / 2;
+        uint64_t energy = 0;
+        uint8_t band = 0;
+
+        for (uint16_t k = edges[0]; k < edges[bands]; k++)
+        {
+            const int16_t* a = &work[2 * (k % complex_points)];
+            const int16_t* b = &work[2 * ((complex_points - k) % complex_points)];
+
+            // Twice the FFTs of the even and odd samples
+            int32_t even_r = a[0] + b[0];
+            int32_t even_i = a[1] - b[1];
+            int32_t odd_r = a[1] + b[1];
+            int32_t odd_i = b[0] - a[0];
+
+            // X[k] = E[k] + W^k O[k], divided by 4 to get the DFT / N
+            uint32_t angle = (uint32_t)k * (SPECTRUM_MAX_POINTS / points);
+            int32_t c = Spectrum_Cos(angle);
+            int32_t s = Spectrum_Sin(angle);
+            int32_t xr = (even_r + Spectrum_Mul(odd_r, c) + Spectrum_Mul(odd_i, s)) >> 2;
+            int32_t xi = (even_i + Spectrum_Mul(odd_i, c) - Spectrum_Mul(odd_r, s)) >> 2;
+            energy += (uint32_t)(xr * xr) + (uint32_t)(xi * xi);
+
+            if (k + 1 == edges[band + 1])
+            {
+                result->energy[band] = energy > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)energy;
+                energy = 0;
+                band++;
+            }
+        }
+
+        result->first_index = work_index;
+        result->points = points;
+        result->exponent = work_exponent;
+        result->bands = bands;
+        for (uint8_t b = 0; b <= bands; b++)
+        {
+            result->edges[b] = edges[b];
+        }
+    }
+
+    uint8_t Spectrum_Process(Spectrum_Result* result)
+    {
+        if (step == STEP_IDLE)
+        {
+            if (block_full)
+            {
+                Spectrum_Load();
+                step = STEP_FIRST_STAGE;
+            }
+            return 0;
+        }
+
+        if (step < STEP_FIRST_STAGE + stages)
+        {
+            Spectrum_Stage(step - STEP_FIRST_STAGE);
+            step++;
+            return 0;
+        }
+
+        Spectrum_Bands(result);
+        step = STEP_IDLE;
+        return 1;
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,94 @@
+/**
+*   \file Spectrum.h
+*   \brief Fixed-point vibration spectrum of one acceleration axis.
+*
+*   The samples of the selected axis are collected in blocks of 256 or 512
+*   points. Each block is mean-removed, scaled to the Q15 range, weighted
+*   with a Hann window and transformed with a real FFT (a complex Q15 FFT of
+*   half the points followed by the split step). The power of the bins is
+*   summed into a few configurable bands.
+*
+*   The transform is done one step per call of Spectrum_Process(), so the
+*   task that drives it never blocks the acquisition for long, and the next
+*   block is collected while the current one is transformed. Only integer
+*   arithmetic is used and the code does not include any PSoC header, so it
+*   can be compiled on a host PC too.
+*/
+
+#ifndef Spectrum_H
+    #define Spectrum_H
+
+    #include <stdint.h>
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Maximum number of points of a block
+    */
+    #define SPECTRUM_MAX_POINTS 512
+
+    /**
+    *   \brief Maximum number of energy bands
+    */
+    #define SPECTRUM_MAX_BANDS 8
+
+    /**
+    *   \brief Default configuration: Z axis, 256 points
+    */
+    #define SPECTRUM_DEFAULT_AXIS 2
+    #define SPECTRUM_DEFAULT_POINTS 256
+
+    /**
+    *   \brief Period of the spectrum task in Timer ticks (10 ms)
+    */
+    #define SPECTRUM_TASK_PERIOD 1
+
+    /**
+    *   \brief Band energies of one block
+    */
+    typedef struct {
+        uint32_t first_index;                   ///< Index of the first sample of the block
+        uint16_t points;                        ///< Points of the block
+        int8_t exponent;                        ///< The samples were scaled by 2^exponent before the FFT
+        uint8_t bands;                          ///< Number of bands
+        uint16_t edges[SPECTRUM_MAX_BANDS + 1]; ///< Band b covers the bins edges[b] .. edges[b+1]-1
+        uint32_t energy[SPECTRUM_MAX_BANDS];    ///< Sum of |X[k]|^2 of the band, saturated
+    } Spectrum_Result;
+
+    /**
+    *   \brief Set the default configuration and discard any block.
+    */
+    void Spectrum_Init(void);
+
+    /**
+    *   \brief Configure axis, block size and bands, and discard any block.
+    *
+    *   \param axis 0 = X, 1 = Y, 2 = Z.
+    *   \param points 256 or 512.
+    *   \param edges Band edges in bins, increasing, the last one at most points/2 + 1.
+    *   \param bands Number of bands, from 1 to SPECTRUM_MAX_BANDS.
+    */
+    ErrorCode Spectrum_Configure(uint8_t axis,
+                                 uint16_t points,
+                                 const uint16_t* edges,
+                                 uint8_t bands);
+
+    /**
+    *   \brief Put a new sample in the block being collected.
+    *
+    *   While a full block waits for the previous transform to end, the
+    *   samples are discarded and the next block starts later.
+    *   \param acceleration X, Y, Z.
+    *   \param index Index of the sample in the stream.
+    */
+    void Spectrum_AddSample(const int32_t acceleration[3], uint32_t index);
+
+    /**
+    *   \brief Do the next step of the transform.
+    *
+    *   \param result Filled when the band energies of a block are ready.
+    *   \retval Returns 1 if \p result was filled, 0 otherwise.
+    */
+    uint8_t Spectrum_Process(Spectrum_Result* result);
+
+#endif // Spectrum_H
+/* [] END OF FILE */
@@ -0,0 +1,120 @@
+/*
+* This file includes the windowed statistics. It does not depend on the
+* PSoC generated code, so it can be compiled on a host PC too.
+*/
+
+#include "Statistics.h"
+
+static uint16_t window = STATISTICS_DEFAULT_WINDOW;
+static uint16_t count = 0;
+static uint32_t first_index = 0;
+
+static int64_t sum[3];
+static uint64_t sum_squares[3];     // |x| <= 240992 < 2^18 at +-16 g: below 2^36 per sample, 2^52 per window
+static int32_t minimum[3];
+static int32_t maximum[3];
+
+    uint32_t Statistics_Sqrt(uint64_t value)
+    {
+        uint64_t root = 0;
+        uint64_t bit = (uint64_t)1 << 62;
+
+        while (bit > value)
+        {
+            bit >>= 2;
+        }
+        while (bit != 0)
+        {
+            if (value >= root + bit)
+            {
+                value -= root + bit;
+                root = (root >> 1) + bit;
+            }
+            else
+            {
+                root >>= 1;
+            }
+            bit >>= 2;
+        }
+        return (uint32_t)root;
+    }
+
+    ErrorCode Statistics_SetWindow(uint16_t samples)
+    {
+        if (samples == 0)
+        {
+            return ERROR;
+        }
+        window = samples;
+        Statistics_Reset();
+        return NO_ERROR;
+    }
+
+    uint16_t Statistics_GetWindow(void)
+    {
+        return window;
+    }
+
+    void Statistics_Reset(void)
+    {
+        count = 0;
+    }
+
+    uint8_t Statistics_AddSample(const int32_t acceleration[3],
+                                 uint32_t index,
+                                 Statistics_Result* result)
+    {
+        if (count == 0)
+        {
+            first_index = index;
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                sum[axis] = 0;
+                sum_squares[axis] = 0;
+                minimum[axis] = acceleration[axis];
+                maximum[axis] = acceleration[axis];
+            }
+        }
+
+        // Per sample only additions and 32x32->64 multiplications
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            int32_t value = acceleration[axis];
+            sum[axis] += value;
+            sum_squares[axis] += (uint64_t)((int64_t)value * value);
+            if (value < minimum[axis])
+            {
+                minimum[axis] = value;
+            }
+            if (value > maximum[axis])
+            {
+                maximum[axis] = value;
+            }
+        }
+        count++;
+
+        if (count < window)
+        {
+            return 0;
+        }
+
+        // Window complete: the divisions and square roots run once per window
+        uint64_t magnitude_squares = 0;
+        result->first_index = first_index;
+        result->count = count;
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            Statistics_Axis* out = &result->axis[axis];
+            out->mean = (int32_t)(sum[axis] / count);
+            out->rms = Statistics_Sqrt(sum_squares[axis] / count);
+            out->min = minimum[axis];
+            out->max = maximum[axis];
+            out->peak_to_peak = (uint32_t)(maximum[axis] - minimum[axis]);
+            magnitude_squares += sum_squares[axis];
+        }
+        result->magnitude_rms = Statistics_Sqrt(magnitude_squares / count);
+        count = 0;
+        return 1;
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,79 @@
+/**
+*   \file Statistics.h
+*   \brief Windowed statistics of the acceleration samples.
+*
+*   The samples are reduced over windows of a configurable number of samples
+*   to mean, RMS, minimum, maximum and peak-to-peak of each axis and to the
+*   RMS of the vector magnitude. Only integer accumulators are used (the
+*   Cortex-M3 has no FPU) and the code does not include any PSoC header, so
+*   it can be compiled on a host PC too.
+*/
+
+#ifndef Statistics_H
+    #define Statistics_H
+
+    #include <stdint.h>
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Default window: one second at 100 Hz
+    */
+    #define STATISTICS_DEFAULT_WINDOW 100
+
+    /**
+    *   \brief Statistics of one axis over a window, in the unit of the samples
+    */
+    typedef struct {
+        int32_t mean;
+        uint32_t rms;
+        int32_t min;
+        int32_t max;
+        uint32_t peak_to_peak;
+    } Statistics_Axis;
+
+    /**
+    *   \brief Statistics of a complete window
+    */
+    typedef struct {
+        uint32_t first_index;       ///< Index of the first sample of the window
+        uint16_t count;             ///< Samples of the window
+        Statistics_Axis axis[3];    ///< X, Y, Z
+        uint32_t magnitude_rms;     ///< RMS of the vector magnitude
+    } Statistics_Result;
+
+    /**
+    *   \brief Set the window length and restart the current window.
+    *
+    *   \param samples Samples per window, from 1 to 65535.
+    */
+    ErrorCode Statistics_SetWindow(uint16_t samples);
+
+    /**
+    *   \brief Current window length [samples].
+    */
+    uint16_t Statistics_GetWindow(void);
+
+    /**
+    *   \brief Discard the samples of the current window.
+    */
+    void Statistics_Reset(void);
+
+    /**
+    *   \brief Accumulate a sample.
+    *
+    *   \param acceleration X, Y, Z.
+    *   \param index Index of the sample in the stream.
+    *   \param result Filled when the window is complete.
+    *   \retval Returns 1 if the window was completed by this sample, 0 otherwise.
+    */
+    uint8_t Statistics_AddSample(const int32_t acceleration[3],
+                                 uint32_t index,
+                                 Statistics_Result* result);
+
+    /**
+    *   \brief Integer square root (floor) of a 64-bit value.
+    */
+    uint32_t Statistics_Sqrt(uint64_t value);
+
+#endif // Statistics_H
+/* [] END OF FILE */
@@ -0,0 +1,60 @@
+/*
+* This file includes the emulated EEPROM used for the settings.
+*/
+
+#include "Storage.h"
+#include "cy_em_eeprom.h"
+
+/**
+*   \brief Em_EEPROM parameters: each row is written every second update,
+*   and a redundant copy protects from a reset during a write
+*/
+#define STORAGE_WEAR_LEVELING 2
+#define STORAGE_REDUNDANT_COPY 1
+
+/**
+*   \brief Flash array of the emulated EEPROM, aligned to the flash rows
+*/
+static const uint8_t storage_flash[CY_EM_EEPROM_GET_PHYSICAL_SIZE(STORAGE_SIZE,
+                                                                  STORAGE_WEAR_LEVELING,
+                                                                  STORAGE_REDUNDANT_COPY)]
+    CY_ALIGN(CY_EM_EEPROM_FLASH_SIZEOF_ROW) = {0u};
+
+static cy_stc_eeprom_context_t storage_context;
+static uint8_t storage_ready = 0;
+
+    ErrorCode Storage_Init(void)
+    {
+        cy_stc_eeprom_config_t config;
+        config.eepromSize = STORAGE_SIZE;
+        config.wearLevelingFactor = STORAGE_WEAR_LEVELING;
+        config.redundantCopy = STORAGE_REDUNDANT_COPY;
+        config.blockingWrite = 1u;
+        config.userFlashStartAddr = (uint32)storage_flash;
+
+        storage_ready = (Cy_Em_EEPROM_Init(&config, &storage_context) == CY_EM_EEPROM_SUCCESS);
+        return storage_ready ? NO_ERROR : ERROR;
+    }
+
+    ErrorCode Storage_Read(uint16_t address, void* data, uint16_t size)
+    {
+        if (!storage_ready || address + size > STORAGE_SIZE)
+        {
+            return ERROR;
+        }
+        return Cy_Em_EEPROM_Read(address, data, size, &storage_context) == CY_EM_EEPROM_SUCCESS ?
+               NO_ERROR : ERROR;
+    }
+
+    ErrorCode Storage_Write(uint16_t address, const void* data, uint16_t size)
+    {
+        if (!storage_ready || address + size > STORAGE_SIZE)
+        {
+            return ERROR;
+        }
+        // The middleware does not modify the data, the cast only drops const
+        return Cy_Em_EEPROM_Write(address, (void*)data, size, &storage_context) == CY_EM_EEPROM_SUCCESS ?
+               NO_ERROR : ERROR;
+    }
+
+/* [] END OF FILE */
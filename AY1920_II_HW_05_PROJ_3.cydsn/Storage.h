@@ -0,0 +1,56 @@
+/**
+*   \file Storage.h
+*   \brief Non-volatile settings in emulated EEPROM.
+*
+*   The settings are kept in a flash array managed by the Em_EEPROM
+*   middleware (wear leveling and redundant copy), so they survive a power
+*   cycle. Each user of the storage owns a fixed area defined below.
+*/
+
+#ifndef Storage_H
+    #define Storage_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Logical size of the emulated EEPROM [bytes]
+    */
+    #define STORAGE_SIZE 256
+
+    /**
+    *   \brief Areas of the emulated EEPROM
+    */
+    #define STORAGE_TEMPCOMP_ADDRESS 0      ///< Temperature compensation table
+    #define STORAGE_TEMPCOMP_SIZE 64
+    #define STORAGE_CALIBRATION_ADDRESS 64  ///< Six-position calibration
+    #define STORAGE_CALIBRATION_SIZE 64
+    #define STORAGE_FLASHLOG_ADDRESS 128    ///< First row of the flash log
+    #define STORAGE_FLASHLOG_SIZE 4
+
+    /**
+    *   \brief Initialize the emulated EEPROM.
+    */
+    ErrorCode Storage_Init(void);
+
+    /**
+    *   \brief Read bytes from the emulated EEPROM.
+    *
+    *   \param address Logical address of the first byte.
+    *   \param data Pointer to an array where the bytes will be saved.
+    *   \param size Number of bytes to be read.
+    */
+    ErrorCode Storage_Read(uint16_t address, void* data, uint16_t size);
+
+    /**
+    *   \brief Write bytes to the emulated EEPROM.
+    *
+    *   The function blocks until the flash rows are written.
+    *   \param address Logical address of the first byte.
+    *   \param data Bytes to be written.
+    *   \param size Number of bytes to be written.
+    */
+    ErrorCode Storage_Write(uint16_t address, const void* data, uint16_t size);
+
+#endif // Storage_H
+/* [] END OF FILE */
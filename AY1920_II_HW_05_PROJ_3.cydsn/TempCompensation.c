@@ -0,0 +1,128 @@
+/*
+* This file includes the temperature compensated offset correction. It does
+* not depend on the PSoC generated code, so it can be compiled on a host PC
+* too.
+*/
+
+#include <stddef.h>
+#include "TempCompensation.h"
+
+/**
+*   \brief Point of the table
+*/
+typedef struct {
+    int16_t temperature;    // ADC3 digits
+    int16_t offset[3];      // X, Y, Z [mm/s^2]
+} TempComp_Point;
+
+static TempComp_Point table[TEMPCOMP_MAX_POINTS];
+static uint8_t table_points = 0;
+
+static int32_t current_offset[3] = {0, 0, 0};
+static uint8_t offset_valid = 0;
+
+    static int16_t TempComp_GetInt16(const uint8_t* data)
+    {
+        return (int16_t)(data[0] | (data[1] << 8));
+    }
+
+    ErrorCode TempComp_Load(const uint8_t* image, uint16_t length)
+    {
+        if (image == NULL || length < TEMPCOMP_IMAGE_SIZE(1))
+        {
+            return ERROR;
+        }
+        uint8_t points = image[2];
+        if ((uint16_t)TempComp_GetInt16(image) != TEMPCOMP_MAGIC ||
+            points == 0 || points > TEMPCOMP_MAX_POINTS ||
+            length < TEMPCOMP_IMAGE_SIZE(points))
+        {
+            return ERROR;
+        }
+
+        uint8_t sum = 0;
+        for (uint16_t i = 0; i < TEMPCOMP_IMAGE_SIZE(points); i++)
+        {
+            sum += image[i];
+        }
+        if (sum != 0)
+        {
+            return ERROR;
+        }
+
+        // Temperatures must be strictly increasing
+        const uint8_t* position = &image[4];
+        for (uint8_t p = 1; p < points; p++)
+        {
+            if (TempComp_GetInt16(position + 8 * p) <= TempComp_GetInt16(position + 8 * (p - 1)))
+            {
+                return ERROR;
+            }
+        }
+
+        for (uint8_t p = 0; p < points; p++, position += 8)
+        {
+            table[p].temperature = TempComp_GetInt16(position);
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                table[p].offset[axis] = TempComp_GetInt16(position + 2 + 2 * axis);
+            }
+        }
+        table_points = points;
+        offset_valid = 0;
+        return NO_ERROR;
+    }
+
+    uint8_t TempComp_IsLoaded(void)
+    {
+        return table_points > 0;
+    }
+
+    void TempComp_Update(int16_t temperature)
+    {
+        if (table_points == 0)
+        {
+            return;
+        }
+
+        // Segment containing the temperature, clamped to the ends of the table
+        uint8_t p = 0;
+        while (p + 1 < table_points && temperature > table[p + 1].temperature)
+        {
+            p++;
+        }
+        const TempComp_Point* low = &table[p];
+        if (p + 1 == table_points || temperature <= low->temperature)
+        {
+            const TempComp_Point* end = temperature <= low->temperature ? low : &table[table_points - 1];
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                current_offset[axis] = end->offset[axis];
+            }
+            offset_valid = 1;
+            return;
+        }
+
+        const TempComp_Point* high = &table[p + 1];
+        int32_t span = high->temperature - low->temperature;
+        int32_t position = temperature - low->temperature;
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            int32_t delta = high->offset[axis] - low->offset[axis];
+            current_offset[axis] = low->offset[axis] + (delta * position) / span;
+        }
+        offset_valid = 1;
+    }
+
+    void TempComp_Apply(int32_t acceleration[3])
+    {
+        if (!offset_valid)
+        {
+            return;
+        }
+        acceleration[0] -= current_offset[0];
+        acceleration[1] -= current_offset[1];
+        acceleration[2] -= current_offset[2];
+    }
+
+/* [] END OF FILE */
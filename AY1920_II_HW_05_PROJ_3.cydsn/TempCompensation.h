@@ -0,0 +1,75 @@
+/**
+*   \file TempCompensation.h
+*   \brief Temperature compensated offset correction.
+*
+*   A table of up to TEMPCOMP_MAX_POINTS temperatures, each with the offset
+*   of the three axes, describes the offset drift as a piecewise-linear
+*   function. The offsets are interpolated only when a new temperature is
+*   read (low rate); each sample then costs three subtractions. Outside the
+*   table the offsets of the nearest point are used.
+*
+*   The table is exchanged as a binary image, the same for the emulated
+*   EEPROM and the upload from the host fitting tool (Host_Tools):
+*   magic 0x5443 (uint16), number of points (uint8), reserved (uint8),
+*   for each point temperature in ADC3 digits and offsets X, Y, Z in
+*   [mm/s^2] (int16), then a checksum byte that makes the sum of all the
+*   bytes zero. Multi-byte fields are little endian.
+*
+*   The code does not include any PSoC header, so it can be compiled on a
+*   host PC too.
+*/
+
+#ifndef TempCompensation_H
+    #define TempCompensation_H
+
+    #include <stdint.h>
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Maximum number of points of the table
+    */
+    #define TEMPCOMP_MAX_POINTS 7
+
+    /**
+    *   \brief Magic number at the start of a table image
+    */
+    #define TEMPCOMP_MAGIC 0x5443
+
+    /**
+    *   \brief Size of a table image [bytes]
+    */
+    #define TEMPCOMP_IMAGE_SIZE(points) (4 + 8 * (points) + 1)
+    #define TEMPCOMP_MAX_IMAGE_SIZE TEMPCOMP_IMAGE_SIZE(TEMPCOMP_MAX_POINTS)
+
+    /**
+    *   \brief Decode and validate a table image.
+    *
+    *   The current table is kept if the image is not valid.
+    *   \param image Bytes of the image.
+    *   \param length Bytes available, at least the size of the image.
+    *   \retval Returns ERROR if the image is not valid.
+    */
+    ErrorCode TempComp_Load(const uint8_t* image, uint16_t length);
+
+    /**
+    *   \brief Return 1 if a valid table is loaded.
+    */
+    uint8_t TempComp_IsLoaded(void);
+
+    /**
+    *   \brief Interpolate the offsets at a new temperature.
+    *
+    *   \param temperature ADC3 reading [digits].
+    */
+    void TempComp_Update(int16_t temperature);
+
+    /**
+    *   \brief Remove the current offsets from a sample.
+    *
+    *   Nothing is done until the first TempComp_Update().
+    *   \param acceleration X, Y, Z in [mm/s^2], corrected in place.
+    */
+    void TempComp_Apply(int32_t acceleration[3]);
+
+#endif // TempCompensation_H
+/* [] END OF FILE */
@@ -0,0 +1,151 @@
+/*
+* This file includes the pitch and roll computation. It does not depend on
+* the PSoC generated code, so it can be compiled on a host PC too.
+*/
+
+#include <stddef.h>
+#include "Tilt.h"
+
+/**
+*   \brief atan(2^-i) in [0.01 degrees] with 8 fractional bits
+*/
+static const int32_t cordic_angle[TILT_CORDIC_ITERATIONS] = {
+    1152000, 680065, 359328, 182400, 91554, 45822, 22916, 11459,
+    5730, 2865, 1432, 716, 358, 179, 90, 45
+};
+
+/**
+*   \brief Inverse of the CORDIC gain, 1 / 1.6468 in Q16
+*/
+#define TILT_CORDIC_INVERSE_GAIN 39797
+
+/**
+*   \brief Inputs are scaled to [2^27, 2^28): the gain of the CORDIC and
+*   the folding of the left half-plane stay below 2^31
+*/
+#define TILT_CORDIC_TOP_BIT 27
+
+static uint16_t interval = TILT_DEFAULT_INTERVAL;
+static uint16_t count = 0;
+static uint32_t first_index = 0;
+static int64_t sum[3];
+
+    ErrorCode Tilt_SetInterval(uint16_t samples)
+    {
+        if (samples == 0)
+        {
+            return ERROR;
+        }
+        interval = samples;
+        Tilt_Reset();
+        return NO_ERROR;
+    }
+
+    uint16_t Tilt_GetInterval(void)
+    {
+        return interval;
+    }
+
+    void Tilt_Reset(void)
+    {
+        count = 0;
+        sum[0] = 0;
+        sum[1] = 0;
+        sum[2] = 0;
+    }
+
+    int16_t Tilt_Atan2(int32_t y, int32_t x, uint32_t* magnitude)
+    {
+        uint32_t ux = x < 0 ? 0u - (uint32_t)x : (uint32_t)x;
+        uint32_t uy = y < 0 ? 0u - (uint32_t)y : (uint32_t)y;
+        uint32_t largest = ux > uy ? ux : uy;
+        if (largest == 0)
+        {
+            if (magnitude != NULL)
+            {
+                *magnitude = 0;
+            }
+            return 0;
+        }
+
+        // Normalize to keep the full resolution in every iteration
+        int8_t shift = 0;
+        while (largest >= (1u << (TILT_CORDIC_TOP_BIT + 1)))
+        {
+            largest >>= 1;
+            shift--;
+        }
+        while (largest < (1u << TILT_CORDIC_TOP_BIT))
+        {
+            largest <<= 1;
+            shift++;
+        }
+        int32_t cx = (int32_t)(shift >= 0 ? ux << shift : ux >> -shift);
+        int32_t cy = (int32_t)(shift >= 0 ? uy << shift : uy >> -shift);
+        if (y < 0)
+        {
+            cy = -cy;
+        }
+
+        // Left half-plane: rotate by 180 degrees
+        int32_t angle = 0;
+        if (x < 0)
+        {
+            cy = -cy;
+            angle = y < 0 ? -18000 * 256 : 18000 * 256;
+        }
+
+        // Vectoring mode: rotate the vector onto the X axis
+        for (uint8_t i = 0; i < TILT_CORDIC_ITERATIONS; i++)
+        {
+            int32_t next_x;
+            if (cy > 0)
+            {
+                next_x = cx + (cy >> i);
+                cy -= cx >> i;
+                angle += cordic_angle[i];
+            }
+            else
+            {
+                next_x = cx - (cy >> i);
+                cy += cx >> i;
+                angle -= cordic_angle[i];
+            }
+            cx = next_x;
+        }
+
+        if (magnitude != NULL)
+        {
+            uint64_t scaled = ((uint64_t)cx * TILT_CORDIC_INVERSE_GAIN) >> 16;
+            *magnitude = (uint32_t)(shift >= 0 ? (scaled + ((1u << shift) >> 1)) >> shift : scaled << -shift);
+        }
+        return (int16_t)((angle + 128) >> 8);
+    }
+
+    uint8_t Tilt_AddSample(const int32_t acceleration[3], uint32_t index, Tilt_Result* result)
+    {
+        if (count == 0)
+        {
+            first_index = index;
+        }
+        sum[0] += acceleration[0];
+        sum[1] += acceleration[1];
+        sum[2] += acceleration[2];
+        if (++count < interval)
+        {
+            return 0;
+        }
+
+        int32_t x = (int32_t)(sum[0] / count);
+        int32_t y = (int32_t)(sum[1] / count);
+        int32_t z = (int32_t)(sum[2] / count);
+        Tilt_Reset();
+
+        uint32_t yz;
+        result->first_index = first_index;
+        result->roll = Tilt_Atan2(y, z, &yz);
+        result->pitch = Tilt_Atan2(-x, (int32_t)(yz > INT32_MAX ? INT32_MAX : yz), NULL);
+        return 1;
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,79 @@
+/**
+*   \file Tilt.h
+*   \brief Pitch and roll from the gravity vector, in fixed point.
+*
+*   The samples are averaged over an interval of a configurable number of
+*   samples and the angles of the average are computed with an integer
+*   CORDIC atan2 (no libm, no FPU):
+*
+*       roll  = atan2(Y, Z)
+*       pitch = atan2(-X, sqrt(Y^2 + Z^2))
+*
+*   The magnitude sqrt(Y^2 + Z^2) is a by-product of the first CORDIC, so
+*   no square root is needed. The code does not include any PSoC header, so
+*   it can be compiled on a host PC too (see Host_Tools/tilt_benchmark.c).
+*/
+
+#ifndef Tilt_H
+    #define Tilt_H
+
+    #include <stdint.h>
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Default interval: 10 samples, 10 Hz at 100 Hz
+    */
+    #define TILT_DEFAULT_INTERVAL 10
+
+    /**
+    *   \brief Iterations of the CORDIC: the error is below 0.01 degrees
+    */
+    #define TILT_CORDIC_ITERATIONS 16
+
+    /**
+    *   \brief Angles of an interval [0.01 degrees]
+    */
+    typedef struct {
+        uint32_t first_index;   ///< Index of the first sample of the interval
+        int16_t pitch;          ///< -9000 ... 9000
+        int16_t roll;           ///< -18000 ... 18000
+    } Tilt_Result;
+
+    /**
+    *   \brief Set the interval and restart the current one.
+    *
+    *   \param samples Samples averaged for each output, from 1 to 65535.
+    */
+    ErrorCode Tilt_SetInterval(uint16_t samples);
+
+    /**
+    *   \brief Current interval [samples].
+    */
+    uint16_t Tilt_GetInterval(void);
+
+    /**
+    *   \brief Discard the samples of the current interval.
+    */
+    void Tilt_Reset(void);
+
+    /**
+    *   \brief Add a sample to the current interval.
+    *
+    *   \param acceleration X, Y, Z of the sample.
+    *   \param index Index of the sample in the acquisition.
+    *   \param result Filled with the angles when the interval is complete.
+    *   \retval Returns 1 when result holds the angles of a completed interval.
+    */
+    uint8_t Tilt_AddSample(const int32_t acceleration[3], uint32_t index, Tilt_Result* result);
+
+    /**
+    *   \brief Four-quadrant arctangent of y / x with CORDIC.
+    *
+    *   \param y, x Any values; atan2(0, 0) is 0.
+    *   \param magnitude If not NULL, filled with sqrt(x^2 + y^2).
+    *   \retval Angle in [0.01 degrees], -18000 ... 18000.
+    */
+    int16_t Tilt_Atan2(int32_t y, int32_t x, uint32_t* magnitude);
+
+#endif // Tilt_H
+/* [] END OF FILE */
@@ -0,0 +1,127 @@
+/*
+* This file includes the timestamps of the samples and the jitter statistics.
+*/
+
+#include "Timestamp.h"
+#include "InterruptRoutines.h"
+#include "PowerManager.h"
+#include "project.h"
+
+/**
+*   \brief Duration of a Timer tick [us]
+*/
+#define TIMESTAMP_TICK_US 10000u
+
+/**
+*   \brief CPU cycles in a microsecond
+*/
+#define TIMESTAMP_CYCLES_PER_US (BCLK__BUS_CLK__HZ / 1000000u)
+
+static Timestamp_Histogram latency;
+static Timestamp_Histogram interval_error;
+static uint32_t previous_read = 0;
+static uint8_t has_previous = 0;
+static uint16_t sample_rate = 0;
+
+    uint32_t Timestamp_Now(void)
+    {
+        // Tick and cycle counter of the same Timer interrupt: read again if
+        // the ISR ran in the meantime
+        uint32_t tick;
+        uint32_t tick_cycles;
+        uint32_t cycles;
+        do
+        {
+            tick = Timer_Tick;
+            tick_cycles = Timer_TickCycles;
+            cycles = PowerManager_ReadCycles();
+        } while (tick != Timer_Tick);
+
+        // Until the ISR of the next tick has run the time stays in this
+        // tick, so it never goes back when the tick is counted
+        uint32_t elapsed = (cycles - tick_cycles) / TIMESTAMP_CYCLES_PER_US;
+        if (elapsed >= TIMESTAMP_TICK_US)
+        {
+            elapsed = TIMESTAMP_TICK_US - 1;
+        }
+        return tick * TIMESTAMP_TICK_US + elapsed;
+    }
+
+    static void Timestamp_Add(Timestamp_Histogram* histogram, int32_t value)
+    {
+        int32_t bin = (value - histogram->first_bin_us) / TIMESTAMP_BIN_US;
+        if (value < histogram->first_bin_us || bin < 0)
+        {
+            bin = 0;
+        }
+        else if (bin >= TIMESTAMP_BINS)
+        {
+            bin = TIMESTAMP_BINS - 1;
+        }
+        histogram->bins[bin]++;
+        if (histogram->count == 0 || value < histogram->min)
+        {
+            histogram->min = value;
+        }
+        if (histogram->count == 0 || value > histogram->max)
+        {
+            histogram->max = value;
+        }
+        histogram->count++;
+    }
+
+    void Timestamp_SetRate(uint16_t rate)
+    {
+        sample_rate = rate;
+        has_previous = 0;
+    }
+
+    uint32_t Timestamp_RecordBatch(uint32_t now, uint32_t release_tick, uint8_t samples)
+    {
+        Timestamp_Add(&latency, (int32_t)(now - release_tick * TIMESTAMP_TICK_US));
+
+        // The samples of the batch were acquired since the previous read
+        uint32_t delta = 0;
+        if (has_previous)
+        {
+            delta = now - previous_read;
+            if (sample_rate > 0)
+            {
+                int32_t nominal = (int32_t)(((uint32_t)samples * 1000000u) / sample_rate);
+                Timestamp_Add(&interval_error, (int32_t)delta - nominal);
+            }
+        }
+        previous_read = now;
+        has_previous = 1;
+        return delta;
+    }
+
+    const Timestamp_Histogram* Timestamp_GetLatency(void)
+    {
+        return &latency;
+    }
+
+    const Timestamp_Histogram* Timestamp_GetIntervalError(void)
+    {
+        return &interval_error;
+    }
+
+    void Timestamp_Reset(void)
+    {
+        Timestamp_Histogram* histograms[2] = {&latency, &interval_error};
+        for (uint8_t h = 0; h < 2; h++)
+        {
+            for (uint8_t b = 0; b < TIMESTAMP_BINS; b++)
+            {
+                histograms[h]->bins[b] = 0;
+            }
+            histograms[h]->count = 0;
+            histograms[h]->min = 0;
+            histograms[h]->max = 0;
+        }
+        // Latency from 0, interval error centered on 0
+        latency.first_bin_us = 0;
+        interval_error.first_bin_us = -(TIMESTAMP_BINS / 2) * TIMESTAMP_BIN_US;
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,88 @@
+/**
+*   \file Timestamp.h
+*   \brief Timestamps of the sample batches and jitter statistics.
+*
+*   The timestamp is a free-running microsecond counter built from the
+*   Timer tick count and the CPU cycle counter, read by the Timer ISR at
+*   each tick: it resolves 1 us inside a tick, referenced to the entry in
+*   the ISR. (The hardware counter of the Timer only counts milliseconds.)
+*   The cycle counter may stop while the CPU sleeps, but the timestamps are
+*   taken by the tasks released by the tick, before the CPU sleeps again;
+*   inside a tick the time never reaches the next one.
+*
+*   The timestamp of a batch is taken when the acquisition task starts the
+*   FIFO read of device 0; the samples of a batch of n samples read at t
+*   are at t - (n - 1 - i) / ODR, i = 0 ... n - 1.
+*
+*   Two histograms quantify the jitter of the acquisition:
+*   - latency: from the release of the acquisition task (Timer ISR) to the
+*     start of the read;
+*   - interval error: interval between two reads minus the nominal time of
+*     the samples read, centered on zero.
+*/
+
+#ifndef Timestamp_H
+    #define Timestamp_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Bins of a histogram and their width [us]; the first and the
+    *   last bin also count the values below and above the range
+    */
+    #define TIMESTAMP_BINS 32
+    #define TIMESTAMP_BIN_US 100
+
+    /**
+    *   \brief Histogram of a time measure
+    */
+    typedef struct {
+        uint32_t bins[TIMESTAMP_BINS];
+        int32_t first_bin_us;   ///< Lower edge of the first bin [us]
+        uint32_t count;         ///< Values recorded
+        int32_t min;            ///< Smallest value [us]
+        int32_t max;            ///< Largest value [us]
+    } Timestamp_Histogram;
+
+    /**
+    *   \brief Current time [us], wraps around every 71 minutes.
+    */
+    uint32_t Timestamp_Now(void);
+
+    /**
+    *   \brief Set the output data rate of the samples.
+    *
+    *   The next batch has no previous one, so its interval is not recorded.
+    *   \param rate Output data rate [Hz].
+    */
+    void Timestamp_SetRate(uint16_t rate);
+
+    /**
+    *   \brief Record the start of a batch read.
+    *
+    *   Updates the histograms and returns the time elapsed since the
+    *   previous batch.
+    *   \param now Timestamp of the read [us].
+    *   \param release_tick Tick at which the acquisition task was released.
+    *   \param samples Samples of the batch.
+    *   \retval Time since the previous batch [us], 0 for the first one.
+    */
+    uint32_t Timestamp_RecordBatch(uint32_t now, uint32_t release_tick, uint8_t samples);
+
+    /**
+    *   \brief Histogram of the latency from the release to the read.
+    */
+    const Timestamp_Histogram* Timestamp_GetLatency(void);
+
+    /**
+    *   \brief Histogram of the error of the interval between two reads.
+    */
+    const Timestamp_Histogram* Timestamp_GetIntervalError(void);
+
+    /**
+    *   \brief Clear the histograms; also called at start-up.
+    */
+    void Timestamp_Reset(void);
+
+#endif // Timestamp_H
+/* [] END OF FILE */
@@ -0,0 +1,139 @@
+/*
+* This file includes the velocity integration. It does not depend on the
+* PSoC generated code, so it can be compiled on a host PC too.
+*/
+
+#include "Velocity.h"
+#include "Statistics.h"
+
+/**
+*   \brief Fractional bits of the filter states
+*/
+#define VELOCITY_FRACTION 6
+
+static uint8_t leak_shift = 6;                          // k: cut-off 0.25 Hz at 100 Hz
+static int32_t step_q16 = (1000L << 16) / 100;          // 1000 / fs in Q16: mm/s^2 to um/s
+static uint16_t window = VELOCITY_DEFAULT_WINDOW;
+static uint16_t count = 0;
+static uint32_t first_index = 0;
+
+static uint8_t primed = 0;
+static int32_t previous[3];         // Last input [mm/s^2]
+static int32_t acceleration_hp[3];  // DC blocker output [mm/s^2], Q6
+static int32_t velocity[3];         // Integrator output [um/s], Q6: up to 33 m/s
+static int32_t hp_residue[3];       // Bits dropped by the leaks, fed back
+static int32_t velocity_residue[3];
+static uint64_t sum_squares[3];
+
+    /**
+    *   \brief Leak state / 2^k with error feedback: the bits dropped by the
+    *   shift are added to the next call, so the leak has no dead band and
+    *   a constant input cannot leave an offset in the state.
+    */
+    static int32_t Velocity_Leak(int32_t state, int32_t* residue)
+    {
+        int32_t total = state + *residue;
+        int32_t leak = total >> leak_shift;
+        *residue = total - (leak << leak_shift);
+        return leak;
+    }
+
+    ErrorCode Velocity_SetRate(uint16_t rate)
+    {
+        if (rate == 0)
+        {
+            return ERROR;
+        }
+        // Smallest k with fs / (2 pi 2^k) <= VELOCITY_CUTOFF_CHZ / 100 (2 pi ~ 6.28)
+        uint8_t k = 1;
+        while (k < 15 && ((uint32_t)rate * 10000) > ((uint32_t)628 * VELOCITY_CUTOFF_CHZ << k))
+        {
+            k++;
+        }
+        leak_shift = k;
+        step_q16 = (int32_t)((1000L << 16) / rate);
+        Velocity_Reset();
+        return NO_ERROR;
+    }
+
+    ErrorCode Velocity_SetWindow(uint16_t samples)
+    {
+        if (samples == 0)
+        {
+            return ERROR;
+        }
+        window = samples;
+        count = 0;
+        return NO_ERROR;
+    }
+
+    uint16_t Velocity_GetWindow(void)
+    {
+        return window;
+    }
+
+    void Velocity_Reset(void)
+    {
+        primed = 0;
+        count = 0;
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            acceleration_hp[axis] = 0;
+            velocity[axis] = 0;
+            hp_residue[axis] = 0;
+            velocity_residue[axis] = 0;
+        }
+    }
+
+    uint8_t Velocity_AddSample(const int32_t acceleration[3],
+                               uint32_t index,
+                               Velocity_Result* result)
+    {
+        // The first sample only sets the DC level: no step from zero
+        if (!primed)
+        {
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                previous[axis] = acceleration[axis];
+            }
+            primed = 1;
+        }
+        if (count == 0)
+        {
+            first_index = index;
+            sum_squares[0] = 0;
+            sum_squares[1] = 0;
+            sum_squares[2] = 0;
+        }
+
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            int32_t difference = acceleration[axis] - previous[axis];
+            int32_t last_hp = acceleration_hp[axis];
+            previous[axis] = acceleration[axis];
+            acceleration_hp[axis] += (difference << VELOCITY_FRACTION) - Velocity_Leak(last_hp, &hp_residue[axis]);
+
+            // Al-Alaoui rule: 7/8 of the current and 1/8 of the previous sample
+            int32_t area = 7 * acceleration_hp[axis] + last_hp;
+            int32_t step = (int32_t)(((int64_t)area * step_q16) >> 19);
+            velocity[axis] += step - Velocity_Leak(velocity[axis], &velocity_residue[axis]);
+
+            int32_t v = velocity[axis] >> VELOCITY_FRACTION;
+            sum_squares[axis] += (uint64_t)((int64_t)v * v);
+        }
+
+        if (++count < window)
+        {
+            return 0;
+        }
+        result->first_index = first_index;
+        result->count = count;
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            result->rms[axis] = Statistics_Sqrt(sum_squares[axis] / count);
+        }
+        count = 0;
+        return 1;
+    }
+
+/* [] END OF FILE */
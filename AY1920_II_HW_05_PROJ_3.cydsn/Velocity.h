@@ -0,0 +1,86 @@
+/**
+*   \file Velocity.h
+*   \brief Velocity RMS of each axis for vibration severity.
+*
+*   Each axis goes through a DC blocker, which removes gravity and the
+*   offset, and then through a leaky integrator that gives the velocity:
+*
+*       a[n] = x[n] - x[n-1] + (1 - 2^-k) * a[n-1]
+*       v[n] = (1 - 2^-k) * v[n-1] + (7 a[n] + a[n-1]) / (8 fs)
+*
+*   The leak keeps the integrator from drifting. Both stages are
+*   first-order high-pass filters with the cut-off fs / (2 pi 2^k); k is
+*   chosen from the output data rate so that the cut-off is at most
+*   VELOCITY_CUTOFF_CHZ. The Al-Alaoui integration rule (7 a[n] + a[n-1])
+*   / 8 keeps the gain close to 1 / (2 pi f): at 100 Hz and above the
+*   velocity is within 1.5% from 5 Hz to fs / 5 (2.5% at 50 Hz) and
+*   within 6% at fs / 2.5. The RMS of the velocity is computed over
+*   windows of a configurable number of samples.
+*
+*   Only integer arithmetic is used and the code does not include any PSoC
+*   header, so it can be compiled on a host PC too.
+*/
+
+#ifndef Velocity_H
+    #define Velocity_H
+
+    #include <stdint.h>
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Maximum cut-off of the high-pass filters [0.01 Hz]
+    */
+    #define VELOCITY_CUTOFF_CHZ 25
+
+    /**
+    *   \brief Default window: one second at 100 Hz
+    */
+    #define VELOCITY_DEFAULT_WINDOW 100
+
+    /**
+    *   \brief Velocity RMS of a complete window
+    */
+    typedef struct {
+        uint32_t first_index;   ///< Index of the first sample of the window
+        uint16_t count;         ///< Samples of the window
+        uint32_t rms[3];        ///< X, Y, Z [um/s]
+    } Velocity_Result;
+
+    /**
+    *   \brief Set the sample rate and restart the filters.
+    *
+    *   \param rate Output data rate [Hz].
+    */
+    ErrorCode Velocity_SetRate(uint16_t rate);
+
+    /**
+    *   \brief Set the window length and restart the current window.
+    *
+    *   \param samples Samples per window, from 1 to 65535.
+    */
+    ErrorCode Velocity_SetWindow(uint16_t samples);
+
+    /**
+    *   \brief Current window length [samples].
+    */
+    uint16_t Velocity_GetWindow(void);
+
+    /**
+    *   \brief Restart the filters and the current window.
+    */
+    void Velocity_Reset(void);
+
+    /**
+    *   \brief Integrate a sample.
+    *
+    *   \param acceleration X, Y, Z [mm/s^2].
+    *   \param index Index of the sample in the stream.
+    *   \param result Filled when the window is complete.
+    *   \retval Returns 1 if the window was completed by this sample, 0 otherwise.
+    */
+    uint8_t Velocity_AddSample(const int32_t acceleration[3],
+                               uint32_t index,
+                               Velocity_Result* result);
+
+#endif // Velocity_H
+/* [] END OF FILE */
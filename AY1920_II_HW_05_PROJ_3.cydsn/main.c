@@ -10,57 +10,70 @@
 // Include required header files
 #include "I2C_Interface.h"
 #include "project.h"
-#include "stdio.h"
+#include "Format.h"
 #include "InterruptRoutines.h"
-/**
-*   \brief 7-bit I2C address of the slave device.
-*/
-#define LIS3DH_DEVICE_ADDRESS 0x18
-
-/**
-*   \brief Address of the WHO AM I register
-*/
-#define LIS3DH_WHO_AM_I_REG_ADDR 0x0F
-
-/**
-*   \brief Address of the Status register
-*/
-#define LIS3DH_STATUS_REG 0x27
+#include "LIS3DH_Registers.h"
+#include "Scheduler.h"
+#include "Acquisition.h"
+#include "PowerManager.h"
+#include "Commands.h"
+#include "AdaptiveRate.h"
+#include "Capture.h"
+#include "Spectrum.h"
+#include "Decimator.h"
+#include "Click.h"
+#include "Storage.h"
+#include "TempCompensation.h"
+#include "Calibration.h"
+#include "SelfTest.h"
+#include "Device.h"
+#include "I2C_Queue.h"
+#include "Health.h"
+#include "FlashLog.h"
 
 /**
-*   \brief Address of the Control register 1
+*   \brief Period of the acquisition task in Timer ticks (10 ms)
 */
-#define LIS3DH_CTRL_REG1 0x20
+#define ACQUISITION_TASK_PERIOD 1
 
 /**
-*   \brief Hex value to set high resolution mode at 100 Hz to the accelerator
+*   \brief Tick source of the scheduler: Timer ISR counter (10 ms)
 */
-#define LIS3DH_HIGH_RESOLUTION_MODE_100HZ_CTRL_REG1 0x57
+static uint32_t Tick_Read(void)
+{
+    return Timer_Tick;
+}
 
 /**
-*   \brief Address of the Control register 4
+*   \brief Period of the I2C queue task in Timer ticks (10 ms)
 */
-#define LIS3DH_CTRL_REG4 0x23  
+#define BUS_TASK_PERIOD 1
 
 /**
-*   \brief Hex value to set High Resolution mode at 100 Hz in the ±4.0 g FSR to the accelerator (BDU =1)
+*   \brief Transfer function of the I2C queue: auto-increment read or write,
+*   failures counted in Health
 */
-#define LIS3DH_HIGH_RESOLUTION_MODE_100HZ_CTRL_REG4 0x98
+static ErrorCode Bus_Transfer(uint8_t device_address, uint8_t register_address,
+                              uint8_t register_count, uint8_t* data, uint8_t write)
+{
+    ErrorCode error = write ?
+        I2C_Peripheral_WriteRegisterMulti(device_address, register_address, register_count, data) :
+        I2C_Peripheral_ReadRegisterMulti(device_address, register_address, register_count, data);
+    if (error != NO_ERROR)
+    {
+        Health_Count(HEALTH_I2C_ERROR, 1);
+    }
+    return error;
+}
 
 /**
-*   \brief Address of the X-axis acceleration data output LSB register
-*/
-#define LIS3DH_OUT_X_L 0x28
-/**
-*   \brief Address of the Y-axis acceleration data output LSB register
-*/
-#define LIS3DH_OUT_Y_L 0x2A
-/**
-*   \brief Address of the Z-axis acceleration data output LSB register
+*   \brief I2C queue task: serves the queued transactions in the bus time
+*   left before the next acquisition
 */
-#define LIS3DH_OUT_Z_L 0x2C
-
-//Thanks to the MultiRead function we don't need to specify the MSB registers Address
+static void Bus_Task(void)
+{
+    I2C_Queue_Service(Acquisition_GetBusBudget());
+}
 
 int main(void)
 {
@@ -80,7 +93,7 @@ int main(void)
         if (I2C_Peripheral_IsDeviceConnected(i))
         {
             // print out the address is hex format
-            sprintf(message, "Device 0x%02X is connected\r\n", i);
+            Format_Text(message, sizeof(message), "Device 0x%02X is connected\r\n", i);
             UART_Debug_PutString(message); 
         }
         
@@ -97,7 +110,7 @@ int main(void)
                                                   &who_am_i_reg);
     if (error == NO_ERROR)
     {
-        sprintf(message, "WHO AM I REG: 0x%02X [Expected: 0x33]\r\n", who_am_i_reg);
+        Format_Text(message, sizeof(message), "WHO AM I REG: 0x%02X [Expected: 0x33]\r\n", who_am_i_reg);
         UART_Debug_PutString(message); 
     }
     else
@@ -116,7 +129,7 @@ int main(void)
     
     if (error == NO_ERROR)
     {
-        sprintf(message, "CONTROL REGISTER 1: 0x%02X\r\n", ctrl_reg1);
+        Format_Text(message, sizeof(message), "CONTROL REGISTER 1: 0x%02X\r\n", ctrl_reg1);
         UART_Debug_PutString(message); 
     }
     else
@@ -134,7 +147,7 @@ int main(void)
     
     if (error == NO_ERROR)
     {
-        sprintf(message, "CONTROL REGISTER 4: 0x%02X\r\n", ctrl_reg4);
+        Format_Text(message, sizeof(message), "CONTROL REGISTER 4: 0x%02X\r\n", ctrl_reg4);
         UART_Debug_PutString(message); 
     }
     else
@@ -158,7 +171,7 @@ int main(void)
     
         if (error == NO_ERROR)
         {
-            sprintf(message, "CONTROL REGISTER 1 successfully written as: 0x%02X\r\n", ctrl_reg1);
+            Format_Text(message, sizeof(message), "CONTROL REGISTER 1 successfully written as: 0x%02X\r\n", ctrl_reg1);
             UART_Debug_PutString(message); 
         }
         else
@@ -180,7 +193,7 @@ int main(void)
     
         if (error == NO_ERROR)
         {
-            sprintf(message, "CONTROL REGISTER 4 successfully written as: 0x%02X\r\n", ctrl_reg4);
+            Format_Text(message, sizeof(message), "CONTROL REGISTER 4 successfully written as: 0x%02X\r\n", ctrl_reg4);
             UART_Debug_PutString(message); 
         }
         else
@@ -188,81 +201,94 @@ int main(void)
             UART_Debug_PutString("Error occurred during I2C comm to set control register 1\r\n");   
         }
     }
-   
-    uint8_t status_register;
-    int16_t OutX,OutY,OutZ;  //int16 values of acceleration
-    int32_t OutX32,OutY32,OutZ32; //int32 values of acceleration after the cast of the floating point
-    float32 AccX,AccY,AccZ; //floating point values in m/s^2
-    uint8_t AccData[6]; // Array of the acceleration data
     
+    // Self-test: a stuck axis passes the WHO AM I check but not this one
+    SelfTest_Result self_test;
+    if (SelfTest_Run(&self_test) == NO_ERROR)
+    {
+        Format_Text(message, sizeof(message), "Self-test passed: %d %d %d LSb\r\n",
+                self_test.change[0], self_test.change[1], self_test.change[2]);
+        UART_Debug_PutString(message);
+    }
+    else if (self_test.error != NO_ERROR)
+    {
+        UART_Debug_PutString("Error occurred during I2C comm in the self-test\r\n");
+    }
+    else
+    {
+        Format_Text(message, sizeof(message), "Self-test FAILED (axes 0x%X): %d %d %d\r\n",
+                self_test.failed_axes, self_test.change[0], self_test.change[1], self_test.change[2]);
+        UART_Debug_PutString(message);
+    }
+    
+    // Device 0 is configured: the other accelerometers get the same settings
+    if (Device_Init() == NO_ERROR)
+    {
+        Format_Text(message, sizeof(message), "Accelerometers found: %u\r\n", Device_GetCount());
+        UART_Debug_PutString(message);
+    }
+    else
+    {
+        UART_Debug_PutString("Error occurred during I2C comm to register the accelerometers\r\n");
+    }
     
-    uint8_t OutArray[14]; // In this case we have 4 byte for every axis + 1 header +  1 tail
-    uint8_t header = 0xA0;
-    uint8_t footer = 0xC0;
-    OutArray[0] = header;
-    OutArray[13] = footer;
+    // FIFO in Stream mode: the acquisition task reads the samples in batches
+    error = Acquisition_Start();
+    if (error != NO_ERROR)
+    {
+        UART_Debug_PutString("Error occurred during I2C comm to enable the FIFO\r\n");
+    }
+    
+    // Settings saved in the emulated EEPROM
+    uint8_t tempcomp_image[STORAGE_TEMPCOMP_SIZE];
+    if (Storage_Init() == NO_ERROR &&
+        Storage_Read(STORAGE_TEMPCOMP_ADDRESS, tempcomp_image, sizeof(tempcomp_image)) == NO_ERROR &&
+        TempComp_Load(tempcomp_image, sizeof(tempcomp_image)) == NO_ERROR)
+    {
+        UART_Debug_PutString("Temperature compensation table loaded\r\n");
+    }
+    Calibration_Init();
+    FlashLog_Init();
+   
+    // Start the cycle counter used to measure the tasks and the awake time
+    PowerManager_Start();
+    
+    // Task table: the first task has the highest priority
+    uint8_t task_id = 0;
+    uint8_t task_errors = 0;
+    task_errors += Scheduler_Init(Tick_Read, PowerManager_ReadCycles, PowerManager_Idle) != NO_ERROR;
+    task_errors += Scheduler_AddTask("Acquisition", Acquisition_Task, ACQUISITION_TASK_PERIOD, 0, 0, &task_id) != NO_ERROR;
+    Acquisition_Init(task_id);
+    task_errors += Scheduler_AddTask("Bus", Bus_Task, BUS_TASK_PERIOD, 0, 0, NULL) != NO_ERROR;
+    I2C_Queue_Init(Bus_Transfer);
+    task_errors += Scheduler_AddTask("Adaptive", AdaptiveRate_Task, ADAPTIVE_TASK_PERIOD, 0, 0, &task_id) != NO_ERROR;
+    AdaptiveRate_Init(task_id);
+    task_errors += Scheduler_AddTask("Click", Click_Task, CLICK_TASK_PERIOD, 0, 0, &task_id) != NO_ERROR;
+    Click_Init(task_id);
+    task_errors += Scheduler_AddTask("Capture", Capture_Task, CAPTURE_TASK_PERIOD, 0, 0, NULL) != NO_ERROR;
+    Capture_Init();
+    task_errors += Scheduler_AddTask("Log", FlashLog_Task, FLASHLOG_TASK_PERIOD, 0, 0, NULL) != NO_ERROR;
+    task_errors += Scheduler_AddTask("Calibration", Calibration_Task, CALIBRATION_TASK_PERIOD, 0, 0, NULL) != NO_ERROR;
+    task_errors += Scheduler_AddTask("Commands", Commands_Task, COMMANDS_TASK_PERIOD, 0, 0, &task_id) != NO_ERROR;
+    Commands_Init(task_id);
+    task_errors += Scheduler_AddTask("Spectrum", Acquisition_SpectrumTask, SPECTRUM_TASK_PERIOD, 0, 0, NULL) != NO_ERROR;
+    Spectrum_Init();
+    Decimator_Configure(DECIMATOR_DEFAULT_FACTOR);
+    if (task_errors)
+    {
+        // A task missing from the table would silently never run
+        Format_Text(message, sizeof(message), "Error: %u tasks not added to the scheduler\r\n", task_errors);
+        UART_Debug_PutString(message);
+        for(;;);
+    }
     
     Timer_Start();  //Timer Start
     isr_Read_StartEx(Custom_ISR); //Start of the ISR
     
     for(;;)
     {
-        if(Flag_Read != 0)  //ISR for read data at every 10ms
-        { 
-            //Read of the Status Register 
-            error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                                LIS3DH_STATUS_REG,
-                                                &status_register);
-            if(error == NO_ERROR)
-            {
-                if((status_register & 1<<3) == 8) //Control if ZYXDA is set to 1, 
-                                                  //in this case new set of data is available
-               {
-                    //The registers of the OUTPUT of X,Y,Z are consecutive so we use a Multi-Read 
-                    error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
-                                                             LIS3DH_OUT_X_L,
-                                                             6,
-                                                             &AccData[0]);
-                    
-                    if(error == NO_ERROR)
-                    {
-                        OutX = (int16)((AccData[0] | (AccData[1]<<8)))>>4; //We have 12-bit of data
-                        AccX=  OutX*2*9.806*0.001; // Multiply the value for 2 because the sensitivity is 2 mg/digit and 9.806*0.001 m/s^2
-                        OutX32 =  AccX*1000; //Cast the floating point value to an int32 
-                                                   //without loosing information of 3 decimals using the multiplication by 1000
-                        OutArray[1] = (uint8_t)(OutX32 & 0xFF);
-                        OutArray[2] = (uint8_t)(OutX32 >>8);
-                        OutArray[3] = (uint8_t)(OutX32 >>16);
-                        OutArray[4] = (uint8_t)(OutX32 >>24);
-                        
-                        OutY = (int16)((AccData[2] | (AccData[3]<<8)))>>4;
-                        AccY = OutY*2*9.806*0.001; // Multiply the value for  2 because the sensitivity is 2 mg/digit and 9.806*0.001 m/s^2
-                        OutY32 = AccY*1000; //Cast the floating point value to an int32 
-                                                  //without loosing information of 3 decimals using the multiplication by 1000  
-                        OutArray[5] = (uint8_t)(OutY32 & 0xFF);
-                        OutArray[6] = (uint8_t)(OutY32 >> 8);
-                        OutArray[7] = (uint8_t)(OutY32 >>16);
-                        OutArray[8] = (uint8_t)(OutY32 >>24);
-                        
-                        OutZ = (int16)((AccData[4] | (AccData[5]<<8)))>>4;
-                        AccZ = OutZ*2*9.806*0.001; // Multiply the value for 2 because the sensitivity is 2 mg/digit and 9.806*0.001 m/s^2
-                        OutZ32 = AccZ*1000;//Cast the floating point value to an int32 
-                                               //without loosing information of 3 decimals using the multiplication by 1000  
-                        OutArray[9] = (uint8_t)(OutZ32 & 0xFF);
-                        OutArray[10] =(uint8_t)(OutZ32 >> 8);
-                        OutArray[11] = (uint8_t)(OutZ32 >>16);
-                        OutArray[12] = (uint8_t)(OutZ32 >>24);
-          
-                        UART_Debug_PutArray(OutArray, 14);  //Send array to the Uart (values in [m/s^2])
-                        
-                        Flag_Read = 0;  //Set the ISR flag to 0
-                    }
-                }
-            }
-         }
+        Scheduler_RunOnce();  //Run the ready task or enter low power until the next tick
     }
-    
-    
 }
 
 /* [] END OF FILE */
\ No newline at end of file
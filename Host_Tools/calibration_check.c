@@ -0,0 +1,262 @@
+/*
+* Host test of the six-position calibration of the firmware (Calibration.c)
+* on a simulated sensor with known offset, gain and misalignment.
+*
+* The sensor reads S * a + offset plus noise, rounded to whole mm/s^2,
+* with S the sensitivity matrix: a gain on the diagonal and the
+* misalignment and cross-axis terms off it. The six orientations are
+* captured in a shuffled order through Calibration_Capture() and
+* Calibration_AddSample(), with Calibration_Task() after each capture, as
+* on the board. The solved offsets, gains and matrix are read back from the
+* image saved in the emulated EEPROM and compared with the exact ones
+* (offset, 1 / S[i][i] and S^-1); then gravity in 500 random directions
+* and 2 g along the diagonals go through Calibration_Apply() in both
+* modes. A restart must load the same correction. A moving board, a
+* capture with no axis along gravity and gains out of range (still board,
+* up to 1.45 g on an axis) must be rejected for that reason. Exits with 1
+* on an unexpected result.
+*
+* Build and run from the Host_Tools folder (psoc holds the minimal PSoC
+* headers for the host):
+*
+*     cc -O2 -Ipsoc -I../AY1920_II_HW_05_PROJ_3.cydsn calibration_check.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Calibration.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Format.c -lm -o calibration_check
+*     ./calibration_check
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "Calibration.h"
+#include "Storage.h"
+#include "project.h"
+
+#define NOISE 40.0              // Standard deviation of the sensor noise [mm/s^2]
+#define OFFSET_LIMIT 5          // Error of the solved offsets [mm/s^2]
+#define MATRIX_LIMIT 4          // Error of the solved gains and matrix [Q12 LSb]
+#define FULL_LIMIT 10.0         // Error of a corrected reading, full matrix [mm/s^2]
+#define DIRECTIONS 500
+
+static const double true_offset[3] = {183.0, -97.0, 312.0};
+static const double sensitivity[3][3] = {
+    {1.042, 0.018, -0.011},
+    {-0.014, 0.963, 0.022},
+    {0.009, -0.025, 1.071},
+};
+static const uint8_t capture_order[6] = {4, 1, 2, 5, 0, 3};     // +Z, -X, +Y, -Z, +X, -Y
+
+static uint8_t eeprom[STORAGE_SIZE];
+static uint16_t lines = 0;
+static char last_line[80];
+static uint32_t noise = 1;
+
+ErrorCode Storage_Read(uint16_t address, void* data, uint16_t size)
+{
+    memcpy(data, &eeprom[address], size);
+    return NO_ERROR;
+}
+
+ErrorCode Storage_Write(uint16_t address, const void* data, uint16_t size)
+{
+    memcpy(&eeprom[address], data, size);
+    return NO_ERROR;
+}
+
+void UART_Debug_PutString(const char8 string[])
+{
+    lines++;
+    strncpy(last_line, string, sizeof(last_line) - 1);
+}
+
+/*
+* Gaussian noise from the sum of 12 uniform values.
+*/
+static double Gaussian(void)
+{
+    double sum = -6;
+    for (int i = 0; i < 12; i++)
+    {
+        noise = noise * 1103515245u + 12345u;
+        sum += ((noise >> 8) & 0xFFFF) / 65536.0;
+    }
+    return sum;
+}
+
+static void Read(const double a[3], double gain_error, double noise_level, int32_t reading[3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        double value = true_offset[i] + noise_level * Gaussian();
+        for (int j = 0; j < 3; j++)
+        {
+            value += sensitivity[i][j] * (i == j ? gain_error : 1.0) * a[j];
+        }
+        reading[i] = (int32_t)lround(value);
+    }
+}
+
+/*
+* Capture one orientation (k = 2 axis + down) with the given gravity
+* vector; returns the number of lines the task printed.
+*/
+static uint16_t Capture(const double a[3], double gain_error, double noise_level)
+{
+    uint16_t before = lines;
+    Calibration_Capture();
+    for (int n = 0; n < CALIBRATION_SAMPLES; n++)
+    {
+        int32_t reading[3];
+        Read(a, gain_error, noise_level, reading);
+        Calibration_AddSample(reading);
+    }
+    Calibration_Task();
+    return lines - before;
+}
+
+static void Orientation(uint8_t k, double a[3])
+{
+    a[0] = a[1] = a[2] = 0;
+    a[k / 2] = k % 2 ? -CALIBRATION_GRAVITY : CALIBRATION_GRAVITY;
+}
+
+static void Session(double gain_error)
+{
+    for (int c = 0; c < 6; c++)
+    {
+        double a[3];
+        Orientation(capture_order[c], a);
+        Capture(a, gain_error, NOISE);
+    }
+}
+
+static int32_t GetInt(const uint8_t* data, uint8_t bytes)
+{
+    uint32_t value = 0;
+    for (uint8_t i = bytes; i > 0; i--)
+    {
+        value = (value << 8) | data[i - 1];
+    }
+    return bytes == 2 ? (int16_t)value : (int32_t)value;
+}
+
+/*
+* Inverse of the sensitivity matrix (the exact full correction).
+*/
+static void Inverse(double inverse[3][3])
+{
+    const double (*s)[3] = sensitivity;
+    double determinant = s[0][0] * (s[1][1] * s[2][2] - s[1][2] * s[2][1]) -
+                         s[0][1] * (s[1][0] * s[2][2] - s[1][2] * s[2][0]) +
+                         s[0][2] * (s[1][0] * s[2][1] - s[1][1] * s[2][0]);
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            int r0 = (j + 1) % 3, r1 = (j + 2) % 3, c0 = (i + 1) % 3, c1 = (i + 2) % 3;
+            inverse[i][j] = (s[r0][c0] * s[r1][c1] - s[r0][c1] * s[r1][c0]) / determinant;
+        }
+    }
+}
+
+/*
+* Worst error of the corrected readings over random directions of gravity
+* and 2 g along the diagonals, noise-free.
+*/
+static double Worst(void)
+{
+    double worst = 0;
+    for (int n = 0; n < DIRECTIONS + 8; n++)
+    {
+        double a[3], norm = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            a[i] = n < DIRECTIONS ? Gaussian() : ((n >> i) & 1 ? 1.0 : -1.0);
+            norm += a[i] * a[i];
+        }
+        double magnitude = n < DIRECTIONS ? CALIBRATION_GRAVITY : 2.0 * CALIBRATION_GRAVITY;
+        for (int i = 0; i < 3; i++)
+        {
+            a[i] *= magnitude / sqrt(norm);
+        }
+        int32_t reading[3];
+        Read(a, 1.0, 0, reading);
+        Calibration_Apply(reading);
+        for (int i = 0; i < 3; i++)
+        {
+            double error = fabs(reading[i] - a[i]);
+            worst = error > worst ? error : worst;
+        }
+    }
+    return worst;
+}
+
+int main(void)
+{
+    int failures = 0;
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    Calibration_Init();
+
+    // Calibration session, then the result from the saved image
+    Session(1.0);
+    const uint8_t* image = &eeprom[STORAGE_CALIBRATION_ADDRESS];
+    failures += Calibration_GetMode() != CALIBRATION_FULL_MATRIX;
+    double inverse[3][3];
+    Inverse(inverse);
+    double offset_error = 0, gain_error = 0, matrix_error = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        double error = fabs(GetInt(&image[4 + 4 * i], 4) - true_offset[i]);
+        offset_error = error > offset_error ? error : offset_error;
+        error = fabs(GetInt(&image[34 + 2 * i], 2) - 4096.0 / sensitivity[i][i]);
+        gain_error = error > gain_error ? error : gain_error;
+        for (int j = 0; j < 3; j++)
+        {
+            error = fabs(GetInt(&image[16 + 6 * i + 2 * j], 2) - 4096.0 * inverse[i][j]);
+            matrix_error = error > matrix_error ? error : matrix_error;
+        }
+    }
+    failures += offset_error > OFFSET_LIMIT || gain_error > MATRIX_LIMIT || matrix_error > MATRIX_LIMIT;
+    printf("solved offsets within %.1f mm/s^2, gains within %.1f/4096, matrix within %.1f/4096%s\n",
+           offset_error, gain_error, matrix_error,
+           offset_error > OFFSET_LIMIT || gain_error > MATRIX_LIMIT || matrix_error > MATRIX_LIMIT ? "  UNEXPECTED" : "");
+
+    // Corrected readings in both modes, with the correction off for reference
+    double full = Worst();
+    Calibration_SetMode(CALIBRATION_OFFSET_GAIN);
+    double gain_only = Worst();
+    Calibration_SetMode(CALIBRATION_OFF);
+    double off = Worst();
+    failures += full > FULL_LIMIT || gain_only < full || off < gain_only;
+    printf("worst error of a reading: %.0f mm/s^2 uncorrected, %.0f offset and gain, %.0f full matrix%s\n",
+           off, gain_only, full, full > FULL_LIMIT || gain_only < full || off < gain_only ? "  UNEXPECTED" : "");
+
+    // A restart loads the saved mode and correction
+    Calibration_SetMode(CALIBRATION_FULL_MATRIX);
+    Calibration_SetMode(CALIBRATION_OFF);
+    Calibration_SetMode(CALIBRATION_FULL_MATRIX);
+    Calibration_Init();
+    double restarted = Worst();
+    failures += Calibration_GetMode() != CALIBRATION_FULL_MATRIX || restarted != full;
+    printf("after a restart: mode %d, worst error %.0f mm/s^2%s\n", Calibration_GetMode(), restarted,
+           Calibration_GetMode() != CALIBRATION_FULL_MATRIX || restarted != full ? "  UNEXPECTED" : "");
+
+    // Rejected captures and sessions
+    double a[3];
+    Orientation(4, a);
+    Capture(a, 1.0, 4 * CALIBRATION_MAX_NOISE);
+    int moved = strstr(last_line, "moved") != NULL;
+    double tilted[3] = {CALIBRATION_GRAVITY * 0.6, CALIBRATION_GRAVITY * 0.6, CALIBRATION_GRAVITY * 0.53};
+    Capture(tilted, 1.0, NOISE);
+    int not_aligned = strstr(last_line, "no axis") != NULL;
+    uint8_t saved[STORAGE_CALIBRATION_SIZE];
+    memcpy(saved, image, sizeof(saved));
+    Session(1.35);
+    int out_of_range = strstr(last_line, "out of range") != NULL && memcmp(saved, image, sizeof(saved)) == 0;
+    failures += !moved + !not_aligned + !out_of_range;
+    printf("moving board %s, no axis along gravity %s, gains 1.35 times higher %s\n", moved ? "rejected" : "ACCEPTED",
+           not_aligned ? "rejected" : "ACCEPTED", out_of_range ? "rejected" : "ACCEPTED");
+
+    printf("%s\n", failures ? "UNEXPECTED RESULTS" : "calibration as expected");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,235 @@
+/*
+* Host test of the threshold triggered capture of the firmware (Capture.c).
+*
+* Samples enter Capture_AddSample() in batches of one Timer tick (10 ms)
+* at the data rate of each case, then the capture task runs. The burst
+* frame goes to a simulated UART at 19200 baud (1920 bytes/s): each run
+* may write the bytes the link sends in the rest of the tick, as
+* Acquisition_GetTxAllowance() reports on the board.
+*
+* Every sample carries its own index, so each decoded burst is checked
+* sample by sample: the pre-trigger samples and the post-trigger samples
+* (trigger included) must be the ones around the trigger, in order. A
+* second trigger follows right after each dump; at 400 Hz the samples
+* acquired during the dump catch up with the samples still to be sent (the
+* lapping case): the window being sent and the next one must still hold
+* only valid samples.
+* A trigger during the dump must be reported as missed. Exits with 1 on
+* an unexpected result.
+*
+* Build and run from the Host_Tools folder (psoc holds the minimal PSoC
+* headers for the host):
+*
+*     cc -O2 -Ipsoc -I../AY1920_II_HW_05_PROJ_3.cydsn capture_check.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Capture.c -o capture_check
+*     ./capture_check
+*/
+
+#include <stdio.h>
+#include "Acquisition.h"
+#include "Capture.h"
+#include "Frames.h"
+
+#define LINK_RATE 1920          // Bytes per second at 19200 baud
+#define TICK_BYTES (LINK_RATE / 100)
+#define GRAVITY 9806            // [mm/s^2], below the magnitude threshold
+#define SPIKE 30000             // [mm/s^2], above it
+#define BURST_BYTES (11 + 12 * CAPTURE_MAX_WINDOW + 2)
+#define MAX_TICKS 1000
+
+static uint8_t burst[BURST_BYTES];
+static uint16_t burst_length = 0;
+static uint8_t burst_open = 0;
+static uint8_t burst_done = 0;
+static uint32_t link_queued = 0;        // Bytes written but not sent yet
+static uint32_t link_waits = 0;         // Writes beyond the allowance
+
+uint16_t Acquisition_GetTxAllowance(void)
+{
+    return link_queued < TICK_BYTES ? TICK_BYTES - link_queued : 0;
+}
+
+static void LinkWrite(const uint8_t* data, uint16_t length)
+{
+    for (uint16_t i = 0; i < length; i++)
+    {
+        if (burst_length < sizeof(burst))
+        {
+            burst[burst_length++] = data[i];
+        }
+    }
+    link_queued += length;
+    link_waits += link_queued > TICK_BYTES;
+}
+
+ErrorCode Frames_Begin(uint8_t header)
+{
+    if (burst_open)
+    {
+        return ERROR;
+    }
+    burst_open = 1;
+    burst_length = 0;
+    LinkWrite(&header, 1);
+    return NO_ERROR;
+}
+
+void Frames_Write(const uint8_t* data, uint8_t length)
+{
+    LinkWrite(data, length);
+}
+
+void Frames_End(void)
+{
+    uint8_t tail = FRAME_TAIL;
+    LinkWrite(&tail, 1);
+    burst_open = 0;
+    burst_done = 1;
+}
+
+uint8_t* Frames_PutUint16(uint8_t* buffer, uint16_t value)
+{
+    buffer[0] = (uint8_t)(value & 0xFF);
+    buffer[1] = (uint8_t)(value >> 8);
+    return buffer + 2;
+}
+
+uint8_t* Frames_PutUint32(uint8_t* buffer, uint32_t value)
+{
+    buffer[0] = (uint8_t)(value & 0xFF);
+    buffer[1] = (uint8_t)((value >> 8) & 0xFF);
+    buffer[2] = (uint8_t)((value >> 16) & 0xFF);
+    buffer[3] = (uint8_t)(value >> 24);
+    return buffer + 4;
+}
+
+static uint32_t GetUint(const uint8_t* data, uint8_t bytes)
+{
+    uint32_t value = 0;
+    for (uint8_t i = bytes; i > 0; i--)
+    {
+        value = (value << 8) | data[i - 1];
+    }
+    return value;
+}
+
+/**
+*   \brief Simulated stream: X and Y carry the index of the sample, Z the
+*   gravity or a spike at the trigger samples.
+*/
+static uint32_t sample_index = 0;
+static uint32_t spikes[3];
+static uint8_t spike_count = 0;
+
+static void Sample(void)
+{
+    int32_t acceleration[3] = {(int32_t)(sample_index & 0xFFF), (int32_t)(sample_index >> 12), GRAVITY};
+    for (uint8_t n = 0; n < spike_count; n++)
+    {
+        acceleration[2] = spikes[n] == sample_index ? SPIKE : acceleration[2];
+    }
+    Capture_AddSample(acceleration, sample_index);
+    sample_index++;
+}
+
+/*
+* Run ticks until a burst is complete; returns the ticks from the header to
+* the tail, 0 if no burst came.
+*/
+static uint32_t WaitBurst(uint16_t rate)
+{
+    uint32_t ticks = 0;
+    burst_done = 0;
+    for (uint32_t tick = 0; tick < MAX_TICKS; tick++)
+    {
+        for (uint16_t n = 0; n < rate / 100; n++)
+        {
+            Sample();
+        }
+        Capture_Task();
+        link_queued = link_queued > TICK_BYTES ? link_queued - TICK_BYTES : 0;
+        ticks += burst_open || burst_done;
+        if (burst_done)
+        {
+            return ticks;
+        }
+    }
+    return 0;
+}
+
+/*
+* Decode the last burst and check its samples; returns the failed checks.
+*/
+static int CheckBurst(const char* name, uint16_t rate, uint32_t ticks, uint32_t trigger,
+                      uint16_t min_pre, uint16_t missed)
+{
+    int failures = 0;
+    uint32_t trigger_index = GetUint(&burst[1], 4);
+    uint16_t pre = GetUint(&burst[5], 2);
+    uint16_t post = GetUint(&burst[7], 2);
+    uint16_t missed_triggers = GetUint(&burst[10], 2);
+    uint16_t wrong = 0;
+    failures += ticks == 0 || burst[0] != FRAME_HEADER_BURST;
+    failures += burst_length != BURST_BYTES - 12 * (CAPTURE_MAX_WINDOW - pre - post) || burst[burst_length - 1] != FRAME_TAIL;
+    failures += trigger_index != trigger || pre < min_pre || pre > CAPTURE_DEFAULT_PRE ||
+                post != CAPTURE_DEFAULT_POST || missed_triggers != missed;
+    for (uint16_t n = 0; n < pre + post && 12 + 12 * n + 12 < burst_length; n++)
+    {
+        const uint8_t* sample = &burst[12 + 12 * n];
+        uint32_t index = GetUint(sample, 4) | GetUint(&sample[4], 4) << 12;
+        wrong += index != trigger - pre + n;
+    }
+    failures += wrong > 0;
+    printf("%3u Hz  %-22s trigger %5lu, pre %2u, post %2u, missed %u, %3u wrong samples, "
+           "dump %4lu ms%s\n", rate, name, (unsigned long)trigger_index, pre, post, missed_triggers,
+           wrong, (unsigned long)ticks * 10, failures ? "  UNEXPECTED" : "");
+    return failures;
+}
+
+static int Run(uint16_t rate)
+{
+    int failures = 0;
+    int32_t none[3] = {0, 0, 0};
+    Capture_Init();
+    Capture_Configure(CAPTURE_DEFAULT_PRE, CAPTURE_DEFAULT_POST, none, CAPTURE_DEFAULT_MAGNITUDE_THS);
+    sample_index = 0;
+    link_queued = 0;
+    link_waits = 0;
+
+    // A first trigger with a full buffer, one during its dump
+    uint32_t first = 1000;
+    uint32_t dump_samples = (uint32_t)BURST_BYTES * rate / LINK_RATE;
+    spikes[0] = first;
+    spikes[1] = first + CAPTURE_DEFAULT_POST + dump_samples / 2;
+    spike_count = 2;
+    while (sample_index < first)
+    {
+        Sample();
+    }
+    uint32_t ticks = WaitBurst(rate);
+    failures += CheckBurst("full buffer", rate, ticks, first, CAPTURE_DEFAULT_PRE, 0);
+
+    // The next trigger right after the dump: the samples acquired during
+    // the dump must not have overwritten the window, nor end up in the next
+    // one out of order
+    uint32_t second = sample_index + 1;
+    // The writer catches up with the samples still to send when more than
+    // the free half and the window arrive during the dump
+    uint8_t lapping = dump_samples > CAPTURE_BUFFER_SIZE;
+    uint16_t min_pre = lapping ? 0 : CAPTURE_DEFAULT_PRE;
+    spikes[0] = second;
+    spike_count = 1;
+    ticks = WaitBurst(rate);
+    failures += CheckBurst(lapping ? "after a lapping dump" : "after the dump",
+                           rate, ticks, second, min_pre, 1);
+    failures += link_waits > 0;
+    return failures;
+}
+
+int main(void)
+{
+    int failures = Run(100) + Run(200) + Run(400);
+    printf("%s (burst of %u bytes, %u bytes per tick)\n", failures ? "FAILED" : "all bursts as expected",
+           BURST_BYTES, TICK_BYTES);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+"""Residual error of the clock sync estimator on a simulated drifting clock.
+
+The device clock runs with a constant rate error plus a slow thermal
+wander; the sync frames reach the host after the UART transmission of the
+bytes left in the 4-byte FIFO before them and a random OS/USB latency.
+Without a software TX buffer (the UART_Debug of the firmware) the frames
+report 0 pending bytes: the FIFO bytes are a delay the estimator does not
+see. Every second the timestamps of the last second of samples are mapped
+on the host clock with the estimate available at that time (as a live
+decoder would) and compared with the true host time. Three mappings are compared:
+
+- nominal: offset of the first sync frame and the nominal rate;
+- least squares: line fitted on every sync frame received so far;
+- ClockSync: sliding window, lower envelope fit (frames.py).
+
+The minimum latency of the link cannot be observed, so the mean error is
+reported apart from the spread (the error minus its mean).
+
+    python clock_sync_sim.py --hours 4 --skew 40 --wander 5
+"""
+
+import argparse
+import math
+import random
+import struct
+
+import frames
+
+FIFO_LENGTH = 4     # TX FIFO of UART_Debug [bytes]
+
+
+def device_clock(true_time, skew_ppm, wander_ppm, wander_period):
+    """Device time [s] at a true time: integral of the rate error."""
+    omega = 2 * math.pi / wander_period
+    drift = skew_ppm * true_time + wander_ppm * (1 - math.cos(omega * true_time)) / omega
+    return true_time + drift * 1e-6
+
+
+def sync_payload(device_time, pending):
+    raw = int(device_time * 1e6) & 0xFFFFFFFF
+    return struct.pack("<IIIH", int(device_time * 100) & 0xFFFFFFFF, raw, 0, pending)
+
+
+class RunningLine:
+    """Least squares line on every point, from running sums."""
+
+    def __init__(self, origin):
+        self.origin = origin
+        self.n = self.sd = self.sh = self.sdd = self.sdh = 0.0
+
+    def add(self, device, host):
+        d, h = device - self.origin[0], host - self.origin[1]
+        self.n += 1
+        self.sd += d
+        self.sh += h
+        self.sdd += d * d
+        self.sdh += d * h
+
+    def to_host(self, device):
+        slope = (self.n * self.sdh - self.sd * self.sh) / (self.n * self.sdd - self.sd ** 2)
+        offset = (self.sh - slope * self.sd) / self.n
+        return self.origin[1] + offset + slope * (device - self.origin[0])
+
+
+def statistics(errors):
+    mean = sum(errors) / len(errors)
+    spread = [e - mean for e in errors]
+    rms = math.sqrt(sum(e * e for e in spread) / len(spread))
+    return mean, rms, max(abs(e) for e in spread)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--hours", type=float, default=4.0)
+    parser.add_argument("--skew", type=float, default=40.0, help="rate error [ppm]")
+    parser.add_argument("--wander", type=float, default=5.0, help="thermal wander amplitude [ppm]")
+    parser.add_argument("--wander-period", type=float, default=3600.0, help="[s]")
+    parser.add_argument("--baud", type=int, default=19200)
+    parser.add_argument("--latency", type=float, default=2e-3, help="mean OS/USB latency [s]")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    random.seed(args.seed)
+    estimator = frames.ClockSync(baud=args.baud)
+    everything = None
+    nominal = None
+    errors = {"nominal": [], "least squares": [], "ClockSync": []}
+
+    for second in range(1, int(args.hours * 3600)):
+        # Samples of the last second, mapped with the current estimates
+        if estimator.line is not None:
+            for n in range(0, 100, 10):
+                true_time = second - 1 + n / 100.0
+                raw = int(device_clock(true_time, args.skew, args.wander, args.wander_period) * 1e6) & 0xFFFFFFFF
+                errors["ClockSync"].append(estimator.to_host(raw) - true_time)
+                errors["least squares"].append(everything.to_host(estimator.unwrap(raw) / 1e6) - true_time)
+                errors["nominal"].append(nominal[1] + (estimator.unwrap(raw) - nominal[0]) / 1e6 - true_time)
+
+        # Sync frame: queued behind what is left in the FIFO, not reported
+        device_time = device_clock(second, args.skew, args.wander, args.wander_period)
+        payload = sync_payload(device_time, 0)
+        transmission = (random.randint(0, FIFO_LENGTH) + 16) * 10.0 / args.baud
+        latency = 0.5e-3 + random.expovariate(1.0 / args.latency)
+        if random.random() < 0.01:
+            latency += random.uniform(10e-3, 50e-3)  # scheduling hiccup
+        arrival = second + transmission + latency
+        estimator.add(payload, arrival)
+        if nominal is None:
+            nominal = (estimator.last_device, arrival - transmission)
+            everything = RunningLine((estimator.last_device / 1e6, arrival - transmission))
+        everything.add(estimator.last_device / 1e6, arrival - transmission)
+
+    print("%.1f h, skew %.0f ppm, wander %.0f ppm, latency %.1f ms mean"
+          % (args.hours, args.skew, args.wander, args.latency * 1e3))
+    print("%-14s %10s %10s %10s" % ("mapping", "mean [ms]", "rms [ms]", "max [ms]"))
+    for name, values in errors.items():
+        mean, rms, peak = statistics(values)
+        print("%-14s %10.3f %10.3f %10.3f" % (name, mean * 1e3, rms * 1e3, peak * 1e3))
+    print("device rate error at the end: %.2f ppm estimated" % -estimator.skew())
+
+
+if __name__ == "__main__":
+    main()
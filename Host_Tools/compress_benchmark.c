@@ -0,0 +1,164 @@
+/*
+* Compression ratio and throughput of the lossless compression of the
+* firmware (Compress.c). The samples are taken from the sample frames of a
+* recorded UART stream or, without a file, from a synthetic stream (board
+* at rest, then a 40 Hz vibration). Every frame is decoded back and
+* compared with the original samples.
+*
+* Build and run from the Host_Tools folder:
+*
+*     cc -O2 -I../AY1920_II_HW_05_PROJ_3.cydsn compress_benchmark.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Compress.c -lm -o compress_benchmark
+*     ./compress_benchmark [recording.bin]
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Compress.h"
+
+#define MAX_SAMPLES 2000000
+#define SYNTHETIC_SAMPLES 360000    // One hour at 100 Hz
+#define SAMPLE_FRAME_BYTES 14       // Header, X, Y, Z as int32, tail
+#define PI 3.14159265358979323846
+
+static int32_t samples[MAX_SAMPLES][3];
+static int32_t decoded[MAX_SAMPLES][3];
+
+static double Elapsed(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+/*
+* Sample frames (0xA0, 12 bytes, 0xC0) of a recording.
+*/
+static long LoadRecording(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* data = malloc(size);
+    if (data == NULL || fread(data, 1, size, file) != (size_t)size)
+    {
+        fclose(file);
+        free(data);
+        return -1;
+    }
+    fclose(file);
+
+    long count = 0;
+    for (long i = 0; i + 13 < size && count < MAX_SAMPLES; i++)
+    {
+        if (data[i] == 0xA0 && data[i + 13] == 0xC0)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                const uint8_t* p = &data[i + 1 + 4 * axis];
+                samples[count][axis] = (int32_t)(p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24));
+            }
+            count++;
+            i += 13;
+        }
+    }
+    free(data);
+    return count;
+}
+
+/*
+* Samples of the LIS3DH at +-2 g (1 mg/digit, 12 bits): at rest, then
+* with a vibration, with a few LSB of noise.
+*/
+static long Synthesize(void)
+{
+    srand(1);
+    for (long n = 0; n < SYNTHETIC_SAMPLES; n++)
+    {
+        double vibration = n < SYNTHETIC_SAMPLES / 2 ? 0 : 200 * sin(2 * PI * 40 * n / 100.0);
+        double gravity[3] = {12, -30, 1000};
+        for (int axis = 0; axis < 3; axis++)
+        {
+            int digits = (int)lround(gravity[axis] + vibration * (axis + 1) / 3 + (rand() % 7 - 3));
+            samples[n][axis] = digits * 9806 / 1000;
+        }
+    }
+    return SYNTHETIC_SAMPLES;
+}
+
+int main(int argc, char** argv)
+{
+    long count = argc > 1 ? LoadRecording(argv[1]) : Synthesize();
+    if (count <= 0)
+    {
+        fprintf(stderr, "No sample frames\n");
+        return 1;
+    }
+    count -= count % COMPRESS_FRAME_SAMPLES;
+
+    // Encode the whole stream
+    long frames = count / COMPRESS_FRAME_SAMPLES;
+    uint8_t* payloads = malloc((size_t)frames * COMPRESS_MAX_PAYLOAD);
+    uint64_t coded_bytes = 0;
+    long verbatim = 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    Compress_Reset();
+    for (long n = 0, f = 0; n < count; n++)
+    {
+        uint8_t length = Compress_AddSample(samples[n], (uint32_t)n, &payloads[f * COMPRESS_MAX_PAYLOAD]);
+        if (length > 0)
+        {
+            coded_bytes += length + 2;  // header and tail
+            verbatim += (payloads[f * COMPRESS_MAX_PAYLOAD + 1] & COMPRESS_FLAG_VERBATIM) != 0;
+            f++;
+        }
+    }
+    double encode_time = Elapsed(&start);
+
+    // Decode it back
+    Compress_Decoder decoder;
+    Compress_InitDecoder(&decoder);
+    long decoded_count = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long f = 0; f < frames; f++)
+    {
+        const uint8_t* payload = &payloads[f * COMPRESS_MAX_PAYLOAD];
+        uint8_t n;
+        uint32_t index;
+        if (Compress_Decode(&decoder, payload, payload[0], &decoded[decoded_count], &n, &index) != NO_ERROR ||
+            index != (uint32_t)decoded_count)
+        {
+            fprintf(stderr, "Decoding failed at frame %ld\n", f);
+            return 1;
+        }
+        decoded_count += n;
+    }
+    double decode_time = Elapsed(&start);
+
+    if (decoded_count != count || memcmp(samples, decoded, (size_t)count * sizeof(samples[0])) != 0)
+    {
+        fprintf(stderr, "Decoded samples differ\n");
+        return 1;
+    }
+
+    uint64_t raw_bytes = (uint64_t)count * SAMPLE_FRAME_BYTES;
+    printf("%ld samples, %ld frames (%ld verbatim), lossless\n", count, frames, verbatim);
+    printf("sample frames    %10llu bytes\n", (unsigned long long)raw_bytes);
+    printf("compressed       %10llu bytes, ratio %.2f, %.2f bytes/sample\n",
+           (unsigned long long)coded_bytes, (double)raw_bytes / coded_bytes, (double)coded_bytes / count);
+    printf("encode           %10.1f Msamples/s\n", count / encode_time * 1e-6);
+    printf("decode           %10.1f Msamples/s\n", count / decode_time * 1e-6);
+    free(payloads);
+    return 0;
+}
@@ -0,0 +1,212 @@
+/*
+* Check and throughput of the bulk conversion of raw LIS3DH samples
+* (lis3dh_convert.c). Every 16-bit raw word is converted at the four full
+* scales by each kernel, raw and packed, and compared with the expression
+* of Device_Convert() in Device.c; then the kernels convert the samples of
+* a raw recording (6 bytes per sample, OUT_X_L ... OUT_Z_H) or, without a
+* file, a synthetic stream, and the rates are printed in GB/s of input.
+*
+* Build and run from the Host_Tools folder:
+*
+*     cc -O2 convert_benchmark.c lis3dh_convert.c -lm -o convert_benchmark
+*     ./convert_benchmark [raw.bin]
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lis3dh_convert.h"
+
+#define SYNTHETIC_SAMPLES 8000000   // About 22 hours at 100 Hz
+#define RUNS 5
+#define PI 3.14159265358979323846
+
+static const uint32_t scales[4] = {LIS3DH_SCALE_2G, LIS3DH_SCALE_4G, LIS3DH_SCALE_8G, LIS3DH_SCALE_16G};
+
+static double Elapsed(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+/*
+* Device_Convert() of the firmware, for one sample.
+*/
+static void DeviceConvert(uint32_t um_s2_per_digit, const uint8_t* data, int32_t acceleration[3])
+{
+    for (uint8_t axis = 0; axis < 3; axis++)
+    {
+        int16_t out = (int16_t)(data[2 * axis] | (data[2 * axis + 1] << 8)) >> 4;
+        acceleration[axis] = ((int32_t)out * (int32_t)um_s2_per_digit) / 1000;
+    }
+}
+
+/*
+* Convert every raw word at every scale with every kernel; the sample
+* counts 0 ... 40 exercise the tails of the SIMD loops.
+*/
+static int Check(void)
+{
+    size_t samples = 65536 / 3 + 1;
+    uint8_t* raw = calloc(LIS3DH_RAW_SIZE(samples), 1);
+    uint8_t* packed = calloc(LIS3DH_PACKED_SIZE(samples), 1);
+    int32_t (*expected)[3] = malloc(samples * sizeof(*expected));
+    int32_t (*out)[3] = malloc(samples * sizeof(*out));
+    for (size_t i = 0; i < 65536; i++)
+    {
+        raw[2 * i] = (uint8_t)i;
+        raw[2 * i + 1] = (uint8_t)(i >> 8);
+    }
+    Lis3dh_Pack(raw, samples, packed);
+
+    int errors = 0;
+    for (int s = 0; s < 4; s++)
+    {
+        for (size_t n = 0; n < samples; n++)
+        {
+            DeviceConvert(scales[s], &raw[6 * n], expected[n]);
+        }
+        for (Lis3dh_Kernel kernel = LIS3DH_KERNEL_SCALAR; kernel <= Lis3dh_BestKernel(); kernel++)
+        {
+            for (size_t count = 0; count <= 40; count++)
+            {
+                Lis3dh_ConvertRaw(raw, count, scales[s], out, kernel);
+                errors += count && memcmp(out, expected, count * sizeof(*out)) != 0;
+                Lis3dh_ConvertPacked(packed, count, scales[s], out, kernel);
+                errors += count && memcmp(out, expected, count * sizeof(*out)) != 0;
+            }
+            Lis3dh_ConvertRaw(raw, samples, scales[s], out, kernel);
+            errors += memcmp(out, expected, samples * sizeof(*out)) != 0;
+            Lis3dh_ConvertPacked(packed, samples, scales[s], out, kernel);
+            errors += memcmp(out, expected, samples * sizeof(*out)) != 0;
+        }
+    }
+    free(raw);
+    free(packed);
+    free(expected);
+    free(out);
+    return errors;
+}
+
+static uint8_t* LoadRecording(const char* path, size_t* samples)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* data = malloc(size > 0 ? size : 1);
+    if (data == NULL || fread(data, 1, size, file) != (size_t)size)
+    {
+        fclose(file);
+        free(data);
+        return NULL;
+    }
+    fclose(file);
+    *samples = (size_t)size / 6;
+    return data;
+}
+
+/*
+* Raw samples at +-2 g: at rest, then with a 40 Hz vibration, with a few
+* LSB of noise.
+*/
+static uint8_t* Synthesize(size_t* samples)
+{
+    uint8_t* raw = malloc(LIS3DH_RAW_SIZE(SYNTHETIC_SAMPLES));
+    srand(1);
+    for (size_t n = 0; n < SYNTHETIC_SAMPLES; n++)
+    {
+        double vibration = n < SYNTHETIC_SAMPLES / 2 ? 0 : 200 * sin(2 * PI * 40 * n / 100.0);
+        double gravity[3] = {12, -30, 1000};
+        for (int axis = 0; axis < 3; axis++)
+        {
+            int digits = (int)lround(gravity[axis] + vibration * (axis + 1) / 3 + (rand() % 7 - 3));
+            uint16_t word = (uint16_t)(digits * 16);
+            raw[6 * n + 2 * axis] = (uint8_t)word;
+            raw[6 * n + 2 * axis + 1] = (uint8_t)(word >> 8);
+        }
+    }
+    *samples = SYNTHETIC_SAMPLES;
+    return raw;
+}
+
+/*
+* Best time of RUNS conversions [s].
+*/
+static double Time(int packed_layout, const uint8_t* data, size_t samples, int32_t (*out)[3], Lis3dh_Kernel kernel)
+{
+    double best = INFINITY;
+    for (int run = 0; run < RUNS; run++)
+    {
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (packed_layout)
+        {
+            Lis3dh_ConvertPacked(data, samples, LIS3DH_SCALE_2G, out, kernel);
+        }
+        else
+        {
+            Lis3dh_ConvertRaw(data, samples, LIS3DH_SCALE_2G, out, kernel);
+        }
+        double elapsed = Elapsed(&start);
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    int errors = Check();
+    printf("check: every raw word at 4 scales, raw and packed, %d kernels: %s\n",
+           (int)Lis3dh_BestKernel() + 1, errors ? "MISMATCH" : "bit-identical");
+    if (errors)
+    {
+        return 1;
+    }
+
+    size_t samples = 0;
+    uint8_t* raw = argc > 1 ? LoadRecording(argv[1], &samples) : Synthesize(&samples);
+    if (raw == NULL || samples == 0)
+    {
+        fprintf(stderr, "No samples\n");
+        return 1;
+    }
+    uint8_t* packed = calloc(LIS3DH_PACKED_SIZE(samples), 1);
+    int32_t (*out)[3] = malloc(samples * sizeof(*out));
+    int32_t (*reference)[3] = malloc(samples * sizeof(*reference));
+    Lis3dh_Pack(raw, samples, packed);
+    Lis3dh_ConvertRaw(raw, samples, LIS3DH_SCALE_2G, reference, LIS3DH_KERNEL_SCALAR);
+
+    printf("%zu samples: raw %zu bytes, packed %zu bytes\n", samples, LIS3DH_RAW_SIZE(samples),
+           LIS3DH_PACKED_SIZE(samples));
+    for (int layout = 0; layout < 2; layout++)
+    {
+        const uint8_t* data = layout ? packed : raw;
+        size_t bytes = layout ? LIS3DH_PACKED_SIZE(samples) : LIS3DH_RAW_SIZE(samples);
+        double scalar_time = 0;
+        for (Lis3dh_Kernel kernel = LIS3DH_KERNEL_SCALAR; kernel <= Lis3dh_BestKernel(); kernel++)
+        {
+            double time = Time(layout, data, samples, out, kernel);
+            scalar_time = kernel == LIS3DH_KERNEL_SCALAR ? time : scalar_time;
+            int same = memcmp(out, reference, samples * sizeof(*out)) == 0;
+            printf("%-6s %-6s %7.2f GB/s %8.1f Msamples/s  x%.1f%s\n", layout ? "packed" : "raw",
+                   Lis3dh_KernelName(kernel), bytes / time * 1e-9, samples / time * 1e-6, scalar_time / time,
+                   same ? "" : "  MISMATCH");
+            errors += !same;
+        }
+    }
+    free(raw);
+    free(packed);
+    free(out);
+    free(reference);
+    return errors ? 1 : 0;
+}
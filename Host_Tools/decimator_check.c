@@ -0,0 +1,210 @@
+/*
+* Frequency response and speed of the decimation filter chain of the
+* firmware (Decimator.c).
+*
+* For every decimation factor, tones from 0 to half the input rate go
+* through Decimator_Process() in batches of 32 samples (a full FIFO); the
+* amplitude and phase of the decimated tone are fitted by least squares at
+* its aliased frequency. The gain is checked against Decimator.h, fo being
+* the output rate: flat within 1% up to 0.3 fo, and the tones from 0.6 fo
+* that fold into the passband attenuated at least 48 dB. The worst alias
+* into the transition band (0.3 ... 0.5 fo) is printed too. The response
+* of the default factor follows, then the host time per input sample of
+* each factor.
+*
+* Build and run from the Host_Tools folder:
+*
+*     cc -O2 -I../AY1920_II_HW_05_PROJ_3.cydsn decimator_check.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Decimator.c -lm -o decimator_check
+*     ./decimator_check
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include "Decimator.h"
+
+#define BATCH 32                // Samples of a full LIS3DH FIFO
+#define SETTLE 40               // Decimated samples discarded (filter delay)
+#define FITTED 2000             // Decimated samples fitted
+#define AMPLITUDE 100000.0      // [mm/s^2], about 10 g
+#define STEPS_PER_FO 200        // Tones per output rate
+#define PASSBAND 0.3            // Of the output rate
+#define STOPBAND 0.6
+#define PASSBAND_RIPPLE 0.01
+#define STOPBAND_LIMIT -48.0    // Gain of the aliases in the passband [dB]
+#define TIMED_SAMPLES 4000000
+#define PI 3.14159265358979323846
+
+
+static double Elapsed(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+/*
+* Amplitude of the sinusoid of angular frequency w [rad/sample] in y,
+* fitted with a constant by least squares.
+*/
+static double Fit(const double* y, int n, double w)
+{
+    // Normal equations of y = a cos + b sin + c
+    double m[3][4] = {{0}};
+    for (int i = 0; i < n; i++)
+    {
+        double basis[3] = {cos(w * i), sin(w * i), 1.0};
+        for (int r = 0; r < 3; r++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                m[r][c] += basis[r] * basis[c];
+            }
+            m[r][3] += basis[r] * y[i];
+        }
+    }
+    for (int p = 0; p < 3; p++)
+    {
+        for (int r = p + 1; r < 3; r++)
+        {
+            double k = m[r][p] / m[p][p];
+            for (int c = p; c < 4; c++)
+            {
+                m[r][c] -= k * m[p][c];
+            }
+        }
+    }
+    double x[3];
+    for (int r = 2; r >= 0; r--)
+    {
+        x[r] = m[r][3];
+        for (int c = r + 1; c < 3; c++)
+        {
+            x[r] -= m[r][c] * x[c];
+        }
+        x[r] /= m[r][r];
+    }
+    return hypot(x[0], x[1]);
+}
+
+/*
+* Frequency of a tone at f after the decimation, folded in 0 ... 0.5 fo.
+*/
+static double Aliased(double f)
+{
+    double aliased = fmod(f, 1.0);
+    return aliased > 0.5 ? 1.0 - aliased : aliased;
+}
+
+/*
+* Gain of the chain for a tone at f, as a fraction of the output rate.
+*/
+static double Gain(uint8_t factor, double f)
+{
+    static int32_t input[BATCH][3];
+    static int32_t output[BATCH / 2 + 1][3];
+    static double y[FITTED];
+    Decimator_Configure(factor);
+    int decimated = 0;
+    long n = 0;
+    double w = 2 * PI * f / factor;     // [rad/input sample]
+    while (decimated < SETTLE + FITTED)
+    {
+        for (int i = 0; i < BATCH; i++, n++)
+        {
+            int32_t value = (int32_t)lround(AMPLITUDE * sin(w * n + 0.3));
+            input[i][0] = value;
+            input[i][1] = -value;
+            input[i][2] = 9806 + value / 2;
+        }
+        uint8_t count = Decimator_Process(input, BATCH, output);
+        for (uint8_t i = 0; i < count; i++, decimated++)
+        {
+            if (decimated >= SETTLE && decimated < SETTLE + FITTED)
+            {
+                y[decimated - SETTLE] = output[i][0];
+            }
+        }
+    }
+    return Fit(y, FITTED, 2 * PI * Aliased(f)) / AMPLITUDE;
+}
+
+int main(void)
+{
+    int failures = 0;
+    printf("%6s %16s %26s %26s\n", "factor", "passband ripple", "aliases in the passband", "in the transition band");
+    for (uint8_t factor = DECIMATOR_MIN_FACTOR; factor <= DECIMATOR_MAX_FACTOR; factor *= 2)
+    {
+        double ripple = 0, stopband = -INFINITY, transition = -INFINITY, worst_f = 0, transition_f = 0;
+        // Tones up to half the input rate, off the aliases of DC and fo/2
+        for (int step = 1; step < STEPS_PER_FO * factor / 2; step++)
+        {
+            double f = (step + 0.37) / STEPS_PER_FO;
+            if (f >= factor / 2.0)
+            {
+                break;
+            }
+            double gain = Gain(factor, f);
+            if (f <= PASSBAND)
+            {
+                ripple = fabs(gain - 1) > ripple ? fabs(gain - 1) : ripple;
+            }
+            else if (f >= STOPBAND && Aliased(f) <= PASSBAND && 20 * log10(gain) > stopband)
+            {
+                stopband = 20 * log10(gain);
+                worst_f = f;
+            }
+            else if (f >= STOPBAND && Aliased(f) > PASSBAND && 20 * log10(gain) > transition)
+            {
+                transition = 20 * log10(gain);
+                transition_f = f;
+            }
+        }
+        int pass = ripple <= PASSBAND_RIPPLE && stopband <= STOPBAND_LIMIT;
+        failures += !pass;
+        printf("%6u %15.3f%% %11.1f dB at %6.3f fo %11.1f dB at %6.3f fo %s\n", factor, 100 * ripple, stopband,
+               worst_f, transition, transition_f, pass ? "ok" : "OUT OF SPECIFICATION");
+    }
+
+    printf("\nfactor %u, gain against the frequency [fo]:\n", DECIMATOR_DEFAULT_FACTOR);
+    for (double f = 0.05; f < DECIMATOR_DEFAULT_FACTOR / 2.0; f += 0.05)
+    {
+        double gain = Gain(DECIMATOR_DEFAULT_FACTOR, f + 0.0037);
+        printf("  %.2f %8.2f dB\n", f, 20 * log10(gain));
+        if (f >= 1.0)
+        {
+            f += 0.2;   // Coarser in the stopband
+        }
+    }
+
+    // Speed: batches of a full FIFO, the input of each axis a noisy tone
+    printf("\n");
+    static int32_t input[BATCH][3];
+    static int32_t output[BATCH / 2 + 1][3];
+    for (int i = 0; i < BATCH; i++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            input[i][axis] = (int32_t)lround(2000 * sin(0.3 * i + axis)) + (i * 7919 + axis * 104729) % 50;
+        }
+    }
+    for (uint8_t factor = DECIMATOR_MIN_FACTOR; factor <= DECIMATOR_MAX_FACTOR; factor *= 2)
+    {
+        Decimator_Configure(factor);
+        volatile int32_t sink = 0;  // Keeps the filter from being optimized out
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long n = 0; n < TIMED_SAMPLES; n += BATCH)
+        {
+            uint8_t count = Decimator_Process(input, BATCH, output);
+            sink += count ? output[0][0] : 0;
+        }
+        double elapsed = Elapsed(&start);
+        printf("factor %2u: %.1f ns per input sample (3 axes), %.1f Msamples/s\n", factor,
+               elapsed / TIMED_SAMPLES * 1e9, TIMED_SAMPLES / elapsed * 1e-6);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,453 @@
+/*
+* Host simulation of the flash log of the firmware (FlashLog.c): recording
+* across the wrap of the log, restart, erase and the pacing of the dump.
+*
+* The log task runs once per Timer tick (10 ms), ACQUISITION_US after the
+* acquisition, which adds a compressed frame every 16 samples. The SPC
+* loads the row latch in LOAD_US and erases and programs the row in
+* WRITE_US, the emulated EEPROM holds it now and then (SPC_HELD_ONE_IN);
+* FlashLog.c is included, not linked, so that the simulated SPC can write
+* into its flash region. Every frame carries its own number: the dump must
+* give back the newest frames in order, in rows of valid checksum and
+* consecutive sequence numbers, and every row must be erased as often as
+* the others. The dump goes to a simulated UART at 19200 baud behind a
+* 4-byte FIFO; a write that is still waiting for the link at the next
+* acquisition delays the samples. Exits with 1 on an unexpected result.
+*
+* Build and run from the Host_Tools folder (psoc holds the minimal PSoC
+* headers for the host):
+*
+*     cc -O2 -Ipsoc -I../AY1920_II_HW_05_PROJ_3.cydsn flashlog_sim.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Health.c -o flashlog_sim
+*     ./flashlog_sim
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "../AY1920_II_HW_05_PROJ_3.cydsn/FlashLog.c"
+
+#define TICK_US 10000
+#define ACQUISITION_US 2000     // Acquisition run before the log task
+#define MARGIN_US 1000          // ACQUISITION_BUS_MARGIN_US
+#define LINK_RATE 1920          // Bytes per second at 19200 baud
+#define UART_FIFO 4
+#define LOAD_US 400             // Row latch load
+#define WRITE_US 20000          // Row erase and program
+#define SPC_HELD_ONE_IN 50      // Runs that find the SPC held by the emulated EEPROM
+#define FRAME_SAMPLES 16        // COMPRESS_FRAME_SAMPLES
+#define MAX_PAYLOAD 200         // COMPRESS_MAX_PAYLOAD
+#define DUMP_FRAME_BYTES (1 + 4 + FLASHLOG_ROW_SIZE + 1)
+
+static uint8_t eeprom[STORAGE_SIZE];
+static uint64_t now_us = 0;
+static uint32_t noise = 1;
+
+// SPC
+uint8 dieTemperature[2];
+static uint8_t spc_locked = 0;
+static uint8_t latch[FLASHLOG_ROW_SIZE];
+static uint64_t spc_done_us = 0;
+static int32_t spc_target = -1;         // Row being programmed
+static uint32_t erases[FLASHLOG_ROWS];
+
+// Frames: the next number to add and the dump as decoded
+static uint32_t frames_added = 0;
+static uint32_t samples = 0;
+static uint8_t dump_frame[DUMP_FRAME_BYTES + 1];
+static uint16_t dump_length = 0;
+static uint8_t frame_open = 0;
+static uint8_t dump_rows[FLASHLOG_ROWS][FLASHLOG_ROW_SIZE];
+static uint16_t dump_count = 0;
+static uint32_t dump_errors = 0;        // Bad frames, out of order rows
+
+// Link
+static uint64_t link_free_us = 0;       // The link has sent all the bytes written by then
+static uint32_t late_writes = 0;        // Writes still waiting at the next acquisition
+static uint32_t dump_bytes = 0;
+
+static uint32_t Random(uint32_t range)
+{
+    noise = noise * 1103515245u + 12345u;
+    return (noise >> 8) % range;
+}
+
+ErrorCode Storage_Read(uint16_t address, void* data, uint16_t size)
+{
+    memcpy(data, &eeprom[address], size);
+    return NO_ERROR;
+}
+
+ErrorCode Storage_Write(uint16_t address, const void* data, uint16_t size)
+{
+    memcpy(&eeprom[address], data, size);
+    return NO_ERROR;
+}
+
+cystatus CySetTemp(void)
+{
+    return CYRET_SUCCESS;
+}
+
+cystatus CySpcLock(void)
+{
+    if (spc_locked || Random(SPC_HELD_ONE_IN) == 0)
+    {
+        return !CYRET_SUCCESS;
+    }
+    spc_locked = 1;
+    return CYRET_SUCCESS;
+}
+
+void CySpcUnlock(void)
+{
+    spc_locked = 0;
+}
+
+cystatus CySpcLoadRowFull(uint8 array, uint16 row, const uint8 buffer[], uint16 size)
+{
+    (void)array;
+    (void)row;
+    memcpy(latch, buffer, size);
+    spc_done_us = now_us + LOAD_US;
+    return CYRET_STARTED;
+}
+
+cystatus CySpcWriteRow(uint8 array, uint16 address, uint8 tempPolarity, uint8 tempMagnitude)
+{
+    (void)tempPolarity;
+    (void)tempMagnitude;
+    // The address keeps the low 24 bits of the pointer: enough for the region
+    uint32_t flash = (uint32_t)array * CY_FLASH_SIZEOF_ARRAY + (uint32_t)address * CY_FLASH_SIZEOF_ROW;
+    uint32_t offset = (flash - (uint32_t)(uintptr_t)log_flash) & 0xFFFFFFu;
+    spc_target = (int32_t)(offset / FLASHLOG_ROW_SIZE);
+    spc_done_us = now_us + WRITE_US;
+    return CYRET_STARTED;
+}
+
+uint8 CySpcIsBusy(void)
+{
+    if (now_us < spc_done_us)
+    {
+        return 1;
+    }
+    if (spc_target >= 0)
+    {
+        // The row is erased and programmed at once
+        memcpy((uint8_t*)&log_flash[spc_target * FLASHLOG_ROW_SIZE], latch, FLASHLOG_ROW_SIZE);
+        erases[spc_target]++;
+        spc_target = -1;
+    }
+    return 0;
+}
+
+uint8 CySpcReadStatus(void)
+{
+    return CY_SPC_STATUS_SUCCESS;
+}
+
+void CyFlushCache(void)
+{
+}
+
+/**
+*   \brief Bytes the link takes before the next acquisition, as
+*   Acquisition_GetTxAllowance() on the board
+*/
+uint16_t Acquisition_GetTxAllowance(void)
+{
+    uint64_t next_us = (now_us / TICK_US + 1) * TICK_US;
+    uint64_t queued = link_free_us > now_us ? (link_free_us - now_us) * LINK_RATE / 1000000 : 0;
+    uint32_t room = queued < UART_FIFO ? UART_FIFO - (uint32_t)queued : 0;
+    uint64_t budget_us = next_us > now_us + MARGIN_US ? next_us - now_us - MARGIN_US : 0;
+    return (uint16_t)(room + budget_us / 1000 * LINK_RATE / 1000);
+}
+
+/*
+* Write bytes to the link: the CPU waits until all but the last FIFO bytes
+* are sent.
+*/
+static void LinkWrite(const uint8_t* data, uint16_t length)
+{
+    for (uint16_t i = 0; i < length; i++)
+    {
+        if (dump_length < sizeof(dump_frame))
+        {
+            dump_frame[dump_length++] = data[i];
+        }
+    }
+    dump_bytes += length;
+    uint64_t start_us = link_free_us > now_us ? link_free_us : now_us;
+    link_free_us = start_us + (uint64_t)length * 1000000 / LINK_RATE;
+    uint64_t done_us = link_free_us - (uint64_t)UART_FIFO * 1000000 / LINK_RATE;
+    uint64_t tick = now_us / TICK_US;
+    now_us = done_us > now_us ? done_us : now_us;
+    late_writes += now_us / TICK_US > tick;
+}
+
+ErrorCode Frames_Begin(uint8_t header)
+{
+    if (frame_open)
+    {
+        return ERROR;
+    }
+    frame_open = 1;
+    dump_length = 0;
+    LinkWrite(&header, 1);
+    return NO_ERROR;
+}
+
+void Frames_Write(const uint8_t* data, uint8_t length)
+{
+    LinkWrite(data, length);
+}
+
+static uint32_t GetUint(const uint8_t* data, uint8_t bytes)
+{
+    uint32_t value = 0;
+    for (uint8_t i = bytes; i > 0; i--)
+    {
+        value = (value << 8) | data[i - 1];
+    }
+    return value;
+}
+
+void Frames_End(void)
+{
+    uint8_t tail = FRAME_TAIL;
+    LinkWrite(&tail, 1);
+    frame_open = 0;
+    uint16_t index = (uint16_t)GetUint(&dump_frame[1], 2);
+    if (dump_length != DUMP_FRAME_BYTES || dump_frame[0] != FRAME_HEADER_LOG_ROW || index != dump_count ||
+        GetUint(&dump_frame[3], 2) != FlashLog_GetRowCount() || dump_count >= FLASHLOG_ROWS)
+    {
+        dump_errors++;
+        return;
+    }
+    memcpy(dump_rows[dump_count++], &dump_frame[5], FLASHLOG_ROW_SIZE);
+}
+
+uint8_t* Frames_PutUint16(uint8_t* buffer, uint16_t value)
+{
+    buffer[0] = (uint8_t)(value & 0xFF);
+    buffer[1] = (uint8_t)(value >> 8);
+    return buffer + 2;
+}
+
+uint8_t* Frames_PutUint32(uint8_t* buffer, uint32_t value)
+{
+    buffer[0] = (uint8_t)(value & 0xFF);
+    buffer[1] = (uint8_t)((value >> 8) & 0xFF);
+    buffer[2] = (uint8_t)((value >> 16) & 0xFF);
+    buffer[3] = (uint8_t)(value >> 24);
+    return buffer + 4;
+}
+
+/*
+* Compressed frame number n: its length, its number, then bytes derived
+* from it; a keyframe every 16 frames.
+*/
+static uint8_t FrameLength(uint32_t n)
+{
+    return (uint8_t)(n % 16 == 0 ? 60 + n % (MAX_PAYLOAD - 60) : 20 + (n * 37) % 61);
+}
+
+static void MakeFrame(uint32_t n, uint8_t* payload)
+{
+    payload[0] = FrameLength(n);
+    Frames_PutUint32(&payload[1], n);
+    for (uint8_t i = 5; i < payload[0]; i++)
+    {
+        payload[i] = (uint8_t)(n * 7 + i);
+    }
+}
+
+/*
+* Run ticks at an output data rate, recording or not; returns the frames
+* dropped by the log.
+*/
+static uint32_t Run(uint32_t ticks, uint16_t rate, uint8_t record)
+{
+    uint32_t drops = 0;
+    for (uint32_t t = 0; t < ticks; t++)
+    {
+        uint32_t tick = (uint32_t)(now_us / TICK_US);
+        now_us = (uint64_t)tick * TICK_US;
+        for (uint16_t s = 0; record && s < rate / 100; s++)
+        {
+            if (++samples % FRAME_SAMPLES == 0)
+            {
+                uint8_t payload[MAX_PAYLOAD];
+                MakeFrame(frames_added, payload);
+                if (FlashLog_Add(tick, payload) == NO_ERROR)
+                {
+                    frames_added++;
+                }
+                else
+                {
+                    // The compression restarts: the frame number is lost
+                    frames_added++;
+                    drops++;
+                }
+            }
+        }
+        now_us += ACQUISITION_US;
+        FlashLog_Task();
+        now_us = (uint64_t)(tick + 1) * TICK_US > now_us ? (uint64_t)(tick + 1) * TICK_US : now_us;
+    }
+    return drops;
+}
+
+/*
+* Stop recording and wait for the last row.
+*/
+static void Stop(void)
+{
+    FlashLog_Stop();
+    while (write_pending || used > 0)
+    {
+        Run(1, 100, 0);
+    }
+}
+
+/*
+* Dump the log and check its rows and frames: the frames from first to the
+* last one added, in order. Returns the failed checks.
+*/
+static int Dump(const char* name, uint32_t first, uint16_t rate)
+{
+    int failures = 0;
+    dump_count = 0;
+    dump_errors = 0;
+    dump_bytes = 0;
+    late_writes = 0;
+    uint16_t rows_expected = FlashLog_GetRowCount();
+    uint64_t start_us = now_us;
+    failures += FlashLog_StartDump() != NO_ERROR;
+    while (FlashLog_IsDumping())
+    {
+        Run(1, rate, 0);
+    }
+    double seconds = (now_us - start_us) * 1e-6;
+
+    uint32_t expected = first, wrong_frames = 0, bad_rows = 0;
+    uint32_t previous_sequence = 0;
+    for (uint16_t r = 0; r < dump_count; r++)
+    {
+        const uint8_t* row = dump_rows[r];
+        uint8_t bytes = row[1];
+        uint32_t sequence = GetUint(&row[4], 4);
+        if (row[0] != FLASHLOG_MAGIC || bytes > FLASHLOG_ROW_CAPACITY ||
+            GetUint(&row[2], 2) != FlashLog_Checksum(&row[4], FLASHLOG_HEADER_SIZE - 4 + bytes) ||
+            (r > 0 && sequence != previous_sequence + 1))
+        {
+            bad_rows++;
+            continue;
+        }
+        previous_sequence = sequence;
+        for (uint16_t position = FLASHLOG_HEADER_SIZE; position < FLASHLOG_HEADER_SIZE + bytes;)
+        {
+            uint8_t payload[MAX_PAYLOAD];
+            const uint8_t* record = &row[position + 4];
+            uint32_t n = GetUint(&record[1], 4);
+            MakeFrame(n, payload);
+            wrong_frames += n != expected || memcmp(record, payload, payload[0]) != 0;
+            expected = n + 1;
+            position += 4 + record[0];
+        }
+    }
+    failures += dump_count != rows_expected || dump_errors > 0 || bad_rows > 0 || wrong_frames > 0 ||
+                expected != frames_added || late_writes > 0;
+    printf("%-26s %3u rows, %u bad, frames %6lu to %6lu, %lu wrong; %6.1f s, %4.0f B/s, %lu late writes%s\n",
+           name, dump_count, bad_rows + dump_errors, (unsigned long)first, (unsigned long)expected - 1,
+           (unsigned long)wrong_frames, seconds, dump_bytes / seconds, (unsigned long)late_writes,
+           failures ? "  UNEXPECTED" : "");
+    return failures;
+}
+
+/*
+* Number of the oldest frame in the log: the first record of the oldest row.
+*/
+static uint32_t OldestFrame(void)
+{
+    uint16_t row = (head + FLASHLOG_ROWS - row_count) % FLASHLOG_ROWS;
+    return GetUint((const uint8_t*)&log_flash[row * FLASHLOG_ROW_SIZE + FLASHLOG_HEADER_SIZE + 5], 4);
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    // The region of the log is constant for the CPU: let the SPC write it
+    long page = sysconf(_SC_PAGESIZE);
+    uintptr_t begin = (uintptr_t)log_flash & ~(uintptr_t)(page - 1);
+    uintptr_t end = (uintptr_t)log_flash + sizeof(log_flash);
+    if (mprotect((void*)begin, end - begin, PROT_READ | PROT_WRITE) != 0)
+    {
+        printf("cannot make the flash region writable\n");
+        return 1;
+    }
+    memset(eeprom, 0, sizeof(eeprom));      // Blank, as the zeroed flash of the image
+    FlashLog_Init();
+    FlashLog_SetRate(100);
+
+    // Twelve minutes at 100 Hz: more than a lap of the log
+    failures += FlashLog_Start() != NO_ERROR;
+    uint32_t drops = Run(72000, 100, 1);
+    Stop();
+    uint32_t least = UINT32_MAX, most = 0;
+    for (uint16_t r = 0; r < FLASHLOG_ROWS; r++)
+    {
+        least = erases[r] < least ? erases[r] : least;
+        most = erases[r] > most ? erases[r] : most;
+    }
+    failures += drops > 0 || Health_Get(HEALTH_LOG_DROP) > 0 || row_count != FLASHLOG_ROWS || most - least > 1;
+    printf("recorded 12 min at 100 Hz: %lu frames, %lu dropped, %u rows, every row erased %lu to %lu times%s\n",
+           (unsigned long)frames_added, (unsigned long)drops, row_count, (unsigned long)least,
+           (unsigned long)most, drops > 0 || row_count != FLASHLOG_ROWS || most - least > 1 ? "  UNEXPECTED" : "");
+    failures += Dump("dump after the wrap", OldestFrame(), 100);
+
+    // A restart resumes after the newest row; then a minute at 400 Hz
+    uint16_t saved_head = head;
+    uint32_t saved_sequence = next_sequence;
+    FlashLog_Init();
+    failures += head != saved_head || next_sequence != saved_sequence || row_count != FLASHLOG_ROWS;
+    printf("restart: head %u, next row %lu, %u rows%s\n", head, (unsigned long)next_sequence, row_count,
+           head != saved_head || next_sequence != saved_sequence ? "  UNEXPECTED" : "");
+    FlashLog_SetRate(400);
+    failures += FlashLog_Start() != NO_ERROR;
+    drops = Run(6000, 400, 1);
+    Stop();
+    failures += drops > 0;
+    printf("recorded 1 min at 400 Hz after the restart: %lu dropped%s\n", (unsigned long)drops,
+           drops > 0 ? "  UNEXPECTED" : "");
+    failures += Dump("dump after the restart", OldestFrame(), 400);
+
+    // Erase: refused while recording, then an empty log that survives a
+    // restart and records again from there
+    failures += FlashLog_Start() != NO_ERROR;
+    Run(100, 100, 1);
+    ErrorCode refused = FlashLog_Erase();
+    Stop();
+    uint32_t first = frames_added;
+    ErrorCode erased = FlashLog_Erase();
+    FlashLog_Init();
+    uint16_t rows_after_erase = row_count;
+    failures += refused != ERROR || erased != NO_ERROR || rows_after_erase != 0;
+    FlashLog_SetRate(100);
+    failures += FlashLog_Start() != NO_ERROR;
+    Run(3000, 100, 1);
+    Stop();
+    FlashLog_Init();
+    printf("erase: %s while recording, %u rows after it and a restart, %u rows 30 s later%s\n",
+           refused == ERROR ? "refused" : "ACCEPTED", rows_after_erase, row_count,
+           refused != ERROR || erased != NO_ERROR || rows_after_erase != 0 ? "  UNEXPECTED" : "");
+    failures += Dump("dump after the erase", first, 100);
+
+    printf("%s (a row frame is %d bytes, the link %d B/s)\n", failures ? "UNEXPECTED RESULTS" :
+           "flash log as expected", DUMP_FRAME_BYTES, LINK_RATE);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,224 @@
+/*
+* Output and speed of the text formatter of the firmware (Format.c) against
+* the snprintf() of the C library it replaced.
+*
+* Every diagnostic line of the firmware is formatted both ways with the
+* arguments of a typical report and must come out the same. The CSV lines
+* of the raw stream are checked at the extremes of the +-8 g and +-16 g
+* ranges, where they are longest, and at rest; then both ways are timed on
+* a synthetic stream (board at rest, then a 40 Hz vibration) and on the
+* diagnostic lines. Exits with 1 on a different output or a CSV line
+* longer than the documented limit.
+*
+* The times are those of the host; flash and cycles on the PSoC need a
+* PSoC Creator build (the map file and command 't').
+*
+* Build and run from the Host_Tools folder:
+*
+*     cc -O2 -I../AY1920_II_HW_05_PROJ_3.cydsn format_benchmark.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Format.c -lm -o format_benchmark
+*     ./format_benchmark
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "Format.h"
+
+#define FULL_SCALE_8G 80336     // 2048 digits of 39.2266 mm/s^2 [mm/s^2]
+#define FULL_SCALE_16G 240992   // 2048 digits of 117.672 mm/s^2 [mm/s^2]
+#define LINE_LIMIT_8G 19        // Acquisition_SetTextOutput()
+#define LINE_LIMIT_16G 22
+#define TIMED_LINES 2000000
+#define STREAM_SAMPLES 6000     // One minute at 100 Hz
+#define PI 3.14159265358979323846
+
+static int failures = 0;
+static int32_t stream[STREAM_SAMPLES][3];
+static uint32_t noise = 1;
+
+static int32_t Random(int32_t range)
+{
+    noise = noise * 1103515245u + 12345u;
+    return (int32_t)((noise >> 4) % (2u * (uint32_t)range + 1u)) - range;
+}
+
+static double Elapsed(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+/**
+*   \brief Format a diagnostic line both ways and compare them
+*/
+#define COMPARE(...)                                                        \
+    do                                                                      \
+    {                                                                       \
+        char mine[80], reference[80];                                       \
+        Format_Text(mine, sizeof(mine), __VA_ARGS__);                       \
+        snprintf(reference, sizeof(reference), __VA_ARGS__);                \
+        checked++;                                                          \
+        if (strcmp(mine, reference) != 0)                                   \
+        {                                                                   \
+            failures++;                                                     \
+            printf("  DIFFERENT: \"%s\" instead of \"%s\"\n", mine, reference); \
+        }                                                                   \
+    } while (0)
+
+/*
+* The diagnostic lines of main.c, Commands.c and Calibration.c; returns the
+* lines checked.
+*/
+static int Diagnostics(void)
+{
+    int checked = 0;
+    COMPARE("Other devices: on, raw stream %lu of %u B/s%s\r\n", 1517ul, 1920u, "");
+    COMPARE("Summary window: %u samples\r\n", 100u);
+    COMPARE("Output data rate: %u Hz\r\n", 400u);
+    COMPARE("High-pass output: %s Hz at 100 Hz ODR\r\n", "0.2");
+    COMPARE("Calibration: %s%s\r\n", "full matrix", " (not saved)");
+    COMPARE("Awake: %u.%u%% over %lu ticks, %lu sleeps\r\n", 12u, 7u, 60000ul, 59412ul);
+    COMPARE("Awake per sample: %lu cycles (%lu us), %lu samples\r\n", 41234ul, 1718ul, 6000ul);
+    COMPARE("%s: runs %lu avg %lu max %lu cycles\r\n", "Acquisition", 70015ul, 143568ul, 999960ul);
+    COMPARE("Device %u (0x%02X): bus %u.%u%%\r\n", 1u, 0x19u, 3u, 4u);
+    COMPARE("Device %u (0x%02X): bus %u.%u%%\r\n", 0u, 0x8u, 100u, 0u);
+    COMPARE("%s: %lu values, min %ld us, max %ld us\r\n", "jitter", 6000ul, -412l, 2147483647l);
+    COMPARE("  %ld ... %ld us: %lu\r\n", -2147483647l - 1, -2147483548l, 0ul);
+    COMPARE("Axis %c: offset %ld mm/s^2, gain %d/4096\r\n", 'Z', -312l, -4021);
+    COMPARE("Flash log: stopped, %u rows\r\n", 0u);
+    COMPARE("Register 0x%02x: 0x%02x\r\n", 0x2Fu, 0xA5u);
+    COMPARE("Chip id %lX, %5u%%\r\n", 0xDEADBEEFul, 42u);
+    return checked;
+}
+
+/**
+*   \brief CSV line of the firmware (Acquisition_Output()), returns its length
+*/
+static int CsvLine(char* line, const int32_t acceleration[3])
+{
+    char* position = line;
+    for (uint8_t axis = 0; axis < 3; axis++)
+    {
+        int32_t value = acceleration[axis];
+        position = Format_PutInt(position, (value >= 0 ? value + 5 : value - 5) / 10);
+        *position++ = axis < 2 ? ',' : '\r';
+    }
+    *position++ = '\n';
+    return (int)(position - line);
+}
+
+static int CsvReference(char* line, const int32_t acceleration[3])
+{
+    long value[3];
+    for (uint8_t axis = 0; axis < 3; axis++)
+    {
+        value[axis] = (acceleration[axis] >= 0 ? acceleration[axis] + 5 : acceleration[axis] - 5) / 10;
+    }
+    return snprintf(line, 32, "%ld,%ld,%ld\r\n", value[0], value[1], value[2]);
+}
+
+/*
+* Check the CSV line of a sample; returns its length.
+*/
+static int CheckCsv(const int32_t acceleration[3])
+{
+    char mine[32], reference[32];
+    int length = CsvLine(mine, acceleration);
+    int reference_length = CsvReference(reference, acceleration);
+    if (length != reference_length || memcmp(mine, reference, length) != 0)
+    {
+        failures++;
+        printf("  DIFFERENT CSV line: \"%.*s\"\n", reference_length - 2, reference);
+    }
+    return length;
+}
+
+static int LongestCsv(int32_t full_scale)
+{
+    int longest = 0;
+    for (int n = 0; n < 100000; n++)
+    {
+        int32_t acceleration[3] = {Random(full_scale), Random(full_scale), Random(full_scale)};
+        if (n < 8)
+        {
+            // The corners of the range
+            for (int axis = 0; axis < 3; axis++)
+            {
+                acceleration[axis] = (n >> axis) & 1 ? full_scale : -full_scale;
+            }
+        }
+        int length = CheckCsv(acceleration);
+        longest = length > longest ? length : longest;
+    }
+    return longest;
+}
+
+static void Synthetic(void)
+{
+    for (uint32_t n = 0; n < STREAM_SAMPLES; n++)
+    {
+        double vibration = n < STREAM_SAMPLES / 2 ? 0 : 3000 * sin(2 * PI * 40 * n / 100.0);
+        stream[n][0] = 12 + (int32_t)lround(vibration) + Random(40);
+        stream[n][1] = -7 + (int32_t)lround(vibration / 2) + Random(40);
+        stream[n][2] = 9806 + Random(40);
+    }
+}
+
+int main(void)
+{
+    int lines = Diagnostics();
+    printf("diagnostic lines: %d checked against snprintf\n", lines);
+
+    int32_t rest[3] = {12, -7, 9806};
+    int rest_length = CheckCsv(rest);
+    int longest_8g = LongestCsv(FULL_SCALE_8G);
+    int longest_16g = LongestCsv(FULL_SCALE_16G);
+    int too_long = longest_8g > LINE_LIMIT_8G || longest_16g > LINE_LIMIT_16G;
+    failures += too_long;
+    printf("CSV lines: %d bytes at rest, at most %d at +-8 g and %d at +-16 g%s\n", rest_length, longest_8g,
+           longest_16g, too_long ? "  UNEXPECTED" : "");
+
+    // Time of a CSV line and of a diagnostic line, both ways
+    char line[80];
+    volatile uint32_t sink = 0;     // Keeps the lines from being optimized out
+    struct timespec start;
+    double time[2], bytes = 0;
+    Synthetic();
+    for (int way = 0; way < 2; way++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (uint32_t n = 0; n < TIMED_LINES; n++)
+        {
+            const int32_t* acceleration = stream[n % STREAM_SAMPLES];
+            int length = way ? CsvReference(line, acceleration) : CsvLine(line, acceleration);
+            sink += (uint32_t)line[length - 3];
+            bytes += way ? 0 : length;
+        }
+        time[way] = Elapsed(&start) / TIMED_LINES * 1e9;
+    }
+    printf("CSV line: %.1f ns with Format_PutInt, %.1f ns with snprintf (%.1f times), %.1f bytes on average\n",
+           time[0], time[1], time[1] / time[0], bytes / TIMED_LINES);
+    for (int way = 0; way < 2; way++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (uint32_t n = 0; n < TIMED_LINES; n++)
+        {
+            int length = way ? snprintf(line, sizeof(line), "%s: runs %lu avg %lu max %lu cycles\r\n",
+                                        "Acquisition", (unsigned long)n, 143568ul, 999960ul)
+                             : Format_Text(line, sizeof(line), "%s: runs %lu avg %lu max %lu cycles\r\n",
+                                           "Acquisition", (unsigned long)n, 143568ul, 999960ul);
+            sink += (uint32_t)line[length - 3];
+        }
+        time[way] = Elapsed(&start) / TIMED_LINES * 1e9;
+    }
+    printf("diagnostic line: %.1f ns with Format_Text, %.1f ns with snprintf (%.1f times) on this host\n",
+           time[0], time[1], time[1] / time[0]);
+
+    printf("%s\n", failures ? "UNEXPECTED RESULTS" : "formatter output as snprintf");
+    return failures ? 1 : 0;
+}
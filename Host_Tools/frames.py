@@ -0,0 +1,362 @@
+"""Decoder of the frames sent by AY1920_II_HW_05_PROJ_3 over UART.
+
+Every frame is a header byte, a little-endian payload and the tail 0xC0
+(see Frames.h in the firmware). Text answers to the commands are
+interleaved with the frames; the decoder skips any byte that does not start
+a complete frame.
+"""
+
+import collections
+import struct
+
+import packetgen
+
+TAIL = 0xC0
+
+SAMPLE = 0xA0
+RATE = 0xA1
+BURST = 0xA2
+SUMMARY = 0xA3
+SPECTRUM = 0xA4
+DECIMATED = 0xA5
+CLICK = 0xA6
+AUXILIARY = 0xA7
+TILT = 0xA8
+VELOCITY = 0xA9
+DEVICE_SAMPLE = 0xAA
+TIMESTAMP = 0xAB
+SYNC = 0xAC
+HEALTH = 0xAD
+COMPRESSED = 0xAE
+LOG_ROW = 0xAF
+
+# Loss counters of the health frame, in order (Health_Counter in Health.h)
+HEALTH_COUNTERS = (
+    "sensor overrun", "FIFO overflow", "empty poll", "skipped tick",
+    "I2C error", "queue reject", "TX stall", "TX drop", "log drop",
+)
+
+TIMESTAMP_ABSOLUTE = 0xFFFF
+
+# Rows of the flash log (FlashLog.h)
+LOG_ROW_SIZE = 256
+LOG_HEADER_SIZE = 10
+LOG_MAGIC = 0x4C
+
+
+def _burst_length(data, start):
+    # trigger index (4), pre (2), post (2), source (1), missed (2), samples
+    if len(data) < start + 9:
+        return None
+    pre, post = struct.unpack_from("<HH", data, start + 4)
+    return 11 + 12 * (pre + post)
+
+
+def _spectrum_length(data, start):
+    # first index (4), points (2), exponent (1), bands (1), edges, energies
+    if len(data) < start + 8:
+        return None
+    bands = data[start + 7]
+    return 8 + 2 * (bands + 1) + 4 * bands
+
+
+def _timestamp_length(data, start):
+    # samples (1), delta (2), absolute timestamp (4) if delta is 0xFFFF
+    if len(data) < start + 3:
+        return None
+    delta, = struct.unpack_from("<H", data, start + 1)
+    return 7 if delta == TIMESTAMP_ABSOLUTE else 3
+
+
+def _health_length(data, start):
+    # tick (4), sample count (4), counters (1), counters x 4
+    if len(data) < start + 9:
+        return None
+    return 9 + 4 * data[start + 8]
+
+
+# Payload length of each frame type: a number or a function of the payload
+# start. The fixed-layout frames are read from packets.json.
+PAYLOAD_LENGTH = {
+    BURST: _burst_length,
+    SPECTRUM: _spectrum_length,
+    TIMESTAMP: _timestamp_length,
+    HEALTH: _health_length,
+    COMPRESSED: lambda data, start: data[start] if start < len(data) else None,
+    LOG_ROW: 4 + LOG_ROW_SIZE,
+}
+PAYLOAD_LENGTH.update((packet["header"], packet["length"]) for packet in packetgen.load_schema()["packets"])
+
+
+def decode(data):
+    """Yield (header, payload) for every complete frame found in data."""
+    position = 0
+    while position < len(data):
+        header = data[position]
+        length = PAYLOAD_LENGTH.get(header)
+        if callable(length):
+            length = length(data, position + 1)
+        if length is None:
+            position += 1
+            continue
+        end = position + 1 + length
+        if end >= len(data):
+            break
+        if data[end] != TAIL:
+            position += 1
+            continue
+        yield header, bytes(data[position + 1:end])
+        position = end + 1
+
+
+def sample(payload):
+    """X, Y, Z [mm/s^2] of a sample frame."""
+    return struct.unpack("<iii", payload)
+
+
+def device_sample(payload):
+    """Device id, X, Y, Z [mm/s^2] of a sample frame of the other devices."""
+    return struct.unpack("<Biii", payload)
+
+
+def auxiliary(payload):
+    """Sample count, ADC1, ADC2, ADC3 (temperature) of an auxiliary frame."""
+    return struct.unpack("<Ihhh", payload)
+
+
+def tilt(payload):
+    """First sample index, pitch, roll [degrees] of a tilt frame."""
+    index, pitch, roll = struct.unpack("<Ihh", payload)
+    return index, pitch / 100.0, roll / 100.0
+
+
+def velocity(payload):
+    """First sample index, samples, velocity RMS of X, Y, Z [mm/s]."""
+    index, count, x, y, z = struct.unpack("<IHIII", payload)
+    return index, count, x / 1000.0, y / 1000.0, z / 1000.0
+
+
+class TimestampDecoder:
+    """Rebuild the timestamps [us] of the samples from the timestamp frames.
+
+    A frame covers the samples received since the previous timestamp frame
+    and the batch that follows it. The deltas are relative to the previous
+    timestamp frame, so the frames must be fed in order; samples before the
+    first absolute frame have no timestamp.
+    """
+
+    def __init__(self):
+        self.time = None
+
+    def batch(self, payload, rate):
+        """Timestamps [us] of the samples the frame covers, in order."""
+        count, delta = struct.unpack_from("<BH", payload)
+        if delta == TIMESTAMP_ABSOLUTE:
+            self.time, = struct.unpack_from("<I", payload, 3)
+        elif self.time is None:
+            return [None] * count
+        else:
+            self.time += delta
+        # The read starts after the last sample of the batch
+        return [self.time - (count - 1 - i) * 1e6 / rate for i in range(count)]
+
+
+def sync(payload):
+    """Tick, timestamp [us], sample count, TX bytes pending of a sync frame."""
+    return struct.unpack("<IIIH", payload)
+
+
+def health(payload):
+    """Tick, sample count and {name: events} of a health frame.
+
+    Counters unknown to this decoder are named by their position.
+    """
+    tick, count, counters = struct.unpack_from("<IIB", payload)
+    values = struct.unpack_from("<%dI" % counters, payload, 9)
+    names = [HEALTH_COUNTERS[i] if i < len(HEALTH_COUNTERS) else "counter %d" % i
+             for i in range(counters)]
+    return tick, count, dict(zip(names, values))
+
+
+class ClockSync:
+    """Map the device clock [us] on the host clock [s] from the sync frames.
+
+    Each sync frame is paired with the host time at which it arrived. The
+    arrival is late by the UART transmission, corrected with the pending
+    bytes in the frame (always 0 without a software TX buffer, as at
+    19200 baud with the 4-byte FIFO), and by a random OS/USB latency,
+    always positive. A
+    least squares line is fitted on a sliding window, then fitted again on
+    the points below it, so that the late points do not bias the offset:
+    the line follows the lower envelope, the minimum latency path. What is
+    left is a constant offset, the minimum latency of the link.
+    """
+
+    def __init__(self, window=600, baud=19200, rejection_passes=3):
+        self.points = collections.deque(maxlen=window)
+        self.byte_time = 10.0 / baud
+        self.rejection_passes = rejection_passes
+        self.last_raw = None
+        self.last_device = None
+        self.line = None
+
+    def unwrap(self, raw):
+        """Device time [us], unwrapped relative to the last sync frame."""
+        if self.last_raw is None:
+            return raw
+        step = ((raw - self.last_raw + (1 << 31)) & 0xFFFFFFFF) - (1 << 31)
+        return self.last_device + step
+
+    def add(self, payload, host_time):
+        """Add a sync frame and the host time of its arrival [s]."""
+        _, raw, _, pending = sync(payload)
+        device = self.unwrap(raw)
+        self.last_raw, self.last_device = raw, device
+        # The frame left when the bytes before it and its own were sent
+        sent = host_time - (pending + 1 + len(payload) + 1) * self.byte_time
+        self.points.append((device / 1e6, sent))
+        self.line = self._fit()
+
+    def _fit(self):
+        points = list(self.points)
+        if len(points) < 2:
+            return None
+        line = _least_squares(points)
+        for _ in range(self.rejection_passes):
+            residuals = sorted(h - _evaluate(line, d) for d, h in points)
+            median = residuals[len(residuals) // 2]
+            lower = [(d, h) for d, h in points if h - _evaluate(line, d) <= median]
+            if len(lower) < 2:
+                break
+            line = _least_squares(lower)
+            points = lower
+        return line
+
+    def skew(self):
+        """Rate error of the device clock [ppm], positive if it is slow."""
+        return None if self.line is None else (self.line[2] - 1.0) * 1e6
+
+    def to_host(self, raw):
+        """Host time [s] of a device timestamp [us] (wrapped, as sent)."""
+        if self.line is None:
+            return None
+        return _evaluate(self.line, self.unwrap(raw) / 1e6)
+
+
+def _least_squares(points):
+    # Centered on the mean device time, for precision over long captures
+    n = len(points)
+    mean_d = sum(d for d, _ in points) / n
+    mean_h = sum(h for _, h in points) / n
+    sxx = sum((d - mean_d) ** 2 for d, _ in points)
+    sxy = sum((d - mean_d) * (h - mean_h) for d, h in points)
+    return mean_d, mean_h, sxy / sxx if sxx > 0 else 1.0
+
+
+def _evaluate(line, device):
+    mean_d, mean_h, slope = line
+    return mean_h + slope * (device - mean_d)
+
+
+class CompressedDecoder:
+    """Decode the compressed sample frames (see Compress.h in the firmware).
+
+    Feed the payloads in order: batch() returns the index of the first
+    sample and the samples; after a lost frame, empty batches are returned
+    until the next keyframe.
+    """
+
+    KEYFRAME = 1
+    VERBATIM = 2
+    ESCAPE = 16
+
+    def __init__(self):
+        self.previous = None
+        self.sequence = None
+        self.next_index = None
+
+    def batch(self, payload):
+        length, flags, count, sequence = struct.unpack_from("<BBBB", payload)
+        if length != len(payload) or not 0 < count <= 16:
+            raise ValueError("malformed compressed frame")
+        keyframe = flags & self.KEYFRAME
+        if not keyframe and (self.previous is None or sequence != self.sequence):
+            self.previous = None
+            return None, []
+        position = 4
+        index = self.next_index
+        if keyframe:
+            index, = struct.unpack_from("<I", payload, position)
+            position += 4
+
+        if flags & self.VERBATIM:
+            values = struct.unpack_from("<%di" % (3 * count), payload, position)
+            samples = [values[3 * n:3 * n + 3] for n in range(count)]
+        else:
+            samples = []
+            last = self.previous
+            if keyframe:
+                last = struct.unpack_from("<iii", payload, position)
+                samples.append(last)
+                position += 12
+            k = payload[position:position + 3]
+            bits = int.from_bytes(payload[position + 3:], "big")
+            available = 8 * (len(payload) - position - 3)
+            for _ in range(count - len(samples)):
+                sample = []
+                for axis in range(3):
+                    quotient = 0
+                    while quotient < self.ESCAPE:
+                        available -= 1
+                        if available < 0:
+                            raise ValueError("truncated compressed frame")
+                        if not (bits >> available) & 1:
+                            break
+                        quotient += 1
+                    size = 32 if quotient == self.ESCAPE else k[axis]
+                    available -= size
+                    if available < 0:
+                        raise ValueError("truncated compressed frame")
+                    low = (bits >> available) & ((1 << size) - 1)
+                    value = low if quotient == self.ESCAPE else (quotient << size) | low
+                    delta = (value >> 1) ^ -(value & 1)
+                    sample.append(((last[axis] + delta + (1 << 31)) & 0xFFFFFFFF) - (1 << 31))
+                last = tuple(sample)
+                samples.append(last)
+
+        self.previous = samples[-1]
+        self.sequence = (sequence + 1) & 0xFF
+        self.next_index = index + count
+        return index, samples
+
+
+def _fletcher16(data):
+    sum1 = sum2 = 0
+    for byte in data:
+        sum1 = (sum1 + byte) % 255
+        sum2 = (sum2 + sum1) % 255
+    return (sum2 << 8) | sum1
+
+
+def log_row(payload):
+    """Position, rows of the dump and the row of a log row frame.
+
+    The row is (sequence number, rate [Hz], [(tick, compressed payload)]),
+    or None if it was never written or fails the checksum.
+    """
+    index, count = struct.unpack_from("<HH", payload)
+    row = payload[4:]
+    magic, used, checksum = struct.unpack_from("<BBH", row)
+    end = LOG_HEADER_SIZE + used
+    if magic != LOG_MAGIC or end > LOG_ROW_SIZE or _fletcher16(row[4:end]) != checksum:
+        return index, count, None
+    sequence, rate = struct.unpack_from("<IH", row, 4)
+    records = []
+    position = LOG_HEADER_SIZE
+    while position + 5 <= end:
+        tick, length = struct.unpack_from("<IB", row, position)
+        if length < 4 or position + 4 + length > end:
+            return index, count, None
+        records.append((tick, bytes(row[position + 4:position + 4 + length])))
+        position += 4 + length
+    return index, count, (sequence, rate, records)
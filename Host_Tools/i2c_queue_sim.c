@@ -0,0 +1,192 @@
+/*
+* Simulation of the I2C bus shared by the acquisition and by lower priority
+* producers (telemetry polling and configuration writes), with blocking
+* calls and with the prioritised queue of the firmware (I2C_Queue.c).
+* It reports the acquisitions that start later than the allowed lateness.
+*
+* Build and run from the Host_Tools folder:
+*
+*     cc -O2 -I../AY1920_II_HW_05_PROJ_3.cydsn i2c_queue_sim.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/I2C_Queue.c -lm -o i2c_queue_sim
+*     ./i2c_queue_sim
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "I2C_Queue.h"
+
+#define PERIOD_US 10000         // Acquisition period (100 Hz, one sample per period)
+#define MARGIN_US 1000          // ACQUISITION_BUS_MARGIN_US of the firmware
+#define LATENESS_US 500         // An acquisition starting later than this is a miss
+#define PERIODS 100000          // Simulated periods (1000 s)
+#define DEVICE 0x18
+
+/**
+*   \brief Bus time of the sample fetch: FIFO_SRC, then one sample
+*/
+#define ACQUISITION_US (I2C_QUEUE_READ_US(1) + I2C_QUEUE_READ_US(6))
+
+/**
+*   \brief Load of the producers
+*/
+typedef struct {
+    const char* name;
+    uint32_t interval_us;       // Mean time between two requests (exponential)
+    uint8_t first_register;     // Registers read or written, one transaction each
+    uint8_t registers;
+    uint8_t write;
+    I2C_Priority priority;
+} Producer;
+
+static const Producer producers[] = {
+    {"temperature", 100000, 0x08, 1, 0, I2C_PRIORITY_TELEMETRY},  // 6 bytes in one read
+    {"click",        50000, 0x39, 1, 0, I2C_PRIORITY_TELEMETRY},
+    {"status",       20000, 0x31, 5, 0, I2C_PRIORITY_TELEMETRY},  // 5 single reads of adjacent registers
+    {"config",      200000, 0x20, 6, 1, I2C_PRIORITY_CONFIG},     // 6 single writes
+};
+
+#define PRODUCERS (sizeof(producers) / sizeof(producers[0]))
+
+static uint64_t bus_time = 0;       // Simulated time [us]
+static uint8_t buffer[256][I2C_QUEUE_MAX_TRANSFER];  // Registers read, by address
+static uint32_t completed = 0;
+static uint64_t telemetry_latency = 0;
+static uint64_t submit_time[256];
+
+static ErrorCode Simulated_Transfer(uint8_t device_address, uint8_t register_address,
+                                    uint8_t register_count, uint8_t* data, uint8_t write)
+{
+    (void)device_address;
+    (void)register_address;
+    (void)data;
+    bus_time += write ? I2C_QUEUE_WRITE_US(register_count) : I2C_QUEUE_READ_US(register_count);
+    return NO_ERROR;
+}
+
+static void Completed(const I2C_Transaction* transaction, ErrorCode error)
+{
+    (void)error;
+    completed++;
+    telemetry_latency += bus_time - submit_time[transaction->register_address];
+}
+
+static uint32_t Exponential(uint32_t mean)
+{
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double value = -(double)mean * log(u);
+    return value > 10.0 * mean ? 10 * mean : (uint32_t)value;
+}
+
+/**
+*   \brief Bus time of one request of a producer [us]
+*/
+static uint32_t Request_Us(const Producer* producer)
+{
+    uint8_t bytes = producer->first_register == 0x08 ? 6 : 1;
+    uint32_t single = producer->write ? I2C_QUEUE_WRITE_US(bytes) : I2C_QUEUE_READ_US(bytes);
+    return single * producer->registers;
+}
+
+static void Report(const char* name, uint32_t misses, uint64_t lateness_sum, uint32_t worst)
+{
+    printf("%-9s misses %6u (%.3f%%), mean lateness %6.1f us, worst %5u us\n",
+           name, misses, 100.0 * misses / PERIODS, (double)lateness_sum / PERIODS, worst);
+}
+
+int main(void)
+{
+    uint64_t next_request[PRODUCERS];
+
+    // Blocking calls: a producer holds the bus from its arrival until it is done
+    srand(1);
+    for (uint8_t p = 0; p < PRODUCERS; p++)
+    {
+        next_request[p] = Exponential(producers[p].interval_us);
+    }
+    uint64_t busy_until = 0;
+    uint32_t misses = 0, worst = 0;
+    uint64_t lateness_sum = 0;
+    for (uint32_t k = 0; k < PERIODS; k++)
+    {
+        uint64_t release = (uint64_t)k * PERIOD_US;
+        uint64_t start = busy_until > release ? busy_until : release;
+        uint32_t lateness = (uint32_t)(start - release);
+        misses += lateness > LATENESS_US;
+        lateness_sum += lateness;
+        worst = lateness > worst ? lateness : worst;
+        busy_until = start + ACQUISITION_US;
+
+        // Requests arriving in this period run as soon as the bus is free
+        for (uint8_t p = 0; p < PRODUCERS; p++)
+        {
+            while (next_request[p] < release + PERIOD_US)
+            {
+                uint64_t begin = next_request[p] > busy_until ? next_request[p] : busy_until;
+                busy_until = begin + Request_Us(&producers[p]);
+                next_request[p] += Exponential(producers[p].interval_us);
+            }
+        }
+    }
+    Report("blocking", misses, lateness_sum, worst);
+
+    // Queue: requests are submitted, served after the acquisition in the budget
+    srand(1);
+    for (uint8_t p = 0; p < PRODUCERS; p++)
+    {
+        next_request[p] = Exponential(producers[p].interval_us);
+    }
+    I2C_Queue_Init(Simulated_Transfer);
+    bus_time = 0;
+    misses = 0;
+    worst = 0;
+    lateness_sum = 0;
+    for (uint32_t k = 0; k < PERIODS; k++)
+    {
+        uint64_t release = (uint64_t)k * PERIOD_US;
+        uint64_t start = bus_time > release ? bus_time : release;
+        uint32_t lateness = (uint32_t)(start - release);
+        misses += lateness > LATENESS_US;
+        lateness_sum += lateness;
+        worst = lateness > worst ? lateness : worst;
+        bus_time = start + ACQUISITION_US;
+
+        // Requests of the previous period are already queued
+        uint64_t elapsed = bus_time - release;
+        uint32_t budget = elapsed + MARGIN_US < PERIOD_US ? (uint32_t)(PERIOD_US - elapsed - MARGIN_US) : 0;
+        I2C_Queue_Service(budget);
+
+        for (uint8_t p = 0; p < PRODUCERS; p++)
+        {
+            while (next_request[p] < release + PERIOD_US)
+            {
+                const Producer* producer = &producers[p];
+                for (uint8_t r = 0; r < producer->registers; r++)
+                {
+                    I2C_Transaction transaction = {
+                        DEVICE, (uint8_t)(producer->first_register + r),
+                        (uint8_t)(producer->first_register == 0x08 ? 6 : 1),
+                        (uint8_t)(producer->write ? I2C_FLAG_WRITE : 0),
+                        producer->priority, buffer[producer->first_register + r], Completed
+                    };
+                    submit_time[transaction.register_address] = next_request[p];
+                    I2C_Queue_Submit(&transaction);
+                }
+                next_request[p] += Exponential(producer->interval_us);
+            }
+        }
+        if (bus_time < release + PERIOD_US)
+        {
+            bus_time = release + PERIOD_US;     // Bus idle until the next release
+        }
+    }
+    Report("queue", misses, lateness_sum, worst);
+
+    I2C_QueueStats stats;
+    I2C_Queue_GetStats(&stats);
+    printf("queue: %u transactions in %u transfers (%u coalesced), %u deferred services, "
+           "%u rejected, max pending %u, mean latency %.1f ms\n",
+           stats.submitted, stats.transfers, stats.coalesced, stats.deferred,
+           stats.rejected, stats.max_pending, completed ? telemetry_latency / 1000.0 / completed : 0.0);
+    return 0;
+}
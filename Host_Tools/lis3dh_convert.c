@@ -0,0 +1,281 @@
+/*
+* Bulk conversion of raw LIS3DH samples, see lis3dh_convert.h.
+*
+* The conversion is the same for the three axes, so the samples are a flat
+* array of values. Every value becomes a left justified 16-bit word first;
+* then the kernels do what Device_Convert() does: arithmetic shift by 4,
+* product by the scale, division by 1000. The SIMD kernels divide with the
+* multiply-high by 0x10624DD3 and shift by 6 that the compilers use for a
+* signed division by 1000, exact for every int32: the results match the
+* scalar code bit for bit.
+*/
+
+#include "lis3dh_convert.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LIS3DH_X86 1
+#include <immintrin.h>
+#else
+#define LIS3DH_X86 0
+#endif
+
+#define DIVIDE_1000_MAGIC 0x10624DD3
+#define DIVIDE_1000_SHIFT 6
+
+/*
+* Same expression as Device_Convert() in Device.c.
+*/
+static inline int32_t ConvertWord(uint16_t word, int32_t scale)
+{
+    int16_t out = (int16_t)word >> 4;
+    return ((int32_t)out * scale) / 1000;
+}
+
+static inline uint16_t RawWord(const uint8_t* raw, size_t value)
+{
+    return (uint16_t)(raw[2 * value] | (raw[2 * value + 1] << 8));
+}
+
+/*
+* Value of the packed stream as a left justified word.
+*/
+static inline uint16_t PackedWord(const uint8_t* packed, size_t value)
+{
+    const uint8_t* pair = &packed[3 * (value / 2)];
+    if (value % 2 == 0)
+    {
+        return (uint16_t)((pair[0] << 4) | ((pair[1] & 0x0F) << 12));
+    }
+    return (uint16_t)((pair[1] & 0xF0) | (pair[2] << 8));
+}
+
+static void ConvertRawScalar(const uint8_t* raw, size_t first, size_t values, int32_t scale, int32_t* out)
+{
+    for (size_t i = first; i < values; i++)
+    {
+        out[i] = ConvertWord(RawWord(raw, i), scale);
+    }
+}
+
+static void ConvertPackedScalar(const uint8_t* packed, size_t first, size_t values, int32_t scale, int32_t* out)
+{
+    for (size_t i = first; i < values; i++)
+    {
+        out[i] = ConvertWord(PackedWord(packed, i), scale);
+    }
+}
+
+#if LIS3DH_X86
+
+/*
+* Byte pairs of 8 packed values (12 bytes), for _mm_shuffle_epi8
+*/
+#define PACKED_SHUFFLE 11, 10, 10, 9, 8, 7, 7, 6, 5, 4, 4, 3, 2, 1, 1, 0
+
+__attribute__((target("sse4.1")))
+static inline __m128i Sse41Convert(__m128i words, __m128i scale)
+{
+    __m128i n = _mm_mullo_epi32(_mm_srai_epi32(words, 4), scale);
+    __m128i magic = _mm_set1_epi32(DIVIDE_1000_MAGIC);
+    __m128i even = _mm_srli_epi64(_mm_mul_epi32(n, magic), 32);
+    __m128i odd = _mm_mul_epi32(_mm_srli_epi64(n, 32), magic);
+    __m128i high = _mm_blend_epi16(even, odd, 0xCC);
+    return _mm_sub_epi32(_mm_srai_epi32(high, DIVIDE_1000_SHIFT), _mm_srai_epi32(n, 31));
+}
+
+/*
+* Convert 8 left justified words.
+*/
+__attribute__((target("sse4.1")))
+static inline void Sse41Convert8(__m128i words, __m128i scale, int32_t* out)
+{
+    _mm_storeu_si128((__m128i*)out, Sse41Convert(_mm_cvtepi16_epi32(words), scale));
+    _mm_storeu_si128((__m128i*)(out + 4), Sse41Convert(_mm_cvtepi16_epi32(_mm_srli_si128(words, 8)), scale));
+}
+
+/*
+* Left justified words of 8 packed values: the even ones are shifted up
+* by a nibble, the low nibble of the odd ones is dropped by the conversion.
+*/
+__attribute__((target("sse4.1")))
+static inline __m128i Sse41Unpack(__m128i bytes)
+{
+    __m128i words = _mm_shuffle_epi8(bytes, _mm_set_epi8(PACKED_SHUFFLE));
+    return _mm_blend_epi16(_mm_slli_epi16(words, 4), words, 0xAA);
+}
+
+__attribute__((target("sse4.1")))
+static void ConvertRawSse41(const uint8_t* raw, size_t values, int32_t scale, int32_t* out)
+{
+    __m128i factor = _mm_set1_epi32(scale);
+    size_t i = 0;
+    for (; i + 8 <= values; i += 8)
+    {
+        Sse41Convert8(_mm_loadu_si128((const __m128i*)&raw[2 * i]), factor, &out[i]);
+    }
+    ConvertRawScalar(raw, i, values, scale, out);
+}
+
+__attribute__((target("sse4.1")))
+static void ConvertPackedSse41(const uint8_t* packed, size_t values, int32_t scale, int32_t* out)
+{
+    __m128i factor = _mm_set1_epi32(scale);
+    size_t size = (values * 3 + 1) / 2;
+    size_t i = 0;
+    // 12 bytes are used, 16 are loaded
+    for (; 3 * i / 2 + 16 <= size; i += 8)
+    {
+        Sse41Convert8(Sse41Unpack(_mm_loadu_si128((const __m128i*)&packed[3 * i / 2])), factor, &out[i]);
+    }
+    ConvertPackedScalar(packed, i, values, scale, out);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i Avx2Convert(__m256i words, __m256i scale)
+{
+    __m256i n = _mm256_mullo_epi32(_mm256_srai_epi32(words, 4), scale);
+    __m256i magic = _mm256_set1_epi32(DIVIDE_1000_MAGIC);
+    __m256i even = _mm256_srli_epi64(_mm256_mul_epi32(n, magic), 32);
+    __m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(n, 32), magic);
+    __m256i high = _mm256_blend_epi32(even, odd, 0xAA);
+    return _mm256_sub_epi32(_mm256_srai_epi32(high, DIVIDE_1000_SHIFT), _mm256_srai_epi32(n, 31));
+}
+
+/*
+* Convert 16 left justified words.
+*/
+__attribute__((target("avx2")))
+static inline void Avx2Convert16(__m256i words, __m256i scale, int32_t* out)
+{
+    __m256i low = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(words));
+    __m256i high = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(words, 1));
+    _mm256_storeu_si256((__m256i*)out, Avx2Convert(low, scale));
+    _mm256_storeu_si256((__m256i*)(out + 8), Avx2Convert(high, scale));
+}
+
+__attribute__((target("avx2")))
+static void ConvertRawAvx2(const uint8_t* raw, size_t values, int32_t scale, int32_t* out)
+{
+    __m256i factor = _mm256_set1_epi32(scale);
+    size_t i = 0;
+    for (; i + 16 <= values; i += 16)
+    {
+        Avx2Convert16(_mm256_loadu_si256((const __m256i*)&raw[2 * i]), factor, &out[i]);
+    }
+    ConvertRawScalar(raw, i, values, scale, out);
+}
+
+__attribute__((target("avx2")))
+static void ConvertPackedAvx2(const uint8_t* packed, size_t values, int32_t scale, int32_t* out)
+{
+    __m256i factor = _mm256_set1_epi32(scale);
+    __m256i shuffle = _mm256_setr_m128i(_mm_set_epi8(PACKED_SHUFFLE), _mm_set_epi8(PACKED_SHUFFLE));
+    size_t size = (values * 3 + 1) / 2;
+    size_t i = 0;
+    // 24 bytes are used, 28 are loaded: 12 bytes per 128-bit lane
+    for (; 3 * i / 2 + 28 <= size; i += 16)
+    {
+        const uint8_t* bytes = &packed[3 * i / 2];
+        __m256i lanes = _mm256_setr_m128i(_mm_loadu_si128((const __m128i*)bytes),
+                                          _mm_loadu_si128((const __m128i*)(bytes + 12)));
+        __m256i words = _mm256_shuffle_epi8(lanes, shuffle);
+        words = _mm256_blend_epi16(_mm256_slli_epi16(words, 4), words, 0xAA);
+        Avx2Convert16(words, factor, &out[i]);
+    }
+    ConvertPackedScalar(packed, i, values, scale, out);
+}
+
+#endif // LIS3DH_X86
+
+Lis3dh_Kernel Lis3dh_BestKernel(void)
+{
+#if LIS3DH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return LIS3DH_KERNEL_AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1"))
+    {
+        return LIS3DH_KERNEL_SSE41;
+    }
+#endif
+    return LIS3DH_KERNEL_SCALAR;
+}
+
+const char* Lis3dh_KernelName(Lis3dh_Kernel kernel)
+{
+    switch (kernel)
+    {
+        case LIS3DH_KERNEL_AVX2:
+            return "AVX2";
+        case LIS3DH_KERNEL_SSE41:
+            return "SSE4.1";
+        default:
+            return "scalar";
+    }
+}
+
+void Lis3dh_ConvertRaw(const uint8_t* raw, size_t samples, uint32_t um_s2_per_digit,
+                       int32_t (*acceleration)[3], Lis3dh_Kernel kernel)
+{
+    Lis3dh_Kernel best = Lis3dh_BestKernel();
+    int32_t scale = (int32_t)um_s2_per_digit;
+    int32_t* out = &acceleration[0][0];
+    switch (kernel > best ? best : kernel)
+    {
+#if LIS3DH_X86
+        case LIS3DH_KERNEL_AVX2:
+            ConvertRawAvx2(raw, 3 * samples, scale, out);
+            break;
+        case LIS3DH_KERNEL_SSE41:
+            ConvertRawSse41(raw, 3 * samples, scale, out);
+            break;
+#endif
+        default:
+            ConvertRawScalar(raw, 0, 3 * samples, scale, out);
+            break;
+    }
+}
+
+void Lis3dh_ConvertPacked(const uint8_t* packed, size_t samples, uint32_t um_s2_per_digit,
+                          int32_t (*acceleration)[3], Lis3dh_Kernel kernel)
+{
+    Lis3dh_Kernel best = Lis3dh_BestKernel();
+    int32_t scale = (int32_t)um_s2_per_digit;
+    int32_t* out = &acceleration[0][0];
+    switch (kernel > best ? best : kernel)
+    {
+#if LIS3DH_X86
+        case LIS3DH_KERNEL_AVX2:
+            ConvertPackedAvx2(packed, 3 * samples, scale, out);
+            break;
+        case LIS3DH_KERNEL_SSE41:
+            ConvertPackedSse41(packed, 3 * samples, scale, out);
+            break;
+#endif
+        default:
+            ConvertPackedScalar(packed, 0, 3 * samples, scale, out);
+            break;
+    }
+}
+
+void Lis3dh_Pack(const uint8_t* raw, size_t samples, uint8_t* packed)
+{
+    size_t values = 3 * samples;
+    for (size_t i = 0; i < values; i++)
+    {
+        uint16_t value = RawWord(raw, i) >> 4;
+        uint8_t* pair = &packed[3 * (i / 2)];
+        if (i % 2 == 0)
+        {
+            pair[0] = (uint8_t)value;
+            pair[1] = (uint8_t)(value >> 8);
+        }
+        else
+        {
+            pair[1] |= (uint8_t)(value << 4);
+            pair[2] = (uint8_t)(value >> 4);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/*
+* Bulk conversion of raw LIS3DH samples to [mm/s^2] on the host.
+*
+* The result is bit-identical to Device_Convert() of the firmware: the
+* 12-bit value times the scale [um/s^2/digit], divided by 1000 with the C
+* integer division. Multiply by 0.001 to get [m/s^2]. The conversion runs
+* with AVX2 or SSE4.1 when the CPU has them (gcc or clang on x86), else
+* with the scalar code.
+*
+* Two layouts of the samples are read:
+*
+* - raw: the 6 bytes of OUT_X_L ... OUT_Z_H of each sample, as read from
+*   the FIFO: X, Y, Z as little endian int16, left justified;
+* - packed: the 12-bit values of X, Y, Z one sample after the other, two
+*   values in 3 bytes: the first in byte 0 and the low nibble of byte 1,
+*   the second in the high nibble of byte 1 and byte 2. 4.5 bytes per
+*   sample, see Lis3dh_Pack().
+*/
+
+#ifndef LIS3DH_CONVERT_H
+#define LIS3DH_CONVERT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+* Scale [um/s^2/digit] of the full scales +-2, 4, 8, 16 g, as in Device.c
+*/
+#define LIS3DH_SCALE_2G 9806
+#define LIS3DH_SCALE_4G 19612
+#define LIS3DH_SCALE_8G 39224
+#define LIS3DH_SCALE_16G 117672
+
+#define LIS3DH_RAW_SIZE(samples) ((size_t)(samples) * 6)
+#define LIS3DH_PACKED_SIZE(samples) (((size_t)(samples) * 9 + 1) / 2)
+
+typedef enum {
+    LIS3DH_KERNEL_SCALAR,
+    LIS3DH_KERNEL_SSE41,
+    LIS3DH_KERNEL_AVX2,
+} Lis3dh_Kernel;
+
+/*
+* Fastest kernel supported by the CPU.
+*/
+Lis3dh_Kernel Lis3dh_BestKernel(void);
+
+/*
+* Name of a kernel, for the reports.
+*/
+const char* Lis3dh_KernelName(Lis3dh_Kernel kernel);
+
+/*
+* Convert samples raw samples to X, Y, Z [mm/s^2]. A kernel the CPU does
+* not support is replaced by the best one supported.
+*/
+void Lis3dh_ConvertRaw(const uint8_t* raw, size_t samples, uint32_t um_s2_per_digit,
+                       int32_t (*acceleration)[3], Lis3dh_Kernel kernel);
+
+/*
+* Convert samples packed samples to X, Y, Z [mm/s^2].
+*/
+void Lis3dh_ConvertPacked(const uint8_t* packed, size_t samples, uint32_t um_s2_per_digit,
+                          int32_t (*acceleration)[3], Lis3dh_Kernel kernel);
+
+/*
+* Pack samples raw samples in LIS3DH_PACKED_SIZE(samples) bytes. The 4 low
+* bits of each raw value are dropped: the conversion ignores them.
+*/
+void Lis3dh_Pack(const uint8_t* raw, size_t samples, uint8_t* packed);
+
+#endif // LIS3DH_CONVERT_H
@@ -0,0 +1,61 @@
+"""Decode a dump of the flash log of AY1920_II_HW_05_PROJ_3 into CSV.
+
+Record the UART while sending the dump command ('D'); the log row frames
+are checked (checksum, missing rows), put in the order of their sequence
+numbers and the compressed frames are expanded. Each line of the output is
+the sample index, the Timer tick of the end of its frame, the output data
+rate [Hz] and X, Y, Z [mm/s^2]. The samples between a lost row and the
+next keyframe cannot be decoded and are missing from the output. The exit
+status is 1 if a row was missing or damaged.
+
+    python log_dump.py dump.bin -o log.csv
+"""
+
+import argparse
+import sys
+
+import frames
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("recording", help="binary UART recording of the dump")
+    parser.add_argument("-o", "--output", help="CSV file (default: standard output)")
+    args = parser.parse_args()
+
+    with open(args.recording, "rb") as f:
+        dump = [frames.log_row(payload) for header, payload in frames.decode(f.read())
+                if header == frames.LOG_ROW]
+    if not dump:
+        print("No log row frame", file=sys.stderr)
+        return 2
+
+    expected = dump[0][1]
+    received = {index for index, _, _ in dump}
+    rows = sorted(row for _, _, row in dump if row is not None)
+    damaged = sum(1 for _, _, row in dump if row is None)
+    missing = expected - len(received)
+
+    decoder = frames.CompressedDecoder()
+    samples = skipped = 0
+    output = open(args.output, "w") if args.output else sys.stdout
+    output.write("index,tick,rate,x,y,z\n")
+    for _, rate, records in rows:
+        for tick, payload in records:
+            index, batch = decoder.batch(payload)
+            if index is None:
+                skipped += 1
+                continue
+            for n, (x, y, z) in enumerate(batch):
+                output.write("%d,%d,%d,%d,%d,%d\n" % (index + n, tick, rate, x, y, z))
+            samples += len(batch)
+    if output is not sys.stdout:
+        output.close()
+
+    print("%d rows of %d, %d damaged, %d missing; %d samples, %d frames waiting for a keyframe"
+          % (len(rows), expected, damaged, missing, samples, skipped), file=sys.stderr)
+    return 1 if damaged or missing else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,46 @@
+"""Check that a recorded run of AY1920_II_HW_05_PROJ_3 lost no sample.
+
+The health frames carry cumulative loss counters (Health.h): the events of
+the run are the difference between the last and the first frame. Empty
+polls and TX stalls are reported but not counted as losses, since no
+sample is lost. The exit status is 1 if a loss counter changed.
+
+    python loss_check.py run.bin
+"""
+
+import argparse
+import sys
+
+import frames
+
+NOT_LOSSES = ("empty poll", "TX stall")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("recording", help="binary UART recording")
+    args = parser.parse_args()
+
+    with open(args.recording, "rb") as f:
+        reports = [frames.health(payload) for header, payload in frames.decode(f.read())
+                   if header == frames.HEALTH]
+    if len(reports) < 2:
+        print("At least two health frames are needed, found %d" % len(reports))
+        return 2
+
+    first, last = reports[0], reports[-1]
+    seconds = ((last[0] - first[0]) & 0xFFFFFFFF) / 100.0
+    samples = (last[1] - first[1]) & 0xFFFFFFFF
+    print("%.0f s, %d samples" % (seconds, samples))
+    lost = False
+    for name, value in last[2].items():
+        events = (value - first[2].get(name, 0)) & 0xFFFFFFFF
+        print("  %-15s %d" % (name, events))
+        if events and name not in NOT_LOSSES:
+            lost = True
+    print("LOSSES" if lost else "loss-free")
+    return 1 if lost else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,356 @@
+"""Generate the code of the fixed-layout frames from packets.json.
+
+The schema is the only place where the layout of these frames is written.
+From it the generator writes:
+
+- Packets.h and Packets.c of the firmware: header, payload length, a
+  structure with the fields and the function that packs them;
+- packets.hpp: the host C++ decoder, with the offsets known at compile
+  time;
+- the .iic and .ini files of the Bridge Control Panel for the frame that
+  it plots.
+
+frames.py reads the payload lengths from the schema directly. With --check
+nothing is written and the exit status is 1 if a generated file is stale.
+
+    python packetgen.py [--check]
+"""
+
+import argparse
+import json
+import os
+import sys
+import textwrap
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+FIRMWARE = os.path.join(HERE, "..", "AY1920_II_HW_05_PROJ_3.cydsn")
+BRIDGE_CONTROL_PANEL = os.path.join(FIRMWARE, "Bridge_Control_Panel")
+
+TYPES = {
+    "int8": (1, True), "uint8": (1, False),
+    "int16": (2, True), "uint16": (2, False),
+    "int32": (4, True), "uint32": (4, False),
+}
+
+# Bridge Control Panel: variable types by size and default colors
+BCP_TYPES = {1: "byte", 2: "int", 4: "long int"}
+BCP_VARIABLES = 32
+BCP_FLAGS = 16
+BCP_VARIABLE_COLORS = (
+    "Black", "Blue", "Lime", "Red", "BlueViolet", "LawnGreen", "Magenta", "Olive",
+    "MidnightBlue", "Orange", "SeaGreen", "Maroon", "OrangeRed", "Purple", "SaddleBrown", "Gray",
+)
+BCP_FLAG_COLORS = (
+    "Blue", "BlueViolet", "Chocolate", "Gray", "Green", "LawnGreen", "Lime", "Magenta",
+    "Maroon", "MidnightBlue", "Olive", "Orange", "OrangeRed", "Purple", "Red", "SaddleBrown",
+)
+BCP_SETTINGS = (
+    "PACKET=1", "SCROLL=1000", "AXIS_X_TYPE=1", "AUTO_RANGE_OF_AXIS_Y=1", "AXIS_Y_MIN=0",
+    "AXIS_Y_MAX=500", "SHOW_FLAGS=0", "AMPLITUDE=10", "THICKNESS=1",
+)
+
+
+def load_schema(path=os.path.join(HERE, "packets.json")):
+    """Packets of the schema, with the offset of every field."""
+    with open(path) as f:
+        schema = json.load(f)
+    for packet in schema["packets"]:
+        packet["header"] = int(packet["header"], 16)
+        offset = 0
+        for field in packet["fields"]:
+            field["size"], field["signed"] = TYPES[field["type"]]
+            field["offset"] = offset
+            offset += field["size"]
+        packet["length"] = offset
+    schema["tail"] = int(schema["tail"], 16)
+    return schema
+
+
+def camel(name):
+    return "".join(part.capitalize() for part in name.split("_"))
+
+
+def field_text(field):
+    """Description of a field for the comments: doc or name, [unit], (type)."""
+    text = field.get("doc", field["name"])
+    if "unit" in field:
+        text += " [%s]" % field["unit"]
+    return text + " (%s)" % field["type"]
+
+
+def doxygen(text, indent):
+    """Lines of a doxygen block body, wrapped at 80 columns."""
+    prefix = indent + "*   "
+    return [line.rstrip() for line in textwrap.wrap(text, 80 - len(prefix), initial_indent=prefix,
+                                                    subsequent_indent=prefix)]
+
+
+def firmware_header(schema):
+    lines = [
+        "/**",
+        "*   \\file Packets.h",
+        "*   \\brief Fixed-layout frames sent to the host over UART.",
+        "*",
+        "*   Generated by Host_Tools/packetgen.py from Host_Tools/packets.json: do",
+        "*   not edit, change the schema and run the generator. For each frame:",
+        "*   the header byte, the length of the payload, a structure with the",
+        "*   fields and a function that writes them in little endian order. The",
+        "*   frames of variable length are described in Frames.h.",
+        "*/",
+        "",
+        "#ifndef Packets_H",
+        "    #define Packets_H",
+        "",
+        "    #include \"cytypes.h\"",
+    ]
+    for packet in schema["packets"]:
+        name, upper = camel(packet["name"]), packet["name"].upper()
+        payload = "Payload: " + ", ".join(field_text(f) for f in packet["fields"]) + "."
+        lines += ["", "    /**"]
+        lines += doxygen("\\brief " + packet["description"], "    ")
+        lines += ["    *"]
+        lines += doxygen(payload, "    ")
+        lines += [
+            "    */",
+            "    #define FRAME_HEADER_%s 0x%02X" % (upper, packet["header"]),
+            "    #define PACKETS_%s_LENGTH %d" % (upper, packet["length"]),
+            "",
+            "    typedef struct {",
+        ]
+        width = max(len("%s_t %s;" % (f["type"], f["name"])) for f in packet["fields"])
+        for field in packet["fields"]:
+            declaration = "%s_t %s;" % (field["type"], field["name"])
+            comment = " ///< [%s]" % field["unit"] if "unit" in field else ""
+            lines.append(("        " + declaration.ljust(width) + comment).rstrip())
+        lines += [
+            "    } Packets_%s;" % name,
+            "",
+            "    uint8_t* Packets_Pack%s(uint8_t* payload, const Packets_%s* packet);" % (name, name),
+        ]
+    lines += ["", "#endif // Packets_H", "/* [] END OF FILE */", ""]
+    return "\n".join(lines)
+
+
+def firmware_source(schema):
+    lines = [
+        "/*",
+        "* This file includes the packers of the fixed-layout frames. Generated by",
+        "* Host_Tools/packetgen.py from Host_Tools/packets.json: do not edit.",
+        "*/",
+        "",
+        "#include \"Packets.h\"",
+    ]
+    for packet in schema["packets"]:
+        name = camel(packet["name"])
+        lines += [
+            "",
+            "    uint8_t* Packets_Pack%s(uint8_t* payload, const Packets_%s* packet)" % (name, name),
+            "    {",
+        ]
+        for field in packet["fields"]:
+            unsigned = "uint%d_t" % (8 * field["size"])
+            for byte in range(field["size"]):
+                if byte == 0:
+                    value = "(uint8_t)packet->%s" % field["name"]
+                else:
+                    value = "(uint8_t)((%s)packet->%s >> %d)" % (unsigned, field["name"], 8 * byte)
+                lines.append("        payload[%d] = %s;" % (field["offset"] + byte, value))
+        lines += ["        return payload + %d;" % packet["length"], "    }"]
+    lines += ["", "/* [] END OF FILE */", ""]
+    return "\n".join(lines)
+
+
+def host_decoder(schema):
+    lines = [
+        "// Decoder of the fixed-layout frames of AY1920_II_HW_05_PROJ_3.",
+        "//",
+        "// Generated by packetgen.py from packets.json: do not edit. Every frame",
+        "// is a struct whose decode() reads the fields at offsets known at compile",
+        "// time; for_each_frame() finds the frames in a stream. Multiply a field",
+        "// by its <field>_scale to get the unit of the comment after it.",
+        "",
+        "#pragma once",
+        "",
+        "#include <cstddef>",
+        "#include <cstdint>",
+        "#include <type_traits>",
+        "",
+        "namespace packets {",
+        "",
+        "constexpr std::uint8_t tail = 0x%02X;" % schema["tail"],
+        "",
+        "// Little endian field of type T at a compile-time offset of the payload",
+        "template <typename T, std::size_t Offset>",
+        "inline T get(const std::uint8_t* payload)",
+        "{",
+        "    using U = std::make_unsigned_t<T>;",
+        "    U value = 0;",
+        "    for (std::size_t i = 0; i < sizeof(T); i++)",
+        "        value = static_cast<U>(value | static_cast<U>(payload[Offset + i]) << (8 * i));",
+        "    return static_cast<T>(value);",
+        "}",
+    ]
+    for packet in schema["packets"]:
+        name = camel(packet["name"])
+        lines.append("")
+        lines += textwrap.wrap(packet["description"], 77, initial_indent="// ", subsequent_indent="// ")
+        lines += [
+            "struct %s {" % name,
+            "    static constexpr std::uint8_t header = 0x%02X;" % packet["header"],
+            "    static constexpr std::size_t length = %d;" % packet["length"],
+            "",
+        ]
+        for field in packet["fields"]:
+            comment = " ".join(filter(None, (field.get("doc"), "[%s]" % field["unit"] if "unit" in field else None)))
+            lines.append(("    std::%s_t %s;  // %s" % (field["type"], field["name"], comment)).rstrip(" /"))
+        lines.append("")
+        for field in packet["fields"]:
+            lines.append("    static constexpr std::size_t %s_offset = %d;" % (field["name"], field["offset"]))
+        for field in packet["fields"]:
+            if "scale" in field:
+                lines.append("    static constexpr double %s_scale = %r;" % (field["name"], field["scale"]))
+        reads = ",\n                ".join("get<std::%s_t, %d>(payload)" % (f["type"], f["offset"])
+                                           for f in packet["fields"])
+        lines += [
+            "",
+            "    static %s decode(const std::uint8_t* payload)" % name,
+            "    {",
+            "        return %s{%s};" % (name, reads),
+            "    }",
+            "};",
+        ]
+    lines += [
+        "",
+        "// Payload length of a fixed-layout frame, 0 for the other headers",
+        "constexpr std::size_t payload_length(std::uint8_t header)",
+        "{",
+        "    switch (header) {",
+    ]
+    for packet in schema["packets"]:
+        lines.append("    case %s::header: return %s::length;" % ((camel(packet["name"]),) * 2))
+    lines += [
+        "    default: return 0;",
+        "    }",
+        "}",
+        "",
+        "// Call visitor(frame) for every complete fixed-layout frame of data, with",
+        "// frame one of the structs above. The bytes that do not start a frame",
+        "// (text, frames of variable length) are skipped. Returns the bytes used:",
+        "// the rest is the start of an incomplete frame.",
+        "template <typename Visitor>",
+        "std::size_t for_each_frame(const std::uint8_t* data, std::size_t size, Visitor&& visitor)",
+        "{",
+        "    std::size_t position = 0;",
+        "    while (position < size) {",
+        "        const std::uint8_t* frame = data + position;",
+        "        std::size_t length = payload_length(frame[0]);",
+        "        if (length == 0) {",
+        "            position++;",
+        "            continue;",
+        "        }",
+        "        if (position + length + 2 > size)",
+        "            break;",
+        "        if (frame[length + 1] != tail) {",
+        "            position++;",
+        "            continue;",
+        "        }",
+        "        switch (frame[0]) {",
+    ]
+    for packet in schema["packets"]:
+        name = camel(packet["name"])
+        lines.append("        case %s::header: visitor(%s::decode(frame + 1)); break;" % (name, name))
+    lines += [
+        "        }",
+        "        position += length + 2;",
+        "    }",
+        "    return position;",
+        "}",
+        "",
+        "}  // namespace packets",
+        "",
+    ]
+    return "\n".join(lines)
+
+
+def bridge_control_panel(packet, tail):
+    """Contents of the .iic and .ini files plotting the fields of packet."""
+    terms = ["rx8", "[h=%02X]" % packet["header"]]
+    for field in packet["fields"]:
+        terms += ["@%d%s" % (byte, field["label"].lower()) for byte in range(field["size"])]
+    terms.append("[t=%02X]" % tail)
+    iic = " ".join(terms) + " "
+
+    lines = ["[VARIABLES_SETTINGS]"] + list(BCP_SETTINGS) + ["VARIABLES=%d" % BCP_VARIABLES]
+    for number in range(1, BCP_VARIABLES + 1):
+        if number <= len(packet["fields"]):
+            field = packet["fields"][number - 1]
+            values = (True, field["label"], BCP_TYPES[field["size"]], field["signed"], field.get("scale", 1))
+        else:
+            values = (False, "Var%d" % number, "byte", False, 1)
+        active, name, kind, signed, scale = values
+        lines += [
+            "Var%d.Number=%d" % (number, number),
+            "Var%d.Active=%s" % (number, active),
+            "Var%d.VariableName=%s" % (number, name),
+            "Var%d.Type=%s" % (number, kind),
+            "Var%d.Sign=%s" % (number, signed),
+            "Var%d.Scale=%g" % (number, scale),
+            "Var%d.Offset=0" % number,
+            "Var%d.Color=%s" % (number, BCP_VARIABLE_COLORS[(number - 1) % len(BCP_VARIABLE_COLORS)]),
+        ]
+    lines += ["[FLAGS_SETTINGS]", "FLAGS=%d" % BCP_FLAGS]
+    for number in range(1, BCP_FLAGS + 1):
+        lines += [
+            "Flag%d.Number=%d" % (number, number),
+            "Flag%d.Active=False" % number,
+            "Flag%d.VariableName=x" % number,
+            "Flag%d.FlagName=gf%X" % (number, number - 1),
+            "Flag%d.BitMask=00000000" % number,
+            "Flag%d.Inversion=False" % number,
+            "Flag%d.Visible=False" % number,
+            "Flag%d.Position=0" % number,
+            "Flag%d.Color=%s" % (number, BCP_FLAG_COLORS[number - 1]),
+        ]
+    return iic, "\n".join(lines) + "\n"
+
+
+def outputs(schema):
+    """Path and contents of every generated file."""
+    files = {
+        os.path.join(FIRMWARE, "Packets.h"): firmware_header(schema),
+        os.path.join(FIRMWARE, "Packets.c"): firmware_source(schema),
+        os.path.join(HERE, "packets.hpp"): host_decoder(schema),
+    }
+    for packet in schema["packets"]:
+        if "bridge_control_panel" in packet:
+            iic, ini = bridge_control_panel(packet, schema["tail"])
+            base = os.path.join(BRIDGE_CONTROL_PANEL, packet["bridge_control_panel"])
+            files[base + ".iic"] = iic
+            files[base + ".ini"] = ini
+    return files
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--check", action="store_true", help="only check that the files are up to date")
+    args = parser.parse_args()
+
+    stale = []
+    for path, contents in outputs(load_schema()).items():
+        current = None
+        if os.path.exists(path):
+            with open(path, newline="") as f:
+                current = f.read()
+        if current == contents:
+            continue
+        stale.append(os.path.relpath(path))
+        if not args.check:
+            with open(path, "w", newline="") as f:
+                f.write(contents)
+    for path in stale:
+        print(("stale: " if args.check else "written: ") + path)
+    return 1 if args.check and stale else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
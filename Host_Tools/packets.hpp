@@ -0,0 +1,361 @@
+// Decoder of the fixed-layout frames of AY1920_II_HW_05_PROJ_3.
+//
+// Generated by packetgen.py from packets.json: do not edit. Every frame
+// is a struct whose decode() reads the fields at offsets known at compile
+// time; for_each_frame() finds the frames in a stream. Multiply a field
+// by its <field>_scale to get the unit of the comment after it.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace packets {
+
+constexpr std::uint8_t tail = 0xC0;
+
+// Little endian field of type T at a compile-time offset of the payload
+template <typename T, std::size_t Offset>
+inline T get(const std::uint8_t* payload)
+{
+    using U = std::make_unsigned_t<T>;
+    U value = 0;
+    for (std::size_t i = 0; i < sizeof(T); i++)
+        value = static_cast<U>(value | static_cast<U>(payload[Offset + i]) << (8 * i));
+    return static_cast<T>(value);
+}
+
+// Header of the sample frame, plotted by the Bridge Control Panel.
+struct Sample {
+    static constexpr std::uint8_t header = 0xA0;
+    static constexpr std::size_t length = 12;
+
+    std::int32_t x;  // [mm/s^2]
+    std::int32_t y;  // [mm/s^2]
+    std::int32_t z;  // [mm/s^2]
+
+    static constexpr std::size_t x_offset = 0;
+    static constexpr std::size_t y_offset = 4;
+    static constexpr std::size_t z_offset = 8;
+    static constexpr double x_scale = 0.001;
+    static constexpr double y_scale = 0.001;
+    static constexpr double z_scale = 0.001;
+
+    static Sample decode(const std::uint8_t* payload)
+    {
+        return Sample{get<std::int32_t, 0>(payload),
+                get<std::int32_t, 4>(payload),
+                get<std::int32_t, 8>(payload)};
+    }
+};
+
+// Header of the rate change frame.
+struct Rate {
+    static constexpr std::uint8_t header = 0xA1;
+    static constexpr std::size_t length = 10;
+
+    std::uint16_t rate;  // new output rate [Hz]
+    std::uint32_t sample_count;  // number of samples sent before the change
+    std::uint32_t tick;  // Timer tick of the change
+
+    static constexpr std::size_t rate_offset = 0;
+    static constexpr std::size_t sample_count_offset = 2;
+    static constexpr std::size_t tick_offset = 6;
+
+    static Rate decode(const std::uint8_t* payload)
+    {
+        return Rate{get<std::uint16_t, 0>(payload),
+                get<std::uint32_t, 2>(payload),
+                get<std::uint32_t, 6>(payload)};
+    }
+};
+
+// Header of the summary frame of the statistics mode. The peak-to-peak value
+// is max - min.
+struct Summary {
+    static constexpr std::uint8_t header = 0xA3;
+    static constexpr std::size_t length = 58;
+
+    std::uint32_t first_index;  // index of the first sample of the window
+    std::uint16_t count;  // samples of the window
+    std::int32_t x_mean;  // [mm/s^2]
+    std::uint32_t x_rms;  // [mm/s^2]
+    std::int32_t x_min;  // [mm/s^2]
+    std::int32_t x_max;  // [mm/s^2]
+    std::int32_t y_mean;  // [mm/s^2]
+    std::uint32_t y_rms;  // [mm/s^2]
+    std::int32_t y_min;  // [mm/s^2]
+    std::int32_t y_max;  // [mm/s^2]
+    std::int32_t z_mean;  // [mm/s^2]
+    std::uint32_t z_rms;  // [mm/s^2]
+    std::int32_t z_min;  // [mm/s^2]
+    std::int32_t z_max;  // [mm/s^2]
+    std::uint32_t magnitude_rms;  // RMS of the magnitude [mm/s^2]
+
+    static constexpr std::size_t first_index_offset = 0;
+    static constexpr std::size_t count_offset = 4;
+    static constexpr std::size_t x_mean_offset = 6;
+    static constexpr std::size_t x_rms_offset = 10;
+    static constexpr std::size_t x_min_offset = 14;
+    static constexpr std::size_t x_max_offset = 18;
+    static constexpr std::size_t y_mean_offset = 22;
+    static constexpr std::size_t y_rms_offset = 26;
+    static constexpr std::size_t y_min_offset = 30;
+    static constexpr std::size_t y_max_offset = 34;
+    static constexpr std::size_t z_mean_offset = 38;
+    static constexpr std::size_t z_rms_offset = 42;
+    static constexpr std::size_t z_min_offset = 46;
+    static constexpr std::size_t z_max_offset = 50;
+    static constexpr std::size_t magnitude_rms_offset = 54;
+
+    static Summary decode(const std::uint8_t* payload)
+    {
+        return Summary{get<std::uint32_t, 0>(payload),
+                get<std::uint16_t, 4>(payload),
+                get<std::int32_t, 6>(payload),
+                get<std::uint32_t, 10>(payload),
+                get<std::int32_t, 14>(payload),
+                get<std::int32_t, 18>(payload),
+                get<std::int32_t, 22>(payload),
+                get<std::uint32_t, 26>(payload),
+                get<std::int32_t, 30>(payload),
+                get<std::int32_t, 34>(payload),
+                get<std::int32_t, 38>(payload),
+                get<std::uint32_t, 42>(payload),
+                get<std::int32_t, 46>(payload),
+                get<std::int32_t, 50>(payload),
+                get<std::uint32_t, 54>(payload)};
+    }
+};
+
+// Header of the decimated sample frame. The rate of the stream is the output
+// data rate / factor.
+struct Decimated {
+    static constexpr std::uint8_t header = 0xA5;
+    static constexpr std::size_t length = 13;
+
+    std::uint8_t factor;  // decimation factor
+    std::int32_t x;  // [mm/s^2]
+    std::int32_t y;  // [mm/s^2]
+    std::int32_t z;  // [mm/s^2]
+
+    static constexpr std::size_t factor_offset = 0;
+    static constexpr std::size_t x_offset = 1;
+    static constexpr std::size_t y_offset = 5;
+    static constexpr std::size_t z_offset = 9;
+
+    static Decimated decode(const std::uint8_t* payload)
+    {
+        return Decimated{get<std::uint8_t, 0>(payload),
+                get<std::int32_t, 1>(payload),
+                get<std::int32_t, 5>(payload),
+                get<std::int32_t, 9>(payload)};
+    }
+};
+
+// Header of the click event frame.
+struct Click {
+    static constexpr std::uint8_t header = 0xA6;
+    static constexpr std::size_t length = 5;
+
+    std::uint8_t source;  // CLICK_SRC register of the LIS3DH (bit 5 double click, bit 4 single click, bit 3 negative sign, bit 2-0 Z/Y/X axis)
+    std::uint32_t sample_count;  // samples acquired when the click was read
+
+    static constexpr std::size_t source_offset = 0;
+    static constexpr std::size_t sample_count_offset = 1;
+
+    static Click decode(const std::uint8_t* payload)
+    {
+        return Click{get<std::uint8_t, 0>(payload),
+                get<std::uint32_t, 1>(payload)};
+    }
+};
+
+// Header of the auxiliary (ADC/temperature) frame. ADC3 is the temperature
+// sensor: a relative, uncalibrated value.
+struct Auxiliary {
+    static constexpr std::uint8_t header = 0xA7;
+    static constexpr std::size_t length = 10;
+
+    std::uint32_t sample_count;  // samples acquired at the reading
+    std::int16_t adc1;  // 10-bit value
+    std::int16_t adc2;  // 10-bit value
+    std::int16_t adc3;  // 10-bit value
+
+    static constexpr std::size_t sample_count_offset = 0;
+    static constexpr std::size_t adc1_offset = 4;
+    static constexpr std::size_t adc2_offset = 6;
+    static constexpr std::size_t adc3_offset = 8;
+
+    static Auxiliary decode(const std::uint8_t* payload)
+    {
+        return Auxiliary{get<std::uint32_t, 0>(payload),
+                get<std::int16_t, 4>(payload),
+                get<std::int16_t, 6>(payload),
+                get<std::int16_t, 8>(payload)};
+    }
+};
+
+// Header of the tilt frame: pitch and roll of the average gravity vector.
+struct Tilt {
+    static constexpr std::uint8_t header = 0xA8;
+    static constexpr std::size_t length = 8;
+
+    std::uint32_t first_index;  // index of the first sample of the interval
+    std::int16_t pitch;  // [0.01 degrees]
+    std::int16_t roll;  // [0.01 degrees]
+
+    static constexpr std::size_t first_index_offset = 0;
+    static constexpr std::size_t pitch_offset = 4;
+    static constexpr std::size_t roll_offset = 6;
+    static constexpr double pitch_scale = 0.01;
+    static constexpr double roll_scale = 0.01;
+
+    static Tilt decode(const std::uint8_t* payload)
+    {
+        return Tilt{get<std::uint32_t, 0>(payload),
+                get<std::int16_t, 4>(payload),
+                get<std::int16_t, 6>(payload)};
+    }
+};
+
+// Header of the velocity summary frame, for vibration severity in [mm/s].
+struct Velocity {
+    static constexpr std::uint8_t header = 0xA9;
+    static constexpr std::size_t length = 18;
+
+    std::uint32_t first_index;  // index of the first sample of the window
+    std::uint16_t count;  // samples of the window
+    std::uint32_t x_rms;  // [um/s]
+    std::uint32_t y_rms;  // [um/s]
+    std::uint32_t z_rms;  // [um/s]
+
+    static constexpr std::size_t first_index_offset = 0;
+    static constexpr std::size_t count_offset = 4;
+    static constexpr std::size_t x_rms_offset = 6;
+    static constexpr std::size_t y_rms_offset = 10;
+    static constexpr std::size_t z_rms_offset = 14;
+    static constexpr double x_rms_scale = 0.001;
+    static constexpr double y_rms_scale = 0.001;
+    static constexpr double z_rms_scale = 0.001;
+
+    static Velocity decode(const std::uint8_t* payload)
+    {
+        return Velocity{get<std::uint32_t, 0>(payload),
+                get<std::uint16_t, 4>(payload),
+                get<std::uint32_t, 6>(payload),
+                get<std::uint32_t, 10>(payload),
+                get<std::uint32_t, 14>(payload)};
+    }
+};
+
+// Header of the sample frame of the other accelerometers, sent with the raw
+// stream when their output is on (command 'O'). The samples of device 0 use
+// the sample frame.
+struct DeviceSample {
+    static constexpr std::uint8_t header = 0xAA;
+    static constexpr std::size_t length = 13;
+
+    std::uint8_t device;  // device id, 1 ... DEVICE_MAX - 1
+    std::int32_t x;  // [mm/s^2]
+    std::int32_t y;  // [mm/s^2]
+    std::int32_t z;  // [mm/s^2]
+
+    static constexpr std::size_t device_offset = 0;
+    static constexpr std::size_t x_offset = 1;
+    static constexpr std::size_t y_offset = 5;
+    static constexpr std::size_t z_offset = 9;
+
+    static DeviceSample decode(const std::uint8_t* payload)
+    {
+        return DeviceSample{get<std::uint8_t, 0>(payload),
+                get<std::int32_t, 1>(payload),
+                get<std::int32_t, 5>(payload),
+                get<std::int32_t, 9>(payload)};
+    }
+};
+
+// Header of the clock sync frame, sent every ACQUISITION_SYNC_PERIOD ticks.
+// The host pairs each frame with its arrival time to map the device clock on
+// the host clock.
+struct Sync {
+    static constexpr std::uint8_t header = 0xAC;
+    static constexpr std::size_t length = 14;
+
+    std::uint32_t tick;  // Timer tick
+    std::uint32_t timestamp;  // same clock as the timestamp frame [us]
+    std::uint32_t sample_count;  // samples acquired
+    std::uint16_t tx_pending;  // bytes waiting in the UART TX buffer before the frame
+
+    static constexpr std::size_t tick_offset = 0;
+    static constexpr std::size_t timestamp_offset = 4;
+    static constexpr std::size_t sample_count_offset = 8;
+    static constexpr std::size_t tx_pending_offset = 12;
+
+    static Sync decode(const std::uint8_t* payload)
+    {
+        return Sync{get<std::uint32_t, 0>(payload),
+                get<std::uint32_t, 4>(payload),
+                get<std::uint32_t, 8>(payload),
+                get<std::uint16_t, 12>(payload)};
+    }
+};
+
+// Payload length of a fixed-layout frame, 0 for the other headers
+constexpr std::size_t payload_length(std::uint8_t header)
+{
+    switch (header) {
+    case Sample::header: return Sample::length;
+    case Rate::header: return Rate::length;
+    case Summary::header: return Summary::length;
+    case Decimated::header: return Decimated::length;
+    case Click::header: return Click::length;
+    case Auxiliary::header: return Auxiliary::length;
+    case Tilt::header: return Tilt::length;
+    case Velocity::header: return Velocity::length;
+    case DeviceSample::header: return DeviceSample::length;
+    case Sync::header: return Sync::length;
+    default: return 0;
+    }
+}
+
+// Call visitor(frame) for every complete fixed-layout frame of data, with
+// frame one of the structs above. The bytes that do not start a frame
+// (text, frames of variable length) are skipped. Returns the bytes used:
+// the rest is the start of an incomplete frame.
+template <typename Visitor>
+std::size_t for_each_frame(const std::uint8_t* data, std::size_t size, Visitor&& visitor)
+{
+    std::size_t position = 0;
+    while (position < size) {
+        const std::uint8_t* frame = data + position;
+        std::size_t length = payload_length(frame[0]);
+        if (length == 0) {
+            position++;
+            continue;
+        }
+        if (position + length + 2 > size)
+            break;
+        if (frame[length + 1] != tail) {
+            position++;
+            continue;
+        }
+        switch (frame[0]) {
+        case Sample::header: visitor(Sample::decode(frame + 1)); break;
+        case Rate::header: visitor(Rate::decode(frame + 1)); break;
+        case Summary::header: visitor(Summary::decode(frame + 1)); break;
+        case Decimated::header: visitor(Decimated::decode(frame + 1)); break;
+        case Click::header: visitor(Click::decode(frame + 1)); break;
+        case Auxiliary::header: visitor(Auxiliary::decode(frame + 1)); break;
+        case Tilt::header: visitor(Tilt::decode(frame + 1)); break;
+        case Velocity::header: visitor(Velocity::decode(frame + 1)); break;
+        case DeviceSample::header: visitor(DeviceSample::decode(frame + 1)); break;
+        case Sync::header: visitor(Sync::decode(frame + 1)); break;
+        }
+        position += length + 2;
+    }
+    return position;
+}
+
+}  // namespace packets
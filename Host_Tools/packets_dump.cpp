@@ -0,0 +1,56 @@
+// Count the fixed-layout frames of a recorded UART stream and write the
+// sample frames as CSV in [m/s^2], with the decoder generated from
+// packets.json (packets.hpp). The decoding rate is printed at the end.
+//
+// Build and run from the Host_Tools folder:
+//
+//     c++ -O2 -std=c++17 packets_dump.cpp -o packets_dump
+//     ./packets_dump recording.bin [samples.csv]
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+#include "packets.hpp"
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s recording.bin [samples.csv]\n", argv[0]);
+        return 2;
+    }
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input) {
+        std::fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 2;
+    }
+    std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    std::FILE* csv = argc > 2 ? std::fopen(argv[2], "w") : nullptr;
+    if (csv)
+        std::fprintf(csv, "x,y,z\n");
+
+    std::map<std::uint8_t, unsigned long> counts;
+    auto start = std::chrono::steady_clock::now();
+    std::size_t used = packets::for_each_frame(data.data(), data.size(), [&](const auto& frame) {
+        using Frame = std::decay_t<decltype(frame)>;
+        counts[Frame::header]++;
+        if constexpr (std::is_same_v<Frame, packets::Sample>) {
+            if (csv)
+                std::fprintf(csv, "%.3f,%.3f,%.3f\n", frame.x * Frame::x_scale, frame.y * Frame::y_scale,
+                             frame.z * Frame::z_scale);
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (csv)
+        std::fclose(csv);
+
+    for (const auto& [header, count] : counts)
+        std::printf("0x%02X: %lu frames\n", header, count);
+    std::printf("%zu of %zu bytes decoded in %.3f ms (%.1f MB/s%s)\n", used, data.size(), seconds * 1e3,
+                used / seconds / 1e6, csv ? ", with the CSV output" : "");
+    return 0;
+}
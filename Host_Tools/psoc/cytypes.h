@@ -0,0 +1,27 @@
+/*
+* Minimal cytypes.h for the host builds of the firmware modules that
+* include the PSoC headers: the fixed-width types, the status codes and
+* the alignment attribute.
+*/
+
+#ifndef CYTYPES_H
+#define CYTYPES_H
+
+#include <stdint.h>
+
+typedef uint8_t uint8;
+typedef int8_t int8;
+typedef uint16_t uint16;
+typedef int16_t int16;
+typedef uint32_t uint32;
+typedef int32_t int32;
+typedef char char8;
+typedef uint32_t cystatus;
+
+#define CYRET_SUCCESS 0x00u
+#define CYRET_STARTED 0x07u
+
+// Alignment of the variables in flash
+#define CY_ALIGN(align) __attribute__((aligned(align)))
+
+#endif // CYTYPES_H
@@ -0,0 +1,41 @@
+/*
+* Minimal project.h for the host builds of the firmware modules: the
+* generated functions they call are declared here and defined by the tool
+* that compiles them, on its simulated hardware.
+*/
+
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include "cytypes.h"
+
+#define BCLK__BUS_CLK__HZ 24000000u
+
+// Interrupt routines are plain functions, called by the tool
+#define CY_ISR(name) void name(void)
+#define CY_ISR_PROTO(name) void name(void)
+
+void CyDelay(uint32 milliseconds);
+uint8 Timer_ReadStatusRegister(void);
+void UART_Debug_PutString(const char8 string[]);
+
+// Flash and SPC (CyFlash.h, CySpc.h); the status reads call the tool
+#define CY_FLASH_SIZEOF_ARRAY 0x10000u
+#define CY_FLASH_SIZEOF_ROW 256u
+#define CYDEV_FLS_ROW_SIZE 256u
+#define CY_SPC_STATUS_SUCCESS 0x00u
+#define CY_SPC_BUSY (CySpcIsBusy())
+#define CY_SPC_READ_STATUS (CySpcReadStatus())
+
+extern uint8 dieTemperature[2];
+
+cystatus CySetTemp(void);
+cystatus CySpcLock(void);
+void CySpcUnlock(void);
+cystatus CySpcLoadRowFull(uint8 array, uint16 row, const uint8 buffer[], uint16 size);
+cystatus CySpcWriteRow(uint8 array, uint16 address, uint8 tempPolarity, uint8 tempMagnitude);
+uint8 CySpcIsBusy(void);
+uint8 CySpcReadStatus(void);
+void CyFlushCache(void);
+
+#endif // PROJECT_H
@@ -0,0 +1,353 @@
+/*
+* Simulation and benchmark of the cooperative scheduler of the firmware
+* (Scheduler.c) with the task table of main.c. The tick and the cycle
+* counter are simulated: every task body moves the cycle counter on by its
+* execution time and the idle hook jumps to the next tick. The acquisition
+* reads a simulated LIS3DH whose samples come on its own clock and calls
+* Scheduler_Retry() on an empty FIFO, at most ACQUISITION_MAX_RETRIES
+* times per period, as Acquisition_Task() does.
+*
+* The execution times are estimates: the UART writes block at 19200 baud
+* until all but the last 4 bytes are sent (UART_Debug has only its 4-byte
+* hardware FIFO), the I2C reads take the time of the bytes at 100 kHz.
+* Besides the samples, the acquisition sends a timestamp frame every
+* ACQUISITION_TIMESTAMP_PERIOD ticks and the sync and health frames; a
+* help reply (1.7 kB) every minute is sent in pieces of what the link
+* takes before the next tick, as Commands_Task() does. Replace them with
+* the averages printed by command 't' on the board. For every load the
+* bytes per second on the link and the statistics of each task are printed;
+* the host time of one dispatch closes the report.
+*
+* Build and run from the Host_Tools folder:
+*
+*     cc -O2 -I../AY1920_II_HW_05_PROJ_3.cydsn scheduler_sim.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Scheduler.c -o scheduler_sim
+*     ./scheduler_sim
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <time.h>
+#include "Health.h"
+#include "Scheduler.h"
+
+#define CYCLES_PER_US 24                // BUS_CLK 24 MHz
+#define CYCLES_PER_TICK 240000          // Timer tick, 10 ms
+#define SIMULATED_TICKS 60000           // 10 minutes
+#define LINK_BYTES_PER_S 1920           // 19200 baud, 10 bits per byte
+#define UART_FIFO 4
+#define I2C_BYTE_US 90                  // 9 bits at 100 kHz
+#define FIFO_SIZE 32
+#define MAX_RETRIES 3                   // ACQUISITION_MAX_RETRIES
+#define TIMESTAMP_PERIOD 5              // ACQUISITION_TIMESTAMP_PERIOD
+#define TIMESTAMP_BYTES 5               // Relative timestamp frame
+#define SYNC_PERIOD 100                 // ACQUISITION_SYNC_PERIOD
+#define SYNC_BYTES 16
+#define HEALTH_PERIOD 1000              // ACQUISITION_HEALTH_PERIOD
+#define HEALTH_BYTES (9 + 4 * HEALTH_COUNTERS + 2)
+#define REPLY_BYTES 1700                // Help text
+#define REPLY_PERIOD 6000               // A minute
+#define BUS_MARGIN_US 1000              // ACQUISITION_BUS_MARGIN_US
+#define SENSOR_PERIOD_US 10020          // 100 Hz, 0.2 % slow
+#define BENCHMARK_DISPATCHES 20000000
+
+/**
+*   \brief Load of one simulation
+*/
+typedef struct {
+    const char* name;
+    int devices;                // Accelerometers streaming their samples
+    int bytes_per_sample;       // UART bytes per sample of each device
+    int spectrum;               // Spectrum output on (an FFT every 256 samples)
+} Load;
+
+static const Load loads[] = {
+    {"sample frames, 1 device", 1, 14, 0},
+    {"sample frames, 2 devices", 2, 14, 0},
+    {"compressed frames + spectrum", 1, 4, 1},
+    {"summary only", 1, 0, 0},
+};
+
+static const Load* load;
+static uint64_t cycles = 0;             // Simulated cycle counter
+static uint64_t sensor_next_us = 3000;  // Time of the next sample of the sensor
+static int fifo = 0;                    // Samples in the FIFO of each sensor
+static int retries = 0;
+static uint32_t samples = 0, lost = 0, empty_polls = 0, retried = 0;
+static uint64_t busy_cycles = 0;
+static uint64_t link_free_us = 0;       // The link has sent all the bytes written by then
+static uint32_t periodic_bytes = 0;     // Timestamp, sync and health frames written
+static uint32_t reply_left = 0;         // Bytes of the reply being sent
+static uint32_t replies = 0;
+static uint32_t reply_due = 0, timestamp_due = 0;
+static uint8_t command_task = 0;
+
+static uint32_t Tick(void)
+{
+    return (uint32_t)(cycles / CYCLES_PER_TICK);
+}
+
+static uint32_t Cycles(void)
+{
+    return (uint32_t)cycles;
+}
+
+static void Spend(uint64_t us)
+{
+    cycles += us * CYCLES_PER_US;
+    busy_cycles += us * CYCLES_PER_US;
+}
+
+/**
+*   \brief Samples produced by the sensor up to now, FIFO overflows counted
+*/
+static void Sensor(void)
+{
+    uint64_t now_us = cycles / CYCLES_PER_US;
+    while (sensor_next_us <= now_us)
+    {
+        if (fifo < FIFO_SIZE)
+        {
+            fifo++;
+        }
+        else
+        {
+            lost++;
+        }
+        sensor_next_us += SENSOR_PERIOD_US;
+    }
+}
+
+/**
+*   \brief Time to write bytes to the UART: the link sends them after the
+*   ones still queued, the writes wait for all but the last FIFO bytes
+*/
+static uint64_t UartUs(int bytes)
+{
+    uint64_t now_us = cycles / CYCLES_PER_US;
+    uint64_t start_us = link_free_us > now_us ? link_free_us : now_us;
+    link_free_us = start_us + (uint64_t)bytes * 1000000 / LINK_BYTES_PER_S;
+    uint64_t done_us = link_free_us - (uint64_t)UART_FIFO * 1000000 / LINK_BYTES_PER_S;
+    return done_us > now_us ? done_us - now_us : 0;
+}
+
+/**
+*   \brief Bytes the UART takes before the next acquisition without delaying
+*   it, as Acquisition_GetTxAllowance()
+*/
+static uint32_t Allowance(void)
+{
+    uint64_t now_us = cycles / CYCLES_PER_US;
+    uint64_t next_us = (uint64_t)(Tick() + 1) * (CYCLES_PER_TICK / CYCLES_PER_US);
+    uint64_t queued = link_free_us > now_us ? (link_free_us - now_us) * LINK_BYTES_PER_S / 1000000 : 0;
+    uint32_t room = queued < UART_FIFO ? UART_FIFO - (uint32_t)queued : 0;
+    uint64_t budget_us = next_us > now_us + BUS_MARGIN_US ? next_us - now_us - BUS_MARGIN_US : 0;
+    return room + (uint32_t)(budget_us * LINK_BYTES_PER_S / 1000000);
+}
+
+static void Acquisition(void)
+{
+    Sensor();
+    Spend(2 * I2C_BYTE_US + 100);   // FIFO_SRC read
+    if (fifo == 0)
+    {
+        if (retries < MAX_RETRIES)
+        {
+            retries++;
+            retried++;
+            Scheduler_Retry();
+            return;
+        }
+        empty_polls++;
+    }
+    retries = 0;
+    int count = fifo;
+    fifo = 0;
+    samples += count;
+    // Batch read, conversion and output of each device; the raw sample
+    // frames of device 0 carry a timestamp frame every period
+    uint32_t tick = Tick();
+    int periodic = 0;
+    if (load->bytes_per_sample == 14 && (int32_t)(tick - timestamp_due) >= 0)
+    {
+        periodic += TIMESTAMP_BYTES;
+        timestamp_due = tick + TIMESTAMP_PERIOD;
+    }
+    periodic += tick % SYNC_PERIOD == 0 ? SYNC_BYTES : 0;
+    periodic += tick % HEALTH_PERIOD == 0 ? HEALTH_BYTES : 0;
+    periodic_bytes += periodic;
+    for (int d = 0; d < load->devices; d++)
+    {
+        Spend((uint64_t)(2 + 6 * count) * I2C_BYTE_US + 40 * count);
+        Spend(UartUs(count * load->bytes_per_sample + (d ? 0 : periodic)));
+    }
+}
+
+static void Bus(void)
+{
+    Spend(20);
+}
+
+static void Adaptive(void)
+{
+    Spend(3 * I2C_BYTE_US);
+}
+
+static void Click(void)
+{
+    Spend(3 * I2C_BYTE_US);
+}
+
+static void Small(void)
+{
+    Spend(10);
+}
+
+static void Commands(void)
+{
+    // A help reply every minute, in pieces within the allowance; the task
+    // runs at every tick while a reply is pending
+    if (reply_left == 0 && (int32_t)(Tick() - reply_due) >= 0)
+    {
+        reply_due = Tick() + REPLY_PERIOD;
+        reply_left = REPLY_BYTES;
+        replies++;
+        Scheduler_SetPeriod(command_task, 1);
+    }
+    if (reply_left == 0)
+    {
+        Spend(10);
+        return;
+    }
+    uint32_t piece = Allowance();
+    piece = piece < reply_left ? piece : reply_left;
+    Spend(50 + UartUs((int)piece));
+    reply_left -= piece;
+    if (reply_left == 0)
+    {
+        Scheduler_SetPeriod(command_task, 10);
+    }
+}
+
+static void Spectrum(void)
+{
+    static uint32_t done = 0;
+    if (load->spectrum && samples - done >= 256)
+    {
+        done += 256;
+        Spend(6000 + UartUs(40));   // FFT of 256 points and the spectrum frame
+    }
+    else
+    {
+        Spend(5);
+    }
+}
+
+static void Idle(uint32_t now, uint32_t next_release)
+{
+    (void)next_release;
+    cycles = (uint64_t)(now + 1) * CYCLES_PER_TICK;
+}
+
+static void Setup(Scheduler_IdleHook idle)
+{
+    Scheduler_Init(Tick, Cycles, idle);
+    Scheduler_AddTask("Acquisition", Acquisition, 1, 0, 0, NULL);
+    Scheduler_AddTask("Bus", Bus, 1, 0, 0, NULL);
+    Scheduler_AddTask("Adaptive", Adaptive, 5, 0, 0, NULL);
+    Scheduler_AddTask("Click", Click, 5, 0, 0, NULL);
+    Scheduler_AddTask("Capture", Small, 1, 0, 0, NULL);
+    Scheduler_AddTask("Log", Small, 1, 0, 0, NULL);
+    Scheduler_AddTask("Calibration", Small, 10, 0, 0, NULL);
+    Scheduler_AddTask("Commands", Commands, 10, 0, 0, &command_task);
+    Scheduler_AddTask("Spectrum", Spectrum, 1, 0, 0, NULL);
+}
+
+static void Simulate(const Load* simulated)
+{
+    load = simulated;
+    cycles = busy_cycles = 0;
+    sensor_next_us = 3000;
+    fifo = retries = 0;
+    samples = lost = empty_polls = retried = 0;
+    link_free_us = 0;
+    periodic_bytes = reply_left = replies = 0;
+    reply_due = timestamp_due = 0;
+    Setup(Idle);
+    while (Tick() < SIMULATED_TICKS)
+    {
+        Scheduler_RunOnce();
+    }
+
+    uint64_t seconds = SIMULATED_TICKS / 100;
+    printf("%s: CPU busy %.1f %%, %lu samples, %lu lost in FIFO overflows, "
+           "%lu retries, %lu empty polls\n",
+           load->name, 100.0 * busy_cycles / cycles, (unsigned long)samples, (unsigned long)lost,
+           (unsigned long)retried, (unsigned long)empty_polls);
+    printf("  link: %.0f B/s of samples, %.0f B/s of periodic frames, %lu replies, %.1f %% of %d B/s\n",
+           (double)samples * load->devices * load->bytes_per_sample / seconds, (double)periodic_bytes / seconds,
+           (unsigned long)replies,
+           100.0 * ((double)samples * load->devices * load->bytes_per_sample + periodic_bytes +
+                    (double)replies * REPLY_BYTES) / seconds / LINK_BYTES_PER_S, LINK_BYTES_PER_S);
+    printf("  %-12s %8s %9s %9s %9s %8s %9s\n", "task", "runs", "avg [us]", "max [us]", "overruns", "skipped",
+           "lateness");
+    for (uint8_t i = 0; i < Scheduler_GetTaskCount(); i++)
+    {
+        const Scheduler_Task* task = Scheduler_GetTask(i);
+        printf("  %-12s %8lu %9.0f %9lu %9lu %8lu %9lu\n", task->name, (unsigned long)task->stats.runs,
+               task->stats.runs ? (double)task->stats.total_cycles / task->stats.runs / CYCLES_PER_US : 0.0,
+               (unsigned long)(task->stats.max_cycles / CYCLES_PER_US), (unsigned long)task->stats.overruns,
+               (unsigned long)task->stats.skipped, (unsigned long)task->stats.max_lateness);
+    }
+}
+
+/*
+* Host time of a dispatch: empty task bodies, one tick per idle call.
+*/
+static void Nothing(void)
+{
+}
+
+static uint32_t benchmark_tick = 0;
+
+static uint32_t BenchmarkTick(void)
+{
+    return benchmark_tick;
+}
+
+static void BenchmarkIdle(uint32_t now, uint32_t next_release)
+{
+    (void)next_release;
+    benchmark_tick = now + 1;
+}
+
+static void Benchmark(void)
+{
+    Scheduler_Init(BenchmarkTick, BenchmarkTick, BenchmarkIdle);
+    for (int i = 0; i < SCHEDULER_MAX_TASKS; i++)
+    {
+        Scheduler_AddTask("Empty", Nothing, 1 + i % 3, 0, 0, NULL);
+    }
+    struct timespec start, end;
+    uint32_t runs = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long n = 0; n < BENCHMARK_DISPATCHES; n++)
+    {
+        runs += Scheduler_RunOnce();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / BENCHMARK_DISPATCHES;
+    printf("dispatch: %.1f ns per Scheduler_RunOnce() on this host, %d tasks, %.0f %% running a task\n", ns,
+           SCHEDULER_MAX_TASKS, 100.0 * runs / BENCHMARK_DISPATCHES);
+}
+
+int main(void)
+{
+    for (unsigned i = 0; i < sizeof(loads) / sizeof(loads[0]); i++)
+    {
+        Simulate(&loads[i]);
+    }
+    Benchmark();
+    return 0;
+}
@@ -0,0 +1,210 @@
+/*
+* Host test of the boot-time self-test of the firmware (SelfTest.c) on a
+* simulated LIS3DH: a register file behind the I2C_Peripheral functions,
+* a new sample every 10 ms (100 Hz) of simulated time, CyDelay() moving
+* the time on. With CTRL_REG4 ST0 set, each axis adds its self-test
+* output change to the reading.
+*
+* The cases: a working sensor, one axis stuck or too sensitive, a sensor
+* that produces no data, I2C failures at every transaction of the test.
+* After each case the test checks the result, the return value, the
+* restored CTRL_REG4 and the time taken against the bound of SelfTest.h.
+*
+* Build and run from the Host_Tools folder (psoc holds the minimal PSoC
+* headers for the host):
+*
+*     cc -O2 -Ipsoc -I../AY1920_II_HW_05_PROJ_3.cydsn selftest_sim.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/SelfTest.c -o selftest_sim
+*     ./selftest_sim
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "I2C_Interface.h"
+#include "LIS3DH_Registers.h"
+#include "SelfTest.h"
+#include "project.h"
+
+#define SAMPLE_PERIOD_MS 10
+#define GRAVITY_LSB 256         // 1 g in the 10-bit Normal mode at +-2 g
+#define CTRL_REG4_BOOT 0x98     // High resolution, +-4 g, BDU: restored at the end
+#define NOT_FAILING 0xFFFF
+
+/**
+*   \brief Simulated sensor
+*/
+typedef struct {
+    const char* name;
+    int16_t change[3];          // Self-test output change of X, Y, Z [LSb]
+    uint8_t running;            // The ODR is on
+    uint16_t failing;           // Transaction that fails, NOT_FAILING for none
+    // Expected result
+    ErrorCode returned;
+    uint8_t failed_axes;
+    ErrorCode error;
+} Case;
+
+static const Case cases[] = {
+    {"working sensor", {110, -95, 230}, 1, NOT_FAILING, NO_ERROR, 0x00, NO_ERROR},
+    {"Y axis stuck", {110, 0, 230}, 1, NOT_FAILING, ERROR, 0x02, NO_ERROR},
+    {"X axis too sensitive", {400, -95, 230}, 1, NOT_FAILING, ERROR, 0x01, NO_ERROR},
+    {"Z axis weak", {110, -95, 12}, 1, NOT_FAILING, ERROR, 0x04, NO_ERROR},
+    {"no data (ODR off)", {110, -95, 230}, 0, NOT_FAILING, ERROR, 0x07, ERROR},
+};
+
+static const Case* sensor;
+static uint8_t registers[0x40];
+static uint32_t now_ms = 0;             // Simulated time
+static uint32_t last_sample_ms = 0;     // Time of the sample in the output registers
+static uint16_t transactions = 0;
+static uint32_t noise = 1;
+
+void CyDelay(uint32 milliseconds)
+{
+    now_ms += milliseconds;
+}
+
+/*
+* Fill the output registers when a new sample is due.
+*/
+static void Sensor(void)
+{
+    if (!sensor->running || now_ms - last_sample_ms < SAMPLE_PERIOD_MS)
+    {
+        return;
+    }
+    last_sample_ms = now_ms - (now_ms % SAMPLE_PERIOD_MS);
+    const int16_t rest[3] = {12, -20, GRAVITY_LSB};
+    for (int axis = 0; axis < 3; axis++)
+    {
+        noise = noise * 1103515245u + 12345u;
+        int16_t value = rest[axis] + (int16_t)((noise >> 16) % 5) - 2;
+        if (registers[LIS3DH_CTRL_REG4] & LIS3DH_CTRL_REG4_ST_0)
+        {
+            value += sensor->change[axis];
+        }
+        uint16_t word = (uint16_t)(value * 64);   // Left justified 10 bits
+        registers[LIS3DH_OUT_X_L + 2 * axis] = (uint8_t)word;
+        registers[LIS3DH_OUT_X_L + 2 * axis + 1] = (uint8_t)(word >> 8);
+    }
+    registers[LIS3DH_STATUS_REG] |= LIS3DH_STATUS_REG_ZYXDA;
+}
+
+/*
+* Count a transaction; ERROR for the one selected by the case.
+*/
+static ErrorCode Transaction(uint8_t device_address)
+{
+    return device_address != LIS3DH_DEVICE_ADDRESS || transactions++ == sensor->failing ? ERROR : NO_ERROR;
+}
+
+ErrorCode I2C_Peripheral_ReadRegister(uint8_t device_address, uint8_t register_address, uint8_t* data)
+{
+    return I2C_Peripheral_ReadRegisterMulti(device_address, register_address, 1, data);
+}
+
+ErrorCode I2C_Peripheral_ReadRegisterMulti(uint8_t device_address, uint8_t register_address,
+                                           uint8_t register_count, uint8_t* data)
+{
+    if (Transaction(device_address) != NO_ERROR)
+    {
+        return ERROR;
+    }
+    Sensor();
+    memcpy(data, &registers[register_address], register_count);
+    if (register_address <= LIS3DH_OUT_X_L + 5 && register_address + register_count > LIS3DH_OUT_X_L)
+    {
+        // Reading the output clears the data ready flag
+        registers[LIS3DH_STATUS_REG] &= ~LIS3DH_STATUS_REG_ZYXDA;
+    }
+    return NO_ERROR;
+}
+
+ErrorCode I2C_Peripheral_WriteRegister(uint8_t device_address, uint8_t register_address, uint8_t data)
+{
+    if (Transaction(device_address) != NO_ERROR)
+    {
+        return ERROR;
+    }
+    registers[register_address] = data;
+    return NO_ERROR;
+}
+
+ErrorCode I2C_Peripheral_UpdateRegister(uint8_t device_address, uint8_t register_address,
+                                        uint8_t mask, uint8_t value)
+{
+    uint8_t data;
+    ErrorCode error = I2C_Peripheral_ReadRegister(device_address, register_address, &data);
+    if (error == NO_ERROR)
+    {
+        error = I2C_Peripheral_WriteRegister(device_address, register_address, (data & ~mask) | (value & mask));
+    }
+    return error;
+}
+
+/*
+* Run the self-test on the simulated sensor; returns the number of failed
+* checks and, in used, the transactions of the run.
+*/
+static int Run(const Case* simulated, uint16_t* used, int verbose)
+{
+    sensor = simulated;
+    memset(registers, 0, sizeof(registers));
+    registers[LIS3DH_CTRL_REG4] = CTRL_REG4_BOOT;
+    registers[LIS3DH_CTRL_REG5] = LIS3DH_CTRL_REG5_FIFO_EN;
+    now_ms = 3;
+    last_sample_ms = 0;
+    transactions = 0;
+
+    SelfTest_Result result;
+    ErrorCode returned = SelfTest_Run(&result);
+    *used = transactions;
+
+    int failures = 0;
+    // The restore write itself is the only one allowed to leave CTRL_REG4 changed
+    int restored = registers[LIS3DH_CTRL_REG4] == CTRL_REG4_BOOT;
+    uint8_t restore_failed = transactions > 0 && simulated->failing == transactions - 1;
+    failures += returned != simulated->returned;
+    failures += result.error != simulated->error;
+    failures += result.failed_axes != simulated->failed_axes;
+    failures += !restored && !restore_failed;
+    failures += now_ms > SELFTEST_MAX_SAMPLES * SELFTEST_TIMEOUT_MS + 3;
+    if (verbose)
+    {
+        printf("%-22s %s, failed axes 0x%02X, error %s, change %4d %4d %4d, %3lu ms, %2u transactions%s\n",
+               simulated->name, returned == NO_ERROR ? "pass" : "fail", result.failed_axes,
+               result.error == NO_ERROR ? "no" : "yes", result.error == NO_ERROR ? result.change[0] : 0,
+               result.error == NO_ERROR ? result.change[1] : 0, result.error == NO_ERROR ? result.change[2] : 0,
+               (unsigned long)(now_ms - 3), transactions, failures ? "  UNEXPECTED" : "");
+    }
+    return failures;
+}
+
+int main(void)
+{
+    int failures = 0;
+    uint16_t used = 0;
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        failures += Run(&cases[i], &used, 1);
+    }
+
+    // An I2C error at every transaction of a working run
+    Run(&cases[0], &used, 0);
+    Case failing = cases[0];
+    failing.returned = ERROR;
+    failing.failed_axes = 0x07;
+    failing.error = ERROR;
+    int i2c_failures = 0;
+    for (uint16_t t = 0; t < used; t++)
+    {
+        uint16_t ignored;
+        failing.failing = t;
+        i2c_failures += Run(&failing, &ignored, 0);
+    }
+    printf("I2C error at each of the %u transactions: %s\n", used, i2c_failures ? "UNEXPECTED RESULTS" : "all reported");
+    failures += i2c_failures;
+
+    printf("%s\n", failures ? "FAILED" : "all cases as expected");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,322 @@
+/*
+* Check and benchmark of the fixed-point spectrum of the firmware
+* (Spectrum.c).
+*
+* - Golden vectors: the band energies of a set of test signals at 256 and
+*   512 points must match the table below exactly. Run with --golden to
+*   print the table again after a deliberate change of the arithmetic.
+* - Accuracy: the same blocks go through a double precision reference
+*   (mean removal, scaling by 2^exponent, Hann window, DFT / N) and the
+*   error of each band is printed, relative to the band and to the energy
+*   of the block; more than ACCURACY_LIMIT of the block is a failure.
+* - Speed: host time of a whole block and of the longest step of
+*   Spectrum_Process() (the time one run of the spectrum task can take),
+*   against the double precision FFT.
+*
+* Build and run from the Host_Tools folder:
+*
+*     cc -O2 -I../AY1920_II_HW_05_PROJ_3.cydsn spectrum_check.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Spectrum.c -lm -o spectrum_check
+*     ./spectrum_check [--golden]
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "Spectrum.h"
+
+#define SIGNALS 8
+#define SIZES 2
+#define BANDS 6
+#define REPEATS 2000        // Blocks of the timed loops
+#define MAX_STEPS 16
+#define ACCURACY_LIMIT 0.01    // Band errors summed, fraction of the block energy
+#define PI 3.14159265358979323846
+
+static const uint16_t sizes[SIZES] = {256, 512};
+
+// Default bands of Spectrum.c at 256 points; twice the bins at 512
+static const uint16_t edges[SIZES][BANDS + 1] = {
+    {1, 4, 13, 26, 52, 77, 129},
+    {2, 8, 26, 52, 104, 154, 257},
+};
+
+static const char* const names[SIGNALS] = {
+    "tone, bin 5",
+    "tone, bin 40",
+    "tone, bin 100",
+    "tones, bins 2 and 60",
+    "noise",
+    "gravity only",
+    "square 16 g",
+    "tone, bin 20.5",
+};
+
+/*
+* Band energies of the firmware for each signal and size, from --golden.
+*/
+static const uint32_t golden[SIZES][SIGNALS][BANDS] = {
+    {
+        {12, 24000010, 13, 12, 7, 23},  // tone, bin 5
+        {3, 18, 11, 23999581, 13, 38},  // tone, bin 40
+        {6, 8, 11, 14, 6, 13494026},  // tone, bin 100
+        {13500009, 10, 11, 15, 540006, 21},  // tones, bins 2 and 60
+        {84467, 201479, 441413, 1318831, 666238, 1448043},  // noise
+        {0, 0, 0, 0, 0, 0},  // gravity only
+        {3, 8, 14632955, 1805481, 6, 1385461},  // square 16 g
+        {3372, 47, 23995836, 96, 7, 34},  // tone, bin 20.5
+    },
+    {
+        {12, 24000018, 22, 32, 10, 60},  // tone, bin 5
+        {9, 24, 26, 24005124, 13, 58},  // tone, bin 40
+        {12, 19, 22, 40, 15, 13500047},  // tone, bin 100
+        {13500012, 22, 26, 35, 540011, 63},  // tones, bins 2 and 60
+        {721047, 1163897, 2284143, 2941208, 3471382, 6821426},  // noise
+        {0, 0, 0, 0, 0, 0},  // gravity only
+        {9, 22, 14632966, 1804575, 12, 1384877},  // square 16 g
+        {15, 19, 24000022, 31, 17, 52},  // tone, bin 20.5
+    },
+};
+
+/*
+* Z axis [mm/s^2] of sample n of a test signal at a block of points:
+* gravity plus tones at the given bins of the 256-point block.
+*/
+static int32_t Signal(int signal, int n, int points)
+{
+    double scale = points / 256.0;  // Same frequencies at 512 points
+    double g = 9806.0;
+    switch (signal)
+    {
+        case 0:
+            return (int32_t)lround(g + 2000.0 * sin(2 * PI * 5 * scale * n / points));
+        case 1:
+            return (int32_t)lround(g + 500.0 * sin(2 * PI * 40 * scale * n / points + 1.0));
+        case 2:
+            return (int32_t)lround(g + 3000.0 * cos(2 * PI * 100 * scale * n / points));
+        case 3:
+            return (int32_t)lround(g + 1500.0 * sin(2 * PI * 2 * scale * n / points) +
+                                   300.0 * sin(2 * PI * 60 * scale * n / points));
+        case 4:
+        {
+            // Same pseudo-random sequence on every platform
+            static uint32_t state;
+            state = n == 0 ? 12345u : state * 1103515245u + 12345u;
+            return (int32_t)g + (int32_t)((state >> 16) % 2001) - 1000;
+        }
+        case 5:
+            return (int32_t)g;
+        case 6:
+            return (n / 8) % 2 ? 156000 : -156000;
+        default:
+            return (int32_t)lround(g + 1000.0 * sin(2 * PI * 20.5 * scale * n / points));
+    }
+}
+
+/*
+* Put a block in the spectrum and run it to the end; the time of each
+* step is added to step_time when it is not NULL.
+*/
+static void Run(int size, const int32_t* samples, Spectrum_Result* result, double* step_time, int* steps)
+{
+    Spectrum_Configure(2, sizes[size], edges[size], BANDS);
+    for (int n = 0; n < sizes[size]; n++)
+    {
+        int32_t acceleration[3] = {0, 0, samples[n]};
+        Spectrum_AddSample(acceleration, (uint32_t)n);
+    }
+    int step = 0;
+    uint8_t done = 0;
+    while (!done)
+    {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        done = Spectrum_Process(result);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (step_time != NULL && step < MAX_STEPS)
+        {
+            step_time[step] += (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+        }
+        step++;
+    }
+    *steps = step;
+}
+
+/*
+* In-place radix-2 FFT of n complex doubles.
+*/
+static void Fft(double* re, double* im, int n)
+{
+    for (int i = 1, j = 0; i < n; i++)
+    {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j)
+        {
+            double t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    for (int length = 2; length <= n; length <<= 1)
+    {
+        double angle = -2 * PI / length;
+        for (int start = 0; start < n; start += length)
+        {
+            for (int k = 0; k < length / 2; k++)
+            {
+                double wr = cos(angle * k), wi = sin(angle * k);
+                double* ar = &re[start + k];
+                double* ai = &im[start + k];
+                double* br = &re[start + k + length / 2];
+                double* bi = &im[start + k + length / 2];
+                double tr = *br * wr - *bi * wi;
+                double ti = *br * wi + *bi * wr;
+                *br = *ar - tr;
+                *bi = *ai - ti;
+                *ar += tr;
+                *ai += ti;
+            }
+        }
+    }
+}
+
+/*
+* Band energies in double precision, with the exponent of the firmware.
+*/
+static void Reference(int size, const int32_t* samples, int exponent, double energy[BANDS])
+{
+    int points = sizes[size];
+    double re[SPECTRUM_MAX_POINTS], im[SPECTRUM_MAX_POINTS];
+    int64_t sum = 0;
+    for (int n = 0; n < points; n++)
+    {
+        sum += samples[n];
+    }
+    int32_t mean = (int32_t)(sum / points);
+    for (int n = 0; n < points; n++)
+    {
+        double hann = (1 - cos(2 * PI * n / points)) / 2;
+        re[n] = ldexp(samples[n] - mean, exponent) * hann;
+        im[n] = 0;
+    }
+    Fft(re, im, points);
+    for (int b = 0; b < BANDS; b++)
+    {
+        energy[b] = 0;
+        for (int k = edges[size][b]; k < edges[size][b + 1]; k++)
+        {
+            energy[b] += (re[k] * re[k] + im[k] * im[k]) / ((double)points * points);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int print_golden = argc > 1 && strcmp(argv[1], "--golden") == 0;
+    static int32_t samples[SIZES][SIGNALS][SPECTRUM_MAX_POINTS];
+    int mismatches = 0, inaccurate = 0;
+
+    if (!print_golden)
+    {
+        printf("%-22s %6s %4s %12s %12s %12s\n", "signal", "points", "exp", "largest band",
+               "band error", "block error");
+    }
+    for (int size = 0; size < SIZES; size++)
+    {
+        if (print_golden)
+        {
+            printf("    {\n");
+        }
+        for (int signal = 0; signal < SIGNALS; signal++)
+        {
+            for (int n = 0; n < sizes[size]; n++)
+            {
+                samples[size][signal][n] = Signal(signal, n, sizes[size]);
+            }
+            Spectrum_Result result;
+            int steps;
+            Run(size, samples[size][signal], &result, NULL, &steps);
+            if (print_golden)
+            {
+                printf("        {");
+                for (int b = 0; b < BANDS; b++)
+                {
+                    printf("%lu%s", (unsigned long)result.energy[b], b + 1 < BANDS ? ", " : "},");
+                }
+                printf("  // %s\n", names[signal]);
+                continue;
+            }
+            mismatches += memcmp(result.energy, golden[size][signal], sizeof(golden[size][signal])) != 0;
+
+            // Error of the largest band relative to it, of all the bands
+            // relative to the energy of the block
+            double energy[BANDS], total = 0, block_error = 0;
+            int largest = 0;
+            Reference(size, samples[size][signal], result.exponent, energy);
+            for (int b = 0; b < BANDS; b++)
+            {
+                total += energy[b];
+                block_error += fabs(result.energy[b] - energy[b]);
+                largest = energy[b] > energy[largest] ? b : largest;
+            }
+            inaccurate += block_error > ACCURACY_LIMIT * total;
+            double band_error = energy[largest] > 0 ? fabs(result.energy[largest] - energy[largest]) / energy[largest] : 0;
+            printf("%-22s %6u %4d %12d %11.3f%% %11.3f%%%s\n", names[signal], sizes[size], result.exponent, largest,
+                   100 * band_error, total > 0 ? 100 * block_error / total : 0.0,
+                   memcmp(result.energy, golden[size][signal], sizeof(golden[size][signal])) ? "  GOLDEN MISMATCH" : "");
+        }
+        if (print_golden)
+        {
+            printf("    },\n");
+        }
+    }
+    if (print_golden)
+    {
+        return 0;
+    }
+    printf("golden vectors: %s; accuracy: %s\n", mismatches ? "MISMATCH" : "all match",
+           inaccurate ? "OUT OF LIMIT" : "within the limit");
+
+    // Speed: the noise block, fixed point against double precision
+    for (int size = 0; size < SIZES; size++)
+    {
+        double step_time[MAX_STEPS] = {0};
+        Spectrum_Result result;
+        int steps = 0;
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int r = 0; r < REPEATS; r++)
+        {
+            Run(size, samples[size][4], &result, step_time, &steps);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double fixed = ((end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9) / REPEATS;
+        double longest = 0;
+        for (int s = 0; s < steps && s < MAX_STEPS; s++)
+        {
+            longest = step_time[s] > longest ? step_time[s] : longest;
+        }
+
+        double energy[BANDS];
+        volatile double sink = 0;   // Keeps the reference from being optimized out
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int r = 0; r < REPEATS; r++)
+        {
+            Reference(size, samples[size][4], result.exponent, energy);
+            sink += energy[0];
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double reference = ((end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9) / REPEATS;
+        printf("%u points: fixed point %.1f us per block in %d steps, longest step %.1f us; "
+               "double precision %.1f us\n",
+               sizes[size], fixed * 1e6, steps, longest / REPEATS * 1e6, reference * 1e6);
+    }
+    return mismatches || inaccurate ? 1 : 0;
+}
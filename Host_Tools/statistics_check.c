@@ -0,0 +1,196 @@
+/*
+* Accuracy of the windowed statistics of the firmware (Statistics.c)
+* against a double precision reference.
+*
+* Each case feeds a few consecutive windows of a test signal to
+* Statistics_AddSample() and computes mean, RMS, minimum, maximum,
+* peak-to-peak and the RMS of the magnitude of the same samples in double
+* precision. The integer results may only truncate: the mean by less than
+* 1 mm/s^2 towards zero, the RMS values by less than 1 mm/s^2 downwards;
+* minimum, maximum and peak-to-peak must be exact. The full-scale cases
+* use the largest samples of the +-16 g range (240992 mm/s^2) over
+* the longest window (65535 samples), where the accumulators are closest
+* to their limit. The host time per sample closes the report. Exits with 1
+* on an unexpected result.
+*
+* Build and run from the Host_Tools folder:
+*
+*     cc -O2 -I../AY1920_II_HW_05_PROJ_3.cydsn statistics_check.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Statistics.c -lm -o statistics_check
+*     ./statistics_check
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include "Statistics.h"
+
+#define FULL_SCALE 240992       // 2048 digits of 117672 um/s^2 at +-16 g [mm/s^2]
+#define WINDOWS 3
+#define TIMED_SAMPLES 20000000
+#define PI 3.14159265358979323846
+
+/**
+*   \brief Test signals: sample n of axis a
+*/
+typedef int32_t (*Signal)(uint32_t n, uint8_t axis);
+
+typedef struct {
+    const char* name;
+    Signal signal;
+    uint16_t window;
+} Case;
+
+static uint32_t noise = 1;
+
+static int32_t Random(int32_t range)
+{
+    noise = noise * 1103515245u + 12345u;
+    return (int32_t)((noise >> 4) % (2u * (uint32_t)range + 1u)) - range;
+}
+
+static int32_t Still(uint32_t n, uint8_t axis)
+{
+    (void)n;
+    return axis == 2 ? 9806 : (axis == 0 ? 12 : -7);
+}
+
+static int32_t Tone(uint32_t n, uint8_t axis)
+{
+    double phase = 2 * PI * 7 * n / 100 + axis;
+    return (int32_t)lround(5000 * sin(phase)) + (axis == 2 ? 9806 : -333) + Random(40);
+}
+
+static int32_t Negative(uint32_t n, uint8_t axis)
+{
+    // Odd sums of negative samples: the mean truncates towards zero
+    return -1000 * (axis + 1) - (int32_t)(n % 3);
+}
+
+static int32_t FullScale(uint32_t n, uint8_t axis)
+{
+    return (n + axis) % 2 ? FULL_SCALE : -FULL_SCALE;
+}
+
+static int32_t Saturated(uint32_t n, uint8_t axis)
+{
+    (void)n;
+    return axis == 1 ? -FULL_SCALE : FULL_SCALE;
+}
+
+static int32_t Noise(uint32_t n, uint8_t axis)
+{
+    (void)n;
+    (void)axis;
+    return Random(FULL_SCALE);
+}
+
+static const Case cases[] = {
+    {"still, 1 g on Z", Still, 100},
+    {"7 Hz tone with noise", Tone, 100},
+    {"7 Hz tone, 10 s", Tone, 1000},
+    {"negative odd sums", Negative, 7},
+    {"single sample", Tone, 1},
+    {"full scale square", FullScale, 65535},
+    {"full scale constant", Saturated, 65535},
+    {"full scale noise", Noise, 65535},
+};
+
+/*
+* Run the windows of a case; returns the failed checks and prints the
+* worst errors.
+*/
+static int Run(const Case* test)
+{
+    double worst_mean = 0, worst_rms = 0, worst_magnitude = 0;
+    uint32_t wrong_extremes = 0, wrong_windows = 0;
+    uint32_t n = 0;
+    Statistics_SetWindow(test->window);
+    for (uint8_t w = 0; w < WINDOWS; w++)
+    {
+        double sum[3] = {0, 0, 0}, squares[3] = {0, 0, 0};
+        int32_t minimum[3] = {INT32_MAX, INT32_MAX, INT32_MAX};
+        int32_t maximum[3] = {INT32_MIN, INT32_MIN, INT32_MIN};
+        uint32_t first = n;
+        Statistics_Result result;
+        uint8_t done = 0;
+        for (uint32_t k = 0; k < test->window; k++, n++)
+        {
+            int32_t acceleration[3];
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                int32_t value = test->signal(n, axis);
+                acceleration[axis] = value;
+                sum[axis] += value;
+                squares[axis] += (double)value * value;
+                minimum[axis] = value < minimum[axis] ? value : minimum[axis];
+                maximum[axis] = value > maximum[axis] ? value : maximum[axis];
+            }
+            done = Statistics_AddSample(acceleration, n, &result);
+            wrong_windows += done != (k == test->window - 1u);
+        }
+        wrong_windows += result.first_index != first || result.count != test->window;
+
+        double magnitude = 0;
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            const Statistics_Axis* out = &result.axis[axis];
+            double mean = sum[axis] / test->window;
+            double rms = sqrt(squares[axis] / test->window);
+            // Truncation only: towards zero for the mean, down for the RMS
+            double mean_error = out->mean - mean;
+            double rms_error = out->rms - rms;
+            worst_mean = fabs(mean_error) > fabs(worst_mean) ? mean_error : worst_mean;
+            worst_rms = fabs(rms_error) > fabs(worst_rms) ? rms_error : worst_rms;
+            wrong_windows += fabs(mean_error) >= 1 || mean_error * mean > 0;
+            wrong_windows += rms_error > 1e-9 || rms_error <= -1;
+            wrong_extremes += out->min != minimum[axis] || out->max != maximum[axis] ||
+                              out->peak_to_peak != (uint32_t)(maximum[axis] - minimum[axis]);
+            magnitude += squares[axis];
+        }
+        double magnitude_error = result.magnitude_rms - sqrt(magnitude / test->window);
+        worst_magnitude = fabs(magnitude_error) > fabs(worst_magnitude) ? magnitude_error : worst_magnitude;
+        wrong_windows += magnitude_error > 1e-9 || magnitude_error <= -1;
+    }
+    int failures = wrong_windows > 0 || wrong_extremes > 0;
+    printf("%-22s %5u  %+8.3f  %+8.3f  %+8.3f  %8lu%s\n", test->name, test->window, worst_mean, worst_rms,
+           worst_magnitude, (unsigned long)wrong_extremes, failures ? "  UNEXPECTED" : "");
+    return failures;
+}
+
+static double Elapsed(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+int main(void)
+{
+    int failures = 0;
+    printf("%-22s %5s  %8s  %8s  %8s  %8s\n", "case [mm/s^2]", "win", "mean", "rms", "|a| rms",
+           "min/max");
+    for (unsigned c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        failures += Run(&cases[c]);
+    }
+
+    Statistics_SetWindow(STATISTICS_DEFAULT_WINDOW);
+    Statistics_Result result;
+    volatile uint32_t sink = 0;     // Keeps the windows from being optimized out
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long n = 0; n < TIMED_SAMPLES; n++)
+    {
+        int32_t acceleration[3] = {(int32_t)(n % 1000) - 500, (int32_t)(n % 333), 9806};
+        if (Statistics_AddSample(acceleration, (uint32_t)n, &result))
+        {
+            sink += result.magnitude_rms;
+        }
+    }
+    printf("%.1f ns per sample (3 axes) on this host\n", Elapsed(&start) / TIMED_SAMPLES * 1e9);
+    printf("%s\n", failures ? "UNEXPECTED RESULTS" : "all statistics within the truncation of the integer code");
+    return failures ? 1 : 0;
+}
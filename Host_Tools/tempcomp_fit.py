@@ -0,0 +1,161 @@
+"""Build the temperature compensation table of AY1920_II_HW_05_PROJ_3.
+
+Record the UART stream while the board stays still in a known orientation
+and the temperature is swept, with the raw stream ('r') and the temperature
+channel ('p') on and the compensation ('n') off. The tool pairs each sample
+with the last temperature reading, fits a continuous piecewise-linear
+offset per axis (least squares on evenly spaced temperatures) and writes
+the binary table image described in TempCompensation.h. With --port the
+image is also uploaded ('z' command, requires pyserial): after the ready
+line of the board the image goes in chunks of 4 bytes, each acknowledged,
+since UART_Debug has only its 4-byte RX FIFO.
+
+    python tempcomp_fit.py sweep.bin --reference 0,0,9806 --points 5 -o table.bin
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+import frames
+
+MAGIC = 0x5443
+MAX_POINTS = 7
+UPLOAD_READY = b"Compensation table upload: ready\r\n"
+UPLOAD_CHUNK = 4        # COMMANDS_UPLOAD_CHUNK
+UPLOAD_ACK = b"\x06"    # COMMANDS_UPLOAD_ACK
+UPLOAD_READY_TIMEOUT = 5.0  # [s], the command task runs every 100 ms
+
+
+def collect(data):
+    """Return a list of (temperature, x, y, z)."""
+    pairs = []
+    temperature = None
+    for header, payload in frames.decode(data):
+        if header == frames.AUXILIARY:
+            temperature = frames.auxiliary(payload)[3]
+        elif header == frames.SAMPLE and temperature is not None:
+            pairs.append((temperature,) + frames.sample(payload))
+    return pairs
+
+
+def solve(matrix, vector):
+    """Solve a small linear system by Gaussian elimination."""
+    n = len(vector)
+    rows = [matrix[i][:] + [vector[i]] for i in range(n)]
+    for column in range(n):
+        pivot = max(range(column, n), key=lambda r: abs(rows[r][column]))
+        rows[column], rows[pivot] = rows[pivot], rows[column]
+        if rows[column][column] == 0:
+            raise ValueError("temperature sweep too narrow for the number of points")
+        for r in range(n):
+            if r != column:
+                factor = rows[r][column] / rows[column][column]
+                for k in range(column, n + 1):
+                    rows[r][k] -= factor * rows[column][k]
+    return [rows[i][n] / rows[i][i] for i in range(n)]
+
+
+def hat_weights(knots, t):
+    """Weights of the piecewise-linear basis at temperature t."""
+    weights = [0.0] * len(knots)
+    if t <= knots[0]:
+        weights[0] = 1.0
+    elif t >= knots[-1]:
+        weights[-1] = 1.0
+    else:
+        for i in range(len(knots) - 1):
+            if knots[i] <= t <= knots[i + 1]:
+                f = (t - knots[i]) / (knots[i + 1] - knots[i])
+                weights[i] = 1.0 - f
+                weights[i + 1] = f
+                break
+    return weights
+
+
+def fit(pairs, reference, points):
+    low = min(p[0] for p in pairs)
+    high = max(p[0] for p in pairs)
+    if high - low < points - 1:
+        raise ValueError("temperature sweep of %d digits too narrow for %d points" % (high - low, points))
+    knots = [round(low + (high - low) * i / (points - 1)) for i in range(points)]
+
+    offsets = []
+    for axis in range(3):
+        normal = [[0.0] * points for _ in range(points)]
+        right = [0.0] * points
+        for pair in pairs:
+            w = hat_weights(knots, pair[0])
+            error = pair[1 + axis] - reference[axis]
+            for i in range(points):
+                right[i] += w[i] * error
+                for j in range(points):
+                    normal[i][j] += w[i] * w[j]
+        offsets.append(solve(normal, right))
+    return knots, [[round(offsets[axis][i]) for axis in range(3)] for i in range(points)]
+
+
+def image(knots, offsets):
+    body = struct.pack("<HBB", MAGIC, len(knots), 0)
+    for temperature, offset in zip(knots, offsets):
+        body += struct.pack("<hhhh", temperature, *offset)
+    body += bytes([(-sum(body)) & 0xFF])
+    # Fixed size upload, as expected by the firmware
+    return body + bytes(4 + 8 * MAX_POINTS + 1 - len(body))
+
+
+def upload(port, table):
+    """Send the 'z' command and the table in acknowledged chunks."""
+    port.reset_input_buffer()
+    port.write(b"z")
+    # Skip the frames streamed before the command is executed
+    received = b""
+    deadline = time.monotonic() + UPLOAD_READY_TIMEOUT
+    while UPLOAD_READY not in received:
+        if time.monotonic() > deadline:
+            sys.exit("no reply to the upload command")
+        received = received[-len(UPLOAD_READY):] + port.read(max(1, port.in_waiting))
+    for offset in range(0, len(table), UPLOAD_CHUNK):
+        port.write(table[offset:offset + UPLOAD_CHUNK])
+        if port.read(1) != UPLOAD_ACK:
+            sys.exit("upload stopped at byte %d: no acknowledge" % offset)
+    print(port.readline().decode(errors="replace").strip())
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("recording", help="binary UART recording of the sweep")
+    parser.add_argument("--reference", default="0,0,9806",
+                        help="expected X,Y,Z in mm/s^2 for the orientation of the sweep")
+    parser.add_argument("--points", type=int, default=5, help="points of the table (2 ... 7)")
+    parser.add_argument("-o", "--output", default="tempcomp.bin", help="table image file")
+    parser.add_argument("--port", help="serial port to upload the table to")
+    parser.add_argument("--baud", type=int, default=19200)
+    args = parser.parse_args()
+
+    if not 2 <= args.points <= MAX_POINTS:
+        parser.error("--points must be between 2 and %d" % MAX_POINTS)
+    reference = [int(v) for v in args.reference.split(",")]
+
+    with open(args.recording, "rb") as f:
+        pairs = collect(f.read())
+    if not pairs:
+        sys.exit("no samples with a temperature reading in the recording")
+
+    knots, offsets = fit(pairs, reference, args.points)
+    for temperature, offset in zip(knots, offsets):
+        print("T %5d  offset X %6d  Y %6d  Z %6d mm/s^2" % ((temperature,) + tuple(offset)))
+
+    table = image(knots, offsets)
+    with open(args.output, "wb") as f:
+        f.write(table)
+
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=2) as port:
+            upload(port, table)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,102 @@
+/*
+* Accuracy and speed of the CORDIC atan2 of the firmware (Tilt.c) against
+* atan2() of the C library.
+*
+* Build and run from the Host_Tools folder:
+*
+*     cc -O2 -I../AY1920_II_HW_05_PROJ_3.cydsn tilt_benchmark.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Tilt.c -lm -o tilt_benchmark
+*     ./tilt_benchmark
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include "Tilt.h"
+
+#define ANGLES 3600         // Test vectors around the circle
+#define MAGNITUDES 6        // From 10 to 10^6 [mm/s^2]
+#define REPEATS 200         // Repetitions of the timed loops
+#define PI 3.14159265358979323846
+
+static double Elapsed(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+int main(void)
+{
+    static int32_t xs[ANGLES * MAGNITUDES];
+    static int32_t ys[ANGLES * MAGNITUDES];
+    int vectors = 0;
+
+    // Accuracy: angle and magnitude of each vector against double precision
+    double worst_angle = 0.0, sum_squares = 0.0, worst_magnitude = 0.0;
+    double magnitude = 10.0;
+    for (int m = 0; m < MAGNITUDES; m++, magnitude *= 10.0)
+    {
+        for (int a = 0; a < ANGLES; a++)
+        {
+            double theta = (a + 0.37) * 2.0 * PI / ANGLES - PI;
+            int32_t x = (int32_t)lround(magnitude * cos(theta));
+            int32_t y = (int32_t)lround(magnitude * sin(theta));
+            xs[vectors] = x;
+            ys[vectors] = y;
+            vectors++;
+
+            uint32_t cordic_magnitude;
+            double expected = atan2((double)y, (double)x) * 18000.0 / PI;
+            double error = fabs(Tilt_Atan2(y, x, &cordic_magnitude) - expected);
+            if (error > 18000.0)
+            {
+                error = 36000.0 - error;    // +180 and -180 are the same angle
+            }
+            sum_squares += error * error;
+            worst_angle = error > worst_angle ? error : worst_angle;
+
+            // Relative error where the rounding to an integer is negligible
+            double length = hypot((double)x, (double)y);
+            double relative = fabs(cordic_magnitude - length) / length;
+            if (length >= 1000.0 && relative > worst_magnitude)
+            {
+                worst_magnitude = relative;
+            }
+        }
+    }
+    printf("Angle error: max %.4f deg, rms %.4f deg (%d vectors)\n",
+           worst_angle / 100.0, sqrt(sum_squares / vectors) / 100.0, vectors);
+    printf("Magnitude error: max %.4f %% (magnitudes from 1000)\n", worst_magnitude * 100.0);
+
+    // Speed: the sums keep the compiler from dropping the calls
+    struct timespec start;
+    long cordic_sum = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < REPEATS; r++)
+    {
+        for (int i = 0; i < vectors; i++)
+        {
+            cordic_sum += Tilt_Atan2(ys[i], xs[i], NULL);
+        }
+    }
+    double cordic_time = Elapsed(&start);
+
+    double library_sum = 0.0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < REPEATS; r++)
+    {
+        for (int i = 0; i < vectors; i++)
+        {
+            library_sum += atan2((double)ys[i], (double)xs[i]);
+        }
+    }
+    double library_time = Elapsed(&start);
+
+    long calls = (long)REPEATS * vectors;
+    printf("CORDIC: %.1f ns/call, libm atan2: %.1f ns/call (checksums %ld %.1f)\n",
+           cordic_time * 1e9 / calls, library_time * 1e9 / calls, cordic_sum, library_sum);
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+* Host test of the timestamps of the firmware (Timestamp.c with the Timer
+* ISR of InterruptRoutine.c) on a simulated 24 MHz bus clock.
+*
+* The Timer reloads every 10 ms of real time; its ISR runs after a random
+* latency of up to MAX_LATENCY_US (critical sections, other interrupts),
+* also in the middle of a Timestamp_Now() call. The CPU cycle counter
+* starts close to its wrap and only counts while the CPU is awake: in the
+* sleep runs the CPU sleeps from the end of the work of a tick to the next
+* interrupt; in the active runs it stays awake and also reads the time
+* between a reload and its ISR.
+*
+* Every timestamp is checked against the real time: it must never go back,
+* lag by at most the ISR latency and resolve 1 us. Exits with 1 otherwise.
+*
+* Build and run from the Host_Tools folder (psoc holds the minimal PSoC
+* headers for the host):
+*
+*     cc -O2 -Ipsoc -I../AY1920_II_HW_05_PROJ_3.cydsn timestamp_check.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Timestamp.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/InterruptRoutine.c -o timestamp_check
+*     ./timestamp_check
+*/
+
+#include <stdio.h>
+#include "InterruptRoutines.h"
+#include "PowerManager.h"
+#include "Timestamp.h"
+#include "project.h"
+
+#define CYCLES_PER_US (BCLK__BUS_CLK__HZ / 1000000u)
+#define TICK_CYCLES (BCLK__BUS_CLK__HZ / 100u)
+#define MAX_LATENCY_US 100
+#define MAX_WORK_US 3000        // Awake time after each tick in the sleep runs
+#define MAX_READ_GAP 60         // Cycles between two reads, at most
+#define TICKS 3000
+
+static uint64_t real = 0;               // Bus clock cycles since the start
+static uint32_t cycles = 0;             // DWT cycle counter
+static uint64_t next_reload = TICK_CYCLES;
+static uint64_t isr_due = TICK_CYCLES;
+static uint8_t awake = 1;
+static uint8_t in_isr = 0;
+static uint32_t isr_in_read = 0;        // ISRs that ran inside Timestamp_Now()
+static uint8_t reading = 0;
+static uint32_t noise = 1;
+
+static uint32_t Random(uint32_t range)
+{
+    noise = noise * 1103515245u + 12345u;
+    return (noise >> 8) % range;
+}
+
+/*
+* Move the real time on, the cycle counter too when the CPU is awake, and
+* run the Timer ISR when it is due; the interrupt wakes the CPU up.
+*/
+static void Advance(uint32_t n)
+{
+    while (n > 0)
+    {
+        uint32_t step = real + n > isr_due ? (uint32_t)(isr_due - real) : n;
+        real += step;
+        cycles += awake ? step : 0;
+        n -= step;
+        if (real == isr_due)
+        {
+            awake = 1;
+            in_isr = 1;
+            Custom_ISR();
+            in_isr = 0;
+            isr_in_read += reading;
+            next_reload += TICK_CYCLES;
+            isr_due = next_reload + Random(MAX_LATENCY_US * CYCLES_PER_US + 1);
+        }
+    }
+}
+
+uint8 Timer_ReadStatusRegister(void)
+{
+    return 0;
+}
+
+uint32_t PowerManager_ReadCycles(void)
+{
+    if (!in_isr)
+    {
+        // A few cycles of the caller, the ISR may run in between
+        Advance(1 + Random(8));
+    }
+    return cycles;
+}
+
+/*
+* Read the time until TICKS ticks have passed; returns the failed checks
+* and prints the worst values.
+*/
+static int Run(const char* name, uint8_t sleep)
+{
+    uint32_t previous = Timestamp_Now();
+    uint32_t steps_back = 0, reads = 0, smallest_step = UINT32_MAX;
+    int64_t lag_min = INT64_MAX, lag_max = INT64_MIN;
+    uint32_t start_tick = Timer_Tick;
+    uint64_t work_end = next_reload - TICK_CYCLES + Random(MAX_WORK_US * CYCLES_PER_US);
+    isr_in_read = 0;
+    while (Timer_Tick - start_tick < TICKS)
+    {
+        Advance(1 + Random(MAX_READ_GAP));
+        if (sleep && real >= work_end)
+        {
+            // Sleep to the next interrupt, then work for a while
+            awake = 0;
+            uint32_t tick = Timer_Tick;
+            while (Timer_Tick == tick)
+            {
+                Advance(CYCLES_PER_US);
+            }
+            work_end = real + Random(MAX_WORK_US * CYCLES_PER_US);
+        }
+        reading = 1;
+        uint32_t now = Timestamp_Now();
+        reading = 0;
+        reads++;
+        steps_back += now < previous;
+        if (now > previous && now - previous < smallest_step)
+        {
+            smallest_step = now - previous;
+        }
+        previous = now;
+        int64_t lag = (int64_t)(real / CYCLES_PER_US) - now;
+        lag_min = lag < lag_min ? lag : lag_min;
+        lag_max = lag > lag_max ? lag : lag_max;
+    }
+    int failures = (steps_back > 0) + (smallest_step != 1) + (lag_min < 0) + (lag_max > MAX_LATENCY_US + 1);
+    printf("%-7s %9lu reads, %4lu ISRs inside a read, %lu steps back, smallest step %lu us, "
+           "lag %lld ... %lld us%s\n", name, (unsigned long)reads, (unsigned long)isr_in_read,
+           (unsigned long)steps_back, (unsigned long)smallest_step, (long long)lag_min, (long long)lag_max,
+           failures ? "  UNEXPECTED" : "");
+    return failures;
+}
+
+int main(void)
+{
+    // Close to the wrap of the cycle counter; tick 0 starts now
+    cycles = 0xFFFFFFFFu - 5 * TICK_CYCLES;
+    Timer_TickCycles = cycles;
+    int failures = Run("active", 0) + Run("sleep", 1) + Run("active", 0);
+    printf("%s (lag limit: %d us of ISR latency)\n", failures ? "FAILED" : "all timestamps as expected",
+           MAX_LATENCY_US);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+/*
+* Accuracy and speed of the velocity RMS of the firmware (Velocity.c).
+*
+* Sinusoidal accelerations on top of gravity and an offset go through
+* Velocity_AddSample() at the data rates of the LIS3DH; the RMS of each
+* window is compared with the exact A / (2 pi f) / sqrt(2). The errors are
+* checked against the bands of Velocity.h (1.5% from 5 Hz to fs / 5 at
+* 100 Hz and above, 2.5% at 50 Hz, 6% at fs / 2.5). A still sensor must
+* read no velocity, also after a step of the offset (a change of
+* orientation). The host time per sample closes the report.
+*
+* Build and run from the Host_Tools folder:
+*
+*     cc -O2 -I../AY1920_II_HW_05_PROJ_3.cydsn velocity_check.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Velocity.c \
+*        ../AY1920_II_HW_05_PROJ_3.cydsn/Statistics.c -lm -o velocity_check
+*     ./velocity_check
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include "Velocity.h"
+
+#define AMPLITUDE 5000.0        // [mm/s^2], about 0.5 g
+#define SETTLE_S 20             // Seconds before the windows are compared
+#define MEASURED_S 10
+#define STILL_LIMIT 2           // Velocity RMS of a still sensor [um/s]
+#define TIMED_SAMPLES 20000000
+#define PI 3.14159265358979323846
+
+static const uint16_t rates[] = {50, 100, 200, 400};
+static const double frequencies[] = {5, 10, 20, 40, 80, 160};
+
+static double Elapsed(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+/*
+* Worst error of the X RMS against the exact value, over the windows after
+* the settling time, for a tone at f [Hz] at the rate fs [Hz].
+*/
+static double Error(uint16_t fs, double f)
+{
+    Velocity_SetRate(fs);
+    Velocity_SetWindow(fs);
+    double expected = AMPLITUDE / (2 * PI * f) / sqrt(2) * 1000;   // [um/s]
+    double worst = 0;
+    Velocity_Result result;
+    for (long n = 0; n < (long)fs * (SETTLE_S + MEASURED_S); n++)
+    {
+        double phase = 2 * PI * f * n / fs;
+        int32_t acceleration[3] = {
+            (int32_t)lround(AMPLITUDE * sin(phase)) + 150,
+            (int32_t)lround(AMPLITUDE / 10 * sin(phase + 1)) - 80,
+            (int32_t)lround(9806 + AMPLITUDE * cos(phase)),
+        };
+        if (Velocity_AddSample(acceleration, (uint32_t)n, &result) && n >= (long)fs * SETTLE_S)
+        {
+            double error = result.rms[0] / expected - 1;
+            worst = fabs(error) > fabs(worst) ? error : worst;
+        }
+    }
+    return worst;
+}
+
+/*
+* Largest velocity RMS of a still sensor, over the last half of a minute
+* whose offset steps by 1 m/s^2 after 10 s.
+*/
+static uint32_t Still(uint16_t fs)
+{
+    Velocity_SetRate(fs);
+    Velocity_SetWindow(fs);
+    Velocity_Result result;
+    uint32_t worst = 0;
+    for (long n = 0; n < (long)fs * 60; n++)
+    {
+        int32_t step = n >= (long)fs * 10 ? 1000 : 0;
+        int32_t acceleration[3] = {37 + step, -12, 9806 - step};
+        if (Velocity_AddSample(acceleration, (uint32_t)n, &result) && n >= (long)fs * 30)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                worst = result.rms[axis] > worst ? result.rms[axis] : worst;
+            }
+        }
+    }
+    return worst;
+}
+
+int main(void)
+{
+    int failures = 0;
+    printf("%6s", "f [Hz]");
+    for (unsigned r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+    {
+        printf(" %8u Hz", rates[r]);
+    }
+    printf("\n");
+    for (unsigned i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++)
+    {
+        printf("%6.0f", frequencies[i]);
+        for (unsigned r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+        {
+            uint16_t fs = rates[r];
+            double f = frequencies[i];
+            if (f > fs / 2.5)
+            {
+                printf(" %11s", "");
+                continue;
+            }
+            double error = Error(fs, f);
+            // Bands of Velocity.h
+            double limit = f <= fs / 5.0 ? (fs >= 100 ? 0.015 : 0.025) : 0.06;
+            int pass = fabs(error) <= limit;
+            failures += !pass;
+            printf(" %+9.2f%%%s", 100 * error, pass ? " " : "!");
+        }
+        printf("\n");
+    }
+
+    for (unsigned r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+    {
+        uint32_t still = Still(rates[r]);
+        failures += still > STILL_LIMIT;
+        printf("still sensor at %u Hz, offset step: %lu um/s RMS%s\n", rates[r], (unsigned long)still,
+               still > STILL_LIMIT ? "  OVER THE LIMIT" : "");
+    }
+
+    Velocity_SetRate(100);
+    Velocity_SetWindow(100);
+    Velocity_Result result;
+    volatile uint32_t sink = 0;     // Keeps the windows from being optimized out
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long n = 0; n < TIMED_SAMPLES; n++)
+    {
+        int32_t acceleration[3] = {(int32_t)(n % 1000) - 500, (int32_t)(n % 333), 9806};
+        if (Velocity_AddSample(acceleration, (uint32_t)n, &result))
+        {
+            sink += result.rms[0];
+        }
+    }
+    printf("%.1f ns per sample (3 axes) on this host\n", Elapsed(&start) / TIMED_SAMPLES * 1e9);
+    printf("%s\n", failures ? "OUT OF THE LIMITS" : "all within the limits of Velocity.h");
+    return failures ? 1 : 0;
+}